@@ -19,6 +19,8 @@
 #include <SceneManager.h>
 #include <PipelineData.h>
 #include <VertexHelpers.h>
+#include <MeshOptimizer.h>
+#include <NodeRef.h>
 
 #include <EntityRegistry.h>
 
@@ -84,6 +86,14 @@ namespace Glory::Editor
     };
 #pragma warning(pop)
 
+    /* Import settings and overrides of a model are stored next to it */
+    static std::filesystem::path ImportsFilePath(const std::filesystem::path& path)
+    {
+        std::filesystem::path importsFilePath = path;
+        importsFilePath.replace_extension(path.extension().string() + ".imports");
+        return importsFilePath;
+    }
+
     ASSIMPImporter::ASSIMPImporter()
 	{
 	}
@@ -107,9 +117,7 @@ namespace Glory::Editor
 
     EditableResource* ASSIMPImporter::GetEditableResource(const std::filesystem::path& path) const
     {
-        std::filesystem::path overrideFilePath = path;
-        const std::string newExtension = path.extension().string() + ".imports";
-        overrideFilePath.replace_extension(newExtension);
+        const std::filesystem::path overrideFilePath = ImportsFilePath(path);
 
         YAMLResource<ModelData>* pEditableResource = new FullYAMLResource<ModelData>(overrideFilePath);
         if (!std::filesystem::exists(overrideFilePath))
@@ -121,6 +129,8 @@ namespace Glory::Editor
                 imports.SetMap();
             if (!overrides.Exists() || !overrides.IsMap())
                 overrides.SetMap();
+            imports["CompressVertices"].Set(true);
+            imports["QuantizePositions"].Set(true);
         }
         return pEditableResource;
     }
@@ -236,6 +246,12 @@ namespace Glory::Editor
         ReadMetaData("FrontAxisSign", context.FrontAxisSign);
         ReadMetaData("UnitScaleFactor", context.UnitScaleFactor);
 
+        /* Large or precision sensitive meshes like terrain can opt out of compression per model */
+        Utils::YAMLFileRef importsFile{ ImportsFilePath(path) };
+        Utils::NodeValueRef imports = importsFile["ImportSettings"];
+        context.CompressVertices = imports["CompressVertices"].As<bool>(true);
+        context.QuantizePositions = imports["QuantizePositions"].As<bool>(true);
+
         std::function<void(ImportedResource&, Resource*, const std::string_view)> giveName =
         [](ImportedResource& resource, Resource* pResource, const std::string_view name) {
             std::string uniqueName{ name };
@@ -815,6 +831,41 @@ namespace Glory::Editor
         pMesh->AddBoundingBox(min, max);
         pMesh->AddBoundingSphere(center, radius);
 
+        /* Distant objects are drawn with simplified versions of the mesh */
+        GenerateMeshLODs(pMesh);
+
+        /* Reorder triangles and vertices for the post-transform cache, overdraw and vertex fetch */
+        const VertexCacheStats before = AnalyzeVertexCache(pMesh->Indices(), pMesh->IndexCount(), pMesh->VertexCount());
+        OptimizeMesh(pMesh);
+        const VertexCacheStats after = AnalyzeVertexCache(pMesh->Indices(), pMesh->IndexCount(), pMesh->VertexCount());
+        std::stringstream optimizeStream;
+        optimizeStream << "ASSIMPImporter::ProcessMesh: Optimized mesh " << pMesh->Name() << ": ACMR " << before.m_ACMR
+            << " -> " << after.m_ACMR << ", ATVR " << before.m_ATVR << " -> " << after.m_ATVR;
+        debug.LogInfo(optimizeStream.str());
+
+        if (!context.CompressVertices)
+        {
+            delete[] vertices;
+            return pMesh;
+        }
+
+        /* Store attributes in the smallest formats the vertex input can still read as floats, see CompactVertex3D */
+        const uint32_t uncompressedSize = pMesh->VertexCount()*pMesh->VertexSize() + pMesh->IndexCount()*sizeof(uint32_t);
+        const AttributeType positionType = context.QuantizePositions ? AttributeType::UNorm16x4 : AttributeType::Float3;
+        if (!CompressVertices(pMesh, { positionType, AttributeType::SNorm8x4, AttributeType::SNorm8x4,
+            AttributeType::SNorm8x4, AttributeType::Half2, AttributeType::UNorm8x4 }))
+        {
+            debug.LogWarning("ASSIMPImporter::ProcessMesh: Failed to compress vertices of mesh " + pMesh->Name());
+        }
+        else
+        {
+            const uint32_t compressedSize = pMesh->VertexCount()*pMesh->VertexSize() + pMesh->IndexCount()*pMesh->IndexStride();
+            std::stringstream compressStream;
+            compressStream << "ASSIMPImporter::ProcessMesh: Compressed mesh " << pMesh->Name() << " from "
+                << uncompressedSize << " to " << compressedSize << " bytes";
+            debug.LogInfo(compressStream.str());
+        }
+
         delete[] vertices;
         return pMesh;
     }
@@ -52,6 +52,10 @@ namespace Glory::Editor
             AxisConversion FrontAxis{ AxisConversion::Z };
             int FrontAxisSign{ 1 };
             float UnitScaleFactor{ 1.0f };
+            /** @brief Store vertex attributes in smaller formats, see @ref CompactVertex3D */
+            bool CompressVertices{ true };
+            /** @brief Store positions as 16 bit integers over the bounds of the mesh, otherwise they stay floats */
+            bool QuantizePositions{ true };
         };
 
         void EnsureUniqueAssetName(Context& context, Resource* pResource) const;
@@ -12,6 +12,7 @@
 #include <glm/ext/vector_int2.hpp>
 #include <freetype2/ft2build.h>
 #include FT_FREETYPE_H
+#include FT_MODULE_H
 
 namespace Glory::Editor
 {
@@ -45,8 +46,12 @@ namespace Glory::Editor
 		}
 
 		const uint32_t fontHeight = 48;
+		/* Glyphs are stored as signed distance fields so one atlas serves every text size,
+		 * the distance is stored up to this many pixels away from the outline */
+		const FT_Int spread = 6;
 
 		FT_Set_Pixel_Sizes(face, 0, fontHeight);
+		FT_Property_Set(FTLib, "sdf", "spread", &spread);
 
 		FT_ULong charcode;
 		FT_UInt gid;
@@ -60,15 +65,28 @@ namespace Glory::Editor
 		const uint32_t edgePadding = padding;
 		uint32_t writeX = edgePadding, writeY = edgePadding;
 		uint32_t highestGlyph = 0;
+		/* Only read kerning between latin characters to keep the number of pairs to check small */
+		const FT_ULong maxKerningCharacter = 0x250;
 
 		std::vector<uint64_t> characterCodes;
 		std::vector<GlyphData> glyphs;
+		std::vector<std::pair<FT_ULong, FT_UInt>> kerningCandidates;
 		while (gid != 0)
 		{
 			// load character glyph 
-			if (FT_Load_Char(face, charcode, FT_LOAD_RENDER))
+			if (FT_Load_Char(face, charcode, FT_LOAD_DEFAULT))
 			{
 				debug.LogError("FREETYTPE: Failed to load Glyph");
+				charcode = FT_Get_Next_Char(face, charcode, &gid);
+				continue;
+			}
+
+			/* Glyphs without an outline such as spaces have nothing to render */
+			const bool hasOutline = face->glyph->format == FT_GLYPH_FORMAT_OUTLINE && face->glyph->outline.n_points > 0;
+			if (hasOutline && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF))
+			{
+				debug.LogError("FREETYTPE: Failed to render Glyph");
+				charcode = FT_Get_Next_Char(face, charcode, &gid);
 				continue;
 			}
 
@@ -78,10 +96,15 @@ namespace Glory::Editor
 				writeY += highestGlyph + padding;
 				highestGlyph = 0;
 			}
+			if (writeY + face->glyph->bitmap.rows >= height - edgePadding)
+			{
+				debug.LogError("FREETYTPE: Font atlas is full, remaining glyphs are skipped");
+				break;
+			}
 			for (size_t row = 0; row < face->glyph->bitmap.rows; ++row)
 			{
 				char* writeBuffer = &texturePixels[writeY*width + writeX + row*width];
-				unsigned char* readBuffer = &face->glyph->bitmap.buffer[row*face->glyph->bitmap.width];
+				unsigned char* readBuffer = &face->glyph->bitmap.buffer[row*std::abs(face->glyph->bitmap.pitch)];
 				std::memcpy(writeBuffer, readBuffer, face->glyph->bitmap.width);
 				highestGlyph = std::max(highestGlyph, face->glyph->bitmap.rows);
 			}
@@ -100,13 +123,32 @@ namespace Glory::Editor
 
 			characterCodes.emplace_back(charcode);
 			glyphs.emplace_back(character);
+			if (charcode < maxKerningCharacter) kerningCandidates.emplace_back(charcode, gid);
 			charcode = FT_Get_Next_Char(face, charcode, &gid);
 		}
 
+		std::vector<KerningPair> kerningPairs;
+		if (FT_HAS_KERNING(face))
+		{
+			for (const auto& [left, leftGid] : kerningCandidates)
+			{
+				for (const auto& [right, rightGid] : kerningCandidates)
+				{
+					FT_Vector kerning;
+					if (FT_Get_Kerning(face, leftGid, rightGid, FT_KERNING_DEFAULT, &kerning) || kerning.x == 0) continue;
+					kerningPairs.push_back({ left, right, int32_t(kerning.x) });
+				}
+			}
+		}
+
 		ImageData* pImageData = new ImageData(width, height,
 			PixelFormat::PF_R, PixelFormat::PF_R, 1, std::move(texturePixels), width*height);
 
 		FontData* pFont = new FontData(fontHeight, std::move(characterCodes), std::move(glyphs));
+		pFont->SetKerning(std::move(kerningPairs));
+		/* FreeType maps -spread to 0 and +spread to 1 */
+		const float distanceRange = float(spread*2);
+		pFont->SetDistanceRange(distanceRange);
 		ImportedResource resource = { path, pFont };
 		resource.AddChild(pImageData, "Image");
 		TextureData* pTexture = new TextureData(pImageData);
@@ -129,6 +171,7 @@ namespace Glory::Editor
 		resource.AddChild(pDefaultMaterial, "Material");
 		pFont->SetMaterial(pDefaultMaterial->GetUUID());
 		pDefaultMaterial->SetTexture("texSampler", pTexture->GetUUID());
+		pDefaultMaterial->Set("DistanceRange", distanceRange);
 
 		return resource;
 	}
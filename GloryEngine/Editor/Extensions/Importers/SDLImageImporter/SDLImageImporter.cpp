@@ -5,6 +5,7 @@
 #include <sstream>
 #include <Debug.h>
 #include <TextureData.h>
+#include <NodeRef.h>
 #include <bitset>
 
 namespace Glory::Editor
@@ -25,6 +26,14 @@ namespace Glory::Editor
 		".TGA"
 	};
 
+	/* Import settings of an image are stored next to it */
+	static std::filesystem::path ImportsFilePath(const std::filesystem::path& path)
+	{
+		std::filesystem::path importsFilePath = path;
+		importsFilePath.replace_extension(path.extension().string() + ".imports");
+		return importsFilePath;
+	}
+
 	SDLImageImporter::SDLImageImporter() : m_InitializedFlags(0)
 	{
 	}
@@ -61,7 +70,18 @@ namespace Glory::Editor
 			return nullptr;
 		}
 
-		return Process(path, pSDLImage);
+		ImportSettings settings;
+		const std::filesystem::path importsFilePath = ImportsFilePath(path);
+		if (std::filesystem::exists(importsFilePath))
+		{
+			Utils::YAMLFileRef importsFile{ importsFilePath };
+			Utils::NodeValueRef imports = importsFile["ImportSettings"];
+			settings.GenerateMips = imports["GenerateMips"].As<bool>(settings.GenerateMips);
+			settings.Compress = imports["Compress"].As<bool>(settings.Compress);
+			settings.Usage = imports["Usage"].AsEnum<TextureUsage>(settings.Usage);
+		}
+
+		return Process(path, pSDLImage, settings);
 	}
 
 	ImportedResource SDLImageImporter::LoadResource(void* data, size_t dataSize, void* userData) const
@@ -78,13 +98,21 @@ namespace Glory::Editor
 			return nullptr;
 		}
 
-		return Process("", pSDLImage);
+		return Process("", pSDLImage, ImportSettings{});
 	}
 
 	bool SDLImageImporter::SaveResource(const std::filesystem::path& path, ImageData* pResource) const
 	{
-		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(pResource->GetPixels(), pResource->GetWidth(), pResource->GetHeight(), 1,
-			pResource->GetWidth()*pResource->GetBytesPerPixel(), SDL_PixelFormatEnum::SDL_PIXELFORMAT_RGBA32);
+		/* Imported images are usually block compressed, decode the first level back to RGBA */
+		std::vector<uint8_t> pixels;
+		if (!DecodeImage(pResource, pixels))
+		{
+			EditorApplication::GetInstance()->GetEngine()->GetDebug().LogError("SDLImageImporter::SaveResource > Failed to save image, format not supported!");
+			return false;
+		}
+
+		SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels.data(), pResource->GetWidth(), pResource->GetHeight(), 1,
+			pResource->GetWidth()*4, SDL_PixelFormatEnum::SDL_PIXELFORMAT_RGBA32);
 		if (!surface) return false;
 		const bool result = IMG_SavePNG(surface, path.string().data()) == 0;
 		SDL_FreeSurface(surface);
@@ -107,7 +135,7 @@ namespace Glory::Editor
 		IMG_Quit();
 	}
 
-	ImportedResource SDLImageImporter::Process(const std::filesystem::path& path, SDL_Surface* pSDLImage) const
+	ImportedResource SDLImageImporter::Process(const std::filesystem::path& path, SDL_Surface* pSDLImage, const ImportSettings& settings) const
 	{
 		const uint32_t width = static_cast<uint32_t>(pSDLImage->w);
 		const uint32_t height = static_cast<uint32_t>(pSDLImage->h);
@@ -187,6 +215,13 @@ namespace Glory::Editor
 
 		ImageData* pData = new ImageData(width, height, internalFormat, pixelFormat, finalBytesPerPixel,
 			std::move(convertedPixels), finalBytesPerPixel*numPixels);
+
+		/* Store the mip chain compressed so the device can upload it without processing */
+		if (settings.GenerateMips)
+			GenerateMipLevels(pData);
+		const PixelFormat blockFormat = settings.Compress ? ChooseBlockFormat(pData, settings.Usage) : PixelFormat::PF_Undefined;
+		if (blockFormat != PixelFormat::PF_Undefined)
+			CompressImage(pData, blockFormat);
 		ImportedResource importedResource{ path, pData };
 
 		TextureData* pDefualtTexture = new TextureData(pData);
@@ -1,6 +1,7 @@
 #pragma once
 #include <ImporterTemplate.h>
 #include <ImageData.h>
+#include <TextureCompression.h>
 
 struct SDL_Surface;
 
@@ -9,6 +10,17 @@ namespace Glory::Editor
 	class SDLImageImporter : public ImporterTemplate<ImageData>
 	{
 	public:
+		/** @brief Import settings of an image, read from the optional .imports file next to it */
+		struct ImportSettings
+		{
+			/** @brief Store a full chain of mip levels, turn off for UI and pixel art */
+			bool GenerateMips{ true };
+			/** @brief Block compress the pixels, turn off when the image must stay lossless */
+			bool Compress{ true };
+			/** @brief What the texture is sampled as, normal maps are compressed to BC5 */
+			TextureUsage Usage{ TextureUsage::Color };
+		};
+
 		SDLImageImporter();
 		virtual ~SDLImageImporter();
 
@@ -24,7 +36,7 @@ namespace Glory::Editor
 		virtual void Initialize() override;
 		virtual void Cleanup() override;
 
-		ImportedResource Process(const std::filesystem::path& path, SDL_Surface* pSDLImage) const;
+		ImportedResource Process(const std::filesystem::path& path, SDL_Surface* pSDLImage, const ImportSettings& settings) const;
 
 		int m_InitializedFlags;
 	};
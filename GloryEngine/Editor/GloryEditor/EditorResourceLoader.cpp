@@ -414,14 +414,9 @@ namespace Glory::Editor
 
 	bool EditorResourceLoader::CheckCacheVersion(std::filesystem::path& cachePath) const
 	{
-		Version version;
-		{
-			Utils::BinaryFileStream file{ cachePath, true, false };
-			Utils::BinaryStream& stream = static_cast<Utils::BinaryStream&>(file);
-			stream.Read(version);
-		}
-
-		return Version::Compare(CoreVersion, version) == 0;
+		Utils::BinaryFileStream file{ cachePath, true, false };
+		AssetArchive archive{ &file, AssetArchiveFlags::Read };
+		return archive.VerifyVersion();
 	}
 
 	bool EditorResourceLoader::CompileJob(const std::filesystem::path& assetPath)
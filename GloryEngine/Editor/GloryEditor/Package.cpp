@@ -385,7 +385,7 @@ namespace Glory::Editor
 				Utils::BinaryFileStream sceneFile{ path };
 				AssetArchive archive{ &sceneFile, AssetArchiveFlags::WriteNew };
 
-				archive.Serialize(LoadedScenesToPackage[i]);
+				archive.Serialize(LoadedScenesToPackage[i], pEngine);
 
 				UsedAssets.push_back(ScenesToPackage[i]);
 				AssetLocations.push_back({ relativeScenePath.string(), "", 0 });
@@ -440,7 +440,7 @@ namespace Glory::Editor
 					PACKAGE_LAG
 
 					Resource* pResource = pEngine->GetResources().GetResource(assetID);
-					archive.Serialize(pResource);
+					archive.Serialize(pResource, pEngine);
 			
 					AssetLocations.push_back({ relativeScenePath.string(), "", j });
 					UsedAssets.push_back(assetID);
@@ -479,7 +479,7 @@ namespace Glory::Editor
 				PACKAGE_LAG
 
 				Resource* pResource = pEngine->GetResources().GetResource(assetID);
-				archive.Serialize(pResource);
+				archive.Serialize(pResource, pEngine);
 
 				AssetLocations.push_back({ relativePath.string(), "", i });
 				UsedAssets.push_back(assetID);
@@ -8,10 +8,15 @@
 
 #include <BinaryStream.h>
 #include <sstream>
+#include <algorithm>
 
 namespace Glory
 {
-	AssetArchive::AssetArchive(Utils::BinaryStream* pStream, AssetArchiveFlags flags): m_pStream(pStream), m_Version(), m_Owned()
+	/* Written after the version, changes whenever the layout of the archive changes */
+	static constexpr uint32_t AssetArchiveFormat = 0x31414147; /* GAA1 */
+
+	AssetArchive::AssetArchive(Utils::BinaryStream* pStream, AssetArchiveFlags flags):
+		m_pStream(pStream), m_Version(), m_Format(0), m_TableOfContentsRead(false), m_Owned()
 	{
 		if ((flags & AssetArchiveFlags::Read) == AssetArchiveFlags::Read)
 		{
@@ -26,7 +31,10 @@ namespace Glory
 	}
 
 	AssetArchive::AssetArchive(AssetArchive&& other) noexcept:
-		m_pStream(other.m_pStream), m_Version(other.m_Version), m_Owned(std::move(other.m_Owned))
+		m_pStream(other.m_pStream), m_Version(other.m_Version), m_Format(other.m_Format),
+		m_TableOfContentsRead(other.m_TableOfContentsRead), m_pResources(std::move(other.m_pResources)),
+		m_Owned(std::move(other.m_Owned)), m_Entries(std::move(other.m_Entries)),
+		m_PendingEntries(std::move(other.m_PendingEntries)), m_pPendingData(std::move(other.m_pPendingData))
 	{
 		other.m_pStream = nullptr;
 	}
@@ -34,6 +42,8 @@ namespace Glory
 	AssetArchive::~AssetArchive()
 	{
 		if (!m_pStream) return;
+		if (!m_PendingEntries.empty())
+			WriteSegment();
 		m_pStream->Close();
 		m_pStream = nullptr;
 
@@ -48,33 +58,37 @@ namespace Glory
 	bool AssetArchive::VerifyVersion()
 	{
 		const Version currentVersion = Version::Parse(GloryCoreVersion);
-		return Version::Compare(m_Version, currentVersion) == 0;
+		return Version::Compare(m_Version, currentVersion) == 0 && m_Format == AssetArchiveFormat;
 	}
 
-	void AssetArchive::Serialize(Resource* pResource) const
+	void AssetArchive::Serialize(Resource* pResource, IEngine* pEngine) const
 	{
-		std::type_index type = typeid(Resource);
-		if (!pResource->GetType(0, type)) return;
-		const uint32_t typeHash = ResourceTypes::GetHash(type);
-
-		/* Write ID, name and type */
-		m_pStream->Write(pResource->GetUUID()).Write(pResource->Name()).Write(typeHash);
-
-		/* Write the resource */
-		pResource->Serialize(*m_pStream);
+		Serialize(static_cast<const Resource*>(pResource), pEngine);
 	}
 
-	void AssetArchive::Serialize(const Resource* pResource) const
+	void AssetArchive::Serialize(const Resource* pResource, IEngine* pEngine) const
 	{
 		std::type_index type = typeid(Resource);
 		if (!pResource->GetType(0, type)) return;
-		const uint32_t typeHash = ResourceTypes::GetHash(type);
 
-		/* Write ID, name and type */
-		m_pStream->Write(pResource->GetUUID()).Write(pResource->Name()).Write(typeHash);
+		if (!m_pPendingData)
+			m_pPendingData = std::make_unique<Utils::GrowableBinaryMemoryStream>();
 
-		/* Write the resource */
-		pResource->Serialize(*m_pStream);
+		AssetArchiveEntry& entry = m_PendingEntries.emplace_back();
+		entry.m_ID = pResource->GetUUID();
+		entry.m_Name = pResource->Name();
+		entry.m_TypeHash = ResourceTypes::GetHash(type);
+
+		/* Write the resource, the table of contents has to be complete before it can be written */
+		entry.m_Offset = m_pPendingData->Tell();
+		pResource->Serialize(*m_pPendingData);
+		entry.m_Size = m_pPendingData->Tell() - entry.m_Offset;
+
+		if (!pEngine) return;
+		pResource->References(pEngine, entry.m_Dependencies);
+		std::sort(entry.m_Dependencies.begin(), entry.m_Dependencies.end());
+		entry.m_Dependencies.erase(std::unique(entry.m_Dependencies.begin(), entry.m_Dependencies.end()), entry.m_Dependencies.end());
+		entry.m_Dependencies.erase(std::remove(entry.m_Dependencies.begin(), entry.m_Dependencies.end(), entry.m_ID), entry.m_Dependencies.end());
 	}
 
 	void AssetArchive::Deserialize(IEngine* pEngine)
@@ -84,19 +98,14 @@ namespace Glory
 
 	void AssetArchive::Deserialize(Debug* pDebug, ResourceTypes* pResourceTypes)
 	{
-		if (!VerifyVersion())
-		{
-			std::string versionStr;
-			m_Version.GetVersionString(versionStr);
-			std::stringstream str;
-			str << "Compiled asset archive was built with a different core/runtime version (" << versionStr << ") than the current version " << GloryCoreVersion;
-			pDebug->LogFatalError(str.str());
-			return;
-		}
+		if (!ReadTableOfContents(pDebug)) return;
 
-		while (!m_pStream->Eof())
+		m_pResources.reserve(m_Entries.size());
+		for (size_t i = 0; i < m_Entries.size(); ++i)
 		{
-			ReadResource(pResourceTypes);
+			Resource* pResource = Load(pDebug, pResourceTypes, i);
+			if (!pResource) continue;
+			m_pResources.push_back(pResource);
 		}
 
 		m_Owned.Reserve(m_pResources.size());
@@ -124,37 +133,135 @@ namespace Glory
 		return m_pResources[index];
 	}
 
-	void AssetArchive::WriteVersion()
+	bool AssetArchive::ReadTableOfContents(Debug* pDebug)
 	{
-		m_pStream->Write(m_Version);
+		if (m_TableOfContentsRead) return true;
+
+		if (!VerifyVersion())
+		{
+			std::string versionStr;
+			m_Version.GetVersionString(versionStr);
+			std::stringstream str;
+			if (Version::Compare(m_Version, Version::Parse(GloryCoreVersion)) != 0)
+				str << "Compiled asset archive was built with a different core/runtime version (" << versionStr << ") than the current version " << GloryCoreVersion;
+			else
+				str << "Compiled asset archive was built in an older archive format, it has to be built again";
+			pDebug->LogFatalError(str.str());
+			return false;
+		}
+
+		m_TableOfContentsRead = true;
+		while (!m_pStream->Eof())
+		{
+			size_t entryCount = 0;
+			m_pStream->Read(entryCount);
+			const size_t firstEntry = m_Entries.size();
+			m_Entries.resize(firstEntry + entryCount);
+			for (size_t i = firstEntry; i < m_Entries.size(); ++i)
+			{
+				AssetArchiveEntry& entry = m_Entries[i];
+				m_pStream->Read(entry.m_ID).Read(entry.m_Name).Read(entry.m_TypeHash)
+					.Read(entry.m_Offset).Read(entry.m_Size).Read(entry.m_Dependencies);
+			}
+
+			size_t dataSize = 0;
+			m_pStream->Read(dataSize);
+			const size_t dataStart = m_pStream->Tell();
+			if (dataStart + dataSize > m_pStream->Size())
+			{
+				pDebug->LogError("AssetArchive::ReadTableOfContents: Archive is truncated.");
+				m_Entries.resize(firstEntry);
+				break;
+			}
+
+			/* Offsets are stored relative to the data of their segment */
+			for (size_t i = firstEntry; i < m_Entries.size(); ++i)
+				m_Entries[i].m_Offset += dataStart;
+			m_pStream->Seek(dataStart + dataSize);
+		}
+		return true;
 	}
 
-	void AssetArchive::ReadVersion()
+	size_t AssetArchive::EntryCount() const
 	{
-		m_pStream->Read(m_Version);
+		return m_Entries.size();
+	}
+
+	const AssetArchiveEntry& AssetArchive::Entry(size_t index) const
+	{
+		return m_Entries[index];
 	}
 
-	Resource* AssetArchive::ReadResource(ResourceTypes* pResourceTypes)
+	size_t AssetArchive::FindEntry(UUID id) const
 	{
-		std::string name;
-		uint32_t typeHash = 0;
-		UUID uuid = 0;
-		m_pStream->Read(uuid).Read(name).Read(typeHash);
+		for (size_t i = 0; i < m_Entries.size(); ++i)
+		{
+			if (m_Entries[i].m_ID == id) return i;
+		}
+		return m_Entries.size();
+	}
 
-		const ResourceType* pType = pResourceTypes->GetResourceType(typeHash);
+	Resource* AssetArchive::Load(IEngine* pEngine, size_t index)
+	{
+		return Load(&pEngine->GetDebug(), &pEngine->GetResourceTypes(), index);
+	}
+
+	Resource* AssetArchive::Load(Debug* pDebug, ResourceTypes* pResourceTypes, size_t index)
+	{
+		if (index >= m_Entries.size())
+		{
+			pDebug->LogError("AssetArchive::Load: Index out of range.");
+			return nullptr;
+		}
+
+		const AssetArchiveEntry& entry = m_Entries[index];
+		const ResourceType* pType = pResourceTypes->GetResourceType(entry.m_TypeHash);
 		if (!pType)
 		{
-			throw new std::exception("Non existing resource type");
+			std::stringstream str;
+			str << "AssetArchive::Load: Resource " << uint64_t(entry.m_ID) << " has a non existing resource type.";
+			pDebug->LogError(str.str());
+			return nullptr;
 		}
 
 		Resource* pResource = pType->Create();
+		pResource->SetName(entry.m_Name);
+		pResource->SetResourceUUID(entry.m_ID);
 
-		pResource->SetName(name);
-		pResource->SetResourceUUID(uuid);
-
+		m_pStream->Seek(entry.m_Offset);
 		pResource->Deserialize(*m_pStream);
-		m_pResources.push_back(pResource);
-
 		return pResource;
 	}
-}
\ No newline at end of file
+
+	void AssetArchive::WriteVersion()
+	{
+		m_pStream->Write(m_Version).Write(AssetArchiveFormat);
+	}
+
+	void AssetArchive::ReadVersion()
+	{
+		m_pStream->Read(m_Version);
+		if (!m_pStream->Eof())
+			m_pStream->Read(m_Format);
+	}
+
+	void AssetArchive::WriteSegment()
+	{
+		/* Table of contents */
+		m_pStream->Write(m_PendingEntries.size());
+		for (const AssetArchiveEntry& entry : m_PendingEntries)
+		{
+			m_pStream->Write(entry.m_ID).Write(entry.m_Name).Write(entry.m_TypeHash)
+				.Write(entry.m_Offset).Write(entry.m_Size).Write(entry.m_Dependencies);
+		}
+
+		/* Data */
+		const size_t dataSize = m_pPendingData->Tell();
+		m_pStream->Write(dataSize);
+		if (dataSize > 0)
+			m_pStream->Write(m_pPendingData->Buffer(), dataSize);
+
+		m_PendingEntries.clear();
+		m_pPendingData.reset();
+	}
+}
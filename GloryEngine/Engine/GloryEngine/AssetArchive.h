@@ -4,11 +4,15 @@
 #include <engine_visibility.h>
 
 #include <vector>
+#include <string>
+#include <memory>
 #include <BitSet.h>
+#include <UUID.h>
 
 namespace Glory::Utils
 {
 	class BinaryStream;
+	class GrowableBinaryMemoryStream;
 }
 
 namespace Glory
@@ -27,6 +31,28 @@ namespace Glory
 		WriteNew = Write | WriteVersion,
 	};
 
+	/** @brief Table of contents entry of a resource in an @ref AssetArchive */
+	struct AssetArchiveEntry
+	{
+		UUID m_ID;
+		std::string m_Name;
+		uint32_t m_TypeHash;
+		/** @brief Position of the serialized resource in the stream */
+		size_t m_Offset;
+		/** @brief Size of the serialized resource in bytes */
+		size_t m_Size;
+		/** @brief Resources referenced by this resource, empty if unknown when it was written */
+		std::vector<UUID> m_Dependencies;
+	};
+
+	/**
+	 * @brief Archive of serialized resources
+	 *
+	 * After the version the archive consists of one or more segments, one per time it was opened for writing.
+	 * Each segment starts with a table of contents of its resources followed by their data,
+	 * so single resources can be found and loaded without reading the others.
+	 * Resources are written when the archive is destroyed.
+	 */
 	class AssetArchive
 	{
 	public:
@@ -34,26 +60,60 @@ namespace Glory
 		GLORY_ENGINE_API AssetArchive(AssetArchive&& other) noexcept;
 		GLORY_ENGINE_API virtual ~AssetArchive();
 
+		/** @brief Check if the archive was written by this version in the current format */
 		GLORY_ENGINE_API bool VerifyVersion();
 
-		GLORY_ENGINE_API void Serialize(Resource* pResource) const;
-		GLORY_ENGINE_API void Serialize(const Resource* pResource) const;
+		/** @brief Add a resource to the archive
+		 * @param pResource Resource to add
+		 * @param pEngine Engine to collect the dependencies of the resource with, dependencies are not stored if null
+		 */
+		GLORY_ENGINE_API void Serialize(Resource* pResource, IEngine* pEngine=nullptr) const;
+		/** @overload */
+		GLORY_ENGINE_API void Serialize(const Resource* pResource, IEngine* pEngine=nullptr) const;
+		/** @brief Load every resource in the archive, get them with @ref Get */
 		GLORY_ENGINE_API void Deserialize(IEngine* pEngine);
+		/** @overload */
 		GLORY_ENGINE_API void Deserialize(Debug* pDebug, ResourceTypes* pResourceTypes);
 
 		GLORY_ENGINE_API size_t Size() const;
 		GLORY_ENGINE_API Resource* Get(IEngine* pEngine, size_t index) const;
 		GLORY_ENGINE_API Resource* Get(Debug* pDebug, size_t index) const;
 
+		/** @brief Read the tables of contents of all segments without loading any resources
+		 * @returns false if the archive has a different version or format
+		 */
+		GLORY_ENGINE_API bool ReadTableOfContents(Debug* pDebug);
+		/** @brief Number of resources in the table of contents */
+		GLORY_ENGINE_API size_t EntryCount() const;
+		/** @brief Get a table of contents entry */
+		GLORY_ENGINE_API const AssetArchiveEntry& Entry(size_t index) const;
+		/** @brief Find the table of contents entry of a resource
+		 * @returns Index of the entry or @ref EntryCount() if the resource is not in the archive
+		 */
+		GLORY_ENGINE_API size_t FindEntry(UUID id) const;
+		/** @brief Load a single resource from the archive
+		 * @param index Index of the table of contents entry
+		 * @returns A new resource owned by the caller, or nullptr on failure
+		 */
+		GLORY_ENGINE_API Resource* Load(IEngine* pEngine, size_t index);
+		/** @overload */
+		GLORY_ENGINE_API Resource* Load(Debug* pDebug, ResourceTypes* pResourceTypes, size_t index);
+
 	private:
 		void WriteVersion();
 		void ReadVersion();
-
-		Resource* ReadResource(ResourceTypes* pResourceTypes);
+		void WriteSegment();
 
 		Utils::BinaryStream* m_pStream;
 		Version m_Version;
+		uint32_t m_Format;
+		bool m_TableOfContentsRead;
 		std::vector<Resource*> m_pResources;
 		mutable Utils::BitSet m_Owned;
+		std::vector<AssetArchiveEntry> m_Entries;
+
+		/* Resources waiting to be written */
+		mutable std::vector<AssetArchiveEntry> m_PendingEntries;
+		mutable std::unique_ptr<Utils::GrowableBinaryMemoryStream> m_pPendingData;
 	};
 }
@@ -16,23 +16,37 @@ namespace Glory
 
 	const char* AudioData::Data() const
 	{
-		return m_Data.data();
+		return m_pView ? m_pView : m_Data.data();
 	}
 
 	const size_t AudioData::Size() const
 	{
-		return m_Data.size();
+		return m_pView ? m_ViewSize : m_Data.size();
 	}
 
 	void AudioData::Serialize(Utils::BinaryStream& container) const
 	{
-		container.Write(m_Data.size()).Write(m_Data.data(), m_Data.size());
+		container.Write(Size()).Write(Data(), Size());
 	}
 
 	void AudioData::Deserialize(Utils::BinaryStream& container)
 	{
 		size_t size;
 		container.Read(size);
+
+		/* Reference the samples in place when the stream keeps them alive, such as a mapped archive */
+		std::shared_ptr<void> pOwner = container.ViewOwner();
+		m_pView = pOwner ? container.View(size) : nullptr;
+		if (m_pView)
+		{
+			m_ViewSize = size;
+			m_pViewOwner = std::move(pOwner);
+			m_Data.clear();
+			return;
+		}
+
+		m_ViewSize = 0;
+		m_pViewOwner.reset();
 		m_Data.resize(size);
 		container.Read(m_Data.data(), m_Data.size());
 	}
@@ -3,6 +3,8 @@
 
 #include <engine_visibility.h>
 
+#include <memory>
+
 namespace Glory
 {
 	class AudioData : public Resource
@@ -25,5 +27,9 @@ namespace Glory
 
 	private:
 		std::vector<char> m_Data;
+		/** @brief Samples in memory owned by @ref m_pViewOwner, such as a mapped file, used instead of @ref m_Data when set */
+		const char* m_pView{ nullptr };
+		size_t m_ViewSize{ 0 };
+		std::shared_ptr<void> m_pViewOwner;
 	};
 }
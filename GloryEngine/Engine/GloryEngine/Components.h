@@ -146,6 +146,7 @@ namespace Glory
 			PROP(float, WrapWidth)
 		);
 		bool m_Dirty;
+		TextMeshState m_MeshState;
 	};
 
 	//settings->mSupportingVolume = Plane(Vec3::sAxisY(), -cCharacterRadiusStanding); // Accept contacts that touch the lower sphere of the capsule
@@ -7,7 +7,7 @@
 
 namespace Glory
 {
-	FontData::FontData(): m_FontHeight(0), m_Texture(0ull), m_Material(0ull)
+	FontData::FontData(): m_FontHeight(0), m_DistanceRange(0.0f), m_Texture(0ull), m_Material(0ull)
 	{
 		APPEND_TYPE(FontData);
 	}
@@ -15,9 +15,10 @@ namespace Glory
 	FontData::FontData(uint32_t height, std::vector<uint64_t>&& characterCodes,
 		std::vector<GlyphData>&& chars):
 		m_FontHeight(height), m_CharacterCodes(std::move(characterCodes)),
-		m_Glyphs(std::move(chars)), m_Texture(0ull), m_Material(0ull)
+		m_Glyphs(std::move(chars)), m_DistanceRange(0.0f), m_Texture(0ull), m_Material(0ull)
 	{
 		APPEND_TYPE(FontData);
+		BuildLookups();
 	}
 
 	FontData::~FontData()
@@ -32,9 +33,13 @@ namespace Glory
 
 	size_t FontData::GetGlyphIndex(uint64_t c) const
 	{
-		auto iter = std::find(m_CharacterCodes.begin(), m_CharacterCodes.end(), c);
-		if (iter == m_CharacterCodes.end()) return m_CharacterCodes.size();
-		return iter - m_CharacterCodes.begin();
+		if (c < m_DirectLookup.size())
+		{
+			const uint32_t index = m_DirectLookup[c];
+			return index != UINT32_MAX ? index : m_Glyphs.size();
+		}
+		auto iter = m_GlyphLookup.find(c);
+		return iter != m_GlyphLookup.end() ? iter->second : m_Glyphs.size();
 	}
 
 	const GlyphData* FontData::GetGlyph(size_t index) const
@@ -43,6 +48,61 @@ namespace Glory
 		return &m_Glyphs[index];
 	}
 
+	void FontData::SetKerning(std::vector<KerningPair>&& pairs)
+	{
+		m_KerningPairs = std::move(pairs);
+		BuildLookups();
+	}
+
+	float FontData::GetKerning(size_t leftGlyph, size_t rightGlyph) const
+	{
+		if (m_Kerning.empty()) return 0.0f;
+		auto iter = m_Kerning.find((uint64_t(leftGlyph) << 32) | uint64_t(rightGlyph));
+		return iter != m_Kerning.end() ? iter->second/64.0f : 0.0f;
+	}
+
+	void FontData::BuildLookups()
+	{
+		m_DirectLookup.assign(DirectLookupSize, UINT32_MAX);
+		m_GlyphLookup.clear();
+		for (size_t i = 0; i < m_CharacterCodes.size(); ++i)
+		{
+			const uint64_t code = m_CharacterCodes[i];
+			if (code < DirectLookupSize)
+			{
+				if (m_DirectLookup[code] == UINT32_MAX)
+					m_DirectLookup[code] = uint32_t(i);
+				continue;
+			}
+			m_GlyphLookup.emplace(code, uint32_t(i));
+		}
+
+		m_Kerning.clear();
+		m_Kerning.reserve(m_KerningPairs.size());
+		for (const KerningPair& pair : m_KerningPairs)
+		{
+			const size_t left = GetGlyphIndex(pair.Left);
+			const size_t right = GetGlyphIndex(pair.Right);
+			if (left >= m_Glyphs.size() || right >= m_Glyphs.size() || pair.Amount == 0) continue;
+			m_Kerning.emplace((uint64_t(left) << 32) | uint64_t(right), pair.Amount);
+		}
+	}
+
+	void FontData::SetDistanceRange(float range)
+	{
+		m_DistanceRange = range;
+	}
+
+	float FontData::DistanceRange() const
+	{
+		return m_DistanceRange;
+	}
+
+	bool FontData::IsDistanceField() const
+	{
+		return m_DistanceRange > 0.0f;
+	}
+
 	TextureData* FontData::GetGlyphTexture(Resources& resources) const
 	{
 		Resource* pResource = resources.GetResource(m_Texture.GetUUID());
@@ -72,7 +132,7 @@ namespace Glory
 	void FontData::Serialize(Utils::BinaryStream& container) const
 	{
 		container.Write(m_FontHeight).Write(m_Glyphs).
-			Write(m_Texture.GetUUID()).Write(m_Material.GetUUID());
+			Write(m_Texture.GetUUID()).Write(m_Material.GetUUID()).Write(m_KerningPairs).Write(m_DistanceRange);
 	}
 
 	void FontData::Deserialize(Utils::BinaryStream& container)
@@ -80,10 +140,11 @@ namespace Glory
 		UUID textureID, materialID;
 
 		container.Read(m_FontHeight).Read(m_Glyphs).
-			Read(textureID).Read(materialID);
+			Read(textureID).Read(materialID).Read(m_KerningPairs).Read(m_DistanceRange);
 		m_CharacterCodes.resize(m_Glyphs.size());
 		for (size_t i = 0; i < m_CharacterCodes.size(); ++i)
 			m_CharacterCodes[i] = m_Glyphs[i].Code;
+		BuildLookups();
 
 		m_Texture = textureID;
 		m_Material = materialID;
@@ -8,6 +8,8 @@
 
 #include <engine_visibility.h>
 
+#include <unordered_map>
+
 namespace Glory
 {
     class Resources;
@@ -23,8 +25,31 @@ namespace Glory
         GLORY_ENGINE_API virtual ~FontData();
 
         GLORY_ENGINE_API uint32_t FontHeight() const;
+        /** @brief Get the index of the glyph of a code point
+         * @param c Unicode code point
+         * @returns The glyph index or the number of glyphs if the font has no glyph for the code point
+         *
+         * Code points below @ref DirectLookupSize are looked up in a table, others in a hash map.
+         */
         GLORY_ENGINE_API size_t GetGlyphIndex(uint64_t c) const;
         GLORY_ENGINE_API const GlyphData* GetGlyph(size_t index) const;
+        /** @brief Set the kerning pairs of this font, replaces existing pairs */
+        GLORY_ENGINE_API void SetKerning(std::vector<KerningPair>&& pairs);
+        /** @brief Get the advance adjustment in pixels between two glyphs
+         * @param leftGlyph Index of the first glyph
+         * @param rightGlyph Index of the glyph that follows it
+         */
+        GLORY_ENGINE_API float GetKerning(size_t leftGlyph, size_t rightGlyph) const;
+        /** @brief Set how many atlas pixels the distance stored in the glyph texture spans
+         * @param range Distance in pixels between a value of 0 and 1, 0 if the texture stores coverage
+         *
+         * A distance field atlas is rendered once at @ref FontHeight() and scaled to any size by the text shaders.
+         */
+        GLORY_ENGINE_API void SetDistanceRange(float range);
+        /** @brief Distance in atlas pixels between a value of 0 and 1, 0 if the texture stores coverage */
+        GLORY_ENGINE_API float DistanceRange() const;
+        /** @brief Whether the glyph texture stores a signed distance field instead of coverage */
+        GLORY_ENGINE_API bool IsDistanceField() const;
         GLORY_ENGINE_API TextureData* GetGlyphTexture(Resources& assets) const;
         GLORY_ENGINE_API void SetTexture(UUID texture);
         GLORY_ENGINE_API void SetMaterial(UUID material);
@@ -34,13 +59,25 @@ namespace Glory
         GLORY_ENGINE_API void Serialize(Utils::BinaryStream& container) const override;
         GLORY_ENGINE_API void Deserialize(Utils::BinaryStream& container) override;
 
+        /** @brief Number of code points that are looked up in a table, covers all 1 and 2 byte UTF-8 sequences */
+        static constexpr size_t DirectLookupSize = 0x800;
+
     private:
         void References(IEngine* pEngine, std::vector<UUID>& references) const override;
+        void BuildLookups();
 
     private:
         uint32_t m_FontHeight;
         std::vector<uint64_t> m_CharacterCodes;
         std::vector<GlyphData> m_Glyphs;
+        std::vector<KerningPair> m_KerningPairs;
+        /** @brief Glyph index of each code point below @ref DirectLookupSize, UINT32_MAX if the font has no glyph */
+        std::vector<uint32_t> m_DirectLookup;
+        /** @brief Glyph index of code points from @ref DirectLookupSize and up */
+        std::unordered_map<uint64_t, uint32_t> m_GlyphLookup;
+        /** @brief Kerning amount by left glyph index in the high and right glyph index in the low 32 bits */
+        std::unordered_map<uint64_t, int32_t> m_Kerning;
+        float m_DistanceRange;
         ResourceReference<TextureData> m_Texture;
         ResourceReference<MaterialData> m_Material;
     };
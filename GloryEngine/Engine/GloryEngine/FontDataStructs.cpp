@@ -4,11 +4,65 @@
 #include "RenderData.h"
 #include "MeshData.h"
 #include "VertexHelpers.h"
+#include "GraphicsEnums.h"
 
-#include <queue>
+#include <algorithm>
 
 namespace Glory::Utils
 {
+	namespace
+	{
+		/* A decoded character and where it goes on its line */
+		struct LayoutCharacter
+		{
+			uint32_t m_CodePoint;
+			size_t m_GlyphIndex;
+			const GlyphData* m_pGlyph;
+			/* Advance of the glyph with the kerning against the character before it */
+			float m_Advance;
+			float m_Kerning;
+		};
+
+		/* Range of characters on one line */
+		struct LayoutLine
+		{
+			size_t m_First;
+			size_t m_End;
+			float m_Width;
+		};
+
+		constexpr uint32_t ReplacementCharacter = 0xFFFD;
+	}
+
+	uint32_t DecodeUTF8(std::string_view text, size_t& position)
+	{
+		const unsigned char lead = static_cast<unsigned char>(text[position]);
+		++position;
+		if (lead < 0x80) return lead;
+
+		size_t length;
+		uint32_t codePoint;
+		uint32_t minimum;
+		if ((lead & 0xE0) == 0xC0) { length = 1; codePoint = lead & 0x1F; minimum = 0x80; }
+		else if ((lead & 0xF0) == 0xE0) { length = 2; codePoint = lead & 0x0F; minimum = 0x800; }
+		else if ((lead & 0xF8) == 0xF0) { length = 3; codePoint = lead & 0x07; minimum = 0x10000; }
+		else return ReplacementCharacter;
+
+		if (position + length > text.size()) return ReplacementCharacter;
+		for (size_t i = 0; i < length; ++i)
+		{
+			const unsigned char continuation = static_cast<unsigned char>(text[position + i]);
+			if ((continuation & 0xC0) != 0x80) return ReplacementCharacter;
+			codePoint = (codePoint << 6) | (continuation & 0x3F);
+		}
+
+		/* Overlong encodings, surrogates and values past the last code point are malformed */
+		if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+			return ReplacementCharacter;
+		position += length;
+		return codePoint;
+	}
+
 	glm::vec2 GenerateTextMesh(MeshData* pMesh, FontData* pFontData, const TextData& textData, float textWrap)
 	{
 		const std::string_view text = textData.m_Text;
@@ -25,151 +79,183 @@ namespace Glory::Utils
 
 		const uint32_t indexOffset = pMesh->VertexCount();
 
-		/* Get words */
-		std::vector<std::pair<size_t, size_t>> wordPositions;
-		std::queue<size_t> newLineQueue;
-		size_t currentStringPos = 0;
+		/* Decode the text and measure every character */
+		std::vector<LayoutCharacter> characters;
+		characters.reserve(text.size());
+		size_t previousGlyph = SIZE_MAX;
+		for (size_t position = 0; position < text.size();)
+		{
+			const uint32_t codePoint = DecodeUTF8(text, position);
+			if (codePoint == '\n')
+			{
+				characters.push_back({ codePoint, SIZE_MAX, nullptr, 0.0f, 0.0f });
+				previousGlyph = SIZE_MAX;
+				continue;
+			}
+
+			const size_t glyphIndex = pFontData->GetGlyphIndex(codePoint == '\t' ? ' ' : codePoint);
+			const GlyphData* glyph = pFontData->GetGlyph(glyphIndex);
+			if (!glyph) continue;
+
+			const float kerning = previousGlyph != SIZE_MAX ? pFontData->GetKerning(previousGlyph, glyphIndex)*scale : 0.0f;
+			characters.push_back({ codePoint, glyphIndex, glyph, (glyph->Advance >> 6)*scale, kerning });
+			previousGlyph = glyphIndex;
+		}
 
-		while (currentStringPos < text.size())
+		/* Break the text into lines at new lines and, when wrapping, before words that don't fit */
+		std::vector<LayoutLine> lines;
+		size_t lineFirst = 0;
+		float lineWidth = 0.0f;
+		bool lineHasWord = false;
+		for (size_t i = 0; i < characters.size();)
 		{
-			const size_t nextSpace = text.find(' ', currentStringPos);
-			const size_t nextNewLine = text.find('\n', currentStringPos);
-			if (nextSpace == std::string::npos && nextNewLine == std::string::npos)
+			const uint32_t codePoint = characters[i].m_CodePoint;
+			if (codePoint == '\n')
 			{
-				wordPositions.push_back({ currentStringPos, text.size() - currentStringPos });
-				break;
+				lines.push_back({ lineFirst, i, lineWidth });
+				lineFirst = i + 1;
+				lineWidth = 0.0f;
+				lineHasWord = false;
+				++i;
+				continue;
+			}
+			if (codePoint == ' ' || codePoint == '\t')
+			{
+				lineWidth += (i > lineFirst ? characters[i].m_Kerning : 0.0f) + characters[i].m_Advance;
+				++i;
+				continue;
+			}
+
+			size_t wordEnd = i;
+			float wordWidth = 0.0f;
+			for (; wordEnd < characters.size(); ++wordEnd)
+			{
+				const uint32_t wordCodePoint = characters[wordEnd].m_CodePoint;
+				if (wordCodePoint == '\n' || wordCodePoint == ' ' || wordCodePoint == '\t') break;
+				wordWidth += (wordEnd > i ? characters[wordEnd].m_Kerning : 0.0f) + characters[wordEnd].m_Advance;
 			}
-			const size_t first = std::min(nextSpace, nextNewLine);
-			wordPositions.push_back({ currentStringPos, first - currentStringPos });
-			const size_t wordCount = wordPositions.size();
-			if (first == nextNewLine) newLineQueue.push(wordCount);
-			currentStringPos = first + 1;
+
+			const float kerning = i > lineFirst ? characters[i].m_Kerning : 0.0f;
+			if (lineHasWord && textWrap > 0.0f && lineWidth + kerning + wordWidth >= textWrap)
+			{
+				/* Spaces before a wrapped word are not drawn, the word starts the next line */
+				size_t lineEnd = i;
+				while (lineEnd > lineFirst && (characters[lineEnd - 1].m_CodePoint == ' ' || characters[lineEnd - 1].m_CodePoint == '\t'))
+				{
+					lineWidth -= characters[lineEnd - 1].m_Advance + (lineEnd - 1 > lineFirst ? characters[lineEnd - 1].m_Kerning : 0.0f);
+					--lineEnd;
+				}
+				lines.push_back({ lineFirst, lineEnd, lineWidth });
+				lineFirst = i;
+				lineWidth = wordWidth;
+			}
+			else
+				lineWidth += kerning + wordWidth;
+			lineHasWord = true;
+			i = wordEnd;
 		}
+		if (lineFirst < characters.size())
+			lines.push_back({ lineFirst, characters.size(), lineWidth });
 
-		float writeX = 0.0f;
+		/* Generate the mesh one line at a time */
 		float writeY = 0.0f;
+		float textWidth = 0.0f;
 		float textHeight = 0.0f;
 		uint32_t letterCount = 0;
-		/* For generating the mesh one line at a time */
-		std::function<void(const std::string_view, float)> drawLine = [&](const std::string_view line, float lineWidth) {
+		for (const LayoutLine& line : lines)
+		{
+			float writeX = 0.0f;
 			switch (alignment)
 			{
-			case Alignment::Left:
-				writeX = 0.0f;
-				break;
 			case Alignment::Center:
-				writeX = -lineWidth / 2.0f;
+				writeX = -line.m_Width/2.0f;
 				break;
 			case Alignment::Right:
-				writeX = -lineWidth;
+				writeX = -line.m_Width;
 				break;
 			default:
 				break;
 			}
 
-			for (char c : line)
+			for (size_t i = line.m_First; i < line.m_End; ++i)
 			{
-				const size_t glyphIndex = pFontData->GetGlyphIndex(c == '\t' ? ' ' : c);
-				const GlyphData* glyph = pFontData->GetGlyph(glyphIndex);
-
-				if (!glyph) continue;
-
-				const float xpos = textData.m_Offsets.x + writeX + glyph->Bearing.x * scale;
-				const float ypos = textData.m_Offsets.y + writeY - (glyph->Size.y - glyph->Bearing.y) * scale;
-
-				const float w = glyph->Size.x * scale;
-				const float h = glyph->Size.y * scale;
-
-				VertexPosColorTex vertices[4] = {
-					{ { xpos, ypos + h, }, color, { glyph->Coords.x, glyph->Coords.y } },
-					{ { xpos, ypos, }, color, { glyph->Coords.x, glyph->Coords.w } },
-					{ { xpos + w, ypos, }, color, { glyph->Coords.z, glyph->Coords.w } },
-					{ { xpos + w, ypos + h, }, color, { glyph->Coords.z, glyph->Coords.y }, }
-				};
-
-				pMesh->AddVertex(reinterpret_cast<float*>(&vertices[0]));
-				pMesh->AddVertex(reinterpret_cast<float*>(&vertices[1]));
-				pMesh->AddVertex(reinterpret_cast<float*>(&vertices[2]));
-				pMesh->AddVertex(reinterpret_cast<float*>(&vertices[3]));
-				pMesh->AddFace(indexOffset + letterCount*4 + 0, indexOffset + letterCount*4 + 1,
-					indexOffset + letterCount*4 + 2, indexOffset + letterCount*4 + 3);
-				++letterCount;
-				writeX += (glyph->Advance >> 6) * scale;
-			}
-
-			writeY -= pFontData->FontHeight()*scale;
-			textHeight += pFontData->FontHeight()*scale;
-		};
+				const LayoutCharacter& character = characters[i];
+				const GlyphData* glyph = character.m_pGlyph;
+				if (i > line.m_First) writeX += character.m_Kerning;
 
-		/* Calculate lines and generate the mesh */
-		/* Process words into lines */
-		size_t currentLineLength = 0;
-		float textWidth = 0.0f;
-		float currentLineWidth = 0.0f;
-		size_t lineStart = 0;
+				/* Spaces and other empty glyphs only advance */
+				if (glyph->Size.x > 0 && glyph->Size.y > 0)
+				{
+					const float xpos = textData.m_Offsets.x + writeX + glyph->Bearing.x * scale;
+					const float ypos = textData.m_Offsets.y + writeY - (glyph->Size.y - glyph->Bearing.y) * scale;
 
-		const size_t spaceGlyphIndex = pFontData->GetGlyphIndex(' ');
-		const GlyphData* spaceGlyph = pFontData->GetGlyph(spaceGlyphIndex);
+					const float w = glyph->Size.x * scale;
+					const float h = glyph->Size.y * scale;
 
-		size_t nextNewLineWord = std::string::npos;
-		if (!newLineQueue.empty())
-		{
-			nextNewLineWord = newLineQueue.front();
-			newLineQueue.pop();
-		}
+					VertexPosColorTex vertices[4] = {
+						{ { xpos, ypos + h, }, color, { glyph->Coords.x, glyph->Coords.y } },
+						{ { xpos, ypos, }, color, { glyph->Coords.x, glyph->Coords.w } },
+						{ { xpos + w, ypos, }, color, { glyph->Coords.z, glyph->Coords.w } },
+						{ { xpos + w, ypos + h, }, color, { glyph->Coords.z, glyph->Coords.y }, }
+					};
 
-		const float space = spaceGlyph ? (spaceGlyph->Advance >> 6) * scale : 0.0f;
-		for (size_t i = 0; i < wordPositions.size(); ++i)
-		{
-			const bool newLineBeforeWord = nextNewLineWord == i;
-			if (newLineBeforeWord)
-			{
-				nextNewLineWord = std::string::npos;
-				if (!newLineQueue.empty())
-				{
-					nextNewLineWord = newLineQueue.front();
-					newLineQueue.pop();
+					pMesh->AddVertex(reinterpret_cast<float*>(&vertices[0]));
+					pMesh->AddVertex(reinterpret_cast<float*>(&vertices[1]));
+					pMesh->AddVertex(reinterpret_cast<float*>(&vertices[2]));
+					pMesh->AddVertex(reinterpret_cast<float*>(&vertices[3]));
+					pMesh->AddFace(indexOffset + letterCount*4 + 0, indexOffset + letterCount*4 + 1,
+						indexOffset + letterCount*4 + 2, indexOffset + letterCount*4 + 3);
+					++letterCount;
 				}
+				writeX += character.m_Advance;
 			}
 
-			const std::pair<size_t, size_t>& wordPosition = wordPositions[i];
-			const std::string_view word = text.substr(wordPosition.first, wordPosition.second);
-
-			/* Calculate word width */
-			float wordWidth = 0.0f;
-			for (char c : word)
-			{
-				const size_t glyphIndex = pFontData->GetGlyphIndex(c == '\t' ? ' ' : c);
-				const GlyphData* glyph = pFontData->GetGlyph(glyphIndex);
-
-				if (!glyph) continue;
-				const float advance = (glyph->Advance >> 6) * scale;
-				wordWidth += advance;
-			}
+			writeY -= pFontData->FontHeight()*scale;
+			textHeight += pFontData->FontHeight()*scale;
+			textWidth = std::max(line.m_Width, textWidth);
+		}
+		return { textWidth, textHeight };
+	}
 
-			if ((currentLineLength > 0 && textWrap > 0.0f && currentLineWidth + wordWidth >= textWrap) || newLineBeforeWord)
-			{
-				const std::string_view line = text.substr(lineStart, wordPosition.first - lineStart);
-				drawLine(line, currentLineWidth);
-				lineStart = wordPosition.first;
-				textWidth = std::max(currentLineWidth, textWidth);
-				currentLineWidth = 0.0f;
-				currentLineLength = 0;
-				--i;
-				continue;
-			}
+	uint64_t TextLayoutHash(const TextData& textData, const FontData* pFontData, float textWrap)
+	{
+		size_t hash = 0;
+		std::CombineHash(hash, std::string_view(textData.m_Text));
+		std::CombineHash(hash, uint64_t(pFontData->GetUUID()));
+		std::CombineHash(hash, pFontData->DirtyVersion());
+		std::CombineHash(hash, textData.m_Scale);
+		std::CombineHash(hash, textData.m_Alignment);
+		std::CombineHash(hash, textWrap > 0.0f ? textWrap : textData.m_TextWrap);
+		std::CombineHash(hash, textData.m_Offsets.x);
+		std::CombineHash(hash, textData.m_Offsets.y);
+		/* 0 is reserved for meshes that were never generated */
+		return hash != 0 ? uint64_t(hash) : 1;
+	}
 
-			currentLineWidth += wordWidth + space;
-			currentLineLength += word.length() + 1;
-		}
+	void SetTextMeshColor(MeshData* pMesh, const glm::vec4& color)
+	{
+		const uint32_t vertexCount = pMesh->VertexCount();
+		if (vertexCount == 0) return;
+		const glm::vec3 rgb{ color };
+		VertexPosColorTex* vertices = reinterpret_cast<VertexPosColorTex*>(pMesh->Vertices());
+		for (uint32_t i = 0; i < vertexCount; ++i)
+			vertices[i].Color = rgb;
+		pMesh->IncrementDirtyVersion();
+	}
 
-		/* If there was 1 more line we could not generate yet we can generate it now */
-		if (currentLineLength > 0)
+	bool UpdateTextMesh(MeshData* pMesh, FontData* pFontData, const TextData& textData, TextMeshState& state, float textWrap)
+	{
+		const uint64_t layoutHash = TextLayoutHash(textData, pFontData, textWrap);
+		if (layoutHash != state.m_LayoutHash)
 		{
-			const std::string_view line = text.substr(lineStart);
-			drawLine(line, currentLineWidth);
-			textWidth = std::max(currentLineWidth, textWidth);
+			GenerateTextMesh(pMesh, pFontData, textData, textWrap);
+			state.m_LayoutHash = layoutHash;
+			state.m_Color = textData.m_Color;
+			return true;
 		}
-		return { textWidth, textHeight };
+		if (textData.m_Color == state.m_Color) return false;
+		SetTextMeshColor(pMesh, textData.m_Color);
+		state.m_Color = textData.m_Color;
+		return true;
 	}
 }
@@ -4,6 +4,7 @@
 #include <engine_visibility.h>
 
 #include <vector>
+#include <string_view>
 #include <glm/ext/vector_int2.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
@@ -39,11 +40,67 @@ namespace Glory
 		glm::vec4 Coords;
 	};
 
+	/** @brief Adjustment of the advance between two characters */
+	struct KerningPair
+	{
+		uint64_t Left;
+		uint64_t Right;
+		/** @brief Adjustment in 1/64th pixels, same as @ref GlyphData::Advance */
+		int32_t Amount;
+	};
+
+	/** @brief What a text mesh was last generated from, see @ref Utils::UpdateTextMesh */
+	struct TextMeshState
+	{
+		/** @brief Hash of everything that moves glyphs, 0 if the mesh was never generated */
+		uint64_t m_LayoutHash{ 0 };
+		glm::vec4 m_Color{};
+	};
+
 	class MeshData;
 	class FontData;
 
 	namespace Utils
 	{
+		/** @brief Decode the UTF-8 code point at a position in a string
+		 * @param text Text to decode
+		 * @param position Byte position of the code point, moved to the next code point
+		 * @returns The code point, or U+FFFD for malformed sequences which skip a single byte
+		 */
+		GLORY_ENGINE_API uint32_t DecodeUTF8(std::string_view text, size_t& position);
+
+		/** @brief Generate quads for UTF-8 text with kerning and word wrapping
+		 * @param pMesh Mesh to write the quads to
+		 * @param pFontData Font to lay the text out with
+		 * @param renderData Text and its settings
+		 * @param textWrap Width at which lines wrap, uses the wrap of the text data if 0
+		 * @returns Width of the widest line and the total height of the text
+		 */
 		GLORY_ENGINE_API glm::vec2 GenerateTextMesh(MeshData* pMesh, FontData* pFontData, const TextData& renderData, float textWrap=0.0f);
+
+		/** @brief Hash the text and settings that decide where glyphs are placed
+		 * @param textData Text and its settings, the color and dirty flag are not included
+		 * @param pFontData Font the text is laid out with
+		 * @param textWrap Wrap width that will be passed to @ref GenerateTextMesh
+		 */
+		GLORY_ENGINE_API uint64_t TextLayoutHash(const TextData& textData, const FontData* pFontData, float textWrap=0.0f);
+
+		/** @brief Replace the color of every vertex of a text mesh without laying it out again */
+		GLORY_ENGINE_API void SetTextMeshColor(MeshData* pMesh, const glm::vec4& color);
+
+		/** @brief Bring a text mesh up to date doing as little work as possible
+		 * @param pMesh Mesh that was generated from the text before, or an empty mesh
+		 * @param pFontData Font to lay the text out with
+		 * @param textData Text and its settings, the dirty flag is ignored
+		 * @param state What the mesh was last generated from, updated when the mesh changes
+		 * @param textWrap Width at which lines wrap, uses the wrap of the text data if 0
+		 * @returns true if the mesh changed
+		 *
+		 * The mesh is only laid out again when its layout hash changed and only recolored
+		 * when just the color changed. An unchanged mesh keeps its dirty version so the
+		 * graphics device keeps using its uploaded copy.
+		 */
+		GLORY_ENGINE_API bool UpdateTextMesh(MeshData* pMesh, FontData* pFontData, const TextData& textData,
+			TextMeshState& state, float textWrap=0.0f);
 	}
 }
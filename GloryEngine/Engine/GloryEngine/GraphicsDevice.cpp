@@ -8,9 +8,16 @@
 #include "MeshData.h"
 #include "FileData.h"
 #include "CubemapData.h"
+#include "TextureData.h"
+#include "Resources.h"
 
 #include <Module.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <queue>
+
 #define TEMPLATE_GETTER(type) template<> \
 type* GraphicsDevice::GetResource<type>(UUID id)\
 {\
@@ -26,14 +33,52 @@ void GraphicsDevice::Free<type##Handle>(type##Handle& handle)\
 
 namespace Glory
 {
+	namespace
+	{
+		/* One bit per device index that is in use */
+		uint32_t UsedDeviceIndices = 0;
+
+		/* Streamed textures always keep the levels up to this size resident */
+		constexpr uint32_t StreamingTailSize = 64;
+		/* Frames a replaced texture stays alive so frames in flight can finish using it */
+		constexpr uint64_t RetiredTextureFrames = 4;
+
+		uint32_t StreamingTailLevel(const ImageData* pImage)
+		{
+			const size_t levelCount = pImage->MipLevelCount();
+			for (size_t i = 0; i < levelCount; ++i)
+			{
+				const ImageData::MipLevel& level = pImage->GetMipLevel(i);
+				if (std::max(level.m_Width, level.m_Height) <= StreamingTailSize)
+					return static_cast<uint32_t>(i);
+			}
+			return levelCount ? static_cast<uint32_t>(levelCount - 1) : 0;
+		}
+
+		size_t ResidentLevelsSize(const ImageData* pImage, uint32_t firstMip)
+		{
+			if (firstMip == 0 || firstMip >= pImage->MipLevelCount()) return pImage->DataSize();
+			return pImage->DataSize() - pImage->GetMipLevel(firstMip).m_Offset;
+		}
+	}
+
 	GraphicsDevice::GraphicsDevice(Module* pModule):
 		m_pModule(pModule), m_APIFeatures(APIFeatures::None), m_CurrentDrawCalls(0), m_LastDrawCalls(0),
-		m_LastVertices(0), m_CurrentVertices(0), m_LastTriangles(0), m_CurrentTriangles(0)
+		m_LastVertices(0), m_CurrentVertices(0), m_LastTriangles(0), m_CurrentTriangles(0), m_DeviceIndex(UINT32_MAX)
 	{
+		for (uint32_t i = 0; i < Resource::MaxGPUSlots; ++i)
+		{
+			if (UsedDeviceIndices & (1 << i)) continue;
+			UsedDeviceIndices |= 1 << i;
+			m_DeviceIndex = i;
+			break;
+		}
 	}
 
 	GraphicsDevice::~GraphicsDevice()
 	{
+		if (m_DeviceIndex < Resource::MaxGPUSlots)
+			UsedDeviceIndices &= ~(1 << m_DeviceIndex);
 		m_pModule = nullptr;
 	}
 
@@ -56,12 +101,13 @@ namespace Glory
 
 		uint64_t& cacheVersion = m_CacheVersions[pPipeline->GetUUID()];
 
-		auto iter = m_PipelineHandles.find(pPipeline->GetGPUUUID());
-		if (iter == m_PipelineHandles.end())
+		std::vector<LayoutPipeline>& layoutPipelines = m_LayoutPipelines[pPipeline->GetGPUUUID()];
+		if (layoutPipelines.empty())
 		{
 			PipelineHandle newPipeline = CreatePipeline(renderPass, pPipeline,
 				std::move(descriptorSets), stride, attributeTypes);
 			m_PipelineHandles.emplace(pPipeline->GetGPUUUID(), newPipeline).first;
+			layoutPipelines.push_back(LayoutPipeline{ stride, attributeTypes, newPipeline });
 
 			cacheVersion = pPipeline->DirtyVersion();
 			pPipeline->SettingsDirty() = false;
@@ -69,17 +115,31 @@ namespace Glory
 			return newPipeline;
 		}
 
-		PipelineHandle pipeline = iter->second;
-
-		if (pPipeline->IsDirty(cacheVersion))
-			RecreatePipeline(pipeline, pPipeline);
-		else if (pPipeline->SettingsDirty())
-			UpdatePipelineSettings(pipeline, pPipeline);
+		/* The dirty flags are shared by all layouts so they are all updated at once */
+		const bool recreate = pPipeline->IsDirty(cacheVersion);
+		if (recreate || pPipeline->SettingsDirty())
+		{
+			for (const LayoutPipeline& layoutPipeline : layoutPipelines)
+			{
+				if (!layoutPipeline.m_Pipeline) continue;
+				if (recreate) RecreatePipeline(layoutPipeline.m_Pipeline, pPipeline);
+				else UpdatePipelineSettings(layoutPipeline.m_Pipeline, pPipeline);
+			}
+		}
 
 		cacheVersion = pPipeline->DirtyVersion();
 		pPipeline->SettingsDirty() = false;
 
-		return pipeline;
+		for (const LayoutPipeline& layoutPipeline : layoutPipelines)
+		{
+			if (layoutPipeline.m_Stride == stride && layoutPipeline.m_Attributes == attributeTypes)
+				return layoutPipeline.m_Pipeline;
+		}
+
+		PipelineHandle newPipeline = CreatePipeline(renderPass, pPipeline,
+			std::move(descriptorSets), stride, attributeTypes);
+		layoutPipelines.push_back(LayoutPipeline{ stride, attributeTypes, newPipeline });
+		return newPipeline;
 	}
 
 	PipelineHandle GraphicsDevice::AcquireCachedComputePipeline(PipelineData* pPipeline,
@@ -108,59 +168,112 @@ namespace Glory
 		return iter->second;
 	}
 
-	MeshHandle GraphicsDevice::AcquireCachedMesh(MeshData* pMesh, MeshUsage usage)
+	MeshHandle GraphicsDevice::AcquireCachedMesh(MeshData* pMesh, MeshUsage usage, UploadMode mode)
 	{
 		if (!pMesh)
 			return nullptr;
 
-		uint64_t& cacheVersion = m_CacheVersions[pMesh->GetUUID()];
-
-		auto iter = m_MeshHandles.find(pMesh->GetGPUUUID());
-		if (iter == m_MeshHandles.end())
+		CachedResource* pCached = FindCachedResource(pMesh);
+		if (!pCached)
 		{
+			const size_t uploadSize = pMesh->VertexCount()*pMesh->VertexSize() + (pMesh->IndexCount() + pMesh->LODIndexCount())*pMesh->IndexStride();
+			if (!ReserveUpload(pMesh->GetGPUUUID(), uploadSize, mode))
+				return nullptr;
+
 			MeshHandle newMesh = CreateMesh(pMesh, usage);
-			iter = m_MeshHandles.emplace(pMesh->GetGPUUUID(), newMesh).first;
-			cacheVersion = pMesh->DirtyVersion();
+			AddCachedResource(pMesh, newMesh);
 			return newMesh;
 		}
 
-		MeshHandle mesh = iter->second;
-
-		if (pMesh->IsDirty(cacheVersion))
+		MeshHandle mesh = pCached->m_Handle;
+		if (pMesh->IsDirty(pCached->m_Version))
 		{
 			UpdateMesh(mesh, pMesh);
-			cacheVersion = pMesh->DirtyVersion();
+			pCached->m_Version = pMesh->DirtyVersion();
 		}
 
 		return mesh;
 	}
 
-	TextureHandle GraphicsDevice::AcquireCachedTexture(TextureData* pTexture)
+	TextureHandle GraphicsDevice::AcquireCachedTexture(TextureData* pTexture, UploadMode mode)
 	{
 		if (!pTexture) return m_DefaultTexture;
 
-		uint64_t& cacheVersion = m_CacheVersions[pTexture->GetUUID()];
+		CachedResource* pCached = FindCachedResource(pTexture);
+		ImageData* pImage = pTexture->GetImageData(&m_pModule->GetEngine()->GetResources());
 
-		auto iter = m_TextureHandles.find(pTexture->GetGPUUUID());
-		if (iter == m_TextureHandles.end())
+		/* Deferred textures with a stored mip chain start at their smallest levels and are streamed in */
+		auto streamedIter = m_StreamedTextures.find(pTexture->GetGPUUUID());
+		if (streamedIter == m_StreamedTextures.end() && !pCached && mode == UM_Deferred && pImage && pImage->MipLevelCount() > 1)
 		{
-			TextureHandle newTexture = CreateTexture(pTexture);
+			const uint32_t tail = StreamingTailLevel(pImage);
+			streamedIter = m_StreamedTextures.emplace(pTexture->GetGPUUUID(),
+				StreamedTexture{ pTexture->GetUUID(), FLT_MAX, tail, tail, m_StreamingFrame, 0 }).first;
+		}
+		StreamedTexture* pStreamed = streamedIter != m_StreamedTextures.end() ? &streamedIter->second : nullptr;
+
+		if (!pCached)
+		{
+			const uint32_t firstMip = pStreamed && pImage ? std::min(pStreamed->m_TargetMip, StreamingTailLevel(pImage)) : 0;
+			if (!ReserveUpload(pTexture->GetGPUUUID(), pImage ? ResidentLevelsSize(pImage, firstMip) : 0, mode))
+				return nullptr;
+
+			TextureHandle newTexture = CreateTexture(pTexture, firstMip);
 			if (!newTexture) return nullptr;
-			iter = m_TextureHandles.emplace(pTexture->GetGPUUUID(), newTexture).first;
-			cacheVersion = pTexture->DirtyVersion();
+			CachedResource& cached = AddCachedResource(pTexture, newTexture);
+			cached.m_ImageVersion = pImage ? pImage->DirtyVersion() : 0;
+			if (pStreamed) pStreamed->m_ResidentMip = firstMip;
 			return newTexture;
 		}
 
-		TextureHandle texture = iter->second;
-		ImageData* pImage = pTexture->GetImageData(&m_pModule->GetEngine()->GetResources());
-		uint64_t* imageCacheVersion = pImage ? &m_CacheVersions[pImage->GetUUID()] : nullptr;
+		TextureHandle texture = pCached->m_Handle;
+		if (pStreamed && pStreamed->m_ResidentMip > 0 &&
+			(pTexture->IsDirty(pCached->m_Version) || (pImage && pImage->IsDirty(pCached->m_ImageVersion))))
+		{
+			/* Updating would swap in the full image, create the texture again with the levels it had */
+			const bool stillStreamed = pImage && pImage->MipLevelCount() > 1;
+			ReplaceStreamedTexture(*pCached, pTexture, *pStreamed,
+				stillStreamed ? std::min(pStreamed->m_ResidentMip, StreamingTailLevel(pImage)) : 0);
+			if (!stillStreamed) m_StreamedTextures.erase(streamedIter);
+			pCached->m_Version = pTexture->DirtyVersion();
+			if (pImage)
+				pCached->m_ImageVersion = pImage->DirtyVersion();
+			return pCached->m_Handle;
+		}
 
-		if (pTexture->IsDirty(cacheVersion) || (pImage && pImage->IsDirty(*imageCacheVersion)))
+		if (pTexture->IsDirty(pCached->m_Version) || (pImage && pImage->IsDirty(pCached->m_ImageVersion)))
 		{
 			UpdateTexture(texture, pTexture);
-			cacheVersion = pTexture->DirtyVersion();
+			pCached->m_Version = pTexture->DirtyVersion();
 			if (pImage)
-				*imageCacheVersion = pImage->DirtyVersion();
+				pCached->m_ImageVersion = pImage->DirtyVersion();
+
+			/* Cached descriptor sets may still point at the old image or sampler */
+			auto setsIter = m_HandleDescriptorSets.find(texture);
+			if (setsIter != m_HandleDescriptorSets.end())
+			{
+				for (const DescriptorSetInfo* pSetInfo : setsIter->second)
+				{
+					std::vector<TextureHandle> textures(pSetInfo->m_Samplers.size());
+					DescriptorSetUpdateInfo updateInfo;
+					updateInfo.m_Buffers.resize(pSetInfo->m_Buffers.size());
+					updateInfo.m_Samplers.resize(pSetInfo->m_Samplers.size());
+					for (size_t i = 0; i < pSetInfo->m_Buffers.size(); ++i)
+					{
+						updateInfo.m_Buffers[i].m_BufferHandle = pSetInfo->m_Buffers[i].m_BufferHandle;
+						updateInfo.m_Buffers[i].m_Offset = pSetInfo->m_Buffers[i].m_Offset;
+						updateInfo.m_Buffers[i].m_Size = pSetInfo->m_Buffers[i].m_Size;
+						updateInfo.m_Buffers[i].m_DescriptorIndex = static_cast<uint32_t>(i);
+					}
+					for (size_t i = 0; i < pSetInfo->m_Samplers.size(); ++i)
+					{
+						textures[i] = pSetInfo->m_Samplers[i].m_TextureHandle;
+						updateInfo.m_Samplers[i].m_TextureHandles = &textures[i];
+						updateInfo.m_Samplers[i].m_DescriptorIndex = static_cast<uint32_t>(pSetInfo->m_Buffers.size() + i);
+					}
+					UpdateDescriptorSet(m_CachedDescriptorSets.at(*pSetInfo), updateInfo);
+				}
+			}
 		}
 
 		return texture;
@@ -171,23 +284,336 @@ namespace Glory
 		if (!pCubemap)
 			return nullptr;
 
-		uint64_t& cacheVersion = m_CacheVersions[pCubemap->GetUUID()];
-
-		auto iter = m_TextureHandles.find(pCubemap->GetGPUUUID());
-		if (iter == m_TextureHandles.end())
+		CachedResource* pCached = FindCachedResource(pCubemap);
+		if (!pCached)
 		{
 			TextureHandle newTexture = CreateTexture(pCubemap);
-			iter = m_TextureHandles.emplace(pCubemap->GetGPUUUID(), newTexture).first;
-			cacheVersion = pCubemap->DirtyVersion();
+			AddCachedResource(pCubemap, newTexture);
 			return newTexture;
 		}
-		return iter->second;
+		return pCached->m_Handle;
+	}
+
+	DescriptorSetHandle GraphicsDevice::AcquireCachedDescriptorSet(DescriptorSetInfo&& setInfo)
+	{
+		ProfileSample s{ &Profiler(), "GraphicsDevice::AcquireCachedDescriptorSet" };
+		auto iter = m_CachedDescriptorSets.find(setInfo);
+		if (iter != m_CachedDescriptorSets.end()) return iter->second;
+
+		DescriptorSetInfo key = setInfo;
+		DescriptorSetHandle set = CreateDescriptorSet(std::move(setInfo));
+		if (!set) return NULL;
+		iter = m_CachedDescriptorSets.emplace(std::move(key), set).first;
+		for (const BufferDescriptor& buffer : iter->first.m_Buffers)
+		{
+			if (!buffer.m_BufferHandle) continue;
+			m_HandleDescriptorSets[buffer.m_BufferHandle].push_back(&iter->first);
+		}
+		for (const SamplerDescriptor& sampler : iter->first.m_Samplers)
+		{
+			if (!sampler.m_TextureHandle) continue;
+			m_HandleDescriptorSets[sampler.m_TextureHandle].push_back(&iter->first);
+		}
+		return set;
 	}
 
 	bool GraphicsDevice::CachedTextureExists(TextureData* pTexture)
 	{
-		auto iter = m_TextureHandles.find(pTexture->GetGPUUUID());
-		return iter != m_TextureHandles.end();
+		return FindCachedResource(pTexture) != nullptr;
+	}
+
+	bool GraphicsDevice::IsUploadPending(Resource* pResource) const
+	{
+		return pResource && m_PendingUploads.find(pResource->GetGPUUUID()) != m_PendingUploads.end();
+	}
+
+	void GraphicsDevice::SetUploadBudget(size_t budget)
+	{
+		m_UploadBudget = budget;
+	}
+
+	void GraphicsDevice::RequestTextureMip(TextureData* pTexture, float mipLevel)
+	{
+		if (!pTexture) return;
+		ImageData* pImage = pTexture->GetImageData(&m_pModule->GetEngine()->GetResources());
+		if (!pImage || pImage->MipLevelCount() <= 1) return;
+
+		auto iter = m_StreamedTextures.find(pTexture->GetGPUUUID());
+		if (iter == m_StreamedTextures.end())
+		{
+			/* Textures that were already created without streaming have all their levels */
+			const uint32_t tail = StreamingTailLevel(pImage);
+			const uint32_t resident = FindCachedResource(pTexture) ? 0 : tail;
+			iter = m_StreamedTextures.emplace(pTexture->GetGPUUUID(),
+				StreamedTexture{ pTexture->GetUUID(), FLT_MAX, resident, resident, m_StreamingFrame, 0 }).first;
+		}
+		iter->second.m_RequestedMip = std::min(iter->second.m_RequestedMip, std::max(mipLevel, 0.0f));
+	}
+
+	void GraphicsDevice::SetTextureStreamingBudget(size_t budget)
+	{
+		m_TextureStreamingBudget = budget;
+	}
+
+	size_t GraphicsDevice::StreamedTextureMemory() const
+	{
+		return m_StreamedTextureMemory;
+	}
+
+	uint64_t GraphicsDevice::TextureResidencyVersion(TextureData* pTexture) const
+	{
+		if (!pTexture) return 0;
+		auto iter = m_StreamedTextures.find(pTexture->GetGPUUUID());
+		return iter != m_StreamedTextures.end() ? iter->second.m_ResidencyVersion : 0;
+	}
+
+	void GraphicsDevice::UpdateTextureStreaming()
+	{
+		ProfileSample s{ &Profiler(), "GraphicsDevice::UpdateTextureStreaming" };
+		++m_StreamingFrame;
+
+		for (size_t i = 0; i < m_RetiredTextures.size();)
+		{
+			RetiredTexture& retired = m_RetiredTextures[i];
+			if (retired.m_Frame + RetiredTextureFrames > m_StreamingFrame)
+			{
+				++i;
+				continue;
+			}
+			FreeTexture(retired.m_Texture);
+			for (DescriptorSetHandle& set : retired.m_DescriptorSets)
+				FreeDescriptorSet(set);
+			m_RetiredTextures[i] = std::move(m_RetiredTextures.back());
+			m_RetiredTextures.pop_back();
+		}
+
+		if (m_StreamedTextures.empty())
+		{
+			m_StreamedTextureMemory = 0;
+			return;
+		}
+
+		struct Candidate
+		{
+			StreamedTexture* m_pStreamed;
+			CachedResource* m_pCached;
+			TextureData* m_pTexture;
+			ImageData* m_pImage;
+			uint32_t m_TailMip;
+		};
+
+		Resources& resources = m_pModule->GetEngine()->GetResources();
+		std::vector<Candidate> candidates;
+		candidates.reserve(m_StreamedTextures.size());
+		size_t totalSize = 0;
+		for (auto iter = m_StreamedTextures.begin(); iter != m_StreamedTextures.end();)
+		{
+			StreamedTexture& streamed = iter->second;
+			Resource* pResource = resources.GetResource(streamed.m_TextureID);
+			TextureData* pTexture = pResource ? static_cast<TextureData*>(pResource) : nullptr;
+			ImageData* pImage = pTexture ? pTexture->GetImageData(&resources) : nullptr;
+			if (!pImage || pImage->MipLevelCount() <= 1)
+			{
+				/* The texture was unloaded or lost its mip chain, it is no longer streamed */
+				iter = m_StreamedTextures.erase(iter);
+				continue;
+			}
+
+			CachedResource* pCached = FindCachedResource(pTexture);
+			const uint32_t tailMip = StreamingTailLevel(pImage);
+			if (streamed.m_RequestedMip != FLT_MAX)
+			{
+				streamed.m_TargetMip = std::min(static_cast<uint32_t>(std::floor(streamed.m_RequestedMip)), tailMip);
+				streamed.m_LastRequestFrame = m_StreamingFrame;
+			}
+			else
+				streamed.m_TargetMip = std::min(streamed.m_ResidentMip, tailMip);
+			streamed.m_RequestedMip = FLT_MAX;
+
+			/* Textures that are not created yet are created at their target level when first acquired */
+			if (pCached)
+			{
+				candidates.push_back({ &streamed, pCached, pTexture, pImage, tailMip });
+				totalSize += ResidentLevelsSize(pImage, streamed.m_TargetMip);
+			}
+			++iter;
+		}
+
+		if (totalSize > m_TextureStreamingBudget)
+		{
+			/* First drop the finest levels of textures that were not needed for the longest */
+			std::vector<Candidate*> unused;
+			for (Candidate& candidate : candidates)
+			{
+				if (candidate.m_pStreamed->m_LastRequestFrame != m_StreamingFrame)
+					unused.push_back(&candidate);
+			}
+			std::sort(unused.begin(), unused.end(), [](const Candidate* a, const Candidate* b) {
+				return a->m_pStreamed->m_LastRequestFrame < b->m_pStreamed->m_LastRequestFrame;
+			});
+			for (Candidate* pCandidate : unused)
+			{
+				if (totalSize <= m_TextureStreamingBudget) break;
+				StreamedTexture& streamed = *pCandidate->m_pStreamed;
+				totalSize -= ResidentLevelsSize(pCandidate->m_pImage, streamed.m_TargetMip);
+				streamed.m_TargetMip = pCandidate->m_TailMip;
+				totalSize += ResidentLevelsSize(pCandidate->m_pImage, streamed.m_TargetMip);
+			}
+
+			/* Then drop one level at a time from the texture with the largest finest level */
+			auto topLevelSize = [](const Candidate* pCandidate) {
+				return pCandidate->m_pImage->GetMipLevel(pCandidate->m_pStreamed->m_TargetMip).m_Size;
+			};
+			auto smaller = [&topLevelSize](const Candidate* a, const Candidate* b) {
+				return topLevelSize(a) < topLevelSize(b);
+			};
+			std::priority_queue<Candidate*, std::vector<Candidate*>, decltype(smaller)> largest(smaller);
+			for (Candidate& candidate : candidates)
+			{
+				if (candidate.m_pStreamed->m_TargetMip < candidate.m_TailMip)
+					largest.push(&candidate);
+			}
+			while (totalSize > m_TextureStreamingBudget && !largest.empty())
+			{
+				Candidate* pCandidate = largest.top();
+				largest.pop();
+				totalSize -= topLevelSize(pCandidate);
+				++pCandidate->m_pStreamed->m_TargetMip;
+				if (pCandidate->m_pStreamed->m_TargetMip < pCandidate->m_TailMip)
+					largest.push(pCandidate);
+			}
+		}
+
+		m_StreamedTextureMemory = 0;
+		for (Candidate& candidate : candidates)
+		{
+			StreamedTexture& streamed = *candidate.m_pStreamed;
+			if (streamed.m_TargetMip < streamed.m_ResidentMip)
+			{
+				/* Finer levels are loaded within the upload budget, the rest is retried next frame */
+				const size_t uploadSize = ResidentLevelsSize(candidate.m_pImage, streamed.m_TargetMip);
+				if (ReserveUpload(candidate.m_pTexture->GetGPUUUID(), uploadSize, UM_Deferred))
+					ReplaceStreamedTexture(*candidate.m_pCached, candidate.m_pTexture, streamed, streamed.m_TargetMip);
+			}
+			else if (streamed.m_TargetMip > streamed.m_ResidentMip)
+				ReplaceStreamedTexture(*candidate.m_pCached, candidate.m_pTexture, streamed, streamed.m_TargetMip);
+			m_StreamedTextureMemory += ResidentLevelsSize(candidate.m_pImage, streamed.m_ResidentMip);
+		}
+	}
+
+	void GraphicsDevice::ReplaceStreamedTexture(CachedResource& cached, TextureData* pTexture, StreamedTexture& streamed, uint32_t firstMip)
+	{
+		TextureHandle newTexture = CreateTexture(pTexture, firstMip);
+		if (!newTexture)
+		{
+			Debug().LogError("GraphicsDevice::ReplaceStreamedTexture: Could not create texture.");
+			return;
+		}
+
+		RetireTexture(cached.m_Handle);
+		cached.m_Handle = newTexture;
+		streamed.m_ResidentMip = firstMip;
+		++streamed.m_ResidencyVersion;
+	}
+
+	void GraphicsDevice::RetireTexture(TextureHandle texture)
+	{
+		RetiredTexture retired{ texture, {}, m_StreamingFrame };
+
+		/* Cached descriptor sets are keyed by their textures so they can't point at the new texture,
+		 * drop them from the cache and free them together with the texture */
+		EvictCachedDescriptorSets(texture, retired.m_DescriptorSets);
+		m_RetiredTextures.push_back(std::move(retired));
+	}
+
+	void GraphicsDevice::EvictCachedDescriptorSets(UUID handle, std::vector<DescriptorSetHandle>& evicted)
+	{
+		auto setsIter = m_HandleDescriptorSets.find(handle);
+		if (setsIter == m_HandleDescriptorSets.end()) return;
+
+		/* A set that uses the handle more than once is listed once per use */
+		std::vector<const DescriptorSetInfo*> sets = std::move(setsIter->second);
+		m_HandleDescriptorSets.erase(setsIter);
+		std::sort(sets.begin(), sets.end());
+		sets.erase(std::unique(sets.begin(), sets.end()), sets.end());
+
+		const auto unlink = [this](UUID other, const DescriptorSetInfo* pSetInfo) {
+			auto otherIter = m_HandleDescriptorSets.find(other);
+			if (otherIter == m_HandleDescriptorSets.end()) return;
+			std::vector<const DescriptorSetInfo*>& otherSets = otherIter->second;
+			otherSets.erase(std::remove(otherSets.begin(), otherSets.end(), pSetInfo), otherSets.end());
+			if (otherSets.empty()) m_HandleDescriptorSets.erase(otherIter);
+		};
+
+		for (const DescriptorSetInfo* pSetInfo : sets)
+		{
+			for (const BufferDescriptor& buffer : pSetInfo->m_Buffers)
+				unlink(buffer.m_BufferHandle, pSetInfo);
+			for (const SamplerDescriptor& sampler : pSetInfo->m_Samplers)
+				unlink(sampler.m_TextureHandle, pSetInfo);
+			auto cachedIter = m_CachedDescriptorSets.find(*pSetInfo);
+			if (cachedIter == m_CachedDescriptorSets.end()) continue;
+			evicted.push_back(cachedIter->second);
+			m_CachedDescriptorSets.erase(cachedIter);
+		}
+	}
+
+	void GraphicsDevice::FreeCachedDescriptorSets(UUID handle)
+	{
+		if (m_HandleDescriptorSets.empty()) return;
+		std::vector<DescriptorSetHandle> evicted;
+		EvictCachedDescriptorSets(handle, evicted);
+		for (DescriptorSetHandle& set : evicted)
+			FreeDescriptorSet(set);
+	}
+
+	bool GraphicsDevice::ReserveUpload(UUID gpuID, size_t size, UploadMode mode)
+	{
+		/* Immediate uploads always go through but still use up the budget of this frame */
+		if (mode == UM_Deferred && m_FrameUploadCount > 0 && m_FrameUploadSize + size > m_UploadBudget)
+		{
+			m_PendingUploads.emplace(gpuID);
+			return false;
+		}
+
+		m_PendingUploads.erase(gpuID);
+		m_FrameUploadSize += size;
+		++m_FrameUploadCount;
+		return true;
+	}
+
+	GraphicsDevice::CachedResource* GraphicsDevice::FindCachedResource(const Resource* pResource)
+	{
+		return const_cast<CachedResource*>(static_cast<const GraphicsDevice*>(this)->FindCachedResource(pResource));
+	}
+
+	const GraphicsDevice::CachedResource* GraphicsDevice::FindCachedResource(const Resource* pResource) const
+	{
+		const UUID id = pResource->GetGPUUUID();
+		if (m_DeviceIndex < Resource::MaxGPUSlots)
+		{
+			const uint32_t slot = pResource->GPUSlot(m_DeviceIndex);
+			if (slot < m_CachedResources.size() && m_CachedResources[slot].m_ResourceID == id)
+				return &m_CachedResources[slot];
+		}
+
+		/* Either this device has not seen this instance yet or the slot belongs to another device */
+		auto iter = m_CachedResourceSlots.find(id);
+		if (iter == m_CachedResourceSlots.end()) return nullptr;
+		if (m_DeviceIndex < Resource::MaxGPUSlots)
+			pResource->GPUSlot(m_DeviceIndex) = iter->second;
+		return &m_CachedResources[iter->second];
+	}
+
+	GraphicsDevice::CachedResource& GraphicsDevice::AddCachedResource(const Resource* pResource, UUID handle)
+	{
+		const UUID id = pResource->GetGPUUUID();
+		const uint32_t slot = static_cast<uint32_t>(m_CachedResources.size());
+		m_CachedResources.push_back({ id, handle, pResource->DirtyVersion(), 0 });
+		m_CachedResourceSlots.emplace(id, slot);
+		if (m_DeviceIndex < Resource::MaxGPUSlots)
+			pResource->GPUSlot(m_DeviceIndex) = slot;
+		return m_CachedResources.back();
 	}
 
 	ShaderHandle GraphicsDevice::AcquireCachedShader(const FileData* pShaderFileData, const ShaderType& shaderType, const std::string& function)
@@ -205,21 +631,19 @@ namespace Glory
 
 	void GraphicsDevice::SetCachedTexture(TextureData* pTexture, TextureHandle texture)
 	{
-		m_TextureHandles[pTexture->GetUUID()] = texture;
+		CachedResource* pCached = FindCachedResource(pTexture);
+		if (!pCached)
+		{
+			AddCachedResource(pTexture, texture);
+			return;
+		}
+		pCached->m_Handle = texture;
 	}
 
 	TextureHandle GraphicsDevice::GetCachedTexture(TextureData* pTexture) const
 	{
-		auto iter = m_TextureHandles.find(pTexture->GetGPUUUID());
-		if (iter == m_TextureHandles.end()) return nullptr;
-		return iter->second;
-	}
-
-	bool GraphicsDevice::IsDirty(UUID resourceID, uint64_t version) const
-	{
-		auto iter = m_CacheVersions.find(resourceID);
-		if (iter == m_CacheVersions.end()) return true;
-		return version < iter->second;
+		const CachedResource* pCached = FindCachedResource(pTexture);
+		return pCached ? TextureHandle(pCached->m_Handle) : TextureHandle(nullptr);
 	}
 
 	MeshHandle GraphicsDevice::CreateMesh(MeshData* pMeshData, MeshUsage usage)
@@ -238,12 +662,26 @@ namespace Glory
 		}
 
 		std::vector<BufferHandle> buffers(2);
-		buffers[0] = CreateBuffer(pMeshData->VertexCount()*pMeshData->VertexSize(), BufferType::BT_Vertex, BF_CopyDst);
-		buffers[1] = CreateBuffer(pMeshData->IndexCount()*sizeof(uint32_t), BufferType::BT_Index, BF_CopyDst);
+		buffers[0] = CreateBuffer(pMeshData->VertexCount()*pMeshData->VertexSize(), BufferType::BT_Vertex, bufferFlags);
+		/* LOD indices are stored right after the indices of the full mesh */
+		const uint32_t indexSize = pMeshData->IndexCount()*pMeshData->IndexStride();
+		const uint32_t lodIndexSize = pMeshData->LODIndexCount()*pMeshData->IndexStride();
+		buffers[1] = CreateBuffer(indexSize + lodIndexSize, BufferType::BT_Index, bufferFlags);
 		AssignBuffer(buffers[0], pMeshData->Vertices(), pMeshData->VertexCount()*pMeshData->VertexSize());
-		AssignBuffer(buffers[1], pMeshData->Indices(), pMeshData->IndexCount()*sizeof(uint32_t));
+		if (pMeshData->GetIndexType() == IndexType::UInt16)
+		{
+			std::vector<uint16_t> indices;
+			pMeshData->PackIndices(indices);
+			AssignBuffer(buffers[1], indices.data(), indexSize + lodIndexSize);
+		}
+		else
+		{
+			AssignBuffer(buffers[1], pMeshData->Indices(), indexSize);
+			if (lodIndexSize > 0)
+				AssignBuffer(buffers[1], pMeshData->LODIndices(), indexSize, lodIndexSize);
+		}
 		return CreateMesh(std::move(buffers), pMeshData->VertexCount(), pMeshData->IndexCount(),
-			pMeshData->VertexSize(), pMeshData->AttributeTypesVector());
+			pMeshData->VertexSize(), pMeshData->AttributeTypesVector(), pMeshData->GetIndexType());
 	}
 
 	Debug& GraphicsDevice::Debug()
@@ -345,6 +783,8 @@ namespace Glory
 		m_CurrentDrawCalls = 0;
 		m_CurrentVertices = 0;
 		m_CurrentTriangles = 0;
+		m_FrameUploadSize = 0;
+		m_FrameUploadCount = 0;
 	}
 
 	void GraphicsDevice::EndFrame()
@@ -352,6 +792,7 @@ namespace Glory
 		m_LastDrawCalls = m_CurrentDrawCalls;
 		m_LastVertices = m_CurrentVertices;
 		m_LastTriangles = m_CurrentTriangles;
+		UpdateTextureStreaming();
 	}
 
 	int GraphicsDevice::GetLastDrawCalls() const
@@ -375,4 +816,104 @@ namespace Glory
 		Begin(commandBuffer);
 		return commandBuffer;
 	}
+
+	void GraphicsDevice::Readback(CommandBufferHandle commandBuffer, BufferHandle src,
+		uint32_t offset, uint32_t size, ReadbackCallback callback)
+	{
+		ProfileSample s{ &Profiler(), "GraphicsDevice::Readback" };
+		if (size == 0) return;
+
+		/* Find the smallest free readback buffer that fits */
+		size_t bestIndex = m_FreeReadbackBuffers.size();
+		size_t bestSize = SIZE_MAX;
+		for (size_t i = 0; i < m_FreeReadbackBuffers.size(); ++i)
+		{
+			const size_t bufferSize = BufferSize(m_FreeReadbackBuffers[i]);
+			if (bufferSize < size || bufferSize >= bestSize) continue;
+			bestIndex = i;
+			bestSize = bufferSize;
+		}
+
+		BufferHandle readbackBuffer = NULL;
+		if (bestIndex < m_FreeReadbackBuffers.size())
+		{
+			readbackBuffer = m_FreeReadbackBuffers[bestIndex];
+			m_FreeReadbackBuffers.erase(m_FreeReadbackBuffers.begin() + bestIndex);
+		}
+		else
+		{
+			/* Round up to a power of 2 so buffers can be reused for varying sizes */
+			size_t bufferSize = 256;
+			while (bufferSize < size) bufferSize *= 2;
+			readbackBuffer = CreateBuffer(bufferSize, BufferType::BT_TransferWrite, BF_Read);
+		}
+
+		if (!readbackBuffer)
+		{
+			Debug().LogError("GraphicsDevice::Readback: Failed to create readback buffer.");
+			return;
+		}
+
+		CopyBuffer(commandBuffer, src, readbackBuffer, offset, 0, size);
+
+		BufferBarrier hostBarrier;
+		hostBarrier.m_Buffer = readbackBuffer;
+		hostBarrier.m_SrcAccessMask = AF_CopyDst;
+		hostBarrier.m_DstAccessMask = AF_CPURead;
+		hostBarrier.m_Size = size;
+		PipelineBarrier(commandBuffer, { hostBarrier }, {}, PipelineStageFlagBits::PST_Transfer, PipelineStageFlagBits::PST_Host);
+
+		m_PendingReadbacks.push_back({ commandBuffer, readbackBuffer, size, std::move(callback) });
+	}
+
+	void GraphicsDevice::PollReadbacks()
+	{
+		ProfileSample s{ &Profiler(), "GraphicsDevice::PollReadbacks" };
+		/* Command buffers finish in submission order, so stop at the first one that is still busy */
+		while (!m_PendingReadbacks.empty())
+		{
+			const CommandBufferHandle commandBuffer = m_PendingReadbacks.front().m_CommandBuffer;
+			if (Wait(commandBuffer, 0) != WR_Success) break;
+		}
+	}
+
+	void GraphicsDevice::CompleteReadbacks(CommandBufferHandle commandBuffer)
+	{
+		if (m_PendingReadbacks.empty()) return;
+		ProfileSample s{ &Profiler(), "GraphicsDevice::CompleteReadbacks" };
+
+		for (size_t i = 0; i < m_PendingReadbacks.size();)
+		{
+			if (m_PendingReadbacks[i].m_CommandBuffer != commandBuffer)
+			{
+				++i;
+				continue;
+			}
+
+			/* Remove before invoking the callback in case it records new readbacks */
+			PendingReadback readback = std::move(m_PendingReadbacks[i]);
+			m_PendingReadbacks.erase(m_PendingReadbacks.begin() + i);
+
+			m_ReadbackData.resize(readback.m_Size);
+			ReadBuffer(readback.m_Buffer, m_ReadbackData.data(), 0, readback.m_Size);
+			m_FreeReadbackBuffers.push_back(readback.m_Buffer);
+			if (readback.m_Callback)
+				readback.m_Callback(m_ReadbackData.data(), readback.m_Size);
+		}
+	}
+
+	void GraphicsDevice::DropReadbacks(CommandBufferHandle commandBuffer)
+	{
+		for (size_t i = 0; i < m_PendingReadbacks.size();)
+		{
+			if (m_PendingReadbacks[i].m_CommandBuffer != commandBuffer)
+			{
+				++i;
+				continue;
+			}
+			/* Later copies into the buffer are queued after the unfinished one */
+			m_FreeReadbackBuffers.push_back(m_PendingReadbacks[i].m_Buffer);
+			m_PendingReadbacks.erase(m_PendingReadbacks.begin() + i);
+		}
+	}
 }
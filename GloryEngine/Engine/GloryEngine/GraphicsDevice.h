@@ -8,6 +8,10 @@
 
 #include <glm/vec4.hpp>
 
+#include <filesystem>
+#include <functional>
+#include <unordered_set>
+
 namespace Glory
 {
 	/** @brief Buffer type */
@@ -34,6 +38,8 @@ namespace Glory
 		BF_ReadAndWrite = BF_Read | BF_Write,
 		/** @brief Force copying to be enabled on this buffer */
 		BF_CopyDst = 1 << 2,
+		/** @brief Allow this buffer to be used as a copy source */
+		BF_CopySrc = 1 << 3,
 	};
 
 	/** @brief Mesh usage */
@@ -45,6 +51,18 @@ namespace Glory
 		MU_Dynamic = 1,
 	};
 
+	/** @brief When a cached resource is created on the device */
+	enum UploadMode
+	{
+		/** @brief Create the resource the moment it is first acquired */
+		UM_Immediate = 0,
+		/**
+		 * @brief Create the resource once the per frame upload budget allows it,
+		 * acquiring returns a null handle while the upload is pending
+		 */
+		UM_Deferred = 1,
+	};
+
 	/** @brief Push constants range */
 	struct PushConstantsRange
 	{
@@ -344,8 +362,53 @@ namespace Glory
 		DescriptorSetLayoutHandle m_Layout;
 		std::vector<BufferDescriptor> m_Buffers;
 		std::vector<SamplerDescriptor> m_Samplers;
+
+		inline bool operator==(const DescriptorSetInfo& other) const
+		{
+			if (m_Layout != other.m_Layout || m_Buffers.size() != other.m_Buffers.size() ||
+				m_Samplers.size() != other.m_Samplers.size()) return false;
+			for (size_t i = 0; i < m_Buffers.size(); ++i)
+			{
+				if (m_Buffers[i].m_BufferHandle != other.m_Buffers[i].m_BufferHandle ||
+					m_Buffers[i].m_Offset != other.m_Buffers[i].m_Offset ||
+					m_Buffers[i].m_Size != other.m_Buffers[i].m_Size) return false;
+			}
+			for (size_t i = 0; i < m_Samplers.size(); ++i)
+				if (m_Samplers[i].m_TextureHandle != other.m_Samplers[i].m_TextureHandle) return false;
+			return true;
+		}
+	};
+
+}
+
+namespace std
+{
+	/** @brief Hash generator for DescriptorSetInfo */
+	template <>
+	struct hash<Glory::DescriptorSetInfo>
+	{
+		/** @brief Hash function */
+		inline size_t operator()(const Glory::DescriptorSetInfo& info) const noexcept
+		{
+			size_t hash = 0;
+			CombineHash(hash, uint64_t(info.m_Layout.m_ID));
+
+			for (auto& buffer : info.m_Buffers)
+			{
+				CombineHash(hash, uint64_t(buffer.m_BufferHandle.m_ID));
+				CombineHash(hash, buffer.m_Offset);
+				CombineHash(hash, buffer.m_Size);
+			}
+
+			for (auto& sampler : info.m_Samplers)
+				CombineHash(hash, uint64_t(sampler.m_TextureHandle.m_ID));
+			return hash;
+		}
 	};
+}
 
+namespace Glory
+{
 	/** @brief Buffer descriptor update info */
 	struct BufferDescriptorUpdate
 	{
@@ -442,6 +505,13 @@ namespace Glory
 		GLORY_ENGINE_API int GetLastTriangleCount() const;
 
 		TextureHandle GetDefaultTexture() const { return m_DefaultTexture; }
+		/**
+		 * @brief Index of this device into the GPU slots of resources, see @ref Resource::GPUSlot()
+		 *
+		 * Devices created while @ref Resource::MaxGPUSlots devices already exist
+		 * get an invalid index and find their resources by UUID instead.
+		 */
+		uint32_t DeviceIndex() const { return m_DeviceIndex; }
 
 	public: /* Rendering commands */
 		/** @brief Create a new command buffer */
@@ -507,6 +577,17 @@ namespace Glory
 		 * @param handle Mesh to draw
 		 */
 		virtual void DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle) = 0;
+		/**
+		 * @brief Push a draw of a range of the indices of a mesh onto the command buffer
+		 * @param commandBuffer The handle to the command buffer
+		 * @param handle Mesh to draw
+		 * @param firstIndex Index in the index buffer to start drawing from
+		 * @param indexCount Number of indices to draw
+		 *
+		 * Used to draw a LOD of a mesh, see @ref MeshData::GetLOD().
+		 * Meshes without an index buffer are drawn in full.
+		 */
+		virtual void DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle, uint32_t firstIndex, uint32_t indexCount) = 0;
 		/**
 		 * @brief Push a dispatch onto the command buffer
 		 * @param commandBuffer The handle to the command buffer
@@ -596,6 +677,17 @@ namespace Glory
 
 		virtual void CopyImage(CommandBufferHandle commandBuffer, TextureHandle src, TextureHandle dst) = 0;
 		virtual void CopyImageToBuffer(CommandBufferHandle commandBuffer, TextureHandle src, BufferHandle dst) = 0;
+		/**
+		 * @brief Record a buffer to buffer copy
+		 * @param commandBuffer The handle to the command buffer
+		 * @param src Buffer to copy from, must be a transfer read buffer or have @ref BF_CopySrc
+		 * @param dst Buffer to copy to, must be a transfer write buffer or have @ref BF_CopyDst
+		 * @param srcOffset Offset in bytes into the source buffer
+		 * @param dstOffset Offset in bytes into the destination buffer
+		 * @param size Number of bytes to copy
+		 */
+		virtual void CopyBuffer(CommandBufferHandle commandBuffer, BufferHandle src, BufferHandle dst,
+			uint32_t srcOffset, uint32_t dstOffset, uint32_t size) = 0;
 
 		enum SwapchainResult
 		{
@@ -626,6 +718,52 @@ namespace Glory
 
 		virtual void WaitIdle() = 0;
 
+	public: /* Readback */
+		/** @brief Callback that receives the data of a finished readback */
+		using ReadbackCallback = std::function<void(const void* data, uint32_t size)>;
+
+		/**
+		 * @brief Record a copy of a buffer region into a CPU visible readback buffer
+		 * @param commandBuffer The handle to the command buffer
+		 * @param src Buffer to read back, must have @ref BF_CopySrc
+		 * @param offset Offset in bytes into the source buffer
+		 * @param size Number of bytes to read back
+		 * @param callback Callback to receive the data once the GPU has finished the command buffer
+		 *
+		 * The caller is responsible for recording a barrier that makes prior writes to @p src
+		 * visible to transfer reads. The callback is invoked from @ref Wait or @ref PollReadbacks
+		 * after the command buffer has finished, the CPU never waits on the GPU for the result.
+		 * Readbacks of a command buffer that is released before it finished are dropped.
+		 * Readback buffers are pooled and reused once their results were delivered.
+		 */
+		GLORY_ENGINE_API void Readback(CommandBufferHandle commandBuffer, BufferHandle src,
+			uint32_t offset, uint32_t size, ReadbackCallback callback);
+		/** @brief Deliver the results of readbacks whose command buffers have finished, without blocking */
+		GLORY_ENGINE_API void PollReadbacks();
+
+	protected:
+		/**
+		 * @brief Deliver the results of all readbacks recorded on a command buffer
+		 * @param commandBuffer The handle to the command buffer, must have finished on the GPU
+		 *
+		 * Backends call this when a wait on the command buffer succeeded or when it is released.
+		 */
+		GLORY_ENGINE_API void CompleteReadbacks(CommandBufferHandle commandBuffer);
+		/**
+		 * @brief Discard all readbacks recorded on a command buffer without invoking their callbacks
+		 * @param commandBuffer The handle to the command buffer
+		 *
+		 * Backends call this when a command buffer is released before the GPU finished it.
+		 */
+		GLORY_ENGINE_API void DropReadbacks(CommandBufferHandle commandBuffer);
+		/**
+		 * @brief Free the cached descriptor sets that reference a texture or buffer
+		 * @param handle Handle of the texture or buffer
+		 *
+		 * Backends call this when the texture or buffer is freed so the cache never hands out sets pointing at it.
+		 */
+		GLORY_ENGINE_API void FreeCachedDescriptorSets(UUID handle);
+
 	public: /* Resource caching */
 		/**
 		 * @brief Acquire a cached pipeline or create a new one
@@ -637,6 +775,7 @@ namespace Glory
 		 *
 		 * The pipeline gets recreated if the shaders have changed,
 		 * and gets updated if its settings were changed.
+		 * Each vertex layout gets its own pipeline, all of them are updated together.
 		 */
 		GLORY_ENGINE_API PipelineHandle AcquireCachedPipeline(RenderPassHandle renderPass, PipelineData* pPipeline,
 			std::vector<DescriptorSetLayoutHandle>&& descriptorSets, size_t stride,
@@ -647,13 +786,17 @@ namespace Glory
 		/**
 		 * @brief Acquire a cached mesh or create a new one
 		 * @param pMesh The mesh data to create a mesh from
+		 * @param usage How often the contents of the mesh change
+		 * @param mode Whether the mesh may be created in a later frame, see @ref UploadMode
 		 */
-		GLORY_ENGINE_API MeshHandle AcquireCachedMesh(MeshData* pMesh, MeshUsage usage=MeshUsage::MU_Static);
+		GLORY_ENGINE_API MeshHandle AcquireCachedMesh(MeshData* pMesh, MeshUsage usage=MeshUsage::MU_Static,
+			UploadMode mode=UploadMode::UM_Immediate);
 		/**
 		 * @brief Acquire a cached texture or create a new one
 		 * @param pTexture The texture data to create a texture from
+		 * @param mode Whether the texture may be created in a later frame, see @ref UploadMode
 		 */
-		GLORY_ENGINE_API TextureHandle AcquireCachedTexture(TextureData* pTexture);
+		GLORY_ENGINE_API TextureHandle AcquireCachedTexture(TextureData* pTexture, UploadMode mode=UploadMode::UM_Immediate);
 		/**
 		 * @brief Acquire a cached cubemap texture or create a new one
 		 * @param pTexture The cubemap data to create a texture from
@@ -664,6 +807,44 @@ namespace Glory
 		 * @param pTexture The texture data to check for
 		 */
 		GLORY_ENGINE_API bool CachedTextureExists(TextureData* pTexture);
+		/**
+		 * @brief Check if a deferred mesh or texture is still waiting to be created
+		 * @param pResource The mesh or texture data
+		 */
+		GLORY_ENGINE_API bool IsUploadPending(Resource* pResource) const;
+		/**
+		 * @brief Set how many bytes of deferred mesh and texture data may be created per frame
+		 * @param budget Budget in bytes, at least one deferred resource is created each frame regardless
+		 */
+		GLORY_ENGINE_API void SetUploadBudget(size_t budget);
+
+		/**
+		 * @brief Request the finest mip level of a texture that was needed this frame
+		 * @param pTexture Texture data, only textures with stored mip levels are streamed
+		 * @param mipLevel Finest mip level sampled by a visible object, rounded down
+		 *
+		 * Requested textures only keep the mip levels they need resident.
+		 * Residency changes at the end of the frame within the streaming budget,
+		 * finer levels use the deferred upload budget so they arrive over multiple frames.
+		 * Streamed textures get a new handle when their residency changes,
+		 * see @ref TextureResidencyVersion().
+		 */
+		GLORY_ENGINE_API void RequestTextureMip(TextureData* pTexture, float mipLevel);
+		/**
+		 * @brief Set how many bytes streamed textures may use on this device
+		 * @param budget Budget in bytes, textures drop their finest levels until they fit
+		 */
+		GLORY_ENGINE_API void SetTextureStreamingBudget(size_t budget);
+		/** @brief Bytes used by the resident mip levels of all streamed textures */
+		GLORY_ENGINE_API size_t StreamedTextureMemory() const;
+		/**
+		 * @brief Get a version that increments every time the resident mip levels of a texture change
+		 * @param pTexture The texture data
+		 *
+		 * Handles acquired through @ref AcquireCachedTexture() before the version changed
+		 * stay valid for a few frames and should be acquired again.
+		 */
+		GLORY_ENGINE_API uint64_t TextureResidencyVersion(TextureData* pTexture) const;
 
 		/**
 		 * @brief Acquire a cached shader or create a new one
@@ -672,10 +853,28 @@ namespace Glory
 		 * @param function Main function to invoke in the shader
 		 */
 		GLORY_ENGINE_API ShaderHandle AcquireCachedShader(const FileData* pShaderFileData, const ShaderType& shaderType, const std::string& function);
+		/**
+		 * @brief Acquire a cached descriptor set or create a new one
+		 * @param setInfo Descriptor set info, sets with identical layouts and resources are shared
+		 *
+		 * Cached sets are owned by the device and must not be freed or updated by the caller.
+		 * They are rewritten when a texture they reference is updated through @ref AcquireCachedTexture().
+		 */
+		GLORY_ENGINE_API DescriptorSetHandle AcquireCachedDescriptorSet(DescriptorSetInfo&& setInfo);
+
+		/**
+		 * @brief Load a pipeline cache from disk to speed up pipeline creation
+		 * @param path Path to the cache file, the cache is written back to this path on @ref SavePipelineCache()
+		 *
+		 * The cache is discarded if it was created by a different device or driver.
+		 * Devices that have no use for a pipeline cache ignore this call.
+		 */
+		virtual void LoadPipelineCache(const std::filesystem::path& path) {}
+		/** @brief Write the pipeline cache back to the path passed to @ref LoadPipelineCache() */
+		virtual void SavePipelineCache() {}
 
 		GLORY_ENGINE_API void SetCachedTexture(TextureData* pTexture, TextureHandle texture);
 		GLORY_ENGINE_API TextureHandle GetCachedTexture(TextureData* pTexture) const;
-		GLORY_ENGINE_API bool IsDirty(UUID resourceID, uint64_t version) const;
 
 	public: /* Resource management */
 		
@@ -736,9 +935,11 @@ namespace Glory
 		 * @param indexCount Numnber of indexCount
 		 * @param stride Size of a vertex
 		 * @param attributeTypes Attribute types of the vertices in the mesh
+		 * @param indexType Type of the indices in the index buffer
 		 */
 		virtual MeshHandle CreateMesh(std::vector<BufferHandle>&& buffers, uint32_t vertexCount,
-			uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes) = 0;
+			uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes,
+			IndexType indexType=IndexType::UInt32) = 0;
 
 		/**
 		 * @brief Update a mesh
@@ -758,8 +959,9 @@ namespace Glory
 		/**
 		 * @brief Create a texture on this device
 		 * @param pTexture Texture data
+		 * @param firstMipLevel Finest stored mip level to upload, the texture is the size of this level
 		 */
-		virtual TextureHandle CreateTexture(TextureData* pTexture) = 0;
+		virtual TextureHandle CreateTexture(TextureData* pTexture, uint32_t firstMipLevel=0) = 0;
 		/**
 		 * @brief Create a cubemap texture on this device
 		 * @param pCubemap Cubemap data
@@ -945,10 +1147,95 @@ namespace Glory
 		std::unordered_map<UUID, uint64_t> m_CacheVersions;
 
 	private:
+		/** @brief Device copy of a mesh or texture */
+		struct CachedResource
+		{
+			UUID m_ResourceID;
+			UUID m_Handle;
+			uint64_t m_Version;
+			uint64_t m_ImageVersion;
+		};
+
+		/** @brief Resident mip levels of a texture that has been requested through @ref RequestTextureMip() */
+		struct StreamedTexture
+		{
+			UUID m_TextureID;
+			/** @brief Finest level requested this frame, FLT_MAX if it was not requested */
+			float m_RequestedMip;
+			/** @brief Finest level the texture should have within the budget */
+			uint32_t m_TargetMip;
+			/** @brief Finest level that is uploaded */
+			uint32_t m_ResidentMip;
+			uint64_t m_LastRequestFrame;
+			uint64_t m_ResidencyVersion;
+		};
+
+		/** @brief Cached graphics pipeline created for one vertex layout of its pipeline data */
+		struct LayoutPipeline
+		{
+			size_t m_Stride;
+			std::vector<AttributeType> m_Attributes;
+			PipelineHandle m_Pipeline;
+		};
+
+		/** @brief Texture replaced by the streamer that may still be in use by frames in flight */
+		struct RetiredTexture
+		{
+			TextureHandle m_Texture;
+			/** @brief Cached descriptor sets that referenced the texture */
+			std::vector<DescriptorSetHandle> m_DescriptorSets;
+			uint64_t m_Frame;
+		};
+
+		bool ReserveUpload(UUID gpuID, size_t size, UploadMode mode);
+		CachedResource* FindCachedResource(const Resource* pResource);
+		const CachedResource* FindCachedResource(const Resource* pResource) const;
+		CachedResource& AddCachedResource(const Resource* pResource, UUID handle);
+		void UpdateTextureStreaming();
+		void ReplaceStreamedTexture(CachedResource& cached, TextureData* pTexture, StreamedTexture& streamed, uint32_t firstMip);
+		void RetireTexture(TextureHandle texture);
+		/** @brief Remove cached descriptor sets that reference a texture or buffer from the cache without freeing them */
+		void EvictCachedDescriptorSets(UUID handle, std::vector<DescriptorSetHandle>& evicted);
+
+	private:
+		uint32_t m_DeviceIndex;
+
 		/* Cached handles */
 		std::unordered_map<UUID, PipelineHandle> m_PipelineHandles;
-		std::unordered_map<UUID, MeshHandle> m_MeshHandles;
-		std::unordered_map<UUID, TextureHandle> m_TextureHandles;
+		/** @brief Graphics pipelines of every vertex layout by GPU UUID of the pipeline data */
+		std::unordered_map<UUID, std::vector<LayoutPipeline>> m_LayoutPipelines;
+		/** @brief Cached meshes and textures, indexed by the GPU slot of the resource */
+		std::vector<CachedResource> m_CachedResources;
+		/** @brief Slot of each cached mesh and texture by GPU UUID, only used the first time a resource is seen */
+		std::unordered_map<UUID, uint32_t> m_CachedResourceSlots;
 		std::unordered_map<size_t, ShaderHandle> m_ShaderHandles;
+		std::unordered_map<DescriptorSetInfo, DescriptorSetHandle> m_CachedDescriptorSets;
+		/** @brief Cached descriptor sets that reference a texture or buffer, by texture or buffer handle */
+		std::unordered_map<UUID, std::vector<const DescriptorSetInfo*>> m_HandleDescriptorSets;
+
+		/* Readback */
+		struct PendingReadback
+		{
+			CommandBufferHandle m_CommandBuffer;
+			BufferHandle m_Buffer;
+			uint32_t m_Size;
+			ReadbackCallback m_Callback;
+		};
+		std::vector<PendingReadback> m_PendingReadbacks;
+		std::vector<BufferHandle> m_FreeReadbackBuffers;
+		std::vector<char> m_ReadbackData;
+
+		/* Deferred uploads */
+		std::unordered_set<UUID> m_PendingUploads;
+		size_t m_UploadBudget = 16*1024*1024;
+		size_t m_FrameUploadSize = 0;
+		uint32_t m_FrameUploadCount = 0;
+
+		/* Texture streaming */
+		std::unordered_map<UUID, StreamedTexture> m_StreamedTextures;
+		std::vector<RetiredTexture> m_RetiredTextures;
+		size_t m_TextureStreamingBudget = 512*1024*1024;
+		size_t m_StreamedTextureMemory = 0;
+		uint64_t m_StreamingFrame = 0;
 	};
 }
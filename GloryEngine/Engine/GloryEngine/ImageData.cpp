@@ -16,7 +16,8 @@ namespace Glory
 	}
 
 	ImageData::ImageData(ImageData&& other) noexcept: Resource(std::move(other)),
-		m_Header{ std::move(other.m_Header) }, m_pPixels(other.m_pPixels)
+		m_Header{ std::move(other.m_Header) }, m_pPixels(other.m_pPixels),
+		m_pPixelsOwner(std::move(other.m_pPixelsOwner)), m_MipLevels(std::move(other.m_MipLevels))
 	{
 		other.m_pPixels = nullptr;
 	}
@@ -24,8 +25,11 @@ namespace Glory
 	ImageData& ImageData::operator=(ImageData&& other) noexcept
 	{
 		Resource::operator=(std::move(other));
+		ReleasePixels();
 		m_Header = std::move(other.m_Header);
 		m_pPixels = other.m_pPixels;
+		m_pPixelsOwner = std::move(other.m_pPixelsOwner);
+		m_MipLevels = std::move(other.m_MipLevels);
 		other.m_pPixels = nullptr;
 		return *this;
 	}
@@ -37,9 +41,7 @@ namespace Glory
 
 	ImageData::~ImageData()
 	{
-		if (!m_pPixels) return;
-		delete[] m_pPixels;
-		m_pPixels = nullptr;
+		ReleasePixels();
 	}
 
 	uint32_t ImageData::GetWidth() const
@@ -84,19 +86,53 @@ namespace Glory
 
 	void ImageData::SetPixels(char*&& pPixels, size_t dataSize)
 	{
-		delete[] m_pPixels;
+		ReleasePixels();
+		m_pPixels = std::move(pPixels);
+		m_Header.m_DataSize = dataSize;
+		m_MipLevels.clear();
+		IncrementDirtyVersion();
+	}
+
+	void ImageData::SetMipLevels(char*&& pPixels, size_t dataSize, PixelFormat internalFormat, std::vector<MipLevel>&& levels)
+	{
+		ReleasePixels();
 		m_pPixels = std::move(pPixels);
 		m_Header.m_DataSize = dataSize;
+		m_Header.m_InternalFormat = internalFormat;
+		/* Block compressed data can't be written as png */
+		m_Header.m_Compressed = false;
+		m_MipLevels = std::move(levels);
 		IncrementDirtyVersion();
 	}
 
+	size_t ImageData::MipLevelCount() const
+	{
+		return m_MipLevels.size();
+	}
+
+	const ImageData::MipLevel& ImageData::GetMipLevel(size_t index) const
+	{
+		return m_MipLevels[index];
+	}
+
+	const std::vector<ImageData::MipLevel>& ImageData::MipLevels() const
+	{
+		return m_MipLevels;
+	}
+
+	bool ImageData::IsBlockCompressed() const
+	{
+		return m_Header.m_InternalFormat >= PixelFormat::PF_Bc1RgbUnormBlock &&
+			m_Header.m_InternalFormat <= PixelFormat::PF_Astc12x12SrgbBlock;
+	}
+
 	void ImageData::Serialize(Utils::BinaryStream& container) const
 	{
 		const int channels = m_Header.m_InternalFormat == PixelFormat::PF_RGBA ? 4 : 3;
 		if (!m_Header.m_Compressed)
 		{
 			/* No need to compress if it was already compressed by the importer */
-			container.Write(m_Header).Write(m_pPixels, m_Header.m_DataSize);
+			container.Write(m_Header).Write(m_pPixels, m_Header.m_DataSize).Write(m_MipLevels);
 			return;
 		}
 
@@ -127,8 +163,21 @@ namespace Glory
 		if (!m_Header.m_Compressed)
 		{
 			/* Image is not compressed or was compressed by the importer */
-			m_pPixels = new char[m_Header.m_DataSize];
-			container.Read(m_pPixels, m_Header.m_DataSize);
+			ReleasePixels();
+			/* Reference the pixels in place when the stream keeps them alive, such as a mapped archive */
+			std::shared_ptr<void> pOwner = container.ViewOwner();
+			char* pView = pOwner ? container.View(m_Header.m_DataSize) : nullptr;
+			if (pView)
+			{
+				m_pPixels = pView;
+				m_pPixelsOwner = std::move(pOwner);
+			}
+			else
+			{
+				m_pPixels = new char[m_Header.m_DataSize];
+				container.Read(m_pPixels, m_Header.m_DataSize);
+			}
+			container.Read(m_MipLevels);
 			return;
 		}
 
@@ -136,6 +185,13 @@ namespace Glory
 		//stbi__png_load(&context, );
 	}
 
+	void ImageData::ReleasePixels()
+	{
+		if (!m_pPixelsOwner) delete[] m_pPixels;
+		m_pPixels = nullptr;
+		m_pPixelsOwner.reset();
+	}
+
 	const PixelFormat& ImageData::GetFormat() const
 	{
 		return m_Header.m_PixelFormat;
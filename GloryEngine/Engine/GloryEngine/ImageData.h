@@ -5,6 +5,8 @@
 #include <engine_visibility.h>
 
 #include <cstdint>
+#include <vector>
+#include <memory>
 
 namespace Glory
 {
@@ -23,6 +25,15 @@ namespace Glory
             DataType m_DataType;
         };
 
+        /** @brief Location of one mip level in the pixel data */
+        struct MipLevel
+        {
+            uint32_t m_Width;
+            uint32_t m_Height;
+            size_t m_Offset;
+            size_t m_Size;
+        };
+
     public:
         GLORY_ENGINE_API ImageData();
         GLORY_ENGINE_API ImageData(uint32_t w, uint32_t h, PixelFormat internalFormat, PixelFormat format, uint8_t bytesPerPixel, char*&& pPixels, size_t dataSize, bool compressed=false, DataType dataType=DataType::DT_UByte);
@@ -43,14 +54,36 @@ namespace Glory
 
         GLORY_ENGINE_API void SetPixels(char*&& pPixels, size_t dataSize);
 
+        /**
+         * @brief Replace the pixels with a full mip chain
+         * @param pPixels All mip levels stored one after another
+         * @param dataSize Size of all mip levels combined
+         * @param internalFormat Format of the levels, can be a block compressed format
+         * @param levels Location of each level in the pixel data, starting at the full image
+         */
+        GLORY_ENGINE_API void SetMipLevels(char*&& pPixels, size_t dataSize, PixelFormat internalFormat, std::vector<MipLevel>&& levels);
+        /** @brief Number of mip levels stored in the pixel data, 0 if only the full image is stored */
+        GLORY_ENGINE_API size_t MipLevelCount() const;
+        /** @brief Get a mip level stored in the pixel data */
+        GLORY_ENGINE_API const MipLevel& GetMipLevel(size_t index) const;
+        /** @brief All mip levels stored in the pixel data */
+        GLORY_ENGINE_API const std::vector<MipLevel>& MipLevels() const;
+        /** @brief Whether the pixels are stored in a block compressed format */
+        GLORY_ENGINE_API bool IsBlockCompressed() const;
+
         GLORY_ENGINE_API void Serialize(Utils::BinaryStream& container) const override;
         GLORY_ENGINE_API void Deserialize(Utils::BinaryStream& container) override;
 
     protected:
         Header m_Header;
         char* m_pPixels;
+        /** @brief Keeps the pixels alive when they point into memory this image does not own, such as a mapped file */
+        std::shared_ptr<void> m_pPixelsOwner;
+        std::vector<MipLevel> m_MipLevels;
 
         virtual void BuildTexture();
+        /** @brief Delete the pixels if they are owned by this image */
+        void ReleasePixels();
 
         virtual void References(IEngine*, std::vector<UUID>&) const override {}
 
@@ -35,6 +35,7 @@ namespace Glory
 		m_HashToPropertyInfoIndex[hash] = index;
 		void* pAddress = m_PropertyInfos[index].Address(m_PropertyBuffer);
 		m_PropertyInfos[index].SetDefaultValue(pAddress);
+		IncrementDirtyVersion();
 	}
 
 	void MaterialData::AddResourceProperty(const std::string& displayName, const std::string& shaderName, uint32_t typeHash, UUID resourceUUID, TextureType textureType, uint32_t flags)
@@ -49,6 +50,7 @@ namespace Glory
 				m_TextureSetBits |= 1u << index;
 			else
 				m_TextureSetBits &= ~(1u << index);
+			IncrementDirtyVersion();
 			return;
 		}
 
@@ -63,6 +65,7 @@ namespace Glory
 		else
 			m_TextureSetBits &= ~(1u << index);
 		m_TextureTypeIndices[size_t(textureType)].push_back(textureIndex);
+		IncrementDirtyVersion();
 	}
 
 	void MaterialData::AddProperty(const MaterialPropertyInfo& other)
@@ -88,6 +91,7 @@ namespace Glory
 			m_PropertyInfos[index].SetDefaultValue(pAddress);
 		}
 		m_HashToPropertyInfoIndex[hash] = index;
+		IncrementDirtyVersion();
 	}
 
 	void MaterialData::SetPipeline(PipelineData* pPipeline)
@@ -186,6 +190,7 @@ namespace Glory
 		{
 			m_TextureTypeIndices[i].clear();
 		}
+		IncrementDirtyVersion();
 	}
 
 	size_t MaterialData::TextureCount(TextureType textureType) const
@@ -339,6 +344,7 @@ namespace Glory
 			m_TextureSetBits |= 1u << index;
 		else
 			m_TextureSetBits &= ~(1u << index);
+		IncrementDirtyVersion();
 	}
 
 	void MaterialData::SetTexture(TextureType textureType, size_t texIndex, UUID uuid)
@@ -354,6 +360,7 @@ namespace Glory
 			m_TextureSetBits |= 1u << index;
 		else
 			m_TextureSetBits &= ~(1u << index);
+		IncrementDirtyVersion();
 	}
 
 	bool MaterialData::GetTexture(const std::string& name, TextureData** value, Resources* pResources)
@@ -39,6 +39,11 @@ namespace Glory
         GLORY_ENGINE_API [[nodiscard]]virtual size_t PropertyInfoCount() const;
         GLORY_ENGINE_API virtual MaterialPropertyInfo* GetPropertyInfoAt(size_t index);
         GLORY_ENGINE_API [[nodiscard]]virtual size_t GetCurrentBufferOffset() const;
+        /** @brief Get the raw property buffer
+         *
+         * Call @ref IncrementDirtyVersion() after writing to it directly
+         * so renderers pick up the change.
+         */
         GLORY_ENGINE_API std::vector<char>& GetBufferReference();
         GLORY_ENGINE_API bool GetPropertyInfoIndex(const std::string& name, size_t& index) const;
         GLORY_ENGINE_API bool GetPropertyInfoIndex(TextureType textureType, size_t texIndex, size_t& index) const;
@@ -71,6 +76,7 @@ namespace Glory
             size_t index;
             if (!GetPropertyInfoIndex(name, index)) return;
             GetPropertyInfoAt(index)->Write<T>(m_PropertyBuffer, value);
+            IncrementDirtyVersion();
         }
 
         // Getters
@@ -82,6 +88,7 @@ namespace Glory
             return GetPropertyInfoAt(index)->Read<T>(m_PropertyBuffer, value);
         }
 
+        /** @brief Address of a property in the buffer, see @ref GetBufferReference() */
         GLORY_ENGINE_API void* Address(size_t index);
 
         GLORY_ENGINE_API void SetTexture(const std::string& name, TextureData* value);
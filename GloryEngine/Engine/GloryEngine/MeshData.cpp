@@ -2,6 +2,11 @@
 
 #include <BinaryStream.h>
 
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <limits>
+
 namespace Glory
 {
 	MeshData::MeshData()
@@ -116,7 +121,24 @@ namespace Glory
 		container.Write(m_Attributes.size());
 		container.Write(reinterpret_cast<const char*>(m_Attributes.data()), sizeof(AttributeType)*m_Attributes.size());
 		container.Write(reinterpret_cast<const char*>(m_Vertices.data()), sizeof(float)*m_Vertices.size());
-		container.Write(reinterpret_cast<const char*>(m_Indices.data()), sizeof(uint32_t)*m_Indices.size());
+		container.Write(m_LODs);
+		container.Write(m_LODIndices.size());
+		/* Meshes with few enough vertices store their indices at half the size */
+		const IndexType indexType = GetIndexType();
+		container.Write(indexType);
+		if (indexType == IndexType::UInt16)
+		{
+			std::vector<uint16_t> indices;
+			PackIndices(indices);
+			container.Write(reinterpret_cast<const char*>(indices.data()), sizeof(uint16_t)*indices.size());
+		}
+		else
+		{
+			container.Write(reinterpret_cast<const char*>(m_Indices.data()), sizeof(uint32_t)*m_Indices.size());
+			container.Write(reinterpret_cast<const char*>(m_LODIndices.data()), sizeof(uint32_t)*m_LODIndices.size());
+		}
+		container.Write(m_PositionOffset);
+		container.Write(m_PositionScale);
 	}
 
 	void MeshData::Deserialize(Utils::BinaryStream& container)
@@ -132,8 +154,45 @@ namespace Glory
 		container.Read(m_Attributes.data(), sizeof(AttributeType)*m_Attributes.size());
 		m_Vertices.resize(m_VertexCount*m_VertexSize/sizeof(float));
 		container.Read(m_Vertices.data(), sizeof(float)*m_Vertices.size());
+		container.Read(m_LODs);
+		size_t lodIndexCount;
+		container.Read(lodIndexCount);
 		m_Indices.resize(m_IndexCount);
-		container.Read(m_Indices.data(), sizeof(uint32_t)*m_Indices.size());
+		m_LODIndices.resize(lodIndexCount);
+		IndexType indexType;
+		container.Read(indexType);
+		if (indexType == IndexType::UInt16)
+		{
+			const size_t indicesSize = sizeof(uint16_t)*(m_IndexCount + lodIndexCount);
+			/* Widen the indices straight from the stream when it can hand out its memory */
+			const char* pView = container.View(indicesSize);
+			std::vector<uint16_t> indices;
+			if (!pView)
+			{
+				indices.resize(m_IndexCount + lodIndexCount);
+				container.Read(indices.data(), indicesSize);
+				pView = reinterpret_cast<const char*>(indices.data());
+			}
+			for (size_t i = 0; i < m_IndexCount; ++i)
+			{
+				uint16_t index;
+				std::memcpy(&index, pView + i*sizeof(uint16_t), sizeof(uint16_t));
+				m_Indices[i] = index;
+			}
+			for (size_t i = 0; i < lodIndexCount; ++i)
+			{
+				uint16_t index;
+				std::memcpy(&index, pView + (m_IndexCount + i)*sizeof(uint16_t), sizeof(uint16_t));
+				m_LODIndices[i] = index;
+			}
+		}
+		else
+		{
+			container.Read(m_Indices.data(), sizeof(uint32_t)*m_Indices.size());
+			container.Read(m_LODIndices.data(), sizeof(uint32_t)*m_LODIndices.size());
+		}
+		container.Read(m_PositionOffset);
+		container.Read(m_PositionScale);
 	}
 
 	uint32_t MeshData::AddVertex(const float* vertex)
@@ -159,6 +218,7 @@ namespace Glory
 
 		m_IndexCount += 6;
 
+		ClearLODs();
 		IncrementDirtyVersion();
 	}
 
@@ -166,6 +226,7 @@ namespace Glory
 	{
 		m_Vertices.clear();
 		m_VertexCount = 0;
+		ClearLODs();
 		IncrementDirtyVersion();
 	}
 
@@ -173,19 +234,33 @@ namespace Glory
 	{
 		m_Indices.clear();
 		m_IndexCount = 0;
+		ClearLODs();
+		IncrementDirtyVersion();
+	}
+
+	void MeshData::SetVertexFormat(uint32_t vertexSize, std::vector<AttributeType>&& attributes, std::vector<float>&& vertices)
+	{
+		m_VertexSize = vertexSize;
+		m_Attributes = std::move(attributes);
+		m_Vertices = std::move(vertices);
 		IncrementDirtyVersion();
 	}
 
 	void MeshData::Merge(MeshData* pOther)
 	{
+		const uint32_t vertexOffset = m_VertexCount;
 		m_VertexCount += pOther->m_VertexCount;
 		m_IndexCount += pOther->m_IndexCount;
 		const size_t vertexStart = m_Vertices.size();
 		const size_t indexStart = m_Indices.size();
 		m_Vertices.resize(m_Vertices.size() + pOther->m_Vertices.size());
 		m_Indices.resize(m_Indices.size() + pOther->m_Indices.size());
-		std::memcpy(&m_Vertices[vertexStart], pOther->m_Vertices.data(), pOther->m_Vertices.size()*sizeof(float));
-		std::memcpy(&m_Indices[indexStart], pOther->m_Indices.data(), pOther->m_Indices.size()*sizeof(uint32_t));
+		if (!pOther->m_Vertices.empty())
+			std::memcpy(&m_Vertices[vertexStart], pOther->m_Vertices.data(), pOther->m_Vertices.size()*sizeof(float));
+		/* Indices of the other mesh now point past the vertices that were already here */
+		for (size_t i = 0; i < pOther->m_Indices.size(); ++i)
+			m_Indices[indexStart + i] = pOther->m_Indices[i] + vertexOffset;
+		ClearLODs();
 		IncrementDirtyVersion();
 	}
 
@@ -213,4 +288,103 @@ namespace Glory
 	{
 		return m_BoundingSphere;
 	}
+
+	void MeshData::AddLOD(const std::vector<uint32_t>& indices, float screenSize)
+	{
+		MeshLOD& lod = m_LODs.emplace_back();
+		lod.m_IndexOffset = static_cast<uint32_t>(m_LODIndices.size());
+		lod.m_IndexCount = static_cast<uint32_t>(indices.size());
+		lod.m_ScreenSize = screenSize;
+		m_LODIndices.insert(m_LODIndices.end(), indices.begin(), indices.end());
+		IncrementDirtyVersion();
+	}
+
+	void MeshData::ClearLODs()
+	{
+		m_LODs.clear();
+		m_LODIndices.clear();
+	}
+
+	size_t MeshData::LODCount() const
+	{
+		return m_LODs.size() + 1;
+	}
+
+	MeshLOD MeshData::GetLOD(size_t lod) const
+	{
+		if (lod == 0 || lod > m_LODs.size())
+			return MeshLOD{ 0, m_IndexCount, std::numeric_limits<float>::max() };
+
+		/* LOD offsets are stored relative to the start of the LOD indices */
+		MeshLOD result = m_LODs[lod - 1];
+		result.m_IndexOffset += m_IndexCount;
+		return result;
+	}
+
+	uint32_t* MeshData::LODIndices()
+	{
+		return m_LODIndices.data();
+	}
+
+	const uint32_t* MeshData::LODIndices() const
+	{
+		return m_LODIndices.data();
+	}
+
+	uint32_t MeshData::LODIndexCount() const
+	{
+		return static_cast<uint32_t>(m_LODIndices.size());
+	}
+
+	uint32_t MeshData::SelectLOD(float screenSize, uint32_t currentLOD, float hysteresis) const
+	{
+		uint32_t lod = 0;
+		for (size_t i = 0; i < m_LODs.size(); ++i)
+		{
+			/* Move the threshold away from the side the current LOD is on so small
+			 * changes in size around the threshold do not switch back and forth */
+			const float threshold = m_LODs[i].m_ScreenSize*(i < currentLOD ? 1.0f + hysteresis : 1.0f - hysteresis);
+			if (screenSize >= threshold) break;
+			lod = static_cast<uint32_t>(i + 1);
+		}
+		return lod;
+	}
+
+	IndexType MeshData::GetIndexType() const
+	{
+		/* 0xFFFF is kept free since it restarts primitives when primitive restart is enabled */
+		return m_VertexCount <= std::numeric_limits<uint16_t>::max() ? IndexType::UInt16 : IndexType::UInt32;
+	}
+
+	uint32_t MeshData::IndexStride() const
+	{
+		return GetIndexType() == IndexType::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	}
+
+	void MeshData::PackIndices(std::vector<uint16_t>& out) const
+	{
+		out.resize(m_Indices.size() + m_LODIndices.size());
+		std::transform(m_Indices.begin(), m_Indices.end(), out.begin(),
+			[](uint32_t index) { return static_cast<uint16_t>(index); });
+		std::transform(m_LODIndices.begin(), m_LODIndices.end(), out.begin() + m_Indices.size(),
+			[](uint32_t index) { return static_cast<uint16_t>(index); });
+	}
+
+	void MeshData::SetPositionQuantization(const glm::vec3& offset, float scale)
+	{
+		m_PositionOffset = offset;
+		m_PositionScale = scale;
+		IncrementDirtyVersion();
+	}
+
+	bool MeshData::HasQuantizedPositions() const
+	{
+		return !m_Attributes.empty() && m_Attributes[0] == AttributeType::UNorm16x4;
+	}
+
+	glm::mat4 MeshData::PositionDequantization() const
+	{
+		if (!HasQuantizedPositions()) return glm::identity<glm::mat4>();
+		return glm::scale(glm::translate(glm::identity<glm::mat4>(), m_PositionOffset), glm::vec3{ m_PositionScale });
+	}
 }
@@ -11,6 +11,17 @@
 
 namespace Glory
 {
+	/** @brief Range of the index buffer of a mesh that draws one level of detail */
+	struct MeshLOD
+	{
+		/** @brief First index of the LOD in the index buffer of the mesh */
+		uint32_t m_IndexOffset;
+		/** @brief Number of indices in the LOD */
+		uint32_t m_IndexCount;
+		/** @brief The LOD is used once the bounding sphere covers less than this fraction of the screen height */
+		float m_ScreenSize;
+	};
+
 	class MeshData : public Resource
 	{
 	public:
@@ -45,7 +56,20 @@ namespace Glory
 		GLORY_ENGINE_API void AddFace(uint32_t v0, uint32_t v1, uint32_t v2, uint32_t v3);
 		GLORY_ENGINE_API void ClearVertices();
 		GLORY_ENGINE_API void ClearIndices();
+		/**
+		 * @brief Replace the vertices of this mesh with the same vertices in a different format
+		 * @param vertexSize Size in bytes of a vertex in the new format
+		 * @param attributes Attribute types of the new format
+		 * @param vertices Vertex data in the new format, must hold @ref VertexCount() vertices
+		 */
+		GLORY_ENGINE_API void SetVertexFormat(uint32_t vertexSize, std::vector<AttributeType>&& attributes, std::vector<float>&& vertices);
 
+		/**
+		 * @brief Append the vertices and triangles of another mesh
+		 * @param pOther Mesh to append, must have the same vertex format as this mesh
+		 *
+		 * The indices of the other mesh are offset to its vertices in this mesh, LODs are removed.
+		 */
 		GLORY_ENGINE_API void Merge(MeshData* pOther);
 
 		GLORY_ENGINE_API void AddBoundingBox(const glm::vec3& min, const glm::vec3& max);
@@ -53,6 +77,59 @@ namespace Glory
 		GLORY_ENGINE_API const BoundingBox& GetBoundingBox() const;
 		GLORY_ENGINE_API const BoundingSphere& GetBoundingSphere() const;
 
+		/**
+		 * @brief Add a simplified version of this mesh to the end of the LOD chain
+		 * @param indices Triangle list that indexes the vertices of this mesh
+		 * @param screenSize Fraction of the screen height below which this LOD replaces the previous one
+		 *
+		 * LOD indices are stored after the indices of the full mesh in the same index buffer.
+		 */
+		GLORY_ENGINE_API void AddLOD(const std::vector<uint32_t>& indices, float screenSize);
+		/** @brief Remove all LODs except the full mesh */
+		GLORY_ENGINE_API void ClearLODs();
+		/** @brief Number of LODs including the full mesh */
+		GLORY_ENGINE_API size_t LODCount() const;
+		/**
+		 * @brief Get the index range of a LOD
+		 * @param lod Index of the LOD, 0 is the full mesh
+		 */
+		GLORY_ENGINE_API MeshLOD GetLOD(size_t lod) const;
+		/** @brief Indices of all LODs after the full mesh */
+		GLORY_ENGINE_API uint32_t* LODIndices();
+		GLORY_ENGINE_API const uint32_t* LODIndices() const;
+		/** @brief Number of indices of all LODs after the full mesh */
+		GLORY_ENGINE_API uint32_t LODIndexCount() const;
+		/**
+		 * @brief Pick the LOD to draw for a projected size
+		 * @param screenSize Fraction of the screen height covered by the bounding sphere
+		 * @param currentLOD LOD that was drawn last time
+		 * @param hysteresis Fraction by which the size must pass a threshold before switching away from the current LOD
+		 */
+		GLORY_ENGINE_API uint32_t SelectLOD(float screenSize, uint32_t currentLOD, float hysteresis) const;
+
+		/** @brief Smallest index type that can index every vertex of this mesh */
+		GLORY_ENGINE_API IndexType GetIndexType() const;
+		/** @brief Size in bytes of an index of type @ref GetIndexType() */
+		GLORY_ENGINE_API uint32_t IndexStride() const;
+		/**
+		 * @brief Get the indices of the full mesh followed by the indices of all LODs as 16 bit indices
+		 * @param out Vector to write the indices to
+		 *
+		 * Only valid when @ref GetIndexType() is @ref IndexType::UInt16
+		 */
+		GLORY_ENGINE_API void PackIndices(std::vector<uint16_t>& out) const;
+
+		/**
+		 * @brief Set how quantized positions map back to model space
+		 * @param offset Model space position of a quantized position of 0
+		 * @param scale Model space distance covered by a quantized range of 0 to 1, the same on every axis
+		 */
+		GLORY_ENGINE_API void SetPositionQuantization(const glm::vec3& offset, float scale);
+		/** @brief Whether the first attribute holds positions quantized relative to the bounds of the mesh */
+		GLORY_ENGINE_API bool HasQuantizedPositions() const;
+		/** @brief Transform from quantized positions to model space, identity when positions are not quantized */
+		GLORY_ENGINE_API glm::mat4 PositionDequantization() const;
+
 	private:
 		virtual void References(IEngine*, std::vector<UUID>&) const override {}
 
@@ -65,5 +142,9 @@ namespace Glory
 		uint32_t m_VertexSize;
 		BoundingBox m_BoundingBox;
 		BoundingSphere m_BoundingSphere;
+		std::vector<uint32_t> m_LODIndices;
+		std::vector<MeshLOD> m_LODs;
+		glm::vec3 m_PositionOffset{ 0.0f };
+		float m_PositionScale{ 1.0f };
 	};
 }
@@ -0,0 +1,979 @@
+#include "MeshOptimizer.h"
+#include "MeshData.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <limits>
+
+namespace Glory
+{
+	namespace
+	{
+		/** Symmetric 4x4 matrix that measures the squared distance to a set of planes */
+		struct Quadric
+		{
+			double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+			double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+			double a22 = 0.0, a23 = 0.0;
+			double a33 = 0.0;
+
+			Quadric& operator+=(const Quadric& other)
+			{
+				a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+				a11 += other.a11; a12 += other.a12; a13 += other.a13;
+				a22 += other.a22; a23 += other.a23;
+				a33 += other.a33;
+				return *this;
+			}
+
+			void AddPlane(const glm::dvec3& n, double d, double weight)
+			{
+				a00 += weight*n.x*n.x; a01 += weight*n.x*n.y; a02 += weight*n.x*n.z; a03 += weight*n.x*d;
+				a11 += weight*n.y*n.y; a12 += weight*n.y*n.z; a13 += weight*n.y*d;
+				a22 += weight*n.z*n.z; a23 += weight*n.z*d;
+				a33 += weight*d*d;
+			}
+
+			double Error(const glm::dvec3& p) const
+			{
+				const double x = p.x, y = p.y, z = p.z;
+				const double error = a00*x*x + 2.0*a01*x*y + 2.0*a02*x*z + 2.0*a03*x
+					+ a11*y*y + 2.0*a12*y*z + 2.0*a13*y
+					+ a22*z*z + 2.0*a23*z
+					+ a33;
+				return std::max(error, 0.0);
+			}
+		};
+
+		struct Collapse
+		{
+			uint32_t m_From;
+			uint32_t m_To;
+			double m_Error;
+		};
+
+		uint64_t EdgeKey(uint32_t a, uint32_t b)
+		{
+			return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+		}
+
+		/* Whether moving a vertex onto another flips or flattens any triangle that does not collapse with it */
+		bool CollapseFlipsTriangle(const std::vector<glm::dvec3>& positions, const std::vector<uint32_t>& indices,
+			const std::vector<uint32_t>& adjacencyOffsets, const std::vector<uint32_t>& adjacency, uint32_t from, uint32_t to)
+		{
+			for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; ++i)
+			{
+				const uint32_t* triangle = &indices[adjacency[i]*3];
+				if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+
+				const glm::dvec3 p0 = positions[triangle[0]];
+				const glm::dvec3 p1 = positions[triangle[1]];
+				const glm::dvec3 p2 = positions[triangle[2]];
+				const glm::dvec3 before = glm::cross(p1 - p0, p2 - p0);
+
+				const glm::dvec3 q0 = triangle[0] == from ? positions[to] : p0;
+				const glm::dvec3 q1 = triangle[1] == from ? positions[to] : p1;
+				const glm::dvec3 q2 = triangle[2] == from ? positions[to] : p2;
+				const glm::dvec3 after = glm::cross(q1 - q0, q2 - q0);
+
+				/* Also rejects triangles that become slivers */
+				if (glm::dot(before, after) <= 0.25*glm::length(before)*glm::length(after)) return true;
+			}
+			return false;
+		}
+
+		/* Size in bytes of the attribute types CompressVertices reads and writes */
+		size_t AttributeSize(AttributeType type)
+		{
+			switch (type)
+			{
+			case AttributeType::Float:
+				return sizeof(float);
+			case AttributeType::Float2:
+				return sizeof(float)*2;
+			case AttributeType::Float3:
+				return sizeof(float)*3;
+			case AttributeType::Float4:
+				return sizeof(float)*4;
+			case AttributeType::Half2:
+				return sizeof(uint16_t)*2;
+			case AttributeType::Half4:
+			case AttributeType::UNorm16x4:
+				return sizeof(uint16_t)*4;
+			case AttributeType::UNorm8x4:
+			case AttributeType::SNorm8x4:
+				return sizeof(uint8_t)*4;
+			default:
+				return 0;
+			}
+		}
+
+		bool CanConvertAttribute(AttributeType from, AttributeType to, size_t attributeIndex)
+		{
+			if (from == to) return AttributeSize(from) != 0;
+			switch (to)
+			{
+			case AttributeType::UNorm16x4:
+				return from == AttributeType::Float3 && attributeIndex == 0;
+			case AttributeType::SNorm8x4:
+				return from == AttributeType::Float3;
+			case AttributeType::Half2:
+				return from == AttributeType::Float2;
+			case AttributeType::Half4:
+			case AttributeType::UNorm8x4:
+				return from == AttributeType::Float4;
+			default:
+				return false;
+			}
+		}
+
+		/* Float type a compressed attribute decodes to, other types are returned unchanged */
+		AttributeType DecodedAttributeType(AttributeType type)
+		{
+			switch (type)
+			{
+			case AttributeType::UNorm16x4:
+			case AttributeType::SNorm8x4:
+				return AttributeType::Float3;
+			case AttributeType::Half2:
+				return AttributeType::Float2;
+			case AttributeType::Half4:
+			case AttributeType::UNorm8x4:
+				return AttributeType::Float4;
+			default:
+				return type;
+			}
+		}
+
+		/* Decode an attribute written by CompressVertices to floats, returns the number of floats written */
+		size_t DecodeAttribute(AttributeType type, const char* pData, float* out)
+		{
+			switch (type)
+			{
+			case AttributeType::Float:
+			case AttributeType::Float2:
+			case AttributeType::Float3:
+			case AttributeType::Float4:
+				std::memcpy(out, pData, AttributeSize(type));
+				return AttributeSize(type)/sizeof(float);
+			case AttributeType::UNorm16x4:
+			{
+				glm::uint64 packed;
+				std::memcpy(&packed, pData, sizeof(packed));
+				const glm::vec4 value = glm::unpackUnorm4x16(packed);
+				std::memcpy(out, &value, sizeof(float)*3);
+				return 3;
+			}
+			case AttributeType::SNorm8x4:
+			{
+				glm::uint packed;
+				std::memcpy(&packed, pData, sizeof(packed));
+				const glm::vec4 value = glm::unpackSnorm4x8(packed);
+				std::memcpy(out, &value, sizeof(float)*3);
+				return 3;
+			}
+			case AttributeType::Half2:
+			{
+				glm::uint packed;
+				std::memcpy(&packed, pData, sizeof(packed));
+				const glm::vec2 value = glm::unpackHalf2x16(packed);
+				std::memcpy(out, &value, sizeof(value));
+				return 2;
+			}
+			case AttributeType::Half4:
+			{
+				glm::uint64 packed;
+				std::memcpy(&packed, pData, sizeof(packed));
+				const glm::vec4 value = glm::unpackHalf4x16(packed);
+				std::memcpy(out, &value, sizeof(value));
+				return 4;
+			}
+			case AttributeType::UNorm8x4:
+			{
+				glm::uint packed;
+				std::memcpy(&packed, pData, sizeof(packed));
+				const glm::vec4 value = glm::unpackUnorm4x8(packed);
+				std::memcpy(out, &value, sizeof(value));
+				return 4;
+			}
+			default:
+				return 0;
+			}
+		}
+
+		constexpr size_t ForsythCacheSize = 32;
+		constexpr uint32_t InvalidTriangle = UINT32_MAX;
+
+		/* Scores from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation" */
+		float ForsythVertexScore(int cachePosition, uint32_t remainingTriangles)
+		{
+			if (remainingTriangles == 0) return -1.0f;
+
+			constexpr float CacheDecayPower = 1.5f;
+			constexpr float LastTriangleScore = 0.75f;
+			constexpr float ValenceBoostScale = 2.0f;
+			constexpr float ValenceBoostPower = 0.5f;
+
+			float score = 0.0f;
+			if (cachePosition >= 0)
+			{
+				/* Vertices of the last triangle get a fixed score so the next triangle does not always reuse its edge */
+				if (cachePosition < 3) score = LastTriangleScore;
+				else
+				{
+					const float scaler = 1.0f/float(ForsythCacheSize - 3);
+					score = std::pow(1.0f - float(cachePosition - 3)*scaler, CacheDecayPower);
+				}
+			}
+			/* Finish vertices with few triangles left so they don't have to be transformed again later */
+			score += ValenceBoostScale*std::pow(float(remainingTriangles), -ValenceBoostPower);
+			return score;
+		}
+	}
+
+	VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t cacheSize)
+	{
+		VertexCacheStats stats{ 0.0f, 0.0f };
+		const size_t triangleCount = indexCount/3;
+		if (triangleCount == 0 || vertexCount == 0 || cacheSize == 0) return stats;
+
+		/* A vertex is in the FIFO cache while less than cacheSize misses happened since it was added */
+		std::vector<size_t> timestamps(vertexCount, 0);
+		size_t time = cacheSize + 1;
+		size_t misses = 0;
+		size_t usedVertices = 0;
+		for (size_t i = 0; i < triangleCount*3; ++i)
+		{
+			const uint32_t vertex = indices[i];
+			if (timestamps[vertex] == 0) ++usedVertices;
+			if (time - timestamps[vertex] <= cacheSize) continue;
+			timestamps[vertex] = time++;
+			++misses;
+		}
+
+		stats.m_ACMR = float(misses)/float(triangleCount);
+		stats.m_ATVR = float(misses)/float(usedVertices);
+		return stats;
+	}
+
+	void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+	{
+		const size_t triangleCount = indexCount/3;
+		if (triangleCount == 0 || vertexCount == 0) return;
+
+		/* Triangles that still have to be emitted around each vertex */
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < triangleCount*3; ++i)
+			++adjacencyOffsets[indices[i] + 1];
+		for (size_t i = 1; i < adjacencyOffsets.size(); ++i)
+			adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+		std::vector<uint32_t> adjacency(triangleCount*3);
+		std::vector<uint32_t> remaining(vertexCount, 0);
+		for (size_t i = 0; i < triangleCount*3; ++i)
+		{
+			const uint32_t vertex = indices[i];
+			adjacency[adjacencyOffsets[vertex] + remaining[vertex]++] = uint32_t(i/3);
+		}
+
+		std::vector<int> cachePositions(vertexCount, -1);
+		std::vector<float> vertexScores(vertexCount);
+		for (size_t i = 0; i < vertexCount; ++i)
+			vertexScores[i] = ForsythVertexScore(-1, remaining[i]);
+
+		std::vector<float> triangleScores(triangleCount);
+		uint32_t bestTriangle = InvalidTriangle;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < triangleCount; ++i)
+		{
+			triangleScores[i] = vertexScores[indices[i*3]] + vertexScores[indices[i*3 + 1]] + vertexScores[indices[i*3 + 2]];
+			if (triangleScores[i] <= bestScore) continue;
+			bestScore = triangleScores[i];
+			bestTriangle = uint32_t(i);
+		}
+
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		std::vector<uint32_t> result(triangleCount*3);
+		uint32_t cache[ForsythCacheSize + 3];
+		uint32_t newCache[ForsythCacheSize + 3];
+		size_t cacheCount = 0;
+		size_t inputCursor = 0;
+
+		for (size_t outputTriangle = 0; outputTriangle < triangleCount; ++outputTriangle)
+		{
+			if (bestTriangle == InvalidTriangle)
+			{
+				/* Dead end, continue with the first triangle in input order that is left */
+				while (emitted[inputCursor]) ++inputCursor;
+				bestTriangle = uint32_t(inputCursor);
+			}
+
+			const uint32_t triangle[3] = { indices[bestTriangle*3], indices[bestTriangle*3 + 1], indices[bestTriangle*3 + 2] };
+			std::memcpy(&result[outputTriangle*3], triangle, sizeof(triangle));
+			emitted[bestTriangle] = 1;
+
+			/* The vertices of the emitted triangle move to the front of the LRU cache */
+			size_t newCacheCount = 0;
+			for (const uint32_t vertex : triangle)
+			{
+				if (std::find(newCache, newCache + newCacheCount, vertex) == newCache + newCacheCount)
+					newCache[newCacheCount++] = vertex;
+
+				uint32_t* first = &adjacency[adjacencyOffsets[vertex]];
+				uint32_t* last = first + remaining[vertex];
+				uint32_t* found = std::find(first, last, bestTriangle);
+				*found = *(last - 1);
+				--remaining[vertex];
+			}
+			for (size_t i = 0; i < cacheCount; ++i)
+			{
+				const uint32_t vertex = cache[i];
+				if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+					newCache[newCacheCount++] = vertex;
+			}
+
+			/* Rescore everything that was in the cache, including the vertices that were just pushed out */
+			for (size_t i = 0; i < newCacheCount; ++i)
+			{
+				const uint32_t vertex = newCache[i];
+				cachePositions[vertex] = i < ForsythCacheSize ? int(i) : -1;
+				const float score = ForsythVertexScore(cachePositions[vertex], remaining[vertex]);
+				const float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+				for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex] + remaining[vertex]; ++a)
+					triangleScores[adjacency[a]] += delta;
+			}
+
+			/* Only triangles that use a cached vertex are candidates for the next one */
+			cacheCount = std::min(newCacheCount, ForsythCacheSize);
+			bestTriangle = InvalidTriangle;
+			bestScore = -1.0f;
+			for (size_t i = 0; i < cacheCount; ++i)
+			{
+				const uint32_t vertex = newCache[i];
+				cache[i] = vertex;
+				for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex] + remaining[vertex]; ++a)
+				{
+					const uint32_t candidate = adjacency[a];
+					/* Ties go to the earliest triangle so the result does not depend on adjacency order */
+					if (triangleScores[candidate] < bestScore ||
+						(triangleScores[candidate] == bestScore && candidate > bestTriangle)) continue;
+					bestScore = triangleScores[candidate];
+					bestTriangle = candidate;
+				}
+			}
+		}
+
+		std::memcpy(indices, result.data(), result.size()*sizeof(uint32_t));
+	}
+
+	void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions,
+		size_t vertexCount, size_t vertexStride, float threshold)
+	{
+		const size_t triangleCount = indexCount/3;
+		if (triangleCount < 2 || vertexCount == 0) return;
+
+		/* Split the triangle list into clusters that start with a cold cache so they can be
+		 * reordered without losing much of the cache efficiency */
+		std::vector<uint32_t> clusters;
+		{
+			constexpr size_t CacheSize = 16;
+			std::vector<size_t> timestamps(vertexCount, 0);
+			size_t time = CacheSize + 1;
+			auto triangleMisses = [&](size_t triangle) {
+				uint32_t misses = 0;
+				for (size_t k = 0; k < 3; ++k)
+				{
+					const uint32_t vertex = indices[triangle*3 + k];
+					if (time - timestamps[vertex] <= CacheSize) continue;
+					timestamps[vertex] = time++;
+					++misses;
+				}
+				return misses;
+			};
+
+			/* Triangles that miss on all their vertices start a new cluster regardless of the order */
+			std::vector<uint32_t> hardClusters;
+			std::vector<uint32_t> misses(triangleCount);
+			for (size_t i = 0; i < triangleCount; ++i)
+			{
+				misses[i] = triangleMisses(i);
+				if (i == 0 || misses[i] == 3) hardClusters.push_back(uint32_t(i));
+			}
+			hardClusters.push_back(uint32_t(triangleCount));
+
+			/* Split further wherever a cluster started cold is about as efficient as the whole hard cluster */
+			for (size_t c = 0; c + 1 < hardClusters.size(); ++c)
+			{
+				const uint32_t start = hardClusters[c];
+				const uint32_t end = hardClusters[c + 1];
+				size_t clusterMisses = 0;
+				for (uint32_t i = start; i < end; ++i) clusterMisses += misses[i];
+				const float maxACMR = float(clusterMisses)/float(end - start)*threshold;
+
+				time += CacheSize + 1;
+				clusters.push_back(start);
+				size_t subStart = start;
+				size_t subMisses = 0;
+				for (uint32_t i = start; i < end; ++i)
+				{
+					subMisses += triangleMisses(i);
+					if (i + 1 == end || float(subMisses)/float(i + 1 - subStart) > maxACMR) continue;
+					time += CacheSize + 1;
+					clusters.push_back(i + 1);
+					subStart = i + 1;
+					subMisses = 0;
+				}
+			}
+			clusters.push_back(uint32_t(triangleCount));
+		}
+		const size_t clusterCount = clusters.size() - 1;
+		if (clusterCount < 2) return;
+
+		const char* pPositions = reinterpret_cast<const char*>(positions);
+		auto position = [&](uint32_t vertex) {
+			return *reinterpret_cast<const glm::vec3*>(pPositions + vertex*vertexStride);
+		};
+
+		/* Area weighted centroid and normal of each cluster */
+		std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3{ 0.0f });
+		std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3{ 0.0f });
+		glm::vec3 meshCentroid{ 0.0f };
+		float meshArea = 0.0f;
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			float clusterArea = 0.0f;
+			for (uint32_t i = clusters[c]; i < clusters[c + 1]; ++i)
+			{
+				const glm::vec3 p0 = position(indices[i*3]);
+				const glm::vec3 p1 = position(indices[i*3 + 1]);
+				const glm::vec3 p2 = position(indices[i*3 + 2]);
+				const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const float area = glm::length(normal);
+				clusterCentroids[c] += (p0 + p1 + p2)*(area/3.0f);
+				clusterNormals[c] += normal;
+				clusterArea += area;
+			}
+			meshCentroid += clusterCentroids[c];
+			meshArea += clusterArea;
+			if (clusterArea > 0.0f) clusterCentroids[c] /= clusterArea;
+		}
+		if (meshArea <= 0.0f) return;
+		meshCentroid /= meshArea;
+
+		/* Clusters that face away from the center are likely in front of the rest of the mesh */
+		std::vector<float> sortKeys(clusterCount);
+		std::vector<uint32_t> order(clusterCount);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			const float length = glm::length(clusterNormals[c]);
+			const glm::vec3 normal = length > 0.0f ? clusterNormals[c]/length : glm::vec3{ 0.0f };
+			sortKeys[c] = glm::dot(clusterCentroids[c] - meshCentroid, normal);
+			order[c] = uint32_t(c);
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(triangleCount*3);
+		for (const uint32_t c : order)
+			result.insert(result.end(), indices + clusters[c]*3, indices + clusters[c + 1]*3);
+		std::memcpy(indices, result.data(), result.size()*sizeof(uint32_t));
+	}
+
+	void OptimizeVertexFetch(MeshData* pMesh)
+	{
+		const uint32_t vertexCount = pMesh->VertexCount();
+		if (vertexCount == 0) return;
+
+		/* New position of each vertex in the order the LODs first use them */
+		constexpr uint32_t Unused = UINT32_MAX;
+		std::vector<uint32_t> remap(vertexCount, Unused);
+		uint32_t nextVertex = 0;
+		auto assign = [&](const uint32_t* indices, uint32_t indexCount) {
+			for (uint32_t i = 0; i < indexCount; ++i)
+			{
+				if (remap[indices[i]] != Unused) continue;
+				remap[indices[i]] = nextVertex++;
+			}
+		};
+		assign(pMesh->Indices(), pMesh->IndexCount());
+		assign(pMesh->LODIndices(), pMesh->LODIndexCount());
+		for (uint32_t& index : remap)
+		{
+			if (index == Unused) index = nextVertex++;
+		}
+
+		const size_t vertexSize = pMesh->VertexSize();
+		char* pVertices = reinterpret_cast<char*>(pMesh->Vertices());
+		const std::vector<char> original(pVertices, pVertices + vertexCount*vertexSize);
+		for (uint32_t i = 0; i < vertexCount; ++i)
+			std::memcpy(pVertices + remap[i]*vertexSize, &original[i*vertexSize], vertexSize);
+
+		uint32_t* indices = pMesh->Indices();
+		for (uint32_t i = 0; i < pMesh->IndexCount(); ++i)
+			indices[i] = remap[indices[i]];
+		uint32_t* lodIndices = pMesh->LODIndices();
+		for (uint32_t i = 0; i < pMesh->LODIndexCount(); ++i)
+			lodIndices[i] = remap[lodIndices[i]];
+	}
+
+	void OptimizeMesh(MeshData* pMesh, float overdrawThreshold)
+	{
+		if (pMesh->IndexCount() == 0) return;
+
+		OptimizeVertexCache(pMesh->Indices(), pMesh->IndexCount(), pMesh->VertexCount());
+		if (pMesh->AttributeCount() > 0 && pMesh->AttributeTypes()[0] == AttributeType::Float3)
+		{
+			OptimizeOverdraw(pMesh->Indices(), pMesh->IndexCount(), pMesh->Vertices(),
+				pMesh->VertexCount(), pMesh->VertexSize(), overdrawThreshold);
+		}
+
+		for (size_t lod = 1; lod < pMesh->LODCount(); ++lod)
+		{
+			/* LOD offsets include the indices of the full mesh */
+			const MeshLOD range = pMesh->GetLOD(lod);
+			OptimizeVertexCache(pMesh->LODIndices() + (range.m_IndexOffset - pMesh->IndexCount()),
+				range.m_IndexCount, pMesh->VertexCount());
+		}
+
+		OptimizeVertexFetch(pMesh);
+		pMesh->IncrementDirtyVersion();
+	}
+
+	float SimplifyMesh(const float* positions, size_t vertexCount, size_t vertexStride,
+		const std::vector<uint32_t>& indices, size_t targetIndexCount, float targetError, std::vector<uint32_t>& outIndices)
+	{
+		outIndices = indices;
+		if (indices.size() <= targetIndexCount || vertexCount == 0) return 0.0f;
+
+		/* Work in positions normalized to the extent of the mesh so errors are relative */
+		std::vector<glm::dvec3> normalized(vertexCount);
+		glm::dvec3 min{ std::numeric_limits<double>::max() };
+		glm::dvec3 max{ std::numeric_limits<double>::lowest() };
+		const char* pPositions = reinterpret_cast<const char*>(positions);
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			const float* position = reinterpret_cast<const float*>(pPositions + i*vertexStride);
+			normalized[i] = glm::dvec3{ position[0], position[1], position[2] };
+			min = glm::min(min, normalized[i]);
+			max = glm::max(max, normalized[i]);
+		}
+		const glm::dvec3 size = max - min;
+		const double extent = std::max(size.x, std::max(size.y, size.z));
+		if (extent <= 0.0) return 0.0f;
+		for (glm::dvec3& position : normalized)
+			position = (position - min)/extent;
+
+		/* Vertices on an edge that is not shared by exactly two triangles lie on a border
+		 * or a seam where the vertex is split, collapsing them would open cracks */
+		std::vector<uint8_t> locked(vertexCount, 0);
+		{
+			std::unordered_map<uint64_t, uint32_t> edgeUses;
+			edgeUses.reserve(indices.size());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (size_t e = 0; e < 3; ++e)
+					++edgeUses[EdgeKey(indices[i + e], indices[i + (e + 1)%3])];
+			}
+			for (const auto& [key, uses] : edgeUses)
+			{
+				if (uses == 2) continue;
+				locked[uint32_t(key >> 32)] = 1;
+				locked[uint32_t(key)] = 1;
+			}
+		}
+
+		std::vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const glm::dvec3& p0 = normalized[indices[i]];
+			const glm::dvec3& p1 = normalized[indices[i + 1]];
+			const glm::dvec3& p2 = normalized[indices[i + 2]];
+			const glm::dvec3 cross = glm::cross(p1 - p0, p2 - p0);
+			const double area = glm::length(cross);
+			if (area <= 0.0) continue;
+			const glm::dvec3 normal = cross/area;
+			Quadric quadric;
+			quadric.AddPlane(normal, -glm::dot(normal, p0), area);
+			quadrics[indices[i]] += quadric;
+			quadrics[indices[i + 1]] += quadric;
+			quadrics[indices[i + 2]] += quadric;
+		}
+
+		const double maxError = double(targetError)*double(targetError);
+		double resultError = 0.0;
+
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+		std::vector<uint32_t> adjacency;
+		std::vector<Collapse> collapses;
+		std::vector<uint32_t> remap(vertexCount);
+		std::vector<uint8_t> touched(vertexCount);
+
+		while (outIndices.size() > targetIndexCount)
+		{
+			/* Triangles around each vertex */
+			std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+			for (uint32_t index : outIndices)
+				++adjacencyOffsets[index + 1];
+			for (size_t i = 1; i < adjacencyOffsets.size(); ++i)
+				adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+			adjacency.resize(outIndices.size());
+			{
+				std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < outIndices.size(); ++i)
+					adjacency[fill[outIndices[i]]++] = uint32_t(i/3);
+			}
+
+			/* Cheapest direction of every edge */
+			collapses.clear();
+			for (size_t i = 0; i < outIndices.size(); i += 3)
+			{
+				for (size_t e = 0; e < 3; ++e)
+				{
+					const uint32_t a = outIndices[i + e];
+					const uint32_t b = outIndices[i + (e + 1)%3];
+					/* Edges shared by two triangles appear in both, only consider them once */
+					if (a > b) continue;
+					if (locked[a] && locked[b]) continue;
+
+					Quadric quadric = quadrics[a];
+					quadric += quadrics[b];
+					const double errorToB = locked[a] ? std::numeric_limits<double>::max() : quadric.Error(normalized[b]);
+					const double errorToA = locked[b] ? std::numeric_limits<double>::max() : quadric.Error(normalized[a]);
+					if (errorToB <= errorToA) collapses.push_back({ a, b, errorToB });
+					else collapses.push_back({ b, a, errorToA });
+				}
+			}
+			std::sort(collapses.begin(), collapses.end(),
+				[](const Collapse& a, const Collapse& b) { return a.m_Error < b.m_Error; });
+
+			for (uint32_t i = 0; i < vertexCount; ++i) remap[i] = i;
+			std::fill(touched.begin(), touched.end(), 0);
+
+			size_t triangleCount = outIndices.size()/3;
+			const size_t targetTriangleCount = targetIndexCount/3;
+			size_t collapseCount = 0;
+			for (const Collapse& collapse : collapses)
+			{
+				if (collapse.m_Error > maxError || triangleCount <= targetTriangleCount) break;
+				/* Vertices around a collapse are only collapsed again in the next pass, once the triangles are updated */
+				if (touched[collapse.m_From] || touched[collapse.m_To]) continue;
+				if (CollapseFlipsTriangle(normalized, outIndices, adjacencyOffsets, adjacency, collapse.m_From, collapse.m_To))
+					continue;
+
+				for (uint32_t i = adjacencyOffsets[collapse.m_From]; i < adjacencyOffsets[collapse.m_From + 1]; ++i)
+				{
+					const uint32_t* triangle = &outIndices[adjacency[i]*3];
+					touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+					if (triangle[0] == collapse.m_To || triangle[1] == collapse.m_To || triangle[2] == collapse.m_To)
+						--triangleCount;
+				}
+
+				remap[collapse.m_From] = collapse.m_To;
+				quadrics[collapse.m_To] += quadrics[collapse.m_From];
+				resultError = std::max(resultError, collapse.m_Error);
+				++collapseCount;
+			}
+			if (collapseCount == 0) break;
+
+			/* Apply the collapses and drop the triangles that became degenerate */
+			size_t writeIndex = 0;
+			for (size_t i = 0; i < outIndices.size(); i += 3)
+			{
+				const uint32_t i0 = remap[outIndices[i]];
+				const uint32_t i1 = remap[outIndices[i + 1]];
+				const uint32_t i2 = remap[outIndices[i + 2]];
+				if (i0 == i1 || i1 == i2 || i0 == i2) continue;
+				outIndices[writeIndex++] = i0;
+				outIndices[writeIndex++] = i1;
+				outIndices[writeIndex++] = i2;
+			}
+			outIndices.resize(writeIndex);
+		}
+
+		return float(std::sqrt(resultError));
+	}
+
+	void GenerateMeshLODs(MeshData* pMesh, size_t maxLODs, float reduction, float maxError, float screenError)
+	{
+		pMesh->ClearLODs();
+
+		/* Meshes this small are not worth the extra draw ranges */
+		constexpr uint32_t MinIndexCount = 3*64;
+		if (pMesh->IndexCount() < MinIndexCount || pMesh->AttributeCount() == 0 ||
+			pMesh->AttributeTypes()[0] != AttributeType::Float3) return;
+
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ std::numeric_limits<float>::lowest() };
+		const char* pVertices = reinterpret_cast<const char*>(pMesh->Vertices());
+		for (uint32_t i = 0; i < pMesh->VertexCount(); ++i)
+		{
+			const glm::vec3 position = *reinterpret_cast<const glm::vec3*>(pVertices + size_t(i)*pMesh->VertexSize());
+			min = glm::min(min, position);
+			max = glm::max(max, position);
+		}
+		const glm::vec3 size = max - min;
+		const float extent = std::max(size.x, std::max(size.y, size.z));
+		const float radius = pMesh->GetBoundingSphere().m_Radius > 0.0f ? pMesh->GetBoundingSphere().m_Radius : glm::length(size)/2.0f;
+		if (extent <= 0.0f || radius <= 0.0f) return;
+
+		std::vector<uint32_t> indices(pMesh->Indices(), pMesh->Indices() + pMesh->IndexCount());
+		std::vector<uint32_t> lodIndices;
+		float totalError = 0.0f;
+		float lastScreenSize = std::numeric_limits<float>::max();
+		for (size_t lod = 0; lod < maxLODs; ++lod)
+		{
+			const size_t targetIndexCount = size_t(indices.size()*reduction)/3*3;
+			const float error = SimplifyMesh(pMesh->Vertices(), pMesh->VertexCount(), pMesh->VertexSize(),
+				indices, targetIndexCount, maxError, lodIndices);
+
+			/* Stop once simplification no longer removes enough to be worth another LOD */
+			if (lodIndices.empty() || lodIndices.size() > indices.size()*9/10) break;
+
+			/* Errors of each step add up since every LOD is simplified from the previous one */
+			totalError += error;
+			const float relativeError = totalError*extent/(2.0f*radius);
+			const float screenSize = relativeError > 0.0f ? screenError/relativeError : lastScreenSize;
+			lastScreenSize = std::min(lastScreenSize, screenSize);
+
+			pMesh->AddLOD(lodIndices, lastScreenSize);
+			indices.swap(lodIndices);
+		}
+	}
+
+	bool CompressVertices(MeshData* pMesh, const std::vector<AttributeType>& attributes)
+	{
+		if (attributes.size() != pMesh->AttributeCount()) return false;
+
+		const AttributeType* oldAttributes = pMesh->AttributeTypes();
+		size_t oldVertexSize = 0;
+		size_t newVertexSize = 0;
+		for (size_t i = 0; i < attributes.size(); ++i)
+		{
+			if (!CanConvertAttribute(oldAttributes[i], attributes[i], i)) return false;
+			oldVertexSize += AttributeSize(oldAttributes[i]);
+			newVertexSize += AttributeSize(attributes[i]);
+		}
+		/* Vertices are stored as floats so every vertex must stay 4 byte aligned */
+		if (oldVertexSize != pMesh->VertexSize() || newVertexSize%sizeof(float) != 0) return false;
+
+		const uint32_t vertexCount = pMesh->VertexCount();
+		const char* pOldVertices = reinterpret_cast<const char*>(pMesh->Vertices());
+
+		/* Positions are quantized relative to a cube around the bounds so the scale is the same on every axis */
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		float extent = 0.0f;
+		if (attributes[0] == AttributeType::UNorm16x4 && oldAttributes[0] != AttributeType::UNorm16x4)
+		{
+			glm::vec3 max{ std::numeric_limits<float>::lowest() };
+			for (uint32_t i = 0; i < vertexCount; ++i)
+			{
+				const glm::vec3 position = *reinterpret_cast<const glm::vec3*>(pOldVertices + i*oldVertexSize);
+				min = glm::min(min, position);
+				max = glm::max(max, position);
+			}
+			const glm::vec3 size = max - min;
+			extent = std::max(size.x, std::max(size.y, size.z));
+			if (vertexCount == 0) min = glm::vec3{ 0.0f };
+			if (extent <= 0.0f) extent = 1.0f;
+		}
+
+		std::vector<float> vertices(vertexCount*newVertexSize/sizeof(float));
+		char* pNewVertices = reinterpret_cast<char*>(vertices.data());
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			const char* pOld = pOldVertices + v*oldVertexSize;
+			char* pNew = pNewVertices + v*newVertexSize;
+			for (size_t i = 0; i < attributes.size(); ++i)
+			{
+				const float* values = reinterpret_cast<const float*>(pOld);
+				if (oldAttributes[i] == attributes[i])
+					std::memcpy(pNew, pOld, AttributeSize(attributes[i]));
+				else if (attributes[i] == AttributeType::UNorm16x4)
+				{
+					const glm::vec3 position = (glm::vec3{ values[0], values[1], values[2] } - min)/extent;
+					const glm::uint64 packed = glm::packUnorm4x16(glm::vec4{ position, 0.0f });
+					std::memcpy(pNew, &packed, sizeof(packed));
+				}
+				else if (attributes[i] == AttributeType::SNorm8x4)
+				{
+					glm::vec3 direction{ values[0], values[1], values[2] };
+					const float length = glm::length(direction);
+					if (length > 0.0f) direction /= length;
+					const glm::uint packed = glm::packSnorm4x8(glm::vec4{ direction, 0.0f });
+					std::memcpy(pNew, &packed, sizeof(packed));
+				}
+				else if (attributes[i] == AttributeType::Half2)
+				{
+					const glm::uint packed = glm::packHalf2x16(glm::vec2{ values[0], values[1] });
+					std::memcpy(pNew, &packed, sizeof(packed));
+				}
+				else if (attributes[i] == AttributeType::Half4)
+				{
+					const glm::uint64 packed = glm::packHalf4x16(glm::vec4{ values[0], values[1], values[2], values[3] });
+					std::memcpy(pNew, &packed, sizeof(packed));
+				}
+				else if (attributes[i] == AttributeType::UNorm8x4)
+				{
+					const glm::uint packed = glm::packUnorm4x8(glm::vec4{ values[0], values[1], values[2], values[3] });
+					std::memcpy(pNew, &packed, sizeof(packed));
+				}
+				pOld += AttributeSize(oldAttributes[i]);
+				pNew += AttributeSize(attributes[i]);
+			}
+		}
+
+		if (extent > 0.0f) pMesh->SetPositionQuantization(min, extent);
+		pMesh->SetVertexFormat(uint32_t(newVertexSize), std::vector<AttributeType>(attributes), std::move(vertices));
+		return true;
+	}
+
+	bool MergeMeshes(MeshData* pOut, const std::vector<const MeshData*>& meshes,
+		const std::vector<glm::mat4>& worlds, std::vector<MeshLOD>& outRanges)
+	{
+		if (meshes.empty() || meshes.size() != worlds.size()) return false;
+
+		const std::vector<AttributeType>& attributes = meshes[0]->AttributeTypesVector();
+		if (attributes.empty()) return false;
+		std::vector<AttributeType> decodedAttributes(attributes.size());
+		size_t vertexSize = 0;
+		size_t decodedVertexSize = 0;
+		for (size_t i = 0; i < attributes.size(); ++i)
+		{
+			decodedAttributes[i] = DecodedAttributeType(attributes[i]);
+			/* The decoded vertices must be convertible back to the format of the inputs */
+			if (!CanConvertAttribute(decodedAttributes[i], attributes[i], i)) return false;
+			vertexSize += AttributeSize(attributes[i]);
+			decodedVertexSize += AttributeSize(decodedAttributes[i]);
+		}
+		if (decodedAttributes[0] != AttributeType::Float3) return false;
+		for (const MeshData* pMesh : meshes)
+		{
+			if (pMesh->AttributeTypesVector() != attributes || pMesh->VertexSize() != vertexSize)
+				return false;
+		}
+
+		pOut->ClearVertices();
+		pOut->ClearIndices();
+		pOut->SetVertexFormat(uint32_t(decodedVertexSize), std::vector<AttributeType>(decodedAttributes), {});
+
+		outRanges.clear();
+		outRanges.reserve(meshes.size());
+		glm::vec3 min{ std::numeric_limits<float>::max() };
+		glm::vec3 max{ std::numeric_limits<float>::lowest() };
+		std::vector<float> vertices;
+		std::vector<uint32_t> indices;
+		for (size_t m = 0; m < meshes.size(); ++m)
+		{
+			const MeshData* pMesh = meshes[m];
+			const glm::mat4 positionTransform = worlds[m]*pMesh->PositionDequantization();
+			/* Normals stay perpendicular to the surface under non uniform scale, tangents follow the surface */
+			const glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(worlds[m])));
+			const glm::mat3 tangentTransform = glm::mat3(worlds[m]);
+
+			const uint32_t vertexCount = pMesh->VertexCount();
+			vertices.resize(vertexCount*decodedVertexSize/sizeof(float));
+			const char* pVertex = reinterpret_cast<const char*>(pMesh->Vertices());
+			float* pDecoded = vertices.data();
+			for (uint32_t v = 0; v < vertexCount; ++v)
+			{
+				for (size_t i = 0; i < attributes.size(); ++i)
+				{
+					const size_t floatCount = DecodeAttribute(attributes[i], pVertex, pDecoded);
+					if (i == 0)
+					{
+						const glm::vec3 position = positionTransform*glm::vec4{ pDecoded[0], pDecoded[1], pDecoded[2], 1.0f };
+						std::memcpy(pDecoded, &position, sizeof(position));
+						min = glm::min(min, position);
+						max = glm::max(max, position);
+					}
+					else if (decodedAttributes[i] == AttributeType::Float3)
+					{
+						const glm::mat3& directionTransform = i == 1 ? normalTransform : tangentTransform;
+						glm::vec3 direction = directionTransform*glm::vec3{ pDecoded[0], pDecoded[1], pDecoded[2] };
+						const float length = glm::length(direction);
+						if (length > 0.0f) direction /= length;
+						std::memcpy(pDecoded, &direction, sizeof(direction));
+					}
+					pVertex += AttributeSize(attributes[i]);
+					pDecoded += floatCount;
+				}
+			}
+
+			/* Only the full mesh is merged, LODs can't be drawn for part of a merged mesh */
+			const MeshLOD lod = pMesh->GetLOD(0);
+			indices.assign(pMesh->Indices() + lod.m_IndexOffset, pMesh->Indices() + lod.m_IndexOffset + lod.m_IndexCount);
+			MeshData transformed{ vertexCount, uint32_t(decodedVertexSize), vertices, lod.m_IndexCount, indices, decodedAttributes };
+			outRanges.push_back(MeshLOD{ pOut->IndexCount(), lod.m_IndexCount, 0.0f });
+			pOut->Merge(&transformed);
+		}
+
+		if (pOut->VertexCount() == 0) min = max = glm::vec3{ 0.0f };
+		const glm::vec3 center = (min + max)/2.0f;
+		pOut->AddBoundingBox(min, max);
+		pOut->AddBoundingSphere(center, glm::length(max - center));
+
+		if (attributes != decodedAttributes)
+			return CompressVertices(pOut, attributes);
+		return true;
+	}
+
+	float ComputeUVDensity(const MeshData* pMesh)
+	{
+		const std::vector<AttributeType>& attributes = pMesh->AttributeTypesVector();
+		if (attributes.empty() || DecodedAttributeType(attributes[0]) != AttributeType::Float3) return 0.0f;
+
+		size_t uvOffset = 0;
+		size_t uvAttribute = 0;
+		size_t offset = AttributeSize(attributes[0]);
+		for (size_t i = 1; i < attributes.size(); ++i)
+		{
+			if (DecodedAttributeType(attributes[i]) == AttributeType::Float2)
+			{
+				uvAttribute = i;
+				uvOffset = offset;
+				break;
+			}
+			offset += AttributeSize(attributes[i]);
+		}
+		if (uvAttribute == 0) return 0.0f;
+
+		const glm::mat4 dequantization = pMesh->PositionDequantization();
+		const char* pVertices = reinterpret_cast<const char*>(pMesh->Vertices());
+		const size_t vertexSize = pMesh->VertexSize();
+		const uint32_t vertexCount = pMesh->VertexCount();
+		auto decodeVertex = [&](uint32_t index, glm::vec3& position, glm::vec2& uv) {
+			const char* pVertex = pVertices + index*vertexSize;
+			float decoded[4];
+			DecodeAttribute(attributes[0], pVertex, decoded);
+			position = dequantization*glm::vec4{ decoded[0], decoded[1], decoded[2], 1.0f };
+			DecodeAttribute(attributes[uvAttribute], pVertex + uvOffset, decoded);
+			uv = glm::vec2{ decoded[0], decoded[1] };
+		};
+
+		const MeshLOD lod = pMesh->GetLOD(0);
+		const uint32_t* indices = pMesh->Indices() + lod.m_IndexOffset;
+		double worldArea = 0.0;
+		double uvArea = 0.0;
+		for (uint32_t i = 0; i + 2 < lod.m_IndexCount; i += 3)
+		{
+			if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount) continue;
+			glm::vec3 p0, p1, p2;
+			glm::vec2 t0, t1, t2;
+			decodeVertex(indices[i], p0, t0);
+			decodeVertex(indices[i + 1], p1, t1);
+			decodeVertex(indices[i + 2], p2, t2);
+			worldArea += 0.5*glm::length(glm::cross(p1 - p0, p2 - p0));
+			const glm::vec2 e1 = t1 - t0;
+			const glm::vec2 e2 = t2 - t0;
+			uvArea += 0.5*std::abs(e1.x*e2.y - e1.y*e2.x);
+		}
+		if (worldArea <= 0.0 || uvArea <= 0.0) return 0.0f;
+		return static_cast<float>(std::sqrt(uvArea/worldArea));
+	}
+}
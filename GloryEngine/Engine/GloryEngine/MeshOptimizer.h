@@ -0,0 +1,150 @@
+#pragma once
+#include "VertexDefinitions.h"
+
+#include <engine_visibility.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Glory
+{
+	class MeshData;
+	struct MeshLOD;
+
+	/** @brief Efficiency of a triangle list on a simulated post-transform vertex cache */
+	struct VertexCacheStats
+	{
+		/** @brief Average cache misses per triangle, 0.5 is the best possible and 3 the worst */
+		float m_ACMR;
+		/** @brief Average times each vertex is transformed, 1 is the best possible */
+		float m_ATVR;
+	};
+
+	/**
+	 * @brief Simulate a FIFO post-transform vertex cache over a triangle list
+	 * @param indices Triangle list
+	 * @param indexCount Number of indices
+	 * @param vertexCount Number of vertices the triangle list indexes
+	 * @param cacheSize Number of vertices the simulated cache holds
+	 */
+	GLORY_ENGINE_API VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount,
+		size_t vertexCount, size_t cacheSize=16);
+
+	/**
+	 * @brief Reorder the triangles of a triangle list so vertices are reused while they are still in the vertex cache
+	 * @param indices Triangle list to reorder in place
+	 * @param indexCount Number of indices
+	 * @param vertexCount Number of vertices the triangle list indexes
+	 *
+	 * Uses Tom Forsyth's linear-speed vertex cache optimisation, the result only depends on the input.
+	 */
+	GLORY_ENGINE_API void OptimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+	/**
+	 * @brief Reorder clusters of a cache optimized triangle list so outward facing triangles are drawn first
+	 * @param indices Triangle list to reorder in place, should already be optimized for the vertex cache
+	 * @param indexCount Number of indices
+	 * @param positions Position of the first vertex
+	 * @param vertexCount Number of vertices
+	 * @param vertexStride Distance in bytes between the positions of two vertices
+	 * @param threshold How much worse the cache efficiency of a cluster may get to allow splitting it,
+	 * 1.0 keeps the cache efficiency unchanged
+	 */
+	GLORY_ENGINE_API void OptimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions,
+		size_t vertexCount, size_t vertexStride, float threshold=1.05f);
+
+	/**
+	 * @brief Reorder the vertices of a mesh in the order its triangles first use them
+	 * @param pMesh Mesh to reorder, the indices of all LODs are remapped
+	 *
+	 * Vertices that are not used by any triangle are moved to the end.
+	 */
+	GLORY_ENGINE_API void OptimizeVertexFetch(MeshData* pMesh);
+
+	/**
+	 * @brief Optimize a mesh for the vertex cache, overdraw and vertex fetch in that order
+	 * @param pMesh Mesh to optimize, the first attribute must be its position for the overdraw optimisation
+	 * @param overdrawThreshold See @ref OptimizeOverdraw
+	 *
+	 * Every LOD is optimized for the vertex cache separately, overdraw is only optimized for the full mesh.
+	 */
+	GLORY_ENGINE_API void OptimizeMesh(MeshData* pMesh, float overdrawThreshold=1.05f);
+
+	/**
+	 * @brief Simplify a triangle list by collapsing edges onto one of their vertices
+	 * @param positions Position of the first vertex
+	 * @param vertexCount Number of vertices
+	 * @param vertexStride Distance in bytes between the positions of two vertices
+	 * @param indices Triangle list to simplify
+	 * @param targetIndexCount Stop once the triangle list has this many indices or less
+	 * @param targetError Maximum error of a collapse relative to the extent of the mesh
+	 * @param outIndices Simplified triangle list
+	 * @returns Largest error of all collapses relative to the extent of the mesh
+	 *
+	 * Vertices are never moved or added so the result indexes the same vertex buffer.
+	 * Vertices on borders and attribute seams are never collapsed, this keeps the
+	 * outline of the mesh and its texture seams intact.
+	 */
+	GLORY_ENGINE_API float SimplifyMesh(const float* positions, size_t vertexCount, size_t vertexStride,
+		const std::vector<uint32_t>& indices, size_t targetIndexCount, float targetError, std::vector<uint32_t>& outIndices);
+
+	/**
+	 * @brief Replace the LOD chain of a mesh with progressively simplified versions of it
+	 * @param pMesh Mesh to generate LODs for, the first attribute must be its position
+	 * @param maxLODs Maximum number of LODs to add after the full mesh
+	 * @param reduction Fraction of the triangles of the previous LOD that each LOD aims to keep
+	 * @param maxError Maximum error of each LOD relative to the extent of the mesh
+	 * @param screenError Largest error on screen as a fraction of the screen height, decides when each LOD is used
+	 */
+	GLORY_ENGINE_API void GenerateMeshLODs(MeshData* pMesh, size_t maxLODs=4, float reduction=0.5f,
+		float maxError=0.05f, float screenError=0.001f);
+
+	/**
+	 * @brief Convert the vertices of a mesh to smaller attribute types
+	 * @param pMesh Mesh to convert
+	 * @param attributes New type of each attribute
+	 * @returns false without changing the mesh if an attribute can't be converted
+	 *
+	 * Supported conversions are
+	 * - Float3 to UNorm16x4 for positions, only for the first attribute, relative to the bounds of the mesh
+	 * - Float3 to SNorm8x4 for unit vectors such as normals and tangents
+	 * - Float2 to Half2 and Float4 to Half4
+	 * - Float4 to UNorm8x4 for colors
+	 *
+	 * All of these are read as floats by the vertex input so shaders need no changes,
+	 * quantized positions only need @ref MeshData::PositionDequantization() applied to the world transform.
+	 */
+	GLORY_ENGINE_API bool CompressVertices(MeshData* pMesh, const std::vector<AttributeType>& attributes);
+
+	/**
+	 * @brief Merge meshes into one mesh with their transforms baked into the vertices
+	 * @param pOut Mesh to write the result to, its previous vertices and indices are replaced
+	 * @param meshes Meshes to merge, all must have the same attribute types
+	 * @param worlds Transform of each mesh
+	 * @param outRanges Index range of each mesh in the merged mesh
+	 * @returns false without changing the output mesh if the meshes can't be merged,
+	 * or false with the output mesh left uncompressed if it can't be compressed again
+	 *
+	 * The first attribute must be the position, other Float3 and SNorm8x4 attributes are
+	 * transformed as directions. The second attribute is the normal and is transformed by the
+	 * inverse transpose, tangents and bitangents by the transform itself. Compressed attributes are decoded,
+	 * transformed and compressed again so the merged mesh has the same format as its inputs.
+	 * Only the full mesh of each input is merged, the merged mesh has no LODs.
+	 */
+	GLORY_ENGINE_API bool MergeMeshes(MeshData* pOut, const std::vector<const MeshData*>& meshes,
+		const std::vector<glm::mat4>& worlds, std::vector<MeshLOD>& outRanges);
+
+	/**
+	 * @brief Measure how densely the texture coordinates of a mesh cover its surface
+	 * @param pMesh Mesh to measure, the first attribute must be its position
+	 * @returns Texture coordinate units per model space unit averaged over the full mesh,
+	 * or 0 if the mesh has no texture coordinates
+	 *
+	 * The texture coordinates are the first attribute after the position that decodes to 2 floats.
+	 * A texture of N texels is sampled at about N times this many texels per model space unit.
+	 */
+	GLORY_ENGINE_API float ComputeUVDensity(const MeshData* pMesh);
+}
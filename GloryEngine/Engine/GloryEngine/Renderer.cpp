@@ -7,11 +7,17 @@
 #include "RenderHelpers.h"
 #include "CameraManager.h"
 #include "Camera.h"
+#include "MeshData.h"
+#include "MeshOptimizer.h"
+#include "PipelineManager.h"
+#include "PipelineData.h"
 
 #include <Module.h>
 
 #include <glm/ext/scalar_constants.hpp>
 
+#include <limits>
+
 namespace Glory
 {
 	Renderer::Renderer(Module* pModule)
@@ -74,6 +80,7 @@ namespace Glory
 		else materialIndex = uint32_t(materialIter - pipelineRenderData.m_UniqueMaterials.begin());
 		meshIter->second.m_MaterialIndices.emplace_back(materialIndex);
 		pipelineRenderData.m_Dirty = true;
+		m_StaticBatchesDirty = true;
 	}
 
 	void Renderer::UpdateStatic(UUID pipelineID, UUID meshID, UUID objectID, glm::mat4 world)
@@ -93,7 +100,9 @@ namespace Glory
 			[objectID](const std::pair<UUID, UUID>& ids) { return ids.second == objectID; });
 		if (objectIter == meshRenderData.m_ObjectIDs.end()) return;
 		const size_t instanceID = objectIter - meshRenderData.m_ObjectIDs.begin();
+		if (meshRenderData.m_Worlds[instanceID] == world) return;
 		meshRenderData.m_Worlds[instanceID] = world;
+		m_StaticBatchesDirty = true;
 	}
 
 	void Renderer::UnsubmitStatic(UUID pipelineID, UUID meshID, UUID objectID)
@@ -115,8 +124,255 @@ namespace Glory
 		const size_t index = objectIter - meshRenderData.m_ObjectIDs.begin();
 
 		meshRenderData.m_ObjectIDs.erase(objectIter);
+		meshRenderData.m_Worlds.erase(meshRenderData.m_Worlds.begin() + index);
+		meshRenderData.m_LayerMasks.erase(meshRenderData.m_LayerMasks.begin() + index);
 		meshRenderData.m_MaterialIndices.erase(meshRenderData.m_MaterialIndices.begin() + index);
 		pipelineIter->m_Dirty = true;
+		m_StaticBatchesDirty = true;
+	}
+
+	void Renderer::BuildStaticBatches()
+	{
+		Resources& resources = m_pModule->GetEngine()->GetResources();
+		if (!m_StaticBatchesDirty)
+		{
+			const bool meshLoaded = std::any_of(m_StaticBatchMissingMeshes.begin(), m_StaticBatchMissingMeshes.end(),
+				[&resources](UUID meshID) { return resources.GetResource(meshID) != nullptr; });
+			if (!meshLoaded) return;
+		}
+
+		ProfileSample sample{ &m_pModule->GetEngine()->Profiler(), "Renderer::BuildStaticBatches" };
+
+		/* Objects whose material wasn't loaded when they were submitted get another chance */
+		std::vector<RenderData> toProcess = std::move(m_ToProcessStaticRenderData);
+		m_ToProcessStaticRenderData.clear();
+		for (RenderData& renderData : toProcess)
+			SubmitStatic(std::move(renderData));
+
+		m_StaticBatchesDirty = false;
+		m_StaticBatchMissingMeshes.clear();
+		m_StaticBatches.clear();
+		m_StaticSubMeshes.clear();
+		for (StaticBatchMesh& mesh : m_StaticBatchMeshes)
+			mesh.m_Used = false;
+
+		/* Adding a merged mesh can move every mesh in the resource manager,
+		 * so objects keep the ID of their mesh instead of a pointer to it */
+		struct StaticObject
+		{
+			UUID m_MeshID;
+			uint32_t m_VertexCount;
+			const PipelineMeshBatch* m_pMeshBatch;
+			size_t m_Index;
+			BoundingSphere m_Bounds;
+		};
+
+		struct MergeGroup
+		{
+			uint32_t m_MaterialIndex;
+			LayerMask m_LayerMask;
+			std::vector<AttributeType> m_Attributes;
+			std::vector<StaticObject> m_Objects;
+		};
+
+		const auto addObject = [](PipelineBatch& batch, const PipelineMeshBatch& meshBatch, size_t index) {
+			auto meshIter = batch.m_Meshes.find(meshBatch.m_Mesh);
+			if (meshIter == batch.m_Meshes.end())
+			{
+				meshIter = batch.m_Meshes.emplace(meshBatch.m_Mesh, PipelineMeshBatch{ meshBatch.m_Mesh }).first;
+				batch.m_UniqueMeshOrder.push_back(meshBatch.m_Mesh);
+			}
+			meshIter->second.m_Worlds.push_back(meshBatch.m_Worlds[index]);
+			meshIter->second.m_LayerMasks.push_back(meshBatch.m_LayerMasks[index]);
+			meshIter->second.m_ObjectIDs.push_back(meshBatch.m_ObjectIDs[index]);
+			meshIter->second.m_MaterialIndices.push_back(meshBatch.m_MaterialIndices[index]);
+		};
+
+		PipelineManager& pipelines = m_pModule->GetEngine()->GetPipelineManager();
+		std::vector<MergeGroup> groups;
+		std::vector<const MeshData*> meshes;
+		std::vector<glm::mat4> worlds;
+		std::vector<MeshLOD> ranges;
+		for (const PipelineBatch& source : m_StaticPipelineRenderDatas)
+		{
+			PipelineBatch& batch = m_StaticBatches.emplace_back(source.m_PipelineID);
+			batch.m_UniqueMaterials = source.m_UniqueMaterials;
+			batch.m_Dirty = true;
+
+			/* Transparent objects are sorted per object so they are never merged */
+			PipelineData* pPipeline = pipelines.GetPipelineData(source.m_PipelineID);
+			const bool canMerge = pPipeline && !pPipeline->BlendEnabled();
+
+			groups.clear();
+			for (const UUID meshID : source.m_UniqueMeshOrder)
+			{
+				const PipelineMeshBatch& meshBatch = source.m_Meshes.at(meshID);
+				if (meshBatch.m_Worlds.empty()) continue;
+
+				Resource* pMeshResource = resources.GetResource(meshID);
+				if (!pMeshResource) m_StaticBatchMissingMeshes.push_back(meshID);
+				const MeshData* pMesh = static_cast<const MeshData*>(pMeshResource);
+				const bool mergeable = canMerge && pMesh && pMesh->IndexCount() > 0 &&
+					pMesh->VertexCount() <= MAX_STATIC_BATCH_MESH_VERTICES;
+
+				for (size_t i = 0; i < meshBatch.m_Worlds.size(); ++i)
+				{
+					if (!mergeable)
+					{
+						addObject(batch, meshBatch, i);
+						continue;
+					}
+
+					const uint32_t materialIndex = meshBatch.m_MaterialIndices[i];
+					const LayerMask layerMask = meshBatch.m_LayerMasks[i];
+					auto groupIter = std::find_if(groups.begin(), groups.end(), [&](const MergeGroup& group) {
+						return group.m_MaterialIndex == materialIndex && group.m_LayerMask == layerMask &&
+							group.m_Attributes == pMesh->AttributeTypesVector();
+					});
+					MergeGroup& group = groupIter == groups.end() ?
+						groups.emplace_back(MergeGroup{ materialIndex, layerMask, pMesh->AttributeTypesVector() }) : *groupIter;
+
+					StaticObject& object = group.m_Objects.emplace_back(StaticObject{ meshID, pMesh->VertexCount(),
+						&meshBatch, i, BoundingSphere{ {}, 0.0f } });
+					object.m_Bounds.Combine(pMesh->GetBoundingSphere(), meshBatch.m_Worlds[i]);
+				}
+			}
+
+			for (MergeGroup& group : groups)
+			{
+				/* Nearby objects end up next to each other so visible sub-meshes form long ranges */
+				glm::vec3 min{ std::numeric_limits<float>::max() };
+				glm::vec3 max{ std::numeric_limits<float>::lowest() };
+				for (const StaticObject& object : group.m_Objects)
+				{
+					min = glm::min(min, object.m_Bounds.m_Center);
+					max = glm::max(max, object.m_Bounds.m_Center);
+				}
+				const glm::vec3 extent = glm::max(max - min, glm::vec3{ 0.0001f });
+				const auto mortonCode = [&min, &extent](const glm::vec3& position) {
+					const glm::uvec3 cell = glm::uvec3((position - min)/extent*1023.0f);
+					uint32_t code = 0;
+					for (uint32_t bit = 0; bit < 10; ++bit)
+					{
+						code |= ((cell.x >> bit) & 1u) << (bit*3);
+						code |= ((cell.y >> bit) & 1u) << (bit*3 + 1);
+						code |= ((cell.z >> bit) & 1u) << (bit*3 + 2);
+					}
+					return code;
+				};
+				std::stable_sort(group.m_Objects.begin(), group.m_Objects.end(), [&](const StaticObject& a, const StaticObject& b) {
+					return mortonCode(a.m_Bounds.m_Center) < mortonCode(b.m_Bounds.m_Center);
+				});
+
+				const UUID materialID = source.m_UniqueMaterials[group.m_MaterialIndex];
+				/* Merged positions are quantized again over the extent of the whole chunk */
+				const bool quantized = group.m_Attributes[0] != AttributeType::Float3;
+				size_t chunkIndex = 0;
+				size_t first = 0;
+				while (first < group.m_Objects.size())
+				{
+					size_t last = first;
+					uint32_t vertexCount = 0;
+					glm::vec3 chunkMin{ std::numeric_limits<float>::max() };
+					glm::vec3 chunkMax{ std::numeric_limits<float>::lowest() };
+					while (last < group.m_Objects.size() &&
+						vertexCount + group.m_Objects[last].m_VertexCount <= MAX_STATIC_BATCH_VERTICES)
+					{
+						const BoundingSphere& bounds = group.m_Objects[last].m_Bounds;
+						const glm::vec3 objectMin = glm::min(chunkMin, bounds.m_Center - glm::vec3{ bounds.m_Radius });
+						const glm::vec3 objectMax = glm::max(chunkMax, bounds.m_Center + glm::vec3{ bounds.m_Radius });
+						const glm::vec3 chunkExtent = objectMax - objectMin;
+						if (quantized && last > first &&
+							glm::max(chunkExtent.x, glm::max(chunkExtent.y, chunkExtent.z)) > MAX_STATIC_BATCH_EXTENT)
+							break;
+						chunkMin = objectMin;
+						chunkMax = objectMax;
+						vertexCount += group.m_Objects[last].m_VertexCount;
+						++last;
+					}
+
+					/* A single object gains nothing from merging and keeps its LODs */
+					if (last - first < 2)
+					{
+						for (size_t i = first; i < last; ++i)
+							addObject(batch, *group.m_Objects[i].m_pMeshBatch, group.m_Objects[i].m_Index);
+						first = last;
+						continue;
+					}
+
+					auto meshIter = std::find_if(m_StaticBatchMeshes.begin(), m_StaticBatchMeshes.end(), [&](const StaticBatchMesh& mesh) {
+						return mesh.m_PipelineID == source.m_PipelineID && mesh.m_MaterialID == materialID &&
+							mesh.m_LayerMask == group.m_LayerMask && mesh.m_ChunkIndex == chunkIndex &&
+							mesh.m_Attributes == group.m_Attributes;
+					});
+					MeshData* pMerged = meshIter != m_StaticBatchMeshes.end() ?
+						static_cast<MeshData*>(resources.GetResource(meshIter->m_MeshID)) : nullptr;
+					if (!pMerged)
+					{
+						pMerged = new MeshData();
+						resources.AddResource(&pMerged);
+						if (meshIter == m_StaticBatchMeshes.end())
+							meshIter = m_StaticBatchMeshes.insert(m_StaticBatchMeshes.end(), StaticBatchMesh{ source.m_PipelineID,
+								materialID, group.m_LayerMask, group.m_Attributes, chunkIndex, pMerged->GetUUID(), false });
+						else meshIter->m_MeshID = pMerged->GetUUID();
+					}
+					++chunkIndex;
+
+					/* Meshes are looked up after the merged mesh was added since adding it may have moved them */
+					meshes.clear();
+					worlds.clear();
+					for (size_t i = first; i < last; ++i)
+					{
+						const StaticObject& object = group.m_Objects[i];
+						const MeshData* pMesh = static_cast<const MeshData*>(resources.GetResource(object.m_MeshID));
+						if (!pMesh) break;
+						meshes.push_back(pMesh);
+						worlds.push_back(object.m_pMeshBatch->m_Worlds[object.m_Index]);
+					}
+					if (meshes.size() != last - first || !MergeMeshes(pMerged, meshes, worlds, ranges))
+					{
+						for (size_t i = first; i < last; ++i)
+							addObject(batch, *group.m_Objects[i].m_pMeshBatch, group.m_Objects[i].m_Index);
+						first = last;
+						continue;
+					}
+
+					meshIter->m_Used = true;
+
+					const UUID mergedID = pMerged->GetUUID();
+					std::vector<StaticSubMesh>& subMeshes = m_StaticSubMeshes[mergedID];
+					subMeshes.reserve(last - first);
+					for (size_t i = first; i < last; ++i)
+					{
+						const StaticObject& object = group.m_Objects[i];
+						const MeshLOD& range = ranges[i - first];
+						subMeshes.push_back(StaticSubMesh{ range.m_IndexOffset, range.m_IndexCount,
+							object.m_Bounds, object.m_pMeshBatch->m_ObjectIDs[object.m_Index] });
+					}
+
+					/* Transforms are baked into the vertices so the merged mesh is drawn with an identity world */
+					PipelineMeshBatch& mergedBatch = batch.m_Meshes.emplace(mergedID, PipelineMeshBatch{ mergedID }).first->second;
+					batch.m_UniqueMeshOrder.push_back(mergedID);
+					mergedBatch.m_Worlds.push_back(glm::mat4{ 1.0f });
+					mergedBatch.m_LayerMasks.push_back(group.m_LayerMask);
+					mergedBatch.m_ObjectIDs.push_back(subMeshes.front().m_ObjectIDs);
+					mergedBatch.m_MaterialIndices.push_back(group.m_MaterialIndex);
+					first = last;
+				}
+			}
+		}
+
+		/* Merged meshes of groups or chunks that no longer exist */
+		for (auto iter = m_StaticBatchMeshes.begin(); iter != m_StaticBatchMeshes.end();)
+		{
+			if (iter->m_Used)
+			{
+				++iter;
+				continue;
+			}
+			resources.UnloadResource(iter->m_MeshID);
+			iter = m_StaticBatchMeshes.erase(iter);
+		}
 	}
 
 	void Renderer::SubmitDynamic(RenderData&& renderData)
@@ -548,6 +804,15 @@ namespace Glory
 	{
 		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "Renderer::Reset" };
 		m_StaticPipelineRenderDatas.clear();
+		m_ToProcessStaticRenderData.clear();
+		m_StaticBatches.clear();
+		m_StaticSubMeshes.clear();
+		Resources& resources = m_pModule->GetEngine()->GetResources();
+		for (const StaticBatchMesh& mesh : m_StaticBatchMeshes)
+			resources.UnloadResource(mesh.m_MeshID);
+		m_StaticBatchMeshes.clear();
+		m_StaticBatchMissingMeshes.clear();
+		m_StaticBatchesDirty = false;
 		m_DynamicPipelineRenderDatas.clear();
 		m_DynamicLatePipelineRenderDatas.clear();
 		m_FrameData.Reset();
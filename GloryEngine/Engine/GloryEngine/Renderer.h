@@ -8,6 +8,8 @@
 #include "RenderFrame.h"
 #include "ShapeProperty.h"
 #include "VertexHelpers.h"
+#include "BoundingBox.h"
+#include "VertexDefinitions.h"
 
 #include <engine_visibility.h>
 
@@ -15,6 +17,11 @@
 
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
 namespace Glory
 {
 	class Module;
@@ -48,11 +55,16 @@ namespace Glory
 	template<typename T>
 	struct CPUBuffer
 	{
+		/** @brief Maximum number of disjoint dirty ranges before the closest ones get merged */
+		static constexpr size_t MaxDirtyRanges = 16;
+		/** @brief Ranges closer than this many elements are merged into one upload */
+		static constexpr size_t DirtyRangeMergeDistance = 256/sizeof(T);
+
 		template <class... _Valty>
 		inline decltype(auto) emplace_back(_Valty&&... _Val)
 		{
 			T& newElement = m_Data.emplace_back(std::forward<_Valty>(_Val)...);
-			m_Dirty = true;
+			SetDirty(m_Data.size() - 1);
 			return newElement;
 		}
 
@@ -60,16 +72,13 @@ namespace Glory
 		{
 			m_Data.clear();
 			m_Dirty = true;
-			m_DirtyRange.first = 0;
-			m_DirtyRange.second = 1;
+			m_DirtyRanges.clear();
 		}
 
 		inline void resize(size_t newSize)
 		{
 			m_Data.resize(newSize);
-			m_Dirty = true;
-			m_DirtyRange.first = 0;
-			m_DirtyRange.second = newSize;
+			SetDirty();
 			m_SizeDirty = true;
 		}
 
@@ -91,39 +100,80 @@ namespace Glory
 
 		inline void SetDirty(size_t index)
 		{
-			if (index >= m_Data.size())
-				index = m_Data.size() - 1;
+			SetDirty(index, 1);
+		}
 
-			const bool wasDirty = m_Dirty;
+		/**
+		 * @brief Mark a range of elements as dirty
+		 * @param first Index of the first dirty element
+		 * @param count Number of dirty elements
+		 *
+		 * Overlapping and nearby ranges are coalesced so they can be uploaded together.
+		 */
+		inline void SetDirty(size_t first, size_t count)
+		{
+			if (m_Data.empty() || count == 0) return;
+			if (first >= m_Data.size())
+				first = m_Data.size() - 1;
+			size_t last = std::min(first + count, m_Data.size());
+
+			/* Ranges from a previous upload are no longer needed */
+			if (!m_Dirty)
+				m_DirtyRanges.clear();
 			m_Dirty = true;
-			if (!wasDirty)
+
+			/* Find the first range that touches the new range and merge all that follow */
+			auto begin = std::lower_bound(m_DirtyRanges.begin(), m_DirtyRanges.end(), first,
+				[](const std::pair<size_t, size_t>& range, size_t index) {
+					return range.second + DirtyRangeMergeDistance < index;
+				});
+			auto end = begin;
+			while (end != m_DirtyRanges.end() && end->first <= last + DirtyRangeMergeDistance)
 			{
-				m_DirtyRange.first = index;
-				m_DirtyRange.second = index + 1;
-				return;
+				first = std::min(first, end->first);
+				last = std::max(last, end->second);
+				++end;
 			}
-			if (index < m_DirtyRange.first)
-				m_DirtyRange.first = index;
-			if (index + 1 > m_DirtyRange.second)
-				m_DirtyRange.second = index + 1;
+
+			if (begin == end)
+				m_DirtyRanges.insert(begin, { first, last });
+			else
+			{
+				*begin = { first, last };
+				m_DirtyRanges.erase(begin + 1, end);
+			}
+
+			if (m_DirtyRanges.size() > MaxDirtyRanges)
+				MergeClosestDirtyRanges();
 		}
 
 		inline void SetDirty()
 		{
 			m_Dirty = true;
-			m_DirtyRange.first = 0;
-			m_DirtyRange.second = m_Data.size();
+			m_DirtyRanges.clear();
+			if (m_Data.empty()) return;
+			m_DirtyRanges.push_back({ 0, m_Data.size() });
 		}
 
-		inline size_t DirtySize()
+		/** @brief Sorted and disjoint element ranges that need uploading */
+		inline const std::vector<std::pair<size_t, size_t>>& DirtyRanges() const
 		{
-			return m_DirtyRange.second - m_DirtyRange.first;
+			return m_DirtyRanges;
 		}
 
-		inline void* DirtyStart()
+		/**
+		 * @brief Invoke a callback for every dirty range
+		 * @param callback Callback taking the range data, its offset in bytes and its size in bytes
+		 */
+		template<typename Fn>
+		inline void ForEachDirtyRange(Fn&& callback) const
 		{
-			char* start = (char*)m_Data.data();
-			return start + m_DirtyRange.first*sizeof(T);
+			for (const auto& range : m_DirtyRanges)
+			{
+				const char* start = reinterpret_cast<const char*>(m_Data.data()) + range.first*sizeof(T);
+				callback(static_cast<const void*>(start), static_cast<uint32_t>(range.first*sizeof(T)),
+					static_cast<uint32_t>((range.second - range.first)*sizeof(T)));
+			}
 		}
 
 		inline size_t TotalByteSize()
@@ -134,7 +184,23 @@ namespace Glory
 		std::vector<T> m_Data;
 		bool m_Dirty{ false };
 		bool m_SizeDirty{ false };
-		std::pair<size_t, size_t> m_DirtyRange{ 0, 0 };
+		std::vector<std::pair<size_t, size_t>> m_DirtyRanges;
+
+	private:
+		inline void MergeClosestDirtyRanges()
+		{
+			size_t closest = 0;
+			size_t smallestGap = SIZE_MAX;
+			for (size_t i = 0; i + 1 < m_DirtyRanges.size(); ++i)
+			{
+				const size_t gap = m_DirtyRanges[i + 1].first - m_DirtyRanges[i].second;
+				if (gap >= smallestGap) continue;
+				smallestGap = gap;
+				closest = i;
+			}
+			m_DirtyRanges[closest].second = m_DirtyRanges[closest + 1].second;
+			m_DirtyRanges.erase(m_DirtyRanges.begin() + closest + 1);
+		}
 	};
 
 	struct PipelineMeshBatch
@@ -162,6 +228,33 @@ namespace Glory
 		bool m_Dirty;
 	};
 
+	/** @brief Index range of a static object inside a merged static mesh */
+	struct StaticSubMesh
+	{
+		/** @brief First index of the object in the merged mesh */
+		uint32_t m_IndexOffset;
+		/** @brief Number of indices of the object */
+		uint32_t m_IndexCount;
+		/** @brief World space bounds of the object */
+		BoundingSphere m_Bounds;
+		/** @brief Scene and object ID of the object */
+		std::pair<UUID, UUID> m_ObjectIDs;
+	};
+
+	/** @brief Merged mesh of static objects that is kept across rebuilds so its device mesh is updated in place */
+	struct StaticBatchMesh
+	{
+		UUID m_PipelineID;
+		UUID m_MaterialID;
+		LayerMask m_LayerMask;
+		std::vector<AttributeType> m_Attributes;
+		/** @brief Index of the merged mesh within its group when a group needs more than one */
+		size_t m_ChunkIndex;
+		UUID m_MeshID;
+		/** @brief Whether the last build used this mesh, unused meshes are unloaded after the build */
+		bool m_Used;
+	};
+
 	struct PostProcess
 	{
 		std::string m_Name;
@@ -182,6 +275,14 @@ namespace Glory
 		GLORY_ENGINE_API void SubmitStatic(RenderData&& renderData);
 		GLORY_ENGINE_API void UpdateStatic(UUID pipelineID, UUID meshID, UUID objectID, glm::mat4 world);
 		GLORY_ENGINE_API void UnsubmitStatic(UUID pipelineID, UUID meshID, UUID objectID);
+		/**
+		 * @brief Merge small static objects that share a pipeline, material and layer mask into combined meshes
+		 *
+		 * The result is stored in @ref m_StaticBatches with the sub-mesh range and bounds of every merged
+		 * object in @ref m_StaticSubMeshes. Only rebuilds after static objects were submitted, updated or
+		 * unsubmitted, or once a mesh that was still loading during the last build becomes available.
+		 */
+		GLORY_ENGINE_API void BuildStaticBatches();
 		GLORY_ENGINE_API void SubmitDynamic(RenderData&& renderData);
 		GLORY_ENGINE_API void SubmitLate(RenderData&& renderData);
 		GLORY_ENGINE_API void SubmitCamera(CameraRef camera);
@@ -307,6 +408,12 @@ namespace Glory
 
 		static const uint32_t MAX_LIGHTS = 3000;
 		static const uint32_t MAX_CAMERAS = 100;
+		/** @brief Meshes with more vertices than this are drawn on their own instead of being merged */
+		static const uint32_t MAX_STATIC_BATCH_MESH_VERTICES = 4096;
+		/** @brief Vertex limit of a merged static mesh, keeps its indices 16 bit */
+		static const uint32_t MAX_STATIC_BATCH_VERTICES = 65535;
+		/** @brief Size limit of a merged static mesh with quantized positions, keeps their precision around a millimeter */
+		static constexpr float MAX_STATIC_BATCH_EXTENT = 64.0f;
 
 	protected:
 		SceneManager* m_pSceneManager;
@@ -328,6 +435,14 @@ namespace Glory
 		std::vector<CameraRef> m_OutputCameras;
 		std::vector<RenderData> m_ToProcessStaticRenderData;
 		std::vector<PipelineBatch> m_StaticPipelineRenderDatas;
+		/** @brief Static objects after merging, in the same pipeline order as @ref m_StaticPipelineRenderDatas */
+		std::vector<PipelineBatch> m_StaticBatches;
+		/** @brief Sub-meshes of every merged static mesh by mesh ID */
+		std::unordered_map<UUID, std::vector<StaticSubMesh>> m_StaticSubMeshes;
+		std::vector<StaticBatchMesh> m_StaticBatchMeshes;
+		/** @brief Meshes of static objects that were not loaded yet during the last build */
+		std::vector<UUID> m_StaticBatchMissingMeshes;
+		bool m_StaticBatchesDirty{ false };
 		std::vector<PipelineBatch> m_DynamicPipelineRenderDatas;
 		std::vector<PipelineBatch> m_DynamicLatePipelineRenderDatas;
 
@@ -30,6 +30,7 @@ namespace Glory
 		m_Inheritence = std::move(other.m_Inheritence);
 		m_ID = other.m_ID;
 		m_Name = std::move(other.m_Name);
+		m_GPUSlots = other.m_GPUSlots;
 	}
 
 	Resource& Resource::operator=(Resource&& other) noexcept
@@ -37,6 +38,7 @@ namespace Glory
 		m_Inheritence = std::move(other.m_Inheritence);
 		m_ID = other.m_ID;
 		m_Name = std::move(other.m_Name);
+		m_GPUSlots = other.m_GPUSlots;
 		++m_DirtyVersion;
 		return *this;
 	}
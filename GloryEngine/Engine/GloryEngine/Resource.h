@@ -3,6 +3,7 @@
 
 #include <engine_visibility.h>
 
+#include <array>
 #include <map>
 #include <string>
 #include <string_view>
@@ -22,6 +23,9 @@ namespace Glory
     class Resource : public Object
     {
     public:
+        /** @brief Number of graphics devices that can track this resource by slot at once */
+        static constexpr size_t MaxGPUSlots = 4;
+
         /** @brief Constructor */
         GLORY_ENGINE_API Resource();
         /** @overload */
@@ -43,6 +47,13 @@ namespace Glory
         GLORY_ENGINE_API uint64_t DirtyVersion() const;
         GLORY_ENGINE_API void SetDirtyVersion(uint64_t version);
 
+        /** @brief Index of this resource in the resource cache of a graphics device
+         * @param deviceIndex Index of the device, see @ref GraphicsDevice::DeviceIndex()
+         *
+         * Lets the device find its GPU copy of this resource without a lookup by UUID.
+         */
+        uint32_t& GPUSlot(size_t deviceIndex) const { return m_GPUSlots[deviceIndex]; }
+
     public:
         virtual void Serialize(Utils::BinaryStream& container) const {};
         virtual void Deserialize(Utils::BinaryStream& container) {};
@@ -66,5 +77,6 @@ namespace Glory
         friend class LoaderModule;
 
         uint64_t m_DirtyVersion = 1;
+        mutable std::array<uint32_t, MaxGPUSlots> m_GPUSlots{ UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
     };
 }
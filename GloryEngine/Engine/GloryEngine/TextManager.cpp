@@ -68,15 +68,13 @@ namespace Glory
 				{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2 });
 			pMeshResource->SetResourceUUID(renderData.m_MeshID);
 			m_pResources->AddResource(&pMeshResource);
-			textData.m_TextDirty = true;
+			pComponent.m_MeshState = {};
 		}
 
-		if (textData.m_TextDirty)
-		{
-			MeshData* pMeshData = static_cast<MeshData*>(pMeshResource);
-			const float textWrap = textData.m_TextWrap*textData.m_Scale*pFont->FontHeight();
-			Utils::GenerateTextMesh(pMeshData, pFont, textData, textWrap);
-		}
+		/* Text that did not change since last frame reuses its mesh and its GPU copy */
+		MeshData* pMeshData = static_cast<MeshData*>(pMeshResource);
+		const float textWrap = textData.m_TextWrap*textData.m_Scale*pFont->FontHeight();
+		Utils::UpdateTextMesh(pMeshData, pFont, textData, pComponent.m_MeshState, textWrap);
 
 		pRenderer->SubmitDynamic(std::move(renderData));
 	}
@@ -3,10 +3,12 @@
 #include "Debug.h"
 #include "GraphicsEnums.h"
 
+#include <algorithm>
+
 namespace Glory
 {
 	TextureAtlas::TextureAtlas(IEngine* pEngine, uint32_t width, uint32_t height):
-		m_pEngine(pEngine), m_Width(width), m_Height(height), m_AvailableHeight(height)
+		m_pEngine(pEngine), m_FreeRects{ { 0, 0, width, height } }, m_Width(width), m_Height(height)
 	{
 	}
 
@@ -16,77 +18,54 @@ namespace Glory
 
 	UUID TextureAtlas::ReserveChunk(uint32_t width, uint32_t height, UUID id)
 	{
-		auto chunkIter = std::find_if(m_ReservedChunks.begin(), m_ReservedChunks.end(),
-			[id](const ReservedChunk& chunk) { return chunk.ID == id; });
-		if (chunkIter != m_ReservedChunks.end()) return chunkIter->ID;
-
-		/* Find a row with the same height */
-		for (size_t i = 0; i < m_Rows.size(); ++i)
+		if (FindChunk(id)) return id;
+		if (width == 0 || height == 0) return 0;
+
+		/* Best short side fit, ties are broken by the leftover on the longer side */
+		size_t best = m_FreeRects.size();
+		uint32_t bestShortSide = UINT32_MAX;
+		uint32_t bestLongSide = UINT32_MAX;
+		for (size_t i = 0; i < m_FreeRects.size(); ++i)
 		{
-			RowData& row = m_Rows[i];
-			if (row.Height != height) continue;
-			/* Use this row if enough space is available */
-			if (row.AvailableWidth < width)
-			{
-				/* Check if there is a gap */
-				if (row.m_FreeGaps.empty()) continue;
-				for (size_t j = 0; j < row.m_FreeGaps.size(); ++j)
-				{
-					auto& gap = row.m_FreeGaps[j];
-					if (gap.first != width) continue;
-					/* Get the xoffset */
-					const uint32_t xoffset = m_Width - gap.first;
-					/* Remove the gap */
-					row.m_FreeGaps.erase(row.m_FreeGaps.begin() + j);
-					/* Reserve the chunk */
-					m_ReservedChunks.emplace_back(ReservedChunk{ id, xoffset, row.YOffset, width, height, uint32_t(i) });
-					break;
-				}
-				continue;
-			}
-			/* Get the xoffset */
-			const uint32_t xoffset = m_Width - row.AvailableWidth;
-			/* Reduce available width for this row */
-			row.AvailableWidth -= width;
-			/* Reserve the chunk */
-			m_ReservedChunks.emplace_back(ReservedChunk{ id, xoffset, row.YOffset, width, height, uint32_t(i) });
-			return id;
+			const FreeRect& rect = m_FreeRects[i];
+			if (rect.Width < width || rect.Height < height) continue;
+			const uint32_t leftoverX = rect.Width - width;
+			const uint32_t leftoverY = rect.Height - height;
+			const uint32_t shortSide = std::min(leftoverX, leftoverY);
+			const uint32_t longSide = std::max(leftoverX, leftoverY);
+			if (shortSide > bestShortSide || (shortSide == bestShortSide && longSide >= bestLongSide)) continue;
+			best = i;
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+			/* Nothing fits better than an exact fit */
+			if (longSide == 0) break;
 		}
+		if (best == m_FreeRects.size()) return 0;
 
-		/* No row was found, make a new row if space is available */
-		if (m_AvailableHeight < height) return 0;
-		/* Get yoffset for new row */
-		const uint32_t yoffset = m_Height - m_AvailableHeight;
-		/* Reduce available height */
-		m_AvailableHeight -= height;
-		/* Create the row */
-		const uint32_t rowIndex = uint32_t(m_Rows.size());
-		m_Rows.emplace_back(RowData{ yoffset, m_Width - width, height });
-		/* Reserve the chunk */
-		m_ReservedChunks.emplace_back(ReservedChunk{ id, 0, yoffset, width, height, rowIndex });
+		const FreeRect used{ m_FreeRects[best].XOffset, m_FreeRects[best].YOffset, width, height };
+		SplitFreeRects(used);
+		PruneFreeRects();
+
+		m_ChunkIndices.emplace(id, m_ReservedChunks.size());
+		m_ReservedChunks.emplace_back(ReservedChunk{ id, used.XOffset, used.YOffset, width, height });
 		return id;
 	}
 
 	bool TextureAtlas::HasReservedChunk(UUID id) const
 	{
-		return std::find_if(m_ReservedChunks.begin(), m_ReservedChunks.end(),
-				[id](const ReservedChunk& chunk) { return chunk.ID == id; })
-			!= m_ReservedChunks.end();
+		return FindChunk(id) != nullptr;
 	}
 
 	glm::vec4 TextureAtlas::GetChunkCoords(UUID id) const
 	{
-		auto iter = std::find_if(m_ReservedChunks.begin(), m_ReservedChunks.end(), [id](const ReservedChunk& chunk) {
-			return chunk.ID == id;
-		});
-
-		if (iter == m_ReservedChunks.end())
+		const ReservedChunk* pChunk = FindChunk(id);
+		if (!pChunk)
 		{
 			m_pEngine->GetDebug().LogError("TextureAtlas::GetChunkCoords() > Chunk not found!");
 			return {};
 		}
 
-		const ReservedChunk& chunk = *iter;
+		const ReservedChunk& chunk = *pChunk;
 		glm::vec4 coords;
 		coords.x = float(chunk.XOffset)/m_Width;
 		coords.y = float(chunk.YOffset)/m_Height;
@@ -97,17 +76,14 @@ namespace Glory
 
 	glm::vec4 TextureAtlas::GetChunkPositionAndSize(UUID id) const
 	{
-		auto iter = std::find_if(m_ReservedChunks.begin(), m_ReservedChunks.end(), [id](const ReservedChunk& chunk) {
-			return chunk.ID == id;
-		});
-
-		if (iter == m_ReservedChunks.end())
+		const ReservedChunk* pChunk = FindChunk(id);
+		if (!pChunk)
 		{
 			m_pEngine->GetDebug().LogError("TextureAtlas::GetChunkPositionAndSize() > Chunk not found!");
 			return {};
 		}
 
-		const ReservedChunk& chunk = *iter;
+		const ReservedChunk& chunk = *pChunk;
 		glm::vec4 coords;
 		coords.x = float(chunk.XOffset);
 		coords.y = float(chunk.YOffset);
@@ -118,26 +94,39 @@ namespace Glory
 
 	void TextureAtlas::ReleaseChunk(UUID id)
 	{
-		auto iter = std::find_if(m_ReservedChunks.begin(), m_ReservedChunks.end(),
-			[id](const ReservedChunk& chunk) { return chunk.ID == id; });
-		if (iter == m_ReservedChunks.end()) return;
-		RowData& row = m_Rows[iter->RowIndex];
-		if (m_Width - iter->Width - row.AvailableWidth == iter->XOffset)
+		auto iter = m_ChunkIndices.find(id);
+		if (iter == m_ChunkIndices.end()) return;
+		const size_t index = iter->second;
+		const ReservedChunk chunk = m_ReservedChunks[index];
+		m_ChunkIndices.erase(iter);
+
+		/* Swap the last chunk into the released slot */
+		if (index != m_ReservedChunks.size() - 1)
+		{
+			m_ReservedChunks[index] = m_ReservedChunks.back();
+			m_ChunkIndices[m_ReservedChunks[index].ID] = index;
+		}
+		m_ReservedChunks.pop_back();
+
+		if (m_ReservedChunks.empty())
 		{
-			/* Just free a spot at the end */
-			row.AvailableWidth += iter->Width;
+			ReleaseAllChunks();
 			return;
 		}
 
-		/* We have to make a gap */
-		row.m_FreeGaps.emplace_back(iter->XOffset, iter->Width);
+		/* Grow the freed space into the free space around it, once wide first and once tall first */
+		const FreeRect freed{ chunk.XOffset, chunk.YOffset, chunk.Width, chunk.Height };
+		m_FreeRects.push_back(GrowFreeRect(freed, true));
+		m_FreeRects.push_back(GrowFreeRect(freed, false));
+		PruneFreeRects();
 	}
 
 	void TextureAtlas::ReleaseAllChunks()
 	{
 		m_ReservedChunks.clear();
-		m_Rows.clear();
-		m_AvailableHeight = m_Height;
+		m_ChunkIndices.clear();
+		m_FreeRects.clear();
+		m_FreeRects.push_back(FreeRect{ 0, 0, m_Width, m_Height });
 	}
 
 	void TextureAtlas::Resize(uint32_t newSize)
@@ -152,4 +141,110 @@ namespace Glory
 	{
 		return { m_Width, m_Height };
 	}
+
+	size_t TextureAtlas::ChunkCount() const
+	{
+		return m_ReservedChunks.size();
+	}
+
+	const TextureAtlas::ReservedChunk* TextureAtlas::FindChunk(UUID id) const
+	{
+		auto iter = m_ChunkIndices.find(id);
+		return iter != m_ChunkIndices.end() ? &m_ReservedChunks[iter->second] : nullptr;
+	}
+
+	void TextureAtlas::SplitFreeRects(const FreeRect& used)
+	{
+		/* Replace every free rectangle that overlaps the used area with the maximal rectangles around it */
+		const size_t count = m_FreeRects.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			const FreeRect rect = m_FreeRects[i];
+			if (used.XOffset >= rect.XOffset + rect.Width || used.XOffset + used.Width <= rect.XOffset ||
+				used.YOffset >= rect.YOffset + rect.Height || used.YOffset + used.Height <= rect.YOffset)
+				continue;
+
+			if (used.XOffset > rect.XOffset)
+				m_FreeRects.push_back(FreeRect{ rect.XOffset, rect.YOffset, used.XOffset - rect.XOffset, rect.Height });
+			if (used.XOffset + used.Width < rect.XOffset + rect.Width)
+				m_FreeRects.push_back(FreeRect{ used.XOffset + used.Width, rect.YOffset,
+					rect.XOffset + rect.Width - used.XOffset - used.Width, rect.Height });
+			if (used.YOffset > rect.YOffset)
+				m_FreeRects.push_back(FreeRect{ rect.XOffset, rect.YOffset, rect.Width, used.YOffset - rect.YOffset });
+			if (used.YOffset + used.Height < rect.YOffset + rect.Height)
+				m_FreeRects.push_back(FreeRect{ rect.XOffset, used.YOffset + used.Height,
+					rect.Width, rect.YOffset + rect.Height - used.YOffset - used.Height });
+
+			/* Mark the split rectangle for removal */
+			m_FreeRects[i].Width = 0;
+		}
+	}
+
+	TextureAtlas::FreeRect TextureAtlas::GrowFreeRect(FreeRect rect, bool horizontalFirst) const
+	{
+		for (size_t pass = 0; pass < 2; ++pass)
+		{
+			if ((pass == 0) == horizontalFirst)
+			{
+				/* Extend to the nearest chunks on the left and right that share rows with the rectangle */
+				uint32_t left = 0;
+				uint32_t right = m_Width;
+				for (const ReservedChunk& chunk : m_ReservedChunks)
+				{
+					if (chunk.YOffset >= rect.YOffset + rect.Height || chunk.YOffset + chunk.Height <= rect.YOffset) continue;
+					if (chunk.XOffset + chunk.Width <= rect.XOffset) left = std::max(left, chunk.XOffset + chunk.Width);
+					else if (chunk.XOffset >= rect.XOffset + rect.Width) right = std::min(right, chunk.XOffset);
+				}
+				rect.XOffset = left;
+				rect.Width = right - left;
+				continue;
+			}
+
+			/* Extend to the nearest chunks above and below that share columns with the rectangle */
+			uint32_t top = 0;
+			uint32_t bottom = m_Height;
+			for (const ReservedChunk& chunk : m_ReservedChunks)
+			{
+				if (chunk.XOffset >= rect.XOffset + rect.Width || chunk.XOffset + chunk.Width <= rect.XOffset) continue;
+				if (chunk.YOffset + chunk.Height <= rect.YOffset) top = std::max(top, chunk.YOffset + chunk.Height);
+				else if (chunk.YOffset >= rect.YOffset + rect.Height) bottom = std::min(bottom, chunk.YOffset);
+			}
+			rect.YOffset = top;
+			rect.Height = bottom - top;
+		}
+		return rect;
+	}
+
+	void TextureAtlas::PruneFreeRects()
+	{
+		/* Remove rectangles that were split and rectangles contained in another one */
+		const auto contains = [](const FreeRect& a, const FreeRect& b) {
+			return b.XOffset >= a.XOffset && b.YOffset >= a.YOffset &&
+				b.XOffset + b.Width <= a.XOffset + a.Width && b.YOffset + b.Height <= a.YOffset + a.Height;
+		};
+
+		m_FreeRects.erase(std::remove_if(m_FreeRects.begin(), m_FreeRects.end(),
+			[](const FreeRect& rect) { return rect.Width == 0 || rect.Height == 0; }), m_FreeRects.end());
+		for (size_t i = 0; i < m_FreeRects.size(); ++i)
+		{
+			for (size_t j = i + 1; j < m_FreeRects.size();)
+			{
+				if (contains(m_FreeRects[i], m_FreeRects[j]))
+				{
+					m_FreeRects[j] = m_FreeRects.back();
+					m_FreeRects.pop_back();
+					continue;
+				}
+				if (contains(m_FreeRects[j], m_FreeRects[i]))
+				{
+					m_FreeRects[i] = m_FreeRects[j];
+					m_FreeRects[j] = m_FreeRects.back();
+					m_FreeRects.pop_back();
+					j = i + 1;
+					continue;
+				}
+				++j;
+			}
+		}
+	}
 }
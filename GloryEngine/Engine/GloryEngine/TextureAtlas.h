@@ -6,6 +6,9 @@
 #include <glm/vec4.hpp>
 #include <glm/vec2.hpp>
 
+#include <vector>
+#include <unordered_map>
+
 namespace Glory
 {
 	class IEngine;
@@ -28,15 +31,15 @@ namespace Glory
 		/** @brief Get the GPU texture resource if available, otherwise nullptr */
 		virtual TextureHandle GetTexture() const = 0;
 
-		/** @brief Reserver a chunk in the atlas
+		/** @brief Reserve a chunk in the atlas
 		 * @param width Width of the chunk
 		 * @param height Height of the chunk
 		 * @param id ID of the chunk
 		 * @returns The ID of the chunk on success, 0 on fail
 		 *
-		 * Chunks are reserved in rows first, where each row has a consistent height.
-		 * If a new row is required for the chosen height, reservation will fail if the
-		 * remaining available height is smaller than the requested height.
+		 * Chunks are packed with the MaxRects algorithm, each chunk is placed in the free
+		 * rectangle that leaves the smallest leftover on its shorter side.
+		 * Reservation fails if no free rectangle is large enough.
 		 */
 		GLORY_ENGINE_API UUID ReserveChunk(uint32_t width, uint32_t height, UUID id=UUID());
 		/** @brief Check if the atlas has a reserved chunk with an id
@@ -49,13 +52,14 @@ namespace Glory
 		GLORY_ENGINE_API glm::vec4 GetChunkCoords(UUID id) const;
 		GLORY_ENGINE_API glm::vec4 GetChunkPositionAndSize(UUID id) const;
 
-		/** @brief Release a specific chunk from the atlas so that it can be reserved again
+		/** @brief Release a specific chunk from the atlas so its space can be reserved again
 		 * @param id ID of the chunk to release
 		 *
+		 * The freed space is grown into the free space around it so larger chunks can use it.
 		 * Does not clear the attached texture
 		 */
 		GLORY_ENGINE_API void ReleaseChunk(UUID id);
-		/** @brief Release all chunks and reset rows in the texture atlas
+		/** @brief Release all chunks and reset the free space of the texture atlas
 		 *
 		 * Does not clear the attached texture
 		 */
@@ -69,6 +73,8 @@ namespace Glory
 		GLORY_ENGINE_API void Resize(uint32_t newSize);
 
 		GLORY_ENGINE_API glm::uvec2 Resolution() const;
+		/** @brief Number of reserved chunks */
+		GLORY_ENGINE_API size_t ChunkCount() const;
 
 	protected:
 		/** @brief Reserved chunk data */
@@ -79,27 +85,33 @@ namespace Glory
 			uint32_t YOffset;
 			uint32_t Width;
 			uint32_t Height;
-			uint32_t RowIndex;
 		};
 
-		/** @brief Row data */
-		struct RowData
+		/** @brief Free area of the atlas, free rectangles may overlap each other */
+		struct FreeRect
 		{
+			uint32_t XOffset;
 			uint32_t YOffset;
-			uint32_t AvailableWidth;
+			uint32_t Width;
 			uint32_t Height;
-
-			std::vector<std::pair<uint32_t, uint32_t>> m_FreeGaps;
 		};
+
 		/** @brief Implementation for resizing the atlas */
 		virtual void OnResize() = 0;
 
+	private:
+		const ReservedChunk* FindChunk(UUID id) const;
+		void SplitFreeRects(const FreeRect& used);
+		FreeRect GrowFreeRect(FreeRect rect, bool horizontalFirst) const;
+		void PruneFreeRects();
+
 	protected:
 		IEngine* m_pEngine;
 		std::vector<ReservedChunk> m_ReservedChunks;
-		std::vector<RowData> m_Rows;
+		/** @brief Index of each chunk in @ref m_ReservedChunks by ID */
+		std::unordered_map<UUID, size_t> m_ChunkIndices;
+		std::vector<FreeRect> m_FreeRects;
 		uint32_t m_Width;
 		uint32_t m_Height;
-		uint32_t m_AvailableHeight;
 	};
 }
@@ -0,0 +1,842 @@
+#include "TextureCompression.h"
+#include "ImageData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace Glory
+{
+	namespace
+	{
+		/** 4x4 texels of a block with missing channels filled in, alpha defaults to opaque */
+		struct Block
+		{
+			float m_Texels[16][4];
+		};
+
+		/** Writes values into a block from the least significant bit up */
+		struct BitWriter
+		{
+			uint8_t* m_pOut;
+			size_t m_Position = 0;
+
+			void Write(uint32_t value, uint32_t bits)
+			{
+				for (uint32_t i = 0; i < bits; ++i, ++m_Position)
+				{
+					if (!((value >> i) & 1)) continue;
+					m_pOut[m_Position >> 3] |= uint8_t(1 << (m_Position & 7));
+				}
+			}
+		};
+
+		/** Reads values from a block from the least significant bit up */
+		struct BitReader
+		{
+			const uint8_t* m_pIn;
+			size_t m_Position = 0;
+
+			uint32_t Read(uint32_t bits)
+			{
+				uint32_t value = 0;
+				for (uint32_t i = 0; i < bits; ++i, ++m_Position)
+					value |= uint32_t((m_pIn[m_Position >> 3] >> (m_Position & 7)) & 1) << i;
+				return value;
+			}
+		};
+
+		/** Edge blocks of images that are not a multiple of 4 repeat the last row and column */
+		void FetchBlock(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels,
+			uint32_t blockX, uint32_t blockY, Block& block)
+		{
+			for (uint32_t y = 0; y < 4; ++y)
+			{
+				const uint32_t py = std::min(blockY*4 + y, height - 1);
+				for (uint32_t x = 0; x < 4; ++x)
+				{
+					const uint32_t px = std::min(blockX*4 + x, width - 1);
+					const uint8_t* pixel = pixels + (size_t(py)*width + px)*channels;
+					float* texel = block.m_Texels[y*4 + x];
+					texel[0] = float(pixel[0]);
+					texel[1] = channels > 1 ? float(pixel[1]) : 0.0f;
+					texel[2] = channels > 2 ? float(pixel[2]) : 0.0f;
+					texel[3] = channels > 3 ? float(pixel[3]) : 255.0f;
+				}
+			}
+		}
+
+		/** Find the extremes of a block along the axis with the most variance */
+		void PrincipalEndpoints(const Block& block, uint32_t channels, float* outLow, float* outHigh)
+		{
+			float mean[4]{};
+			float minimum[4]{ 255.0f, 255.0f, 255.0f, 255.0f };
+			float maximum[4]{};
+			for (size_t i = 0; i < 16; ++i)
+			{
+				for (uint32_t c = 0; c < channels; ++c)
+				{
+					mean[c] += block.m_Texels[i][c]/16.0f;
+					minimum[c] = std::min(minimum[c], block.m_Texels[i][c]);
+					maximum[c] = std::max(maximum[c], block.m_Texels[i][c]);
+				}
+			}
+
+			float covariance[4][4]{};
+			for (size_t i = 0; i < 16; ++i)
+			{
+				for (uint32_t a = 0; a < channels; ++a)
+				{
+					for (uint32_t b = 0; b < channels; ++b)
+						covariance[a][b] += (block.m_Texels[i][a] - mean[a])*(block.m_Texels[i][b] - mean[b]);
+				}
+			}
+
+			/* The diagonal of the bounding box is a good first guess that is rarely orthogonal to the real axis */
+			float axis[4]{};
+			float length = 0.0f;
+			for (uint32_t c = 0; c < channels; ++c)
+			{
+				axis[c] = maximum[c] - minimum[c];
+				length = std::max(length, axis[c]);
+			}
+
+			if (length <= 0.0f)
+			{
+				for (uint32_t c = 0; c < channels; ++c)
+					outLow[c] = outHigh[c] = mean[c];
+				return;
+			}
+
+			for (size_t iteration = 0; iteration < 8; ++iteration)
+			{
+				float next[4]{};
+				float largest = 0.0f;
+				for (uint32_t a = 0; a < channels; ++a)
+				{
+					for (uint32_t b = 0; b < channels; ++b)
+						next[a] += covariance[a][b]*axis[b];
+					largest = std::max(largest, std::abs(next[a]));
+				}
+				if (largest <= 0.0f) break;
+				for (uint32_t c = 0; c < channels; ++c)
+					axis[c] = next[c]/largest;
+			}
+
+			float axisLengthSquared = 0.0f;
+			for (uint32_t c = 0; c < channels; ++c)
+				axisLengthSquared += axis[c]*axis[c];
+
+			float lowProjection = 0.0f;
+			float highProjection = 0.0f;
+			for (size_t i = 0; i < 16; ++i)
+			{
+				float projection = 0.0f;
+				for (uint32_t c = 0; c < channels; ++c)
+					projection += (block.m_Texels[i][c] - mean[c])*axis[c];
+				projection /= axisLengthSquared;
+				lowProjection = std::min(lowProjection, projection);
+				highProjection = std::max(highProjection, projection);
+			}
+
+			for (uint32_t c = 0; c < channels; ++c)
+			{
+				outLow[c] = std::clamp(mean[c] + axis[c]*lowProjection, 0.0f, 255.0f);
+				outHigh[c] = std::clamp(mean[c] + axis[c]*highProjection, 0.0f, 255.0f);
+			}
+		}
+
+		float DistanceSquared(const float* a, const float* b, uint32_t channels)
+		{
+			float distance = 0.0f;
+			for (uint32_t c = 0; c < channels; ++c)
+				distance += (a[c] - b[c])*(a[c] - b[c]);
+			return distance;
+		}
+
+		uint32_t NearestIndex(const float* texel, const float (*palette)[4], uint32_t paletteSize, uint32_t channels)
+		{
+			uint32_t best = 0;
+			float bestDistance = DistanceSquared(texel, palette[0], channels);
+			for (uint32_t i = 1; i < paletteSize; ++i)
+			{
+				const float distance = DistanceSquared(texel, palette[i], channels);
+				if (distance >= bestDistance) continue;
+				best = i;
+				bestDistance = distance;
+			}
+			return best;
+		}
+
+		/** Least squares fit of the endpoints to the texels given the interpolation weight of each texel */
+		bool RefineEndpoints(const Block& block, uint32_t channels, const float* weights, float* outLow, float* outHigh)
+		{
+			float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+			float ax[4]{}, bx[4]{};
+			for (size_t i = 0; i < 16; ++i)
+			{
+				const float a = 1.0f - weights[i];
+				const float b = weights[i];
+				aa += a*a;
+				ab += a*b;
+				bb += b*b;
+				for (uint32_t c = 0; c < channels; ++c)
+				{
+					ax[c] += a*block.m_Texels[i][c];
+					bx[c] += b*block.m_Texels[i][c];
+				}
+			}
+
+			const float determinant = aa*bb - ab*ab;
+			if (std::abs(determinant) < 1e-6f) return false;
+			for (uint32_t c = 0; c < channels; ++c)
+			{
+				outLow[c] = std::clamp((ax[c]*bb - bx[c]*ab)/determinant, 0.0f, 255.0f);
+				outHigh[c] = std::clamp((bx[c]*aa - ax[c]*ab)/determinant, 0.0f, 255.0f);
+			}
+			return true;
+		}
+
+		uint16_t ToRGB565(const float* color)
+		{
+			const uint32_t r = uint32_t(std::lround(color[0]*31.0f/255.0f));
+			const uint32_t g = uint32_t(std::lround(color[1]*63.0f/255.0f));
+			const uint32_t b = uint32_t(std::lround(color[2]*31.0f/255.0f));
+			return uint16_t((r << 11) | (g << 5) | b);
+		}
+
+		void FromRGB565(uint16_t packed, float* outColor)
+		{
+			const uint32_t r = (packed >> 11) & 31;
+			const uint32_t g = (packed >> 5) & 63;
+			const uint32_t b = packed & 31;
+			outColor[0] = float((r << 3) | (r >> 2));
+			outColor[1] = float((g << 2) | (g >> 4));
+			outColor[2] = float((b << 3) | (b >> 2));
+			outColor[3] = 255.0f;
+		}
+
+		/** Pick the BC1 indices for a pair of endpoints, returns the squared error of the block */
+		float FitBC1(const Block& block, uint16_t& color0, uint16_t& color1, uint32_t* outIndices)
+		{
+			/* 4 color mode requires the first endpoint to be the larger one */
+			if (color0 < color1) std::swap(color0, color1);
+
+			float palette[4][4];
+			FromRGB565(color0, palette[0]);
+			FromRGB565(color1, palette[1]);
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				palette[2][c] = (2.0f*palette[0][c] + palette[1][c])/3.0f;
+				palette[3][c] = (palette[0][c] + 2.0f*palette[1][c])/3.0f;
+			}
+
+			/* Equal endpoints switch to 3 color mode where only the first entry is the same */
+			const uint32_t paletteSize = color0 != color1 ? 4 : 1;
+			float error = 0.0f;
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				outIndices[i] = NearestIndex(block.m_Texels[i], palette, paletteSize, 3);
+				error += DistanceSquared(block.m_Texels[i], palette[outIndices[i]], 3);
+			}
+			return error;
+		}
+
+		/** BC1 color block in 4 color mode, also used as the color half of BC3 */
+		void EncodeBC1(const Block& block, uint8_t* out)
+		{
+			static constexpr float Weights[4] = { 0.0f, 1.0f, 1.0f/3.0f, 2.0f/3.0f };
+
+			float low[4], high[4];
+			PrincipalEndpoints(block, 3, low, high);
+
+			uint16_t color0 = ToRGB565(high);
+			uint16_t color1 = ToRGB565(low);
+			uint32_t indices[16];
+			const float error = FitBC1(block, color0, color1, indices);
+
+			float weights[16];
+			for (uint32_t i = 0; i < 16; ++i)
+				weights[i] = Weights[indices[i]];
+			if (error > 0.0f && RefineEndpoints(block, 3, weights, high, low))
+			{
+				uint16_t refined0 = ToRGB565(high);
+				uint16_t refined1 = ToRGB565(low);
+				uint32_t refinedIndices[16];
+				if (FitBC1(block, refined0, refined1, refinedIndices) < error)
+				{
+					color0 = refined0;
+					color1 = refined1;
+					std::memcpy(indices, refinedIndices, sizeof(indices));
+				}
+			}
+
+			uint32_t packedIndices = 0;
+			for (uint32_t i = 0; i < 16; ++i)
+				packedIndices |= indices[i] << (2*i);
+
+			out[0] = uint8_t(color0 & 0xFF);
+			out[1] = uint8_t(color0 >> 8);
+			out[2] = uint8_t(color1 & 0xFF);
+			out[3] = uint8_t(color1 >> 8);
+			for (uint32_t i = 0; i < 4; ++i)
+				out[4 + i] = uint8_t((packedIndices >> (8*i)) & 0xFF);
+		}
+
+		/** BC4 block of a single channel, also used for BC5 and the alpha of BC3 */
+		void EncodeBC4(const Block& block, uint32_t channel, uint8_t* out)
+		{
+			float low = 255.0f, high = 0.0f;
+			for (size_t i = 0; i < 16; ++i)
+			{
+				low = std::min(low, block.m_Texels[i][channel]);
+				high = std::max(high, block.m_Texels[i][channel]);
+			}
+
+			const uint8_t value0 = uint8_t(std::lround(high));
+			const uint8_t value1 = uint8_t(std::lround(low));
+			out[0] = value0;
+			out[1] = value1;
+
+			uint64_t indices = 0;
+			if (value0 > value1)
+			{
+				/* 8 value mode, the first 2 entries are the endpoints and the rest is interpolated */
+				float palette[8][4]{};
+				palette[0][0] = float(value0);
+				palette[1][0] = float(value1);
+				for (uint32_t i = 2; i < 8; ++i)
+					palette[i][0] = (float(8 - i)*value0 + float(i - 1)*value1)/7.0f;
+
+				for (uint32_t i = 0; i < 16; ++i)
+				{
+					const float texel[4]{ block.m_Texels[i][channel] };
+					indices |= uint64_t(NearestIndex(texel, palette, 8, 1)) << (3*i);
+				}
+			}
+
+			for (uint32_t i = 0; i < 6; ++i)
+				out[2 + i] = uint8_t((indices >> (8*i)) & 0xFF);
+		}
+
+		/** Quantize an endpoint to 7 bits per channel plus a shared lowest bit */
+		uint32_t QuantizeBC7Endpoint(const float* endpoint, uint32_t* outValues)
+		{
+			uint32_t bestPBit = 0;
+			float bestError = 0.0f;
+			for (uint32_t pBit = 0; pBit < 2; ++pBit)
+			{
+				float error = 0.0f;
+				uint32_t values[4];
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					values[c] = uint32_t(std::clamp(std::lround((endpoint[c] - float(pBit))/2.0f), 0l, 127l));
+					const float reconstructed = float((values[c] << 1) | pBit);
+					error += (reconstructed - endpoint[c])*(reconstructed - endpoint[c]);
+				}
+				if (pBit != 0 && error >= bestError) continue;
+				bestPBit = pBit;
+				bestError = error;
+				std::memcpy(outValues, values, sizeof(values));
+			}
+			return bestPBit;
+		}
+
+		/** BC7 mode 6 endpoints and indices of a block */
+		struct BC7Fit
+		{
+			uint32_t m_Endpoints[2][4];
+			uint32_t m_PBits[2];
+			uint32_t m_Indices[16];
+		};
+
+		static constexpr uint32_t BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		/** Quantize a pair of endpoints and pick the indices, returns the squared error of the block */
+		float FitBC7(const Block& block, const float* low, const float* high, BC7Fit& fit)
+		{
+			fit.m_PBits[0] = QuantizeBC7Endpoint(low, fit.m_Endpoints[0]);
+			fit.m_PBits[1] = QuantizeBC7Endpoint(high, fit.m_Endpoints[1]);
+
+			float palette[16][4];
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					const uint32_t value0 = (fit.m_Endpoints[0][c] << 1) | fit.m_PBits[0];
+					const uint32_t value1 = (fit.m_Endpoints[1][c] << 1) | fit.m_PBits[1];
+					palette[i][c] = float(((64 - BC7Weights[i])*value0 + BC7Weights[i]*value1 + 32) >> 6);
+				}
+			}
+
+			float error = 0.0f;
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				fit.m_Indices[i] = NearestIndex(block.m_Texels[i], palette, 16, 4);
+				error += DistanceSquared(block.m_Texels[i], palette[fit.m_Indices[i]], 4);
+			}
+			return error;
+		}
+
+		/** BC7 mode 6, a single subset of RGBA endpoints with 4 bit indices */
+		void EncodeBC7(const Block& block, uint8_t* out)
+		{
+			float low[4], high[4];
+			PrincipalEndpoints(block, 4, low, high);
+
+			BC7Fit fit;
+			const float error = FitBC7(block, low, high, fit);
+
+			float weights[16];
+			for (uint32_t i = 0; i < 16; ++i)
+				weights[i] = float(BC7Weights[fit.m_Indices[i]])/64.0f;
+			BC7Fit refined;
+			if (error > 0.0f && RefineEndpoints(block, 4, weights, low, high) &&
+				FitBC7(block, low, high, refined) < error)
+				fit = refined;
+
+			/* The highest bit of the first index is implied to be 0, swap the endpoints if it isn't */
+			if (fit.m_Indices[0] & 8)
+			{
+				std::swap(fit.m_Endpoints[0], fit.m_Endpoints[1]);
+				std::swap(fit.m_PBits[0], fit.m_PBits[1]);
+				for (uint32_t i = 0; i < 16; ++i)
+					fit.m_Indices[i] = 15 - fit.m_Indices[i];
+			}
+
+			std::memset(out, 0, 16);
+			BitWriter writer{ out };
+			writer.Write(1 << 6, 7);
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				writer.Write(fit.m_Endpoints[0][c], 7);
+				writer.Write(fit.m_Endpoints[1][c], 7);
+			}
+			writer.Write(fit.m_PBits[0], 1);
+			writer.Write(fit.m_PBits[1], 1);
+			writer.Write(fit.m_Indices[0], 3);
+			for (uint32_t i = 1; i < 16; ++i)
+				writer.Write(fit.m_Indices[i], 4);
+		}
+
+		/** Decoded texels of a block, alpha is opaque unless the format stores it */
+		struct DecodedBlock
+		{
+			uint8_t m_Texels[16][4];
+		};
+
+		void DecodeBC1(const uint8_t* in, DecodedBlock& block)
+		{
+			const uint16_t color0 = uint16_t(in[0] | (in[1] << 8));
+			const uint16_t color1 = uint16_t(in[2] | (in[3] << 8));
+
+			float palette[4][4];
+			FromRGB565(color0, palette[0]);
+			FromRGB565(color1, palette[1]);
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				if (color0 > color1)
+				{
+					palette[2][c] = (2.0f*palette[0][c] + palette[1][c])/3.0f;
+					palette[3][c] = (palette[0][c] + 2.0f*palette[1][c])/3.0f;
+					continue;
+				}
+				/* 3 color mode, the last entry is black */
+				palette[2][c] = (palette[0][c] + palette[1][c])/2.0f;
+				palette[3][c] = 0.0f;
+			}
+
+			const uint32_t indices = uint32_t(in[4] | (in[5] << 8) | (in[6] << 16) | (uint32_t(in[7]) << 24));
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				const float* color = palette[(indices >> (2*i)) & 3];
+				for (uint32_t c = 0; c < 3; ++c)
+					block.m_Texels[i][c] = uint8_t(std::lround(color[c]));
+			}
+		}
+
+		void DecodeBC4(const uint8_t* in, uint32_t channel, DecodedBlock& block)
+		{
+			const uint32_t value0 = in[0];
+			const uint32_t value1 = in[1];
+			uint8_t palette[8]{ uint8_t(value0), uint8_t(value1) };
+			if (value0 > value1)
+			{
+				for (uint32_t i = 2; i < 8; ++i)
+					palette[i] = uint8_t(std::lround(float((8 - i)*value0 + (i - 1)*value1)/7.0f));
+			}
+			else
+			{
+				/* 6 value mode, the last 2 entries are the extremes */
+				for (uint32_t i = 2; i < 6; ++i)
+					palette[i] = uint8_t(std::lround(float((6 - i)*value0 + (i - 1)*value1)/5.0f));
+				palette[6] = 0;
+				palette[7] = 255;
+			}
+
+			uint64_t indices = 0;
+			for (uint32_t i = 0; i < 6; ++i)
+				indices |= uint64_t(in[2 + i]) << (8*i);
+			for (uint32_t i = 0; i < 16; ++i)
+				block.m_Texels[i][channel] = palette[(indices >> (3*i)) & 7];
+		}
+
+		/** Only mode 6 is decoded since it is the only mode @ref EncodeBC7 writes */
+		void DecodeBC7(const uint8_t* in, DecodedBlock& block)
+		{
+			BitReader reader{ in };
+			if (reader.Read(7) != (1 << 6))
+			{
+				std::memset(block.m_Texels, 0, sizeof(block.m_Texels));
+				return;
+			}
+
+			uint32_t endpoints[2][4];
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				endpoints[0][c] = reader.Read(7);
+				endpoints[1][c] = reader.Read(7);
+			}
+			const uint32_t pBit0 = reader.Read(1);
+			const uint32_t pBit1 = reader.Read(1);
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				const uint32_t weight = BC7Weights[reader.Read(i == 0 ? 3 : 4)];
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					const uint32_t value0 = (endpoints[0][c] << 1) | pBit0;
+					const uint32_t value1 = (endpoints[1][c] << 1) | pBit1;
+					block.m_Texels[i][c] = uint8_t(((64 - weight)*value0 + weight*value1 + 32) >> 6);
+				}
+			}
+		}
+
+		bool SupportsUncompressedImage(const ImageData* pImage)
+		{
+			if (!pImage->GetPixels() || pImage->GetDataType() != DataType::DT_UByte || pImage->IsBlockCompressed())
+				return false;
+			const uint8_t channels = pImage->GetBytesPerPixel();
+			if (channels != 1 && channels != 2 && channels != 4) return false;
+			if (pImage->GetWidth() == 0 || pImage->GetHeight() == 0) return false;
+			return pImage->DataSize() >= size_t(pImage->GetWidth())*pImage->GetHeight()*channels;
+		}
+
+		std::vector<ImageData::MipLevel> StoredLevels(const ImageData* pImage)
+		{
+			std::vector<ImageData::MipLevel> levels;
+			if (pImage->MipLevelCount() == 0)
+			{
+				levels.push_back({ pImage->GetWidth(), pImage->GetHeight(), 0,
+					size_t(pImage->GetWidth())*pImage->GetHeight()*pImage->GetBytesPerPixel() });
+				return levels;
+			}
+			for (size_t i = 0; i < pImage->MipLevelCount(); ++i)
+				levels.push_back(pImage->GetMipLevel(i));
+			return levels;
+		}
+	}
+
+	size_t BlockCompressedSize(PixelFormat format, uint32_t width, uint32_t height)
+	{
+		size_t blockSize = 0;
+		switch (format)
+		{
+		case PixelFormat::PF_Bc1RgbUnormBlock:
+		case PixelFormat::PF_Bc1RgbSrgbBlock:
+		case PixelFormat::PF_Bc1RgbaUnormBlock:
+		case PixelFormat::PF_Bc1RgbaSrgbBlock:
+		case PixelFormat::PF_Bc4UnormBlock:
+		case PixelFormat::PF_Bc4SnormBlock:
+		case PixelFormat::PF_Etc2R8G8B8UnormBlock:
+		case PixelFormat::PF_Etc2R8G8B8SrgbBlock:
+		case PixelFormat::PF_Etc2R8G8B8A1UnormBlock:
+		case PixelFormat::PF_Etc2R8G8B8A1SrgbBlock:
+		case PixelFormat::PF_EacR11UnormBlock:
+		case PixelFormat::PF_EacR11SnormBlock:
+			blockSize = 8;
+			break;
+		case PixelFormat::PF_Bc2UnormBlock:
+		case PixelFormat::PF_Bc2SrgbBlock:
+		case PixelFormat::PF_Bc3UnormBlock:
+		case PixelFormat::PF_Bc3SrgbBlock:
+		case PixelFormat::PF_Bc5UnormBlock:
+		case PixelFormat::PF_Bc5SnormBlock:
+		case PixelFormat::PF_Bc6HUfloatBlock:
+		case PixelFormat::PF_Bc6HSfloatBlock:
+		case PixelFormat::PF_Bc7UnormBlock:
+		case PixelFormat::PF_Bc7SrgbBlock:
+		case PixelFormat::PF_Etc2R8G8B8A8UnormBlock:
+		case PixelFormat::PF_Etc2R8G8B8A8SrgbBlock:
+		case PixelFormat::PF_EacR11G11UnormBlock:
+		case PixelFormat::PF_EacR11G11SnormBlock:
+			blockSize = 16;
+			break;
+		default:
+			return 0;
+		}
+		return size_t((width + 3)/4)*size_t((height + 3)/4)*blockSize;
+	}
+
+	bool GenerateMipLevels(ImageData* pImage)
+	{
+		if (!SupportsUncompressedImage(pImage)) return false;
+
+		const uint32_t channels = pImage->GetBytesPerPixel();
+		std::vector<ImageData::MipLevel> levels;
+		size_t dataSize = 0;
+		uint32_t width = pImage->GetWidth();
+		uint32_t height = pImage->GetHeight();
+		while (true)
+		{
+			const size_t size = size_t(width)*height*channels;
+			levels.push_back({ width, height, dataSize, size });
+			dataSize += size;
+			if (width == 1 && height == 1) break;
+			width = std::max(width/2, 1u);
+			height = std::max(height/2, 1u);
+		}
+
+		char* pixels = new char[dataSize];
+		const char* source = static_cast<const char*>(pImage->GetPixels());
+		if (pImage->MipLevelCount()) source += pImage->GetMipLevel(0).m_Offset;
+		std::memcpy(pixels, source, levels[0].m_Size);
+
+		for (size_t i = 1; i < levels.size(); ++i)
+		{
+			const ImageData::MipLevel& previous = levels[i - 1];
+			const ImageData::MipLevel& level = levels[i];
+			const uint8_t* src = reinterpret_cast<const uint8_t*>(pixels + previous.m_Offset);
+			uint8_t* dst = reinterpret_cast<uint8_t*>(pixels + level.m_Offset);
+			for (uint32_t y = 0; y < level.m_Height; ++y)
+			{
+				const size_t y0 = std::min(y*2, previous.m_Height - 1);
+				const size_t y1 = std::min(y*2 + 1, previous.m_Height - 1);
+				for (uint32_t x = 0; x < level.m_Width; ++x)
+				{
+					const size_t x0 = std::min(x*2, previous.m_Width - 1);
+					const size_t x1 = std::min(x*2 + 1, previous.m_Width - 1);
+					for (uint32_t c = 0; c < channels; ++c)
+					{
+						const uint32_t sum = src[(y0*previous.m_Width + x0)*channels + c] +
+							src[(y0*previous.m_Width + x1)*channels + c] +
+							src[(y1*previous.m_Width + x0)*channels + c] +
+							src[(y1*previous.m_Width + x1)*channels + c];
+						dst[(size_t(y)*level.m_Width + x)*channels + c] = uint8_t((sum + 2)/4);
+					}
+				}
+			}
+		}
+
+		pImage->SetMipLevels(std::move(pixels), dataSize, pImage->GetInternalFormat(), std::move(levels));
+		return true;
+	}
+
+	PixelFormat ChooseBlockFormat(const ImageData* pImage, TextureUsage usage)
+	{
+		if (!SupportsUncompressedImage(pImage)) return PixelFormat::PF_Undefined;
+
+		/* BC1 quantizes all 3 axes of a normal together, BC5 stores X and Y separately at full precision */
+		if (usage == TextureUsage::Normal && pImage->GetBytesPerPixel() > 1)
+			return PixelFormat::PF_Bc5UnormBlock;
+
+		const bool srgb = usage == TextureUsage::Color && pImage->GetInternalFormat() == PixelFormat::PF_R8G8B8A8Srgb;
+		switch (pImage->GetBytesPerPixel())
+		{
+		case 1:
+			return pImage->GetInternalFormat() == PixelFormat::PF_R8Srgb ?
+				PixelFormat::PF_Undefined : PixelFormat::PF_Bc4UnormBlock;
+		case 2:
+			return pImage->GetInternalFormat() == PixelFormat::PF_R8G8Srgb ?
+				PixelFormat::PF_Undefined : PixelFormat::PF_Bc5UnormBlock;
+		case 4:
+			break;
+		default:
+			return PixelFormat::PF_Undefined;
+		}
+
+		const uint8_t* pixels = static_cast<const uint8_t*>(pImage->GetPixels());
+		if (pImage->MipLevelCount()) pixels += pImage->GetMipLevel(0).m_Offset;
+		const size_t pixelCount = size_t(pImage->GetWidth())*pImage->GetHeight();
+		for (size_t i = 0; i < pixelCount; ++i)
+		{
+			if (pixels[i*4 + 3] == 255) continue;
+			return srgb ? PixelFormat::PF_Bc7SrgbBlock : PixelFormat::PF_Bc7UnormBlock;
+		}
+		return srgb ? PixelFormat::PF_Bc1RgbSrgbBlock : PixelFormat::PF_Bc1RgbUnormBlock;
+	}
+
+	bool CompressImage(ImageData* pImage, PixelFormat format)
+	{
+		if (!SupportsUncompressedImage(pImage)) return false;
+
+		switch (format)
+		{
+		case PixelFormat::PF_Bc1RgbUnormBlock:
+		case PixelFormat::PF_Bc1RgbSrgbBlock:
+		case PixelFormat::PF_Bc3UnormBlock:
+		case PixelFormat::PF_Bc3SrgbBlock:
+		case PixelFormat::PF_Bc4UnormBlock:
+		case PixelFormat::PF_Bc5UnormBlock:
+		case PixelFormat::PF_Bc7UnormBlock:
+		case PixelFormat::PF_Bc7SrgbBlock:
+			break;
+		default:
+			return false;
+		}
+
+		const uint32_t channels = pImage->GetBytesPerPixel();
+		const std::vector<ImageData::MipLevel> sourceLevels = StoredLevels(pImage);
+		std::vector<ImageData::MipLevel> levels;
+		levels.reserve(sourceLevels.size());
+		size_t dataSize = 0;
+		for (const ImageData::MipLevel& level : sourceLevels)
+		{
+			const size_t size = BlockCompressedSize(format, level.m_Width, level.m_Height);
+			levels.push_back({ level.m_Width, level.m_Height, dataSize, size });
+			dataSize += size;
+		}
+
+		char* pixels = new char[dataSize];
+		const uint8_t* source = static_cast<const uint8_t*>(pImage->GetPixels());
+		Block block;
+		for (size_t i = 0; i < levels.size(); ++i)
+		{
+			const ImageData::MipLevel& sourceLevel = sourceLevels[i];
+			uint8_t* out = reinterpret_cast<uint8_t*>(pixels + levels[i].m_Offset);
+			const uint32_t blocksX = (sourceLevel.m_Width + 3)/4;
+			const uint32_t blocksY = (sourceLevel.m_Height + 3)/4;
+			for (uint32_t y = 0; y < blocksY; ++y)
+			{
+				for (uint32_t x = 0; x < blocksX; ++x)
+				{
+					FetchBlock(source + sourceLevel.m_Offset, sourceLevel.m_Width, sourceLevel.m_Height, channels, x, y, block);
+					switch (format)
+					{
+					case PixelFormat::PF_Bc1RgbUnormBlock:
+					case PixelFormat::PF_Bc1RgbSrgbBlock:
+						EncodeBC1(block, out);
+						out += 8;
+						break;
+					case PixelFormat::PF_Bc3UnormBlock:
+					case PixelFormat::PF_Bc3SrgbBlock:
+						EncodeBC4(block, 3, out);
+						EncodeBC1(block, out + 8);
+						out += 16;
+						break;
+					case PixelFormat::PF_Bc4UnormBlock:
+						EncodeBC4(block, 0, out);
+						out += 8;
+						break;
+					case PixelFormat::PF_Bc5UnormBlock:
+						EncodeBC4(block, 0, out);
+						EncodeBC4(block, 1, out + 8);
+						out += 16;
+						break;
+					default:
+						EncodeBC7(block, out);
+						out += 16;
+						break;
+					}
+				}
+			}
+		}
+
+		pImage->SetMipLevels(std::move(pixels), dataSize, format, std::move(levels));
+		return true;
+	}
+
+	bool DecodeImage(const ImageData* pImage, std::vector<uint8_t>& outPixels)
+	{
+		if (!pImage->GetPixels() || pImage->GetWidth() == 0 || pImage->GetHeight() == 0) return false;
+
+		const uint32_t width = pImage->GetWidth();
+		const uint32_t height = pImage->GetHeight();
+		const uint8_t* source = static_cast<const uint8_t*>(pImage->GetPixels());
+		if (pImage->MipLevelCount()) source += pImage->GetMipLevel(0).m_Offset;
+
+		if (!pImage->IsBlockCompressed())
+		{
+			if (!SupportsUncompressedImage(pImage)) return false;
+			const uint32_t channels = pImage->GetBytesPerPixel();
+			outPixels.assign(size_t(width)*height*4, 0);
+			for (size_t i = 0; i < size_t(width)*height; ++i)
+			{
+				for (uint32_t c = 0; c < channels; ++c)
+					outPixels[i*4 + c] = source[i*channels + c];
+				if (channels < 4) outPixels[i*4 + 3] = 255;
+			}
+			return true;
+		}
+
+		const PixelFormat format = pImage->GetInternalFormat();
+		size_t blockSize = 0;
+		switch (format)
+		{
+		case PixelFormat::PF_Bc1RgbUnormBlock:
+		case PixelFormat::PF_Bc1RgbSrgbBlock:
+		case PixelFormat::PF_Bc4UnormBlock:
+			blockSize = 8;
+			break;
+		case PixelFormat::PF_Bc3UnormBlock:
+		case PixelFormat::PF_Bc3SrgbBlock:
+		case PixelFormat::PF_Bc5UnormBlock:
+		case PixelFormat::PF_Bc7UnormBlock:
+		case PixelFormat::PF_Bc7SrgbBlock:
+			blockSize = 16;
+			break;
+		default:
+			return false;
+		}
+		if (pImage->DataSize() < BlockCompressedSize(format, width, height)) return false;
+
+		outPixels.assign(size_t(width)*height*4, 0);
+		const uint32_t blocksX = (width + 3)/4;
+		const uint32_t blocksY = (height + 3)/4;
+		DecodedBlock block;
+		for (uint32_t y = 0; y < blocksY; ++y)
+		{
+			for (uint32_t x = 0; x < blocksX; ++x)
+			{
+				const uint8_t* in = source + (size_t(y)*blocksX + x)*blockSize;
+				std::memset(block.m_Texels, 0, sizeof(block.m_Texels));
+				for (uint32_t i = 0; i < 16; ++i)
+					block.m_Texels[i][3] = 255;
+
+				switch (format)
+				{
+				case PixelFormat::PF_Bc1RgbUnormBlock:
+				case PixelFormat::PF_Bc1RgbSrgbBlock:
+					DecodeBC1(in, block);
+					break;
+				case PixelFormat::PF_Bc3UnormBlock:
+				case PixelFormat::PF_Bc3SrgbBlock:
+					DecodeBC4(in, 3, block);
+					DecodeBC1(in + 8, block);
+					break;
+				case PixelFormat::PF_Bc4UnormBlock:
+					DecodeBC4(in, 0, block);
+					break;
+				case PixelFormat::PF_Bc5UnormBlock:
+					DecodeBC4(in, 0, block);
+					DecodeBC4(in + 8, 1, block);
+					break;
+				default:
+					DecodeBC7(in, block);
+					break;
+				}
+
+				/* Texels of edge blocks that fall outside of the image are dropped */
+				for (uint32_t ty = 0; ty < 4 && y*4 + ty < height; ++ty)
+				{
+					for (uint32_t tx = 0; tx < 4 && x*4 + tx < width; ++tx)
+					{
+						const size_t pixel = size_t(y*4 + ty)*width + x*4 + tx;
+						std::memcpy(&outPixels[pixel*4], block.m_Texels[ty*4 + tx], 4);
+					}
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "GraphicsEnums.h"
+
+#include <engine_visibility.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+REFLECTABLE_ENUM_NS(Glory, TextureUsage, Color, Normal, Linear);
+
+namespace Glory
+{
+	class ImageData;
+
+	/**
+	 * @brief Size in bytes of an image in a block compressed format
+	 * @param format Block compressed format
+	 * @param width Width of the image in pixels
+	 * @param height Height of the image in pixels
+	 * @returns 0 if the format is not a supported block compressed format
+	 */
+	GLORY_ENGINE_API size_t BlockCompressedSize(PixelFormat format, uint32_t width, uint32_t height);
+
+	/**
+	 * @brief Replace the pixels of an image with a full chain of box filtered mip levels
+	 * @param pImage Image with 1, 2 or 4 unsigned byte channels per pixel
+	 * @returns false without changing the image if the format is not supported
+	 *
+	 * Each level is half the size of the previous one rounded down, the last level is 1x1.
+	 * Odd sizes repeat the last row or column so no pixels are dropped.
+	 */
+	GLORY_ENGINE_API bool GenerateMipLevels(ImageData* pImage);
+
+	/**
+	 * @brief Pick the block compressed format that best fits the channels and usage of an image
+	 * @param pImage Image with 1, 2 or 4 unsigned byte channels per pixel
+	 * @param usage What the texture is sampled as, normal maps only keep their X and Y channels
+	 * @returns BC4 for 1 channel, BC5 for 2 channels and normal maps, BC1 for opaque RGBA and BC7 for RGBA with alpha,
+	 * or PF_Undefined if the image can't be compressed
+	 *
+	 * Color textures keep the sRGB encoding of the image, linear textures and normal maps never use sRGB.
+	 */
+	GLORY_ENGINE_API PixelFormat ChooseBlockFormat(const ImageData* pImage, TextureUsage usage=TextureUsage::Color);
+
+	/**
+	 * @brief Encode all mip levels of an image to a block compressed format
+	 * @param pImage Image with 1, 2 or 4 unsigned byte channels per pixel
+	 * @param format BC1 (opaque), BC3, BC4, BC5 or BC7 format to encode to
+	 * @returns false without changing the image if the format is not supported
+	 *
+	 * Generate the mip levels first, the device can't generate them for compressed images.
+	 * BC7 only uses mode 6 which stores RGBA with a single pair of endpoints per block.
+	 */
+	GLORY_ENGINE_API bool CompressImage(ImageData* pImage, PixelFormat format);
+
+	/**
+	 * @brief Decode the first mip level of an image to 4 unsigned byte channels per pixel
+	 * @param pImage Uncompressed image with 1, 2 or 4 unsigned byte channels or an image compressed by @ref CompressImage
+	 * @param outPixels Receives width*height RGBA pixels
+	 * @returns false if the format is not supported
+	 *
+	 * Missing channels are 0 and alpha defaults to opaque, BC7 blocks in other modes than 6 decode to all zeroes.
+	 */
+	GLORY_ENGINE_API bool DecodeImage(const ImageData* pImage, std::vector<uint8_t>& outPixels);
+}
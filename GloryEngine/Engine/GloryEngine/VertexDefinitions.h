@@ -16,6 +16,22 @@ namespace Glory
 		SINT2,
 		SINT3,
 		SINT4,
+		/** @brief 2 half floats */
+		Half2,
+		/** @brief 4 half floats */
+		Half4,
+		/** @brief 4 unsigned bytes read as floats in [0, 1] */
+		UNorm8x4,
+		/** @brief 4 signed bytes read as floats in [-1, 1] */
+		SNorm8x4,
+		/** @brief 4 unsigned shorts read as floats in [0, 1] */
+		UNorm16x4,
+	};
+
+	enum class IndexType
+	{
+		UInt16,
+		UInt32,
 	};
 
 	enum class InputRate
@@ -1,6 +1,8 @@
 #pragma once
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 namespace Glory
 {
 	struct Vertex
@@ -44,4 +46,21 @@ namespace Glory
 		glm::vec2 TexCoord;
 		glm::vec4 Color;
 	};
-}
\ No newline at end of file
+
+	/** @brief Compressed layout of DefaultVertex3D that imported meshes are stored in */
+	struct CompactVertex3D
+	{
+		/** @brief UNorm16x4 position relative to the bounds of the mesh */
+		uint16_t Pos[4];
+		/** @brief SNorm8x4 */
+		int8_t Normal[4];
+		/** @brief SNorm8x4 */
+		int8_t Tangent[4];
+		/** @brief SNorm8x4 */
+		int8_t Bitangent[4];
+		/** @brief Half2 */
+		uint16_t TexCoord[2];
+		/** @brief UNorm8x4 */
+		uint8_t Color[4];
+	};
+}
@@ -0,0 +1,201 @@
+#include <Tester.h>
+
+#include <MeshOptimizer.h>
+#include <MeshData.h>
+
+#include <algorithm>
+#include <random>
+
+namespace Glory::Test
+{
+	class MeshOptimizerTest : public Utils::Tester
+	{
+	public:
+		MeshOptimizerTest();
+		virtual ~MeshOptimizerTest();
+
+	private:
+		void VertexCacheDeterministic();
+		void VertexCacheACMR();
+		void OverdrawDeterministic();
+		void VertexFetchPermutation();
+
+		void Initialize();
+		void Cleanup();
+
+	private:
+		static constexpr uint32_t GridSize = 32;
+		static constexpr size_t VertexFloats = 3;
+
+		std::vector<float> m_Positions;
+		std::vector<uint32_t> m_GridIndices;
+		std::vector<uint32_t> m_ShuffledIndices;
+	};
+
+	MeshOptimizerTest::MeshOptimizerTest()
+	{
+		AddTests({
+			&MeshOptimizerTest::VertexCacheDeterministic,
+			&MeshOptimizerTest::VertexCacheACMR,
+			&MeshOptimizerTest::OverdrawDeterministic,
+			&MeshOptimizerTest::VertexFetchPermutation,
+			}, &MeshOptimizerTest::Initialize, &MeshOptimizerTest::Cleanup);
+	}
+
+	MeshOptimizerTest::~MeshOptimizerTest()
+	{
+	}
+
+	void MeshOptimizerTest::VertexCacheDeterministic()
+	{
+		std::vector<uint32_t> first = m_ShuffledIndices;
+		std::vector<uint32_t> second = m_ShuffledIndices;
+		const size_t vertexCount = m_Positions.size()/VertexFloats;
+		OptimizeVertexCache(first.data(), first.size(), vertexCount);
+		OptimizeVertexCache(second.data(), second.size(), vertexCount);
+		GLORY_TEST_COMPARE_VECTORS(first, second);
+	}
+
+	void MeshOptimizerTest::VertexCacheACMR()
+	{
+		const size_t vertexCount = m_Positions.size()/VertexFloats;
+		for (const std::vector<uint32_t>& input : { m_GridIndices, m_ShuffledIndices })
+		{
+			std::vector<uint32_t> optimized = input;
+			OptimizeVertexCache(optimized.data(), optimized.size(), vertexCount);
+
+			/* Reordering triangles keeps all of their indices */
+			std::vector<uint32_t> sortedInput = input;
+			std::vector<uint32_t> sortedOptimized = optimized;
+			std::sort(sortedInput.begin(), sortedInput.end());
+			std::sort(sortedOptimized.begin(), sortedOptimized.end());
+			GLORY_TEST_COMPARE_VECTORS(sortedOptimized, sortedInput);
+
+			const VertexCacheStats before = AnalyzeVertexCache(input.data(), input.size(), vertexCount);
+			const VertexCacheStats after = AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount);
+			GLORY_TEST_COMPARE_CUSTOM(after.m_ACMR, before.m_ACMR, Utils::CompareLessOrEqual);
+			GLORY_TEST_COMPARE_CUSTOM(after.m_ATVR, 1.0f, Utils::CompareGreaterOrEqual);
+		}
+	}
+
+	void MeshOptimizerTest::OverdrawDeterministic()
+	{
+		const size_t vertexCount = m_Positions.size()/VertexFloats;
+		std::vector<uint32_t> first = m_ShuffledIndices;
+		OptimizeVertexCache(first.data(), first.size(), vertexCount);
+		std::vector<uint32_t> second = first;
+		OptimizeOverdraw(first.data(), first.size(), m_Positions.data(), vertexCount, VertexFloats*sizeof(float));
+		OptimizeOverdraw(second.data(), second.size(), m_Positions.data(), vertexCount, VertexFloats*sizeof(float));
+		GLORY_TEST_COMPARE_VECTORS(first, second);
+	}
+
+	void MeshOptimizerTest::VertexFetchPermutation()
+	{
+		/* Store the vertices in a random order with one vertex that no triangle uses */
+		const uint32_t vertexCount = uint32_t(m_Positions.size()/VertexFloats) + 1;
+		std::vector<uint32_t> order(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; ++i)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937{ 7 });
+
+		std::vector<float> vertices(vertexCount*VertexFloats, -1.0f);
+		std::vector<uint32_t> newIndex(vertexCount);
+		for (uint32_t i = 0; i + 1 < vertexCount; ++i)
+		{
+			newIndex[i] = order[i];
+			std::copy_n(&m_Positions[i*VertexFloats], VertexFloats, &vertices[order[i]*VertexFloats]);
+		}
+		const uint32_t unusedVertex = order[vertexCount - 1];
+
+		std::vector<uint32_t> indices = m_ShuffledIndices;
+		for (uint32_t& index : indices)
+			index = newIndex[index];
+
+		MeshData mesh{ vertexCount, uint32_t(VertexFloats*sizeof(float)), vertices,
+			uint32_t(indices.size()), indices, { AttributeType::Float3 } };
+		OptimizeVertexFetch(&mesh);
+
+		GLORY_TEST_COMPARE(mesh.VertexCount(), vertexCount);
+		GLORY_TEST_COMPARE(mesh.IndexCount(), uint32_t(indices.size()));
+
+		/* Every vertex is kept exactly once */
+		std::vector<float> sortedBefore = vertices;
+		std::vector<float> sortedAfter{ mesh.Vertices(), mesh.Vertices() + vertexCount*VertexFloats };
+		std::sort(sortedBefore.begin(), sortedBefore.end());
+		std::sort(sortedAfter.begin(), sortedAfter.end());
+		GLORY_TEST_COMPARE_VECTORS(sortedAfter, sortedBefore);
+
+		/* Remapped indices still point at the same positions */
+		std::vector<float> cornersBefore;
+		std::vector<float> cornersAfter;
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			cornersBefore.insert(cornersBefore.end(), &vertices[indices[i]*VertexFloats],
+				&vertices[indices[i]*VertexFloats] + VertexFloats);
+			const uint32_t index = mesh.Indices()[i];
+			GLORY_TEST_COMPARE_CUSTOM(index, vertexCount, Utils::CompareLess);
+			cornersAfter.insert(cornersAfter.end(), mesh.Vertices() + index*VertexFloats,
+				mesh.Vertices() + index*VertexFloats + VertexFloats);
+		}
+		GLORY_TEST_COMPARE_VECTORS(cornersAfter, cornersBefore);
+
+		/* Vertices are in the order the triangles first use them and the unused vertex is last */
+		uint32_t nextVertex = 0;
+		for (uint32_t i = 0; i < mesh.IndexCount(); ++i)
+		{
+			const uint32_t index = mesh.Indices()[i];
+			GLORY_TEST_COMPARE_CUSTOM(index, nextVertex, Utils::CompareLessOrEqual);
+			if (index == nextVertex) ++nextVertex;
+		}
+		GLORY_TEST_COMPARE(nextVertex, vertexCount - 1);
+		const float* pLast = mesh.Vertices() + (vertexCount - 1)*VertexFloats;
+		GLORY_TEST_COMPARE(pLast[0], vertices[unusedVertex*VertexFloats]);
+	}
+
+	void MeshOptimizerTest::Initialize()
+	{
+		/* Flat grid of quads made of 2 triangles each, in row order */
+		const uint32_t rowSize = GridSize + 1;
+		m_Positions.clear();
+		for (uint32_t y = 0; y < rowSize; ++y)
+		{
+			for (uint32_t x = 0; x < rowSize; ++x)
+				m_Positions.insert(m_Positions.end(), { float(x), 0.0f, float(y) });
+		}
+
+		m_GridIndices.clear();
+		for (uint32_t y = 0; y < GridSize; ++y)
+		{
+			for (uint32_t x = 0; x < GridSize; ++x)
+			{
+				const uint32_t v0 = y*rowSize + x;
+				const uint32_t v1 = v0 + 1;
+				const uint32_t v2 = v0 + rowSize;
+				const uint32_t v3 = v2 + 1;
+				m_GridIndices.insert(m_GridIndices.end(), { v0, v2, v1, v1, v2, v3 });
+			}
+		}
+
+		/* Same triangles in a random order, a seeded generator keeps the test reproducible */
+		const size_t triangleCount = m_GridIndices.size()/3;
+		std::vector<size_t> triangles(triangleCount);
+		for (size_t i = 0; i < triangleCount; ++i)
+			triangles[i] = i;
+		std::shuffle(triangles.begin(), triangles.end(), std::mt19937{ 42 });
+		m_ShuffledIndices.clear();
+		for (size_t triangle : triangles)
+		{
+			m_ShuffledIndices.insert(m_ShuffledIndices.end(), m_GridIndices.begin() + triangle*3,
+				m_GridIndices.begin() + triangle*3 + 3);
+		}
+	}
+
+	void MeshOptimizerTest::Cleanup()
+	{
+		m_Positions.clear();
+		m_GridIndices.clear();
+		m_ShuffledIndices.clear();
+	}
+}
+
+GLORY_TEST_MAIN(Glory::Test::MeshOptimizerTest)
@@ -0,0 +1,75 @@
+project "MeshOptimizerTest"
+	language "C++"
+	cppdialect "C++23"
+	staticruntime "Off"
+	kind "ConsoleApp"
+	debugdir "%{engineOutDir}/Tests"
+
+	targetdir ("%{engineOutDir}/Tests")
+	objdir ("%{outputDir}")
+
+	files
+	{
+		"*.h",
+		"*.cpp",
+		"premake5.lua"
+	}
+
+	includedirs
+	{
+		"%{DepsIncludeDir}",
+
+		"%{GloryIncludeDir.enginecore}",
+		"%{GloryIncludeDir.engine}",
+
+		"%{IncludeDir.TestFramework}",
+		"%{IncludeDir.CommandLine}",
+		"%{IncludeDir.glm}",
+		"%{IncludeDir.yaml_cpp}",
+		"%{IncludeDir.Reflect}",
+		"%{IncludeDir.Version}",
+		"%{IncludeDir.ECS}",
+		"%{IncludeDir.Utils}",
+	}
+
+	libdirs
+	{
+		"%{DepsLibDir}",
+
+		"%{LibDirs.glory}",
+		"%{LibDirs.yaml_cpp}",
+	}
+
+	links
+	{
+		"GloryEngineCore",
+		"GloryEngine",
+		"GloryTestFramework",
+		"GloryCommandLine",
+		"GloryReflect",
+		"GloryECS",
+		"GloryUtils",
+		"yaml-cpp",
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+		toolset "v143"
+
+	filter "platforms:Win32"
+		architecture "x86"
+		defines "WIN32"
+
+	filter "platforms:x64"
+		architecture "x64"
+
+	filter "configurations:Debug"
+		runtime "Debug"
+		defines "_DEBUG"
+		symbols "On"
+
+	filter "configurations:Release"
+		runtime "Release"
+		defines "NDEBUG"
+		optimize "On"
+		symbols "Off"
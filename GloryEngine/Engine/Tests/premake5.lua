@@ -0,0 +1 @@
+include "MeshOptimizerTest"
\ No newline at end of file
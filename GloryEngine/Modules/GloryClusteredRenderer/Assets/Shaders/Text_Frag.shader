@@ -8,8 +8,12 @@ struct Material
 {
 	vec4 Color;
 	float Shininess;
+	/* Atlas pixels covered by the distance field, 0 when the atlas stores coverage */
+	float DistanceRange;
 };
 
+#include "Internal/Material.glsl"
+
 layout(binding = 0) uniform sampler2D texSampler;
 
 layout(location = 0) in vec4 inColor;
@@ -24,7 +28,14 @@ layout(location = 5) out vec4 outData;
 void main()
 {
 	float pixel = texture(texSampler, fragTexCoord).r;
-	if (pixel < 1.0) discard;
+	Material material = GetMaterial();
+	if (material.DistanceRange > 0.0)
+	{
+		/* The outline is at 0.5, sharp at any scale and under any transform */
+		if (pixel < 0.5) discard;
+		pixel = 1.0;
+	}
+	else if (pixel < 1.0) discard;
 	outColor = pixel*inColor;
 	outNormal = vec4((normalize(inNormal) + 1.0)*0.5, 1.0);
 	outID = Constants.ObjectID;
@@ -7,6 +7,8 @@
 #include <Debug.h>
 #include <GloryAssert.h>
 
+#include <cstring>
+
 namespace Glory
 {
 #define COMMAND_CASES() \
@@ -27,7 +29,8 @@ namespace Glory
 	X(SetScissor);\
 	X(PipelineBarrier);\
 	X(CopyImage);\
-	X(CopyImageToBuffer);
+	X(CopyImageToBuffer);\
+	X(CopyBuffer);
 
 #define X(type) \
 	case GLCommandType::type:\
@@ -53,7 +56,8 @@ namespace Glory
 
 	void OpenGLCommandImpl::Begin_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData&)
 	{
-		/* Nothing to do here */
+		/* Other code may have changed GL state since the last command buffer ran */
+		device.m_GLState.Invalidate();
 	}
 
 	void OpenGLCommandImpl::BeginRenderPass_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
@@ -71,19 +75,19 @@ namespace Glory
 			return;
 		}
 
-		glDisable(GL_SCISSOR_TEST);
-		glBindFramebuffer(GL_FRAMEBUFFER, glRenderTexture->m_GLFramebufferID);
-		glViewport(0, 0, glRenderTexture->m_Info.Width, glRenderTexture->m_Info.Height);
-		OpenGLGraphicsModule::LogGLError(glGetError());
+		OpenGLStateCache& state = device.m_GLState;
+		state.SetEnabled(GL_SCISSOR_TEST, false);
+		state.BindFramebuffer(glRenderTexture->m_GLFramebufferID);
+		state.Viewport(0, 0, int32_t(glRenderTexture->m_Info.Width), int32_t(glRenderTexture->m_Info.Height));
 
 		const bool hasDepth = glRenderTexture->m_Info.HasDepth;
 		const bool hasStencil = glRenderTexture->m_Info.HasStencil;
 		const bool hasStencilOrDepth = hasDepth || hasStencil;
 		const bool hasColor = glRenderTexture->m_Textures.size() > hasStencilOrDepth ? 1 : 0;
 
-		glColorMask(hasColor, hasColor, hasColor, hasColor);
-		glDepthMask(hasDepth);
-		glStencilMask(hasStencil);
+		state.ColorMask(hasColor, hasColor, hasColor, hasColor);
+		state.DepthMask(hasDepth);
+		state.StencilMask(hasStencil);
 
 		if (!glRenderPass->m_Clear)
 		{
@@ -121,75 +125,67 @@ namespace Glory
 			return;
 		}
 
-		glUseProgram(glPipeline->m_GLProgramID);
-		OpenGLGraphicsModule::LogGLError(glGetError());
+		OpenGLStateCache& state = device.m_GLState;
+		state.UseProgram(glPipeline->m_GLProgramID);
 
+		state.SetEnabled(GL_CULL_FACE, glPipeline->m_GLCullFace != 0);
 		if (glPipeline->m_GLCullFace != 0)
-		{
-			glEnable(GL_CULL_FACE);
-			glCullFace(glPipeline->m_GLCullFace);
-		}
-		else glDisable(GL_CULL_FACE);
-		glDisable(GL_SCISSOR_TEST);
-
-		if (glPipeline->m_SettingToggles.IsSet(PipelineData::DepthTestEnable))
-		{
-			glEnable(GL_DEPTH_TEST);
-			glDepthFunc(glPipeline->m_GLDepthFunc);
-		}
-		else
-			glDisable(GL_DEPTH_TEST);
-		glDepthMask(glPipeline->m_SettingToggles.IsSet(PipelineData::DepthWriteEnable));
+			state.CullFace(glPipeline->m_GLCullFace);
+		state.SetEnabled(GL_SCISSOR_TEST, false);
+
+		const bool depthTest = glPipeline->m_SettingToggles.IsSet(PipelineData::DepthTestEnable);
+		state.SetEnabled(GL_DEPTH_TEST, depthTest);
+		if (depthTest)
+			state.DepthFunc(glPipeline->m_GLDepthFunc);
+		state.DepthMask(glPipeline->m_SettingToggles.IsSet(PipelineData::DepthWriteEnable));
 		commandBuffer.m_GLCurrentPrimitives = glPipeline->m_GLPrimitiveType;
 
 		const bool r = glPipeline->m_SettingToggles.IsSet(PipelineData::ColorWriteRed);
 		const bool g = glPipeline->m_SettingToggles.IsSet(PipelineData::ColorWriteGreen);
 		const bool b = glPipeline->m_SettingToggles.IsSet(PipelineData::ColorWriteBlue);
 		const bool a = glPipeline->m_SettingToggles.IsSet(PipelineData::ColorWriteAlpha);
-		glColorMask(r, g, b, a);
+		state.ColorMask(r, g, b, a);
 
-		if (glPipeline->m_SettingToggles.IsSet(PipelineData::BlendEnable))
+		const bool blend = glPipeline->m_SettingToggles.IsSet(PipelineData::BlendEnable);
+		state.SetEnabled(GL_BLEND, blend);
+		if (blend)
 		{
-			glEnable(GL_BLEND);
-			glBlendFuncSeparate(glPipeline->m_GLSrcColorBlendFactor, glPipeline->m_GLDstColorBlendFactor,
+			state.BlendFuncSeparate(glPipeline->m_GLSrcColorBlendFactor, glPipeline->m_GLDstColorBlendFactor,
 				glPipeline->m_GLSrcAlphaBlendFactor, glPipeline->m_GLDstAlphaBlendFactor);
-			glBlendEquationSeparate(glPipeline->m_GLColorBlendOp, glPipeline->m_GLAlphaBlendOp);
-			glBlendColor(glPipeline->m_BlendConstants.r, glPipeline->m_BlendConstants.g,
-				glPipeline->m_BlendConstants.b, glPipeline->m_BlendConstants.a);
+			state.BlendEquationSeparate(glPipeline->m_GLColorBlendOp, glPipeline->m_GLAlphaBlendOp);
+			state.BlendColor(glPipeline->m_BlendConstants);
 		}
-		else
-			glDisable(GL_BLEND);
 
-		if (glPipeline->m_SettingToggles.IsSet(PipelineData::StencilTestEnable))
+		const bool stencilTest = glPipeline->m_SettingToggles.IsSet(PipelineData::StencilTestEnable);
+		state.SetEnabled(GL_STENCIL_TEST, stencilTest);
+		if (stencilTest)
 		{
-			glEnable(GL_STENCIL_TEST);
 			const uint8_t compareMask = static_cast<uint8_t>(*glPipeline->m_SettingToggles.Data() >> PipelineData::StencilCompareMaskBegin);
 			const uint8_t ref = static_cast<uint8_t>(*glPipeline->m_SettingToggles.Data() >> PipelineData::StencilReferenceBegin);
-			glStencilOp(glPipeline->m_GLStencilFailOp, glPipeline->m_GLStencilDepthFailOp, glPipeline->m_GLStencilPassOp);
-			glStencilFunc(glPipeline->m_GLStencilCompareOp, int32_t(ref), uint32_t(compareMask));
+			state.StencilOp(glPipeline->m_GLStencilFailOp, glPipeline->m_GLStencilDepthFailOp, glPipeline->m_GLStencilPassOp);
+			state.StencilFunc(glPipeline->m_GLStencilCompareOp, int32_t(ref), uint32_t(compareMask));
 		}
-		else
-			glDisable(GL_STENCIL_TEST);
 
 		const uint8_t writeMask = static_cast<uint8_t>(*glPipeline->m_SettingToggles.Data() >> PipelineData::StencilWriteMaskBegin);
-		glStencilMask(uint32_t(writeMask));
+		state.StencilMask(uint32_t(writeMask));
 	}
 
 	void OpenGLCommandImpl::End_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData&)
 	{
-		/* Nothing to do here */
+		/* Leave GL in its default state for code running outside of command buffers */
+		device.m_GLState.RestoreDefaultBindings();
 	}
 
 	void OpenGLCommandImpl::EndRenderPass_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData&)
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, NULL);
-		OpenGLGraphicsModule::LogGLError(glGetError());
+		/* The framebuffer stays bound so the next pass can skip rebinding it if it is the same,
+		 * it is unbound when the command buffer ends */
 	}
 
 	void OpenGLCommandImpl::EndPipeline_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData&)
 	{
-		glUseProgram(NULL);
-		OpenGLGraphicsModule::LogGLError(glGetError());
+		/* The program stays bound so the next pipeline can skip rebinding it if it is the same,
+		 * it is unbound when the command buffer ends */
 	}
 
 	void OpenGLCommandImpl::BindDescriptorSets_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
@@ -215,6 +211,7 @@ namespace Glory
 			return;
 		}
 
+		OpenGLStateCache& state = device.m_GLState;
 		size_t index = 0;
 		for (size_t i = 0; i < glSet->m_Buffers.size(); ++i)
 		{
@@ -225,8 +222,7 @@ namespace Glory
 				return;
 			}
 
-			glBindBufferBase(glBuffer->m_GLTarget, (GLuint)glSetLayout->m_BindingIndices[index], glBuffer->m_GLBufferID);
-			OpenGLGraphicsModule::LogGLError(glGetError());
+			state.BindBufferBase(glBuffer->m_GLTarget, glSetLayout->m_BindingIndices[index], glBuffer->m_GLBufferID);
 			++index;
 		}
 
@@ -235,36 +231,33 @@ namespace Glory
 			if (glSet->m_BindlessTexturesBuffers[i])
 			{
 				GL_Buffer* glBuffer = device.m_Buffers.Find(glSet->m_BindlessTexturesBuffers[i]);
-				glBindBufferBase(glBuffer->m_GLTarget, (GLuint)glSetLayout->m_BindingIndices[index], glBuffer->m_GLBufferID);
-				OpenGLGraphicsModule::LogGLError(glGetError());
+				state.BindBufferBase(glBuffer->m_GLTarget, glSetLayout->m_BindingIndices[index], glBuffer->m_GLBufferID);
 				++index;
 				continue;
 			}
 
-			GL_Texture* glTexture = device.m_Textures.Find(glSet->m_Textures[i]);
-			GLuint texLocation = glGetUniformLocation(glPipeline->m_GLProgramID, glSetLayout->m_SamplerNames[i].c_str());
-			OpenGLGraphicsModule::LogGLError(glGetError());
-			glUniform1i(texLocation, glSetLayout->m_BindingIndices[index]);
-			OpenGLGraphicsModule::LogGLError(glGetError());
-
-			glActiveTexture(GL_TEXTURE0 + glSetLayout->m_BindingIndices[index]);
-			OpenGLGraphicsModule::LogGLError(glGetError());
-			glBindTexture(glTexture ? glTexture->m_GLTextureType : GL_TEXTURE_2D, glTexture ? glTexture->m_GLTextureID : 0);
-			OpenGLGraphicsModule::LogGLError(glGetError());
+			const uint32_t unit = glSetLayout->m_BindingIndices[index];
+			auto samplerIter = glPipeline->m_SamplerUnits.find(glSetLayout->m_SamplerNames[i]);
+			if (samplerIter == glPipeline->m_SamplerUnits.end() || samplerIter->second != unit)
+			{
+				const GLint texLocation = glGetUniformLocation(glPipeline->m_GLProgramID, glSetLayout->m_SamplerNames[i].c_str());
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				glProgramUniform1i(glPipeline->m_GLProgramID, texLocation, GLint(unit));
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				glPipeline->m_SamplerUnits[glSetLayout->m_SamplerNames[i]] = unit;
+			}
 
-			glActiveTexture(GL_TEXTURE0);
-			OpenGLGraphicsModule::LogGLError(glGetError());
+			GL_Texture* glTexture = device.m_Textures.Find(glSet->m_Textures[i]);
+			state.BindTexture(unit, glTexture ? glTexture->m_GLTextureType : GL_TEXTURE_2D, glTexture ? glTexture->m_GLTextureID : 0);
 			++index;
 		}
 	}
 
-	void OpenGLCommandImpl::PushConstants_Impl(OpenGLDevice& device, const GL_CommandBuffer& commandBuffer, const GL_CommandData& data)
+	void OpenGLCommandImpl::PushConstants_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
 	{
 		GL_Buffer* glBuffer = device.m_Buffers.Find(device.m_ConstantsBuffer);
-		auto& constantsData = commandBuffer.m_PushConstantData[data.m_PushConstantsDataIndex];
-		device.AssignBuffer(device.m_ConstantsBuffer, constantsData.data(), data.m_PushConstantsOffset, data.m_PushConstantsSize);
-		glBindBufferBase(glBuffer->m_GLTarget, 0, glBuffer->m_GLBufferID);
-		OpenGLGraphicsModule::LogGLError(glGetError());
+		device.AssignBuffer(device.m_ConstantsBuffer, data.m_InlineData, data.m_PushConstantsOffset, data.m_PushConstantsSize);
+		device.m_GLState.BindBufferBase(glBuffer->m_GLTarget, 0, glBuffer->m_GLBufferID);
 	}
 
 	void OpenGLCommandImpl::DrawMesh_Impl(OpenGLDevice& device, const GL_CommandBuffer& commandBuffer, const GL_CommandData& data)
@@ -276,20 +269,23 @@ namespace Glory
 			return;
 		}
 
-		glBindVertexArray(mesh->m_GLVertexArrayID);
-		OpenGLGraphicsModule::LogGLError(glGetError());
+		/* Stays bound until another mesh is drawn or the command buffer ends */
+		device.m_GLState.BindVertexArray(mesh->m_GLVertexArrayID);
 
 		++device.m_CurrentDrawCalls;
 		device.m_CurrentVertices += mesh->m_VertexCount;
 		if (mesh->m_IndexCount == 0) glDrawArrays(commandBuffer.m_GLCurrentPrimitives, 0, mesh->m_VertexCount);
 		else
 		{
-			glDrawElements(commandBuffer.m_GLCurrentPrimitives, mesh->m_IndexCount, GL_UNSIGNED_INT, NULL);
-			device.m_CurrentTriangles += mesh->m_IndexCount / 3;
+			/* A LOD range may lie past the indices of the full mesh */
+			const uint32_t indexCount = data.m_DrawIndexCount == UINT32_MAX ? mesh->m_IndexCount : data.m_DrawIndexCount;
+			const bool shortIndices = mesh->m_IndexType == IndexType::UInt16;
+			const size_t indexStride = shortIndices ? sizeof(GLushort) : sizeof(GLuint);
+			const void* offset = reinterpret_cast<const void*>(size_t(data.m_FirstIndex)*indexStride);
+			glDrawElements(commandBuffer.m_GLCurrentPrimitives, indexCount, shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, offset);
+			device.m_CurrentTriangles += indexCount / 3;
 		}
 		OpenGLGraphicsModule::LogGLError(glGetError());
-		glBindVertexArray(NULL);
-		OpenGLGraphicsModule::LogGLError(glGetError());
 	}
 
 	void OpenGLCommandImpl::Dispatch_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
@@ -300,10 +296,7 @@ namespace Glory
 
 	void OpenGLCommandImpl::SetStencilTestEnabled_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
 	{
-		if (data.m_Enable)
-			glEnable(GL_STENCIL_TEST);
-		else
-			glDisable(GL_STENCIL_TEST);
+		device.m_GLState.SetEnabled(GL_STENCIL_TEST, data.m_Enable);
 	}
 
 	void OpenGLCommandImpl::SetStencilOp_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
@@ -312,33 +305,35 @@ namespace Glory
 		const GLenum glFail = GLFuncs.at(Func(data.m_Fail));
 		const GLenum glDepthFail = GLFuncs.at(Func(data.m_DepthFail));
 		const GLenum glPass = GLFuncs.at(Func(data.m_Pass));
-		glStencilOp(glFail, glDepthFail, glPass);
-		glStencilFunc(glCompareOp, GLint(data.m_Reference), GLuint(data.m_Mask));
+		device.m_GLState.StencilOp(glFail, glDepthFail, glPass);
+		device.m_GLState.StencilFunc(glCompareOp, GLint(data.m_Reference), GLuint(data.m_Mask));
 	}
 
 	void OpenGLCommandImpl::SetStencilWriteMask_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
 	{
-		glStencilMask(GLuint(data.m_Mask));
+		device.m_GLState.StencilMask(GLuint(data.m_Mask));
 	}
 
 	void OpenGLCommandImpl::Commit_Impl(OpenGLDevice& device, const GL_CommandBuffer& commandBuffer)
 	{
-		for (size_t i = 0; i < commandBuffer.m_CommandsSize; ++i)
+		GL_CommandData data;
+		size_t offset = 0;
+		while (offset < commandBuffer.m_CommandStream.size())
 		{
-			const GL_CommandData& data = commandBuffer.m_Commands[i];
+			offset = commandBuffer.Read(offset, data);
 			Command_Impl(device, commandBuffer, data);
 		}
 	}
 
 	void OpenGLCommandImpl::SetViewport_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
 	{
-		glViewport(int(data.m_XYZFloat.x), int(data.m_XYZFloat.y), uint32_t(data.m_XYZFloat.z), uint32_t(data.m_XYZFloat.w));
+		device.m_GLState.Viewport(int(data.m_XYZFloat.x), int(data.m_XYZFloat.y), int(data.m_XYZFloat.z), int(data.m_XYZFloat.w));
 	}
 
 	void OpenGLCommandImpl::SetScissor_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
 	{
-		glEnable(GL_SCISSOR_TEST);
-		glScissor(data.m_XYZSigned.x, data.m_XYZSigned.y, data.m_XYZSigned.z, data.m_XYZSigned.w);
+		device.m_GLState.SetEnabled(GL_SCISSOR_TEST, true);
+		device.m_GLState.Scissor(int32_t(data.m_XYZSigned.x), int32_t(data.m_XYZSigned.y), int32_t(data.m_XYZSigned.z), int32_t(data.m_XYZSigned.w));
 	}
 
 	void OpenGLCommandImpl::PipelineBarrier_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
@@ -384,12 +379,38 @@ namespace Glory
 
 		glBindBuffer(GL_PIXEL_PACK_BUFFER, glDstBuffer->m_GLBufferID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
-		glBindTexture(GL_TEXTURE_2D, glSrcTexture->m_GLTextureID);
-		OpenGLGraphicsModule::LogGLError(glGetError());
+		device.m_GLState.BindTexture(0, GL_TEXTURE_2D, glSrcTexture->m_GLTextureID);
 		glGetTexImage(GL_TEXTURE_2D, 0, glSrcTexture->m_GLFormat, glSrcTexture->m_GLDataType, (void*)(0));
 		OpenGLGraphicsModule::LogGLError(glGetError());
 
 		glBindBuffer(GL_PIXEL_PACK_BUFFER, NULL);
-		glBindTexture(GL_TEXTURE_2D, NULL);
+	}
+
+	void OpenGLCommandImpl::CopyBuffer_Impl(OpenGLDevice& device, const GL_CommandBuffer&, const GL_CommandData& data)
+	{
+		GL_Buffer* glSrcBuffer = device.m_Buffers.Find(data.m_SrcBuffer);
+		GL_Buffer* glDstBuffer = device.m_Buffers.Find(data.m_DstBuffer);
+		if (!glSrcBuffer)
+		{
+			device.Debug().LogError("OpenGLCommandImpl::CopyBuffer: Invalid src buffer handle.");
+			return;
+		}
+		if (!glDstBuffer)
+		{
+			device.Debug().LogError("OpenGLCommandImpl::CopyBuffer: Invalid dst buffer handle.");
+			return;
+		}
+
+		glm::uvec3 region;
+		std::memcpy(&region, data.m_InlineData, sizeof(glm::uvec3));
+		glBindBuffer(GL_COPY_READ_BUFFER, glSrcBuffer->m_GLBufferID);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, glDstBuffer->m_GLBufferID);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, region.x, region.y, region.z);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+
+		glBindBuffer(GL_COPY_READ_BUFFER, NULL);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, NULL);
 	}
 }
\ No newline at end of file
@@ -30,5 +30,6 @@ namespace Glory
         static void PipelineBarrier_Impl(OpenGLDevice& device, const GL_CommandBuffer& commandBuffer, const GL_CommandData& data);
         static void CopyImage_Impl(OpenGLDevice& device, const GL_CommandBuffer& commandBuffer, const GL_CommandData& data);
         static void CopyImageToBuffer_Impl(OpenGLDevice& device, const GL_CommandBuffer& commandBuffer, const GL_CommandData& data);
+        static void CopyBuffer_Impl(OpenGLDevice& device, const GL_CommandBuffer& commandBuffer, const GL_CommandData& data);
     };
 }
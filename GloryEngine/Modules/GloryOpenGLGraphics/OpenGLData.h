@@ -162,60 +162,60 @@ namespace Glory
 		{ PixelFormat::PF_D16UnormS8Uint,            0 },
 		{ PixelFormat::PF_D24UnormS8Uint,            0 },
 		{ PixelFormat::PF_D32SfloatS8Uint,           0 },
-		{ PixelFormat::PF_Bc1RgbUnormBlock,          0 },
-		{ PixelFormat::PF_Bc1RgbSrgbBlock,           0 },
-		{ PixelFormat::PF_Bc1RgbaUnormBlock,         0 },
-		{ PixelFormat::PF_Bc1RgbaSrgbBlock,          0 },
-		{ PixelFormat::PF_Bc2UnormBlock,             0 },
-		{ PixelFormat::PF_Bc2SrgbBlock,              0 },
-		{ PixelFormat::PF_Bc3UnormBlock,             0 },
-		{ PixelFormat::PF_Bc3SrgbBlock,              0 },
-		{ PixelFormat::PF_Bc4UnormBlock,             0 },
-		{ PixelFormat::PF_Bc4SnormBlock,             0 },
-		{ PixelFormat::PF_Bc5UnormBlock,             0 },
-		{ PixelFormat::PF_Bc5SnormBlock,             0 },
-		{ PixelFormat::PF_Bc6HUfloatBlock,           0 },
-		{ PixelFormat::PF_Bc6HSfloatBlock,           0 },
-		{ PixelFormat::PF_Bc7UnormBlock,             0 },
-		{ PixelFormat::PF_Bc7SrgbBlock,              0 },
-		{ PixelFormat::PF_Etc2R8G8B8UnormBlock,      0 },
-		{ PixelFormat::PF_Etc2R8G8B8SrgbBlock,       0 },
-		{ PixelFormat::PF_Etc2R8G8B8A1UnormBlock,    0 },
-		{ PixelFormat::PF_Etc2R8G8B8A1SrgbBlock,     0 },
-		{ PixelFormat::PF_Etc2R8G8B8A8UnormBlock,    0 },
-		{ PixelFormat::PF_Etc2R8G8B8A8SrgbBlock,     0 },
-		{ PixelFormat::PF_EacR11UnormBlock,          0 },
-		{ PixelFormat::PF_EacR11SnormBlock,          0 },
-		{ PixelFormat::PF_EacR11G11UnormBlock,       0 },
-		{ PixelFormat::PF_EacR11G11SnormBlock,       0 },
-		{ PixelFormat::PF_Astc4x4UnormBlock,         0 },
-		{ PixelFormat::PF_Astc4x4SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc5x4UnormBlock,         0 },
-		{ PixelFormat::PF_Astc5x4SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc5x5UnormBlock,         0 },
-		{ PixelFormat::PF_Astc5x5SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc6x5UnormBlock,         0 },
-		{ PixelFormat::PF_Astc6x5SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc6x6UnormBlock,         0 },
-		{ PixelFormat::PF_Astc6x6SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc8x5UnormBlock,         0 },
-		{ PixelFormat::PF_Astc8x5SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc8x6UnormBlock,         0 },
-		{ PixelFormat::PF_Astc8x6SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc8x8UnormBlock,         0 },
-		{ PixelFormat::PF_Astc8x8SrgbBlock,          0 },
-		{ PixelFormat::PF_Astc10x5UnormBlock,        0 },
-		{ PixelFormat::PF_Astc10x5SrgbBlock,         0 },
-		{ PixelFormat::PF_Astc10x6UnormBlock,        0 },
-		{ PixelFormat::PF_Astc10x6SrgbBlock,         0 },
-		{ PixelFormat::PF_Astc10x8UnormBlock,        0 },
-		{ PixelFormat::PF_Astc10x8SrgbBlock,         0 },
-		{ PixelFormat::PF_Astc10x10UnormBlock,       0 },
-		{ PixelFormat::PF_Astc10x10SrgbBlock,        0 },
-		{ PixelFormat::PF_Astc12x10UnormBlock,       0 },
-		{ PixelFormat::PF_Astc12x10SrgbBlock,        0 },
-		{ PixelFormat::PF_Astc12x12UnormBlock,       0 },
-		{ PixelFormat::PF_Astc12x12SrgbBlock,        0 },
+		{ PixelFormat::PF_Bc1RgbUnormBlock,          GL_COMPRESSED_RGB_S3TC_DXT1_EXT },
+		{ PixelFormat::PF_Bc1RgbSrgbBlock,           GL_COMPRESSED_SRGB_S3TC_DXT1_EXT },
+		{ PixelFormat::PF_Bc1RgbaUnormBlock,         GL_COMPRESSED_RGBA_S3TC_DXT1_EXT },
+		{ PixelFormat::PF_Bc1RgbaSrgbBlock,          GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT },
+		{ PixelFormat::PF_Bc2UnormBlock,             GL_COMPRESSED_RGBA_S3TC_DXT3_EXT },
+		{ PixelFormat::PF_Bc2SrgbBlock,              GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT },
+		{ PixelFormat::PF_Bc3UnormBlock,             GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },
+		{ PixelFormat::PF_Bc3SrgbBlock,              GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT },
+		{ PixelFormat::PF_Bc4UnormBlock,             GL_COMPRESSED_RED_RGTC1 },
+		{ PixelFormat::PF_Bc4SnormBlock,             GL_COMPRESSED_SIGNED_RED_RGTC1 },
+		{ PixelFormat::PF_Bc5UnormBlock,             GL_COMPRESSED_RG_RGTC2 },
+		{ PixelFormat::PF_Bc5SnormBlock,             GL_COMPRESSED_SIGNED_RG_RGTC2 },
+		{ PixelFormat::PF_Bc6HUfloatBlock,           GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT },
+		{ PixelFormat::PF_Bc6HSfloatBlock,           GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT },
+		{ PixelFormat::PF_Bc7UnormBlock,             GL_COMPRESSED_RGBA_BPTC_UNORM },
+		{ PixelFormat::PF_Bc7SrgbBlock,              GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM },
+		{ PixelFormat::PF_Etc2R8G8B8UnormBlock,      GL_COMPRESSED_RGB8_ETC2 },
+		{ PixelFormat::PF_Etc2R8G8B8SrgbBlock,       GL_COMPRESSED_SRGB8_ETC2 },
+		{ PixelFormat::PF_Etc2R8G8B8A1UnormBlock,    GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 },
+		{ PixelFormat::PF_Etc2R8G8B8A1SrgbBlock,     GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2 },
+		{ PixelFormat::PF_Etc2R8G8B8A8UnormBlock,    GL_COMPRESSED_RGBA8_ETC2_EAC },
+		{ PixelFormat::PF_Etc2R8G8B8A8SrgbBlock,     GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC },
+		{ PixelFormat::PF_EacR11UnormBlock,          GL_COMPRESSED_R11_EAC },
+		{ PixelFormat::PF_EacR11SnormBlock,          GL_COMPRESSED_SIGNED_R11_EAC },
+		{ PixelFormat::PF_EacR11G11UnormBlock,       GL_COMPRESSED_RG11_EAC },
+		{ PixelFormat::PF_EacR11G11SnormBlock,       GL_COMPRESSED_SIGNED_RG11_EAC },
+		{ PixelFormat::PF_Astc4x4UnormBlock,         GL_COMPRESSED_RGBA_ASTC_4x4_KHR },
+		{ PixelFormat::PF_Astc4x4SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR },
+		{ PixelFormat::PF_Astc5x4UnormBlock,         GL_COMPRESSED_RGBA_ASTC_5x4_KHR },
+		{ PixelFormat::PF_Astc5x4SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR },
+		{ PixelFormat::PF_Astc5x5UnormBlock,         GL_COMPRESSED_RGBA_ASTC_5x5_KHR },
+		{ PixelFormat::PF_Astc5x5SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR },
+		{ PixelFormat::PF_Astc6x5UnormBlock,         GL_COMPRESSED_RGBA_ASTC_6x5_KHR },
+		{ PixelFormat::PF_Astc6x5SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR },
+		{ PixelFormat::PF_Astc6x6UnormBlock,         GL_COMPRESSED_RGBA_ASTC_6x6_KHR },
+		{ PixelFormat::PF_Astc6x6SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR },
+		{ PixelFormat::PF_Astc8x5UnormBlock,         GL_COMPRESSED_RGBA_ASTC_8x5_KHR },
+		{ PixelFormat::PF_Astc8x5SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR },
+		{ PixelFormat::PF_Astc8x6UnormBlock,         GL_COMPRESSED_RGBA_ASTC_8x6_KHR },
+		{ PixelFormat::PF_Astc8x6SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR },
+		{ PixelFormat::PF_Astc8x8UnormBlock,         GL_COMPRESSED_RGBA_ASTC_8x8_KHR },
+		{ PixelFormat::PF_Astc8x8SrgbBlock,          GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR },
+		{ PixelFormat::PF_Astc10x5UnormBlock,        GL_COMPRESSED_RGBA_ASTC_10x5_KHR },
+		{ PixelFormat::PF_Astc10x5SrgbBlock,         GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR },
+		{ PixelFormat::PF_Astc10x6UnormBlock,        GL_COMPRESSED_RGBA_ASTC_10x6_KHR },
+		{ PixelFormat::PF_Astc10x6SrgbBlock,         GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR },
+		{ PixelFormat::PF_Astc10x8UnormBlock,        GL_COMPRESSED_RGBA_ASTC_10x8_KHR },
+		{ PixelFormat::PF_Astc10x8SrgbBlock,         GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR },
+		{ PixelFormat::PF_Astc10x10UnormBlock,       GL_COMPRESSED_RGBA_ASTC_10x10_KHR },
+		{ PixelFormat::PF_Astc10x10SrgbBlock,        GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR },
+		{ PixelFormat::PF_Astc12x10UnormBlock,       GL_COMPRESSED_RGBA_ASTC_12x10_KHR },
+		{ PixelFormat::PF_Astc12x10SrgbBlock,        GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR },
+		{ PixelFormat::PF_Astc12x12UnormBlock,       GL_COMPRESSED_RGBA_ASTC_12x12_KHR },
+		{ PixelFormat::PF_Astc12x12SrgbBlock,        GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR },
 		{ PixelFormat::PF_Depth16,                   GL_DEPTH_COMPONENT16 },
 		{ PixelFormat::PF_Depth24,                   GL_DEPTH_COMPONENT24 },
 		{ PixelFormat::PF_Depth32,                   GL_DEPTH_COMPONENT32 },
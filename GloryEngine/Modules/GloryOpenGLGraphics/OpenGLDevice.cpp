@@ -17,10 +17,146 @@
 
 namespace Glory
 {
+	namespace
+	{
+		/* Parts of GL_CommandData that a command type stores in the stream */
+		enum CommandPayload : uint8_t
+		{
+			CP_None = 0,
+			/* First union, handles and stencil/flag data */
+			CP_Header = 1 << 0,
+			/* First and second half of the second union */
+			CP_DataLow = 1 << 1,
+			CP_DataHigh = 1 << 2,
+			CP_Data = CP_DataLow | CP_DataHigh,
+		};
+
+		constexpr size_t CommandPartSize = sizeof(uint64_t);
+
+		uint8_t GetCommandPayload(GLCommandType type)
+		{
+			switch (type)
+			{
+			case GLCommandType::BeginRenderPass:
+			case GLCommandType::BeginPipeline:
+			case GLCommandType::SetStencilTestEnabled:
+			case GLCommandType::SetStencilOp:
+			case GLCommandType::SetStencilWriteMask:
+			case GLCommandType::PipelineBarrier:
+				return CP_Header;
+			case GLCommandType::BindDescriptorSets:
+			case GLCommandType::DrawMesh:
+				return CP_Header | CP_DataLow;
+			case GLCommandType::PushConstants:
+				return CP_Header | CP_DataLow;
+			case GLCommandType::Dispatch:
+			case GLCommandType::SetViewport:
+			case GLCommandType::SetScissor:
+			case GLCommandType::CopyImage:
+			case GLCommandType::CopyImageToBuffer:
+			case GLCommandType::CopyBuffer:
+				return CP_Data;
+			default:
+				return CP_None;
+			}
+		}
+
+		size_t GetInlineDataSize(const GL_CommandData& command)
+		{
+			switch (command.m_CommandType)
+			{
+			case GLCommandType::PushConstants:
+				return command.m_PushConstantsSize;
+			case GLCommandType::CopyBuffer:
+				return sizeof(glm::uvec3);
+			default:
+				return 0;
+			}
+		}
+	}
+
 	GL_CommandBuffer::GL_CommandBuffer(size_t capacity) :
-		m_CommandsCapacity(capacity), m_Commands(new GL_CommandData[capacity]),
 		m_GLCurrentPrimitives(PrimitiveTypes.at(PrimitiveType::Triangles))
 	{
+		m_CommandStream.reserve(capacity);
+	}
+
+	void GL_CommandBuffer::Write(const GL_CommandData& command)
+	{
+		const uint8_t payload = GetCommandPayload(command.m_CommandType);
+		const size_t inlineSize = GetInlineDataSize(command);
+		const size_t size = sizeof(GLCommandType) + inlineSize +
+			((payload & CP_Header) ? CommandPartSize : 0) +
+			((payload & CP_DataLow) ? CommandPartSize : 0) +
+			((payload & CP_DataHigh) ? CommandPartSize : 0);
+
+		size_t offset = m_CommandStream.size();
+		m_CommandStream.resize(offset + size);
+		uint8_t* stream = m_CommandStream.data();
+
+		const uint8_t* header = reinterpret_cast<const uint8_t*>(&command.m_RenderPass);
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(&command.m_XYZ);
+
+		std::memcpy(stream + offset, &command.m_CommandType, sizeof(GLCommandType));
+		offset += sizeof(GLCommandType);
+		if (payload & CP_Header)
+		{
+			std::memcpy(stream + offset, header, CommandPartSize);
+			offset += CommandPartSize;
+		}
+		if (payload & CP_DataLow)
+		{
+			std::memcpy(stream + offset, data, CommandPartSize);
+			offset += CommandPartSize;
+		}
+		if (payload & CP_DataHigh)
+		{
+			std::memcpy(stream + offset, data + CommandPartSize, CommandPartSize);
+			offset += CommandPartSize;
+		}
+		if (inlineSize > 0)
+			std::memcpy(stream + offset, command.m_InlineData, inlineSize);
+
+		m_LastCommandType = command.m_CommandType;
+		++m_CommandsSize;
+	}
+
+	size_t GL_CommandBuffer::Read(size_t offset, GL_CommandData& command) const
+	{
+		const uint8_t* stream = m_CommandStream.data();
+		std::memcpy(&command.m_CommandType, stream + offset, sizeof(GLCommandType));
+		offset += sizeof(GLCommandType);
+
+		uint8_t* header = reinterpret_cast<uint8_t*>(&command.m_RenderPass);
+		uint8_t* data = reinterpret_cast<uint8_t*>(&command.m_XYZ);
+
+		const uint8_t payload = GetCommandPayload(command.m_CommandType);
+		if (payload & CP_Header)
+		{
+			std::memcpy(header, stream + offset, CommandPartSize);
+			offset += CommandPartSize;
+		}
+		if (payload & CP_DataLow)
+		{
+			std::memcpy(data, stream + offset, CommandPartSize);
+			offset += CommandPartSize;
+		}
+		if (payload & CP_DataHigh)
+		{
+			std::memcpy(data + CommandPartSize, stream + offset, CommandPartSize);
+			offset += CommandPartSize;
+		}
+
+		const size_t inlineSize = GetInlineDataSize(command);
+		command.m_InlineData = inlineSize > 0 ? stream + offset : nullptr;
+		return offset + inlineSize;
+	}
+
+	void GL_CommandBuffer::Clear()
+	{
+		m_CommandStream.clear();
+		m_CommandsSize = 0;
+		m_LastCommandType = GLCommandType::Unknown;
 	}
 
 	OpenGLDevice::OpenGLDevice(OpenGLGraphicsModule* pModule): GraphicsDevice(pModule)
@@ -40,6 +176,7 @@ namespace Glory
 		m_Buffers.FreeAll(std::bind(&OpenGLDevice::FreeBuffer, this, std::placeholders::_1));
 		m_Sets.FreeAll(std::bind(&OpenGLDevice::FreeDescriptorSet, this, std::placeholders::_1));
 		m_SetLayouts.FreeAll(std::bind(&OpenGLDevice::FreeDescriptorSetLayout, this, std::placeholders::_1));
+		m_StreamingBuffer.Release();
 	}
 
 	OpenGLGraphicsModule* OpenGLDevice::GraphicsModule()
@@ -52,6 +189,11 @@ namespace Glory
 		m_IsCommandBufferEmulationEnabled = enable;
 	}
 
+	void OpenGLDevice::SetStreamingBufferSize(size_t size)
+	{
+		m_StreamingBufferSize = size;
+	}
+
 	uint32_t OpenGLDevice::GetGLTextureID(TextureHandle texture)
 	{
 		GL_Texture* glTexture = m_Textures.Find(texture);
@@ -231,9 +373,7 @@ namespace Glory
 		commandData.m_Pipeline = pipeline;
 		commandData.m_PushConstantsOffset = offset;
 		commandData.m_PushConstantsSize = size;
-		commandData.m_PushConstantsDataIndex = glCommandBuffer->m_PushConstantData.size();
-		auto& array = glCommandBuffer->m_PushConstantData.emplace_back();
-		std::memcpy(array.data(), data, size);
+		commandData.m_InlineData = data;
 		PushCommand(*glCommandBuffer, std::move(commandData));
 	}
 
@@ -253,6 +393,29 @@ namespace Glory
 
 		GL_CommandData commandData = GLCommandType::DrawMesh;
 		commandData.m_Mesh = handle;
+		commandData.m_FirstIndex = 0;
+		commandData.m_DrawIndexCount = UINT32_MAX;
+		PushCommand(*glCommandBuffer, std::move(commandData));
+	}
+
+	void OpenGLDevice::DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle, uint32_t firstIndex, uint32_t indexCount)
+	{
+		GL_CommandBuffer* glCommandBuffer = m_CommandBuffers.Find(commandBuffer);
+		if (!glCommandBuffer)
+		{
+			Debug().LogError("OpenGLDevice::DrawMesh: Invalid command buffer handle.");
+			return;
+		}
+		if (m_IsCommandBufferEmulationEnabled && glCommandBuffer->m_CommandsSize == 0)
+		{
+			Debug().LogError("OpenGLDevice::DrawMesh: Command buffer has not started recording yet.");
+			return;
+		}
+
+		GL_CommandData commandData = GLCommandType::DrawMesh;
+		commandData.m_Mesh = handle;
+		commandData.m_FirstIndex = firstIndex;
+		commandData.m_DrawIndexCount = indexCount;
 		PushCommand(*glCommandBuffer, std::move(commandData));
 	}
 
@@ -352,7 +515,7 @@ namespace Glory
 			return;
 		}
 
-		if (m_IsCommandBufferEmulationEnabled && glCommandBuffer->m_Commands[glCommandBuffer->m_CommandsSize - 1].m_CommandType != GLCommandType::End)
+		if (m_IsCommandBufferEmulationEnabled && glCommandBuffer->m_LastCommandType != GLCommandType::End)
 		{
 			Debug().LogError("OpenGLDevice::Commit: Command buffer has not finished recording.");
 			return;
@@ -363,6 +526,7 @@ namespace Glory
 
 		glCommandBuffer->m_Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 		OpenGLGraphicsModule::LogGLError(glGetError());
+		m_StreamingBuffer.Fence();
 		glFlush();
 	}
 
@@ -375,7 +539,11 @@ namespace Glory
 			return WaitResult::WR_Fail;
 		}
 
-		if (!glCommandBuffer->m_Fence) return WaitResult::WR_Success;
+		if (!glCommandBuffer->m_Fence)
+		{
+			CompleteReadbacks(commandBuffer);
+			return WaitResult::WR_Success;
+		}
 		const GLenum result = glClientWaitSync(glCommandBuffer->m_Fence, 0, timeout);
 		switch (result)
 		{
@@ -383,6 +551,7 @@ namespace Glory
 		case GL_CONDITION_SATISFIED:
 			glDeleteSync(glCommandBuffer->m_Fence);
 			glCommandBuffer->m_Fence = nullptr;
+			CompleteReadbacks(commandBuffer);
 			return WaitResult::WR_Success;
 		case GL_TIMEOUT_EXPIRED:
 			return WaitResult::WR_Timeout;
@@ -401,6 +570,7 @@ namespace Glory
 			Debug().LogError("OpenGLDevice::Release: Invalid command buffer handle.");
 			return;
 		}
+		CompleteReadbacks(commandBuffer);
 		if (glCommandBuffer->m_CommandsSize > 0)
 			Reset(commandBuffer);
 
@@ -427,8 +597,7 @@ namespace Glory
 			return;
 		}
 
-		glCommandBuffer->m_CommandsSize = 0;
-		glCommandBuffer->m_PushConstantData.clear();
+		glCommandBuffer->Clear();
 		glCommandBuffer->m_Fence = nullptr;
 	}
 
@@ -501,6 +670,10 @@ namespace Glory
 			default:
 				break;
 			}
+
+			/* Shader writes must be made visible to buffer copies and reads */
+			if (buffers[i].m_DstAccessMask & (AF_CopySrc | AF_CopyDst | AF_CPURead))
+				barrierBitField |= GL_BUFFER_UPDATE_BARRIER_BIT;
 		}
 
 		if (!images.empty())
@@ -555,6 +728,29 @@ namespace Glory
 		PushCommand(*glCommandBuffer, std::move(commandData));
 	}
 
+	void OpenGLDevice::CopyBuffer(CommandBufferHandle commandBuffer, BufferHandle src, BufferHandle dst,
+		uint32_t srcOffset, uint32_t dstOffset, uint32_t size)
+	{
+		GL_CommandBuffer* glCommandBuffer = m_CommandBuffers.Find(commandBuffer);
+		if (!glCommandBuffer)
+		{
+			Debug().LogError("OpenGLDevice::CopyBuffer: Invalid command buffer handle.");
+			return;
+		}
+		if (m_IsCommandBufferEmulationEnabled && glCommandBuffer->m_CommandsSize == 0)
+		{
+			Debug().LogError("OpenGLDevice::CopyBuffer: Command buffer has not started recording yet.");
+			return;
+		}
+
+		GL_CommandData commandData = GLCommandType::CopyBuffer;
+		commandData.m_SrcBuffer = src;
+		commandData.m_DstBuffer = dst;
+		const glm::uvec3 region{ srcOffset, dstOffset, size };
+		commandData.m_InlineData = &region;
+		PushCommand(*glCommandBuffer, std::move(commandData));
+	}
+
 	GraphicsDevice::SwapchainResult OpenGLDevice::AcquireNextSwapchainImage(SwapchainHandle swapchain, uint32_t* imageIndex, SemaphoreHandle)
 	{
 		GL_Swapchain* glSwapchain = m_Swapchains.Find(swapchain);
@@ -606,6 +802,7 @@ namespace Glory
 
 	uint32_t GetBufferUsage(BufferFlags flags)
 	{
+		flags = BufferFlags(flags & BF_ReadAndWrite);
 		if (flags == BF_None)
 			return GL_STATIC_DRAW;
 		if (flags == BF_Write)
@@ -655,8 +852,9 @@ namespace Glory
 			break;
 		}
 
-		if (flags != BF_None && flags != BF_CopyDst)
+		if (flags & BF_ReadAndWrite)
 			buffer.m_GLUsage = GetBufferUsage(flags);
+		buffer.m_Streamed = (flags & BF_ReadAndWrite) == BF_Write;
 
 		glBindBuffer(buffer.m_GLTarget, buffer.m_GLBufferID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
@@ -706,6 +904,8 @@ namespace Glory
 			return;
 		}
 
+		if (data && StreamBuffer(*buffer, data, 0, uint32_t(buffer->m_Size))) return;
+
 		glBindBuffer(buffer->m_GLTarget, buffer->m_GLBufferID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
 		glBufferData(buffer->m_GLTarget, buffer->m_Size, data, buffer->m_GLUsage);
@@ -723,6 +923,8 @@ namespace Glory
 			return;
 		}
 
+		if (size <= buffer->m_Size && data && StreamBuffer(*buffer, data, 0, size)) return;
+
 		glBindBuffer(buffer->m_GLTarget, buffer->m_GLBufferID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
 		if (size > buffer->m_Size)
@@ -752,6 +954,8 @@ namespace Glory
 			return;
 		}
 
+		if (data && StreamBuffer(*buffer, data, offset, size)) return;
+
 		glBindBuffer(buffer->m_GLTarget, buffer->m_GLBufferID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
 		glBufferSubData(buffer->m_GLTarget, offset, size, data);
@@ -783,13 +987,14 @@ namespace Glory
 	}
 
 	MeshHandle OpenGLDevice::CreateMesh(std::vector<BufferHandle>&& buffers, uint32_t vertexCount,
-		uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes)
+		uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes, IndexType indexType)
 	{
 		MeshHandle handle;
 		GL_Mesh& mesh = m_Meshes.Emplace(handle, GL_Mesh());
 		mesh.m_Buffers = std::move(buffers);
 		mesh.m_VertexCount = vertexCount;
 		mesh.m_IndexCount = indexCount;
+		mesh.m_IndexType = indexType;
 
 		glGenVertexArrays(1, &mesh.m_GLVertexArrayID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
@@ -881,6 +1086,31 @@ namespace Glory
 				OpenGLGraphicsModule::LogGLError(glGetError());
 				offset += 4*sizeof(GLint);
 				break;
+			case Glory::AttributeType::Half2:
+				glVertexAttribPointer(i, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offset);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				offset += 2*sizeof(GLhalf);
+				break;
+			case Glory::AttributeType::Half4:
+				glVertexAttribPointer(i, 4, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offset);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				offset += 4*sizeof(GLhalf);
+				break;
+			case Glory::AttributeType::UNorm8x4:
+				glVertexAttribPointer(i, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offset);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				offset += 4*sizeof(GLubyte);
+				break;
+			case Glory::AttributeType::SNorm8x4:
+				glVertexAttribPointer(i, 4, GL_BYTE, GL_TRUE, stride, (void*)offset);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				offset += 4*sizeof(GLbyte);
+				break;
+			case Glory::AttributeType::UNorm16x4:
+				glVertexAttribPointer(i, 4, GL_UNSIGNED_SHORT, GL_TRUE, stride, (void*)offset);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				offset += 4*sizeof(GLushort);
+				break;
 			default:
 				break;
 			}
@@ -941,24 +1171,46 @@ namespace Glory
 
 		glMesh->m_IndexCount = pMeshData->IndexCount();
 		glMesh->m_VertexCount = pMeshData->VertexCount();
+		glMesh->m_IndexType = pMeshData->GetIndexType();
 		AssignBuffer(glMesh->m_Buffers[0], pMeshData->Vertices(), pMeshData->VertexCount()*pMeshData->VertexSize());
 		if (glMesh->m_IndexCount > 0)
-			AssignBuffer(glMesh->m_Buffers.back(), pMeshData->Indices(), pMeshData->IndexCount()*sizeof(uint32_t));
+		{
+			/* LOD indices are stored right after the indices of the full mesh */
+			const uint32_t indexSize = pMeshData->IndexCount()*pMeshData->IndexStride();
+			const uint32_t lodIndexSize = pMeshData->LODIndexCount()*pMeshData->IndexStride();
+			if (BufferSize(glMesh->m_Buffers.back()) < indexSize + lodIndexSize)
+				ResizeBuffer(glMesh->m_Buffers.back(), indexSize + lodIndexSize);
+			if (glMesh->m_IndexType == IndexType::UInt16)
+			{
+				std::vector<uint16_t> indices;
+				pMeshData->PackIndices(indices);
+				AssignBuffer(glMesh->m_Buffers.back(), indices.data(), indexSize + lodIndexSize);
+			}
+			else
+			{
+				AssignBuffer(glMesh->m_Buffers.back(), pMeshData->Indices(), indexSize);
+				if (lodIndexSize > 0)
+					AssignBuffer(glMesh->m_Buffers.back(), pMeshData->LODIndices(), indexSize, lodIndexSize);
+			}
+		}
 	}
 
-	TextureHandle OpenGLDevice::CreateTexture(TextureData* pTexture)
+	TextureHandle OpenGLDevice::CreateTexture(TextureData* pTexture, uint32_t firstMipLevel)
 	{
 		ImageData* pImageData = pTexture->GetImageData(&m_pModule->GetEngine()->GetResources());
 		if (!pImageData) return NULL;
 
+		const size_t firstMip = std::min(size_t(firstMipLevel), pImageData->MipLevelCount() ? pImageData->MipLevelCount() - 1 : 0);
+
 		TextureHandle handle;
 		GL_Texture& texture = m_Textures.Emplace(handle, GL_Texture());
-		texture.m_Width = pImageData->GetWidth();
-		texture.m_Height = pImageData->GetHeight();
+		texture.m_Width = pImageData->MipLevelCount() ? pImageData->GetMipLevel(firstMip).m_Width : pImageData->GetWidth();
+		texture.m_Height = pImageData->MipLevelCount() ? pImageData->GetMipLevel(firstMip).m_Height : pImageData->GetHeight();
 		
 		texture.m_GLTextureType = GL_TEXTURE_2D;
 
-		if (pImageData->GetBytesPerPixel() == 1)
+		/* Mip levels are tightly packed so their rows are not aligned to 4 bytes */
+		if (pImageData->GetBytesPerPixel() == 1 || pImageData->MipLevelCount())
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 		glGenTextures(1, &texture.m_GLTextureID);
@@ -979,13 +1231,35 @@ namespace Glory
 		texture.m_GLTextureWrapT = Texturewraps.at(sampler.AddressModeV);
 		texture.m_GLTextureWrapR = Texturewraps.at(sampler.AddressModeW);
 
-		glTexImage2D(texture.m_GLTextureType, 0, texture.m_GLInternalFormat, (GLsizei)pImageData->GetWidth(), (GLsizei)pImageData->GetHeight(), 0, texture.m_GLFormat, texture.m_GLDataType, pImageData->GetPixels());
-		OpenGLGraphicsModule::LogGLError(glGetError());
-
-		if (sampler.MipmapMode != Filter::F_None)
+		if (pImageData->MipLevelCount())
 		{
-			glGenerateMipmap(texture.m_GLTextureType);
+			/* Upload the stored mip chain as is, compressed levels can't be generated by the driver */
+			const size_t levelCount = sampler.MipmapMode != Filter::F_None ? pImageData->MipLevelCount() - firstMip : 1;
+			const char* pixels = static_cast<const char*>(pImageData->GetPixels());
+			for (size_t i = 0; i < levelCount; ++i)
+			{
+				const ImageData::MipLevel& level = pImageData->GetMipLevel(firstMip + i);
+				if (pImageData->IsBlockCompressed())
+					glCompressedTexImage2D(texture.m_GLTextureType, GLint(i), texture.m_GLInternalFormat, (GLsizei)level.m_Width,
+						(GLsizei)level.m_Height, 0, (GLsizei)level.m_Size, pixels + level.m_Offset);
+				else
+					glTexImage2D(texture.m_GLTextureType, GLint(i), texture.m_GLInternalFormat, (GLsizei)level.m_Width,
+						(GLsizei)level.m_Height, 0, texture.m_GLFormat, texture.m_GLDataType, pixels + level.m_Offset);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+			}
+			glTexParameteri(texture.m_GLTextureType, GL_TEXTURE_MAX_LEVEL, GLint(levelCount - 1));
+			OpenGLGraphicsModule::LogGLError(glGetError());
+		}
+		else
+		{
+			glTexImage2D(texture.m_GLTextureType, 0, texture.m_GLInternalFormat, (GLsizei)pImageData->GetWidth(), (GLsizei)pImageData->GetHeight(), 0, texture.m_GLFormat, texture.m_GLDataType, pImageData->GetPixels());
 			OpenGLGraphicsModule::LogGLError(glGetError());
+
+			if (sampler.MipmapMode != Filter::F_None)
+			{
+				glGenerateMipmap(texture.m_GLTextureType);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+			}
 		}
 
 		glTexParameteri(texture.m_GLTextureType, GL_TEXTURE_MIN_FILTER, texture.m_GLMinFilter);
@@ -1064,7 +1338,9 @@ namespace Glory
 		texture.m_GLTextureWrapT = Texturewraps.at(sampler.AddressModeV);
 		texture.m_GLTextureWrapR = Texturewraps.at(sampler.AddressModeW);
 
-		if (pImageData->GetBytesPerPixel() == 1)
+		/* Mip levels are tightly packed so their rows are not aligned to 4 bytes */
+		const size_t storedLevelCount = pImageData->MipLevelCount();
+		if (pImageData->GetBytesPerPixel() == 1 || storedLevelCount)
 			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
 		glGenTextures(1, &texture.m_GLTextureID);
@@ -1073,11 +1349,43 @@ namespace Glory
 		glBindTexture(texture.m_GLTextureType, texture.m_GLTextureID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
 
+		/* Each face uploads its own stored mip chain, compressed levels can't be generated by the driver */
+		const size_t levelCount = storedLevelCount && sampler.MipmapMode != Filter::F_None ? storedLevelCount : 1;
 		for (unsigned int i = 0; i < 6; ++i)
 		{
-			ImageData* pImageData = pCubemap->GetImageData(&m_pModule->GetEngine()->GetResources(), i);
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, texture.m_GLInternalFormat,
-				(GLsizei)pImageData->GetWidth(), (GLsizei)pImageData->GetHeight(), 0, texture.m_GLFormat, texture.m_GLDataType, pImageData->GetPixels());
+			ImageData* pFaceData = pCubemap->GetImageData(&m_pModule->GetEngine()->GetResources(), i);
+			if (!pFaceData) continue;
+			if (!storedLevelCount)
+			{
+				glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, texture.m_GLInternalFormat,
+					(GLsizei)pFaceData->GetWidth(), (GLsizei)pFaceData->GetHeight(), 0, texture.m_GLFormat, texture.m_GLDataType, pFaceData->GetPixels());
+				OpenGLGraphicsModule::LogGLError(glGetError());
+				continue;
+			}
+
+			if (pFaceData->MipLevelCount() != storedLevelCount || pFaceData->GetInternalFormat() != pImageData->GetInternalFormat())
+			{
+				Debug().LogError("OpenGLDevice::CreateTexture(CubemapData): All faces must have the same format and mip levels.");
+				continue;
+			}
+
+			const char* pixels = static_cast<const char*>(pFaceData->GetPixels());
+			for (size_t level = 0; level < levelCount; ++level)
+			{
+				const ImageData::MipLevel& mipLevel = pFaceData->GetMipLevel(level);
+				if (pFaceData->IsBlockCompressed())
+					glCompressedTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GLint(level), texture.m_GLInternalFormat,
+						(GLsizei)mipLevel.m_Width, (GLsizei)mipLevel.m_Height, 0, (GLsizei)mipLevel.m_Size, pixels + mipLevel.m_Offset);
+				else
+					glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, GLint(level), texture.m_GLInternalFormat, (GLsizei)mipLevel.m_Width,
+						(GLsizei)mipLevel.m_Height, 0, texture.m_GLFormat, texture.m_GLDataType, pixels + mipLevel.m_Offset);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+			}
+		}
+
+		if (storedLevelCount)
+		{
+			glTexParameteri(texture.m_GLTextureType, GL_TEXTURE_MAX_LEVEL, GLint(levelCount - 1));
 			OpenGLGraphicsModule::LogGLError(glGetError());
 		}
 
@@ -1105,7 +1413,7 @@ namespace Glory
 		glTexParameterf(texture.m_GLTextureType, GL_TEXTURE_MAX_ANISOTROPY_EXT, aniso);
 		OpenGLGraphicsModule::LogGLError(glGetError());
 
-		if (sampler.MipmapMode != Filter::F_None)
+		if (sampler.MipmapMode != Filter::F_None && !storedLevelCount)
 		{
 			glGenerateMipmap(texture.m_GLTextureType);
 			OpenGLGraphicsModule::LogGLError(glGetError());
@@ -1203,7 +1511,9 @@ namespace Glory
 		OpenGLGraphicsModule::LogGLError(glGetError());
 
 		const SamplerSettings& sampler = pTextureData->GetSamplerSettings();
-		if (sampler.MipmapMode != Filter::F_None)
+		ImageData* pImageData = pTextureData->GetImageData(&m_pModule->GetEngine()->GetResources());
+		/* Stored mip levels were uploaded when the texture was created */
+		if (sampler.MipmapMode != Filter::F_None && !(pImageData && pImageData->MipLevelCount()))
 		{
 			glGenerateMipmap(glTexture->m_GLTextureType);
 			OpenGLGraphicsModule::LogGLError(glGetError());
@@ -1872,6 +2182,7 @@ namespace Glory
 			Debug().LogError("OpenGLDevice::FreeBuffer: Invalid buffer handle.");
 			return;
 		}
+		FreeCachedDescriptorSets(handle);
 
 		glDeleteBuffers(1, &buffer->m_GLBufferID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
@@ -1908,6 +2219,7 @@ namespace Glory
 			Debug().LogError("OpenGLDevice::FreeTexture: Invalid texture handle.");
 			return;
 		}
+		FreeCachedDescriptorSets(handle);
 
 		glDeleteTextures(1, &texture->m_GLTextureID);
 		OpenGLGraphicsModule::LogGLError(glGetError());
@@ -2045,6 +2357,9 @@ namespace Glory
 	void OpenGLDevice::OnInitialize()
 	{
 		m_ConstantsBuffer = CreateBuffer(PushConstantsMaxSize, BT_Uniform, BF_Write);
+		m_StreamingBuffer.Initialize(m_StreamingBufferSize);
+		if (m_StreamingBufferSize > 0 && !m_StreamingBuffer.IsPersistent())
+			Debug().LogWarning("OpenGLDevice::OnInitialize: Persistent buffer mapping is not supported, falling back to orphaning for streamed buffers.");
 	}
 
 	void OpenGLDevice::CreateRenderTexture(GL_RenderTexture& renderTexture)
@@ -2150,6 +2465,7 @@ namespace Glory
 
 		pipeline.m_GLProgramID = glCreateProgram();
 		OpenGLGraphicsModule::LogGLError(glGetError());
+		pipeline.m_SamplerUnits.clear();
 
 		for (size_t i = 0; i < pPipeline->ShaderCount(); ++i)
 		{
@@ -2183,34 +2499,32 @@ namespace Glory
 		return true;
 	}
 
+	bool OpenGLDevice::StreamBuffer(const GL_Buffer& buffer, const void* data, uint32_t offset, uint32_t size)
+	{
+		if (!buffer.m_Streamed || size < OpenGLStreamingBuffer::MinStreamSize) return false;
+		return m_StreamingBuffer.Upload(buffer.m_GLBufferID, offset, data, size);
+	}
+
 	void OpenGLDevice::PushCommand(GL_CommandBuffer& buffer, GL_CommandData&& commandData)
 	{
 		if (!m_IsCommandBufferEmulationEnabled)
 		{
-			/* Execute immediately */
+			/* Execute immediately, anything may touch GL between two immediate
+			 * commands so the state cache can not be trusted across them */
+			m_GLState.Invalidate();
 			OpenGLCommandImpl::Command_Impl(*this, buffer, commandData);
+			/* Binding an index buffer outside of commands would otherwise modify the bound vertex array */
+			m_GLState.BindVertexArray(0);
 			return;
 		}
 
-		if (buffer.m_CommandsSize > 0 && buffer.m_Commands[buffer.m_CommandsSize - 1].m_CommandType == GLCommandType::End)
+		if (buffer.m_LastCommandType == GLCommandType::End)
 		{
 			Debug().LogError("OpenGLDevice::PushCommand: Command buffer recording ended.");
 			return;
 		}
 
-		if (buffer.m_CommandsSize == buffer.m_CommandsCapacity)
-		{
-			/* Resize */
-			const size_t newCapacity = buffer.m_CommandsCapacity + buffer.m_CommandsCapacity/2;
-			GL_CommandData* newCommandData = new GL_CommandData[newCapacity];
-			for (size_t i = 0; i < buffer.m_CommandsSize; ++i)
-				newCommandData[i] = std::move(buffer.m_Commands[i]);
-			buffer.m_Commands.reset(newCommandData);
-			buffer.m_CommandsCapacity = newCapacity;
-		}
-
-		buffer.m_Commands[buffer.m_CommandsSize] = std::move(commandData);
-		++buffer.m_CommandsSize;
+		buffer.Write(commandData);
 	}
 
 #pragma endregion
@@ -1,10 +1,14 @@
 #pragma once
 #include "ogl_visibility.h"
+#include "OpenGLStateCache.h"
+#include "OpenGLStreamingBuffer.h"
 
 #include <GraphicsDevice.h>
 
 #include <BitSet.h>
 
+#include <glm/vec3.hpp>
+
 #include <queue>
 
 typedef struct __GLsync* GLsync;
@@ -21,6 +25,8 @@ namespace Glory
         uint32_t m_GLBufferID;
         uint32_t m_GLTarget;
         uint32_t m_GLUsage;
+        /* Written from the CPU every frame, uploads go through the streaming buffer */
+        bool m_Streamed;
     };
 
     struct GL_Mesh
@@ -30,6 +36,7 @@ namespace Glory
         uint32_t m_GLVertexArrayID;
         uint32_t m_VertexCount;
         uint32_t m_IndexCount;
+        IndexType m_IndexType;
         std::vector<BufferHandle> m_Buffers;
     };
 
@@ -107,6 +114,9 @@ namespace Glory
         uint32_t m_GLAlphaBlendOp;
         glm::vec4 m_BlendConstants = glm::vec4{};
         Utils::BitSet m_SettingToggles;
+        /* Texture unit last assigned to each sampler uniform, uniforms are
+         * program state so they only need to be set again when the unit changes */
+        std::unordered_map<std::string, uint32_t> m_SamplerUnits;
     };
 
     struct GL_DescriptorSetLayout
@@ -157,7 +167,8 @@ namespace Glory
         SetScissor,
         PipelineBarrier,
         CopyImage,
-        CopyImageToBuffer
+        CopyImageToBuffer,
+        CopyBuffer
     };
 
     struct GL_CommandData
@@ -174,12 +185,14 @@ namespace Glory
             m_CommandType = other.m_CommandType;
             m_RenderPass = std::move(other.m_RenderPass);
             m_XYZ = std::move(other.m_XYZ);
+            m_InlineData = other.m_InlineData;
         }
         GL_CommandData& operator=(GL_CommandData&& other) noexcept
         {
             m_CommandType = other.m_CommandType;
             m_RenderPass = std::move(other.m_RenderPass);
             m_XYZ = std::move(other.m_XYZ);
+            m_InlineData = other.m_InlineData;
             return *this;
         }
 
@@ -230,10 +243,14 @@ namespace Glory
                 uint64_t m_DescriptorSetPadding;
             };
 
-            /* Texture/image commands */
+            /* Texture/image/buffer copy commands */
             struct
             {
-                TextureHandle m_SrcTexture;
+                union
+                {
+                    TextureHandle m_SrcTexture;
+                    BufferHandle m_SrcBuffer;
+                };
                 union
                 {
                     TextureHandle m_DstTexture;
@@ -241,30 +258,51 @@ namespace Glory
                 };
             };
 
+            /* Mesh commands, UINT32_MAX indices draws the full mesh */
+            struct
+            {
+                uint32_t m_FirstIndex;
+                uint32_t m_DrawIndexCount;
+                uint64_t m_DrawPadding;
+            };
+
             /* Push constants */
             struct
             {
                 uint32_t m_PushConstantsOffset;
                 uint32_t m_PushConstantsSize;
-                uint32_t m_PushConstantsDataIndex;
-                uint32_t m_PushConstantsPadding;
+                uint64_t m_PushConstantsPadding;
             };
         };
+
+        /* Variable sized data that is stored in the stream right after the command,
+         * the push constant bytes or the src offset, dst offset and size of a buffer copy.
+         * Points to the callers data while recording and into the stream during replay. */
+        const void* m_InlineData = nullptr;
     };
 
     struct GL_CommandBuffer
     {
         static constexpr GraphicsHandleType HandleType = H_CommandBuffer;
 
-        GL_CommandBuffer(size_t capacity = 32);
+        GL_CommandBuffer(size_t capacity = 1024);
+
+        /** @brief Encode a command at the end of the stream */
+        void Write(const GL_CommandData& command);
+        /** @brief Decode the command that starts at an offset in the stream
+         * @returns Offset of the next command */
+        size_t Read(size_t offset, GL_CommandData& command) const;
+        /** @brief Remove all recorded commands */
+        void Clear();
 
         GLsync m_Fence = nullptr;
         size_t m_CommandsSize = 0;
-        size_t m_CommandsCapacity;
+        GLCommandType m_LastCommandType = GLCommandType::Unknown;
         mutable uint32_t m_GLCurrentPrimitives = 0;
 
-        std::unique_ptr<GL_CommandData[]> m_Commands;
-        std::vector<std::array<char, PushConstantsMaxSize>> m_PushConstantData;
+        /* Each command is stored as its type byte followed by only
+         * the fields of @ref GL_CommandData that type actually uses */
+        std::vector<uint8_t> m_CommandStream;
     };
 
     class OpenGLGraphicsModule;
@@ -278,6 +316,10 @@ namespace Glory
         OpenGLGraphicsModule* GraphicsModule();
 
         void SetCommandBufferEmulationEnabled(bool enable);
+        /** @brief Set the size of the ring used to stream per frame buffer uploads,
+         * must be called before the device is initialized
+         * @param size Size in bytes, 0 disables streaming */
+        void SetStreamingBufferSize(size_t size);
 
         GLORY_OGL_API uint32_t GetGLTextureID(TextureHandle texture);
 
@@ -293,6 +335,7 @@ namespace Glory
         virtual void PushConstants(CommandBufferHandle commandBuffer, PipelineHandle pipeline, uint32_t offset, uint32_t size, const void* data, ShaderTypeFlag) override;
 
         virtual void DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle) override;
+        virtual void DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle, uint32_t firstIndex, uint32_t indexCount) override;
         virtual void Dispatch(CommandBufferHandle commandBuffer, uint32_t x, uint32_t y, uint32_t z) override;
 
         virtual void SetStencilTestEnabled(CommandBufferHandle commandBuffer, bool enable) override;
@@ -313,6 +356,8 @@ namespace Glory
             const std::vector<ImageBarrier>& images, PipelineStageFlagBits, PipelineStageFlagBits) override;
         virtual void CopyImage(CommandBufferHandle commandBuffer, TextureHandle src, TextureHandle dst) override;
         virtual void CopyImageToBuffer(CommandBufferHandle commandBuffer, TextureHandle src, BufferHandle dst) override;
+        virtual void CopyBuffer(CommandBufferHandle commandBuffer, BufferHandle src, BufferHandle dst,
+            uint32_t srcOffset, uint32_t dstOffset, uint32_t size) override;
 
         virtual SwapchainResult AcquireNextSwapchainImage(SwapchainHandle swapchain, uint32_t* imageIndex, SemaphoreHandle) override;
         virtual SwapchainResult Present(SwapchainHandle swapchain, uint32_t imageIndex, const std::vector<SemaphoreHandle>& waitSemaphores={}) override;
@@ -330,12 +375,13 @@ namespace Glory
         virtual void ReadBuffer(BufferHandle handle, void* outData, uint32_t offset, uint32_t size) override;
 
         virtual MeshHandle CreateMesh(std::vector<BufferHandle>&& buffers, uint32_t vertexCount,
-            uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes) override;
+            uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes,
+            IndexType indexType=IndexType::UInt32) override;
         virtual void UpdateMesh(MeshHandle mesh, std::vector<BufferHandle>&& buffers,
             uint32_t vertexCount, uint32_t indexCount) override;
         virtual void UpdateMesh(MeshHandle texture, MeshData* pMeshData) override;
 
-        virtual TextureHandle CreateTexture(TextureData* pTexture) override;
+        virtual TextureHandle CreateTexture(TextureData* pTexture, uint32_t firstMipLevel=0) override;
         virtual TextureHandle CreateTexture(CubemapData* pCubemap) override;
         virtual TextureHandle CreateTexture(const TextureCreateInfo& textureInfo, const void* pixels=nullptr, size_t dataSize=0) override;
         virtual void UpdateTexture(TextureHandle texture, TextureData* pTextureData) override;
@@ -381,6 +427,7 @@ namespace Glory
         void CreateRenderTexture(GL_RenderTexture& renderTexture);
         bool CreatePipeline(GL_Pipeline& pipeline, PipelineData* pPipeline);
         void PushCommand(GL_CommandBuffer& buffer, GL_CommandData&& commandData);
+        bool StreamBuffer(const GL_Buffer& buffer, const void* data, uint32_t offset, uint32_t size);
 
     private:
         friend class OpenGLCommandImpl;
@@ -401,6 +448,10 @@ namespace Glory
         /* For push constant emulation */
         BufferHandle m_ConstantsBuffer;
 
+        OpenGLStateCache m_GLState;
+        OpenGLStreamingBuffer m_StreamingBuffer;
+        size_t m_StreamingBufferSize = 8*1024*1024;
+
         bool m_IsCommandBufferEmulationEnabled = true;
     };
 }
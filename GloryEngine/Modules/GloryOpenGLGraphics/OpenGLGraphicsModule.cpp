@@ -74,6 +74,10 @@ namespace Glory
 		glEnable(GL_MULTISAMPLE);
 		LogGLError(glGetError());
 
+		const ModuleSettings& settings = Settings();
+		const unsigned int streamingBufferSize = settings.Value<unsigned int>("Streaming Buffer Size");
+		m_Device.SetStreamingBufferSize(size_t(streamingBufferSize)*1024*1024);
+
 		m_pEngine->AddGraphicsDevice(&m_Device);
 	}
 
@@ -94,6 +98,10 @@ namespace Glory
 	{
 		settings.PushGroup("Command Buffer Emulation");
 		settings.RegisterValue<bool>("Enable Command Buffer Emulation", true);
+
+		/* Size in MB of the ring used to upload per frame buffer data, 0 disables streaming */
+		settings.PushGroup("Buffer Streaming");
+		settings.RegisterValue<unsigned int>("Streaming Buffer Size", 8);
 	}
 
 	void OpenGLGraphicsModule::LogGLError(const GLenum& err, bool bIncludeTimeStamp)
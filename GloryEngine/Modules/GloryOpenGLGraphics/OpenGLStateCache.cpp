@@ -0,0 +1,242 @@
+#include "OpenGLStateCache.h"
+#include "OpenGLGraphicsModule.h"
+
+#include <limits>
+
+namespace Glory
+{
+	namespace
+	{
+		/* No valid GL object name or enum takes these values */
+		constexpr uint32_t Unknown = std::numeric_limits<uint32_t>::max();
+		constexpr int32_t UnknownSigned = std::numeric_limits<int32_t>::min();
+		constexpr uint8_t UnknownFlag = std::numeric_limits<uint8_t>::max();
+	}
+
+	OpenGLStateCache::OpenGLStateCache()
+	{
+		Invalidate();
+	}
+
+	void OpenGLStateCache::Invalidate()
+	{
+		m_Program = Unknown;
+		m_VertexArray = Unknown;
+		m_Framebuffer = Unknown;
+		m_ActiveTexture = Unknown;
+		m_Textures.fill(Unknown);
+		m_TextureTargets.fill(Unknown);
+		m_UniformBuffers.fill(Unknown);
+		m_StorageBuffers.fill(Unknown);
+
+		m_Capabilities.fill(UnknownFlag);
+		m_CullFace = Unknown;
+		m_DepthFunc = Unknown;
+		m_DepthMask = UnknownFlag;
+		m_ColorMask = UnknownFlag;
+		m_BlendFuncs.fill(Unknown);
+		m_BlendEquations.fill(Unknown);
+		/* NaN never compares equal so the next color always gets set */
+		m_BlendColor = glm::vec4{ std::numeric_limits<float>::quiet_NaN() };
+		m_StencilFunc.fill(Unknown);
+		m_StencilOp.fill(Unknown);
+		m_StencilMask = Unknown;
+		m_Viewport.fill(UnknownSigned);
+		m_Scissor.fill(UnknownSigned);
+	}
+
+	void OpenGLStateCache::RestoreDefaultBindings()
+	{
+		UseProgram(0);
+		BindVertexArray(0);
+		BindFramebuffer(0);
+		ActiveTexture(0);
+	}
+
+	void OpenGLStateCache::UseProgram(uint32_t program)
+	{
+		if (m_Program == program) return;
+		m_Program = program;
+		glUseProgram(program);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+	}
+
+	void OpenGLStateCache::BindVertexArray(uint32_t vertexArray)
+	{
+		if (m_VertexArray == vertexArray) return;
+		m_VertexArray = vertexArray;
+		glBindVertexArray(vertexArray);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+	}
+
+	void OpenGLStateCache::BindFramebuffer(uint32_t framebuffer)
+	{
+		if (m_Framebuffer == framebuffer) return;
+		m_Framebuffer = framebuffer;
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+	}
+
+	void OpenGLStateCache::BindBufferBase(uint32_t target, uint32_t index, uint32_t buffer)
+	{
+		uint32_t* cached = nullptr;
+		if (index < MaxBufferBindings)
+		{
+			if (target == GL_UNIFORM_BUFFER) cached = &m_UniformBuffers[index];
+			else if (target == GL_SHADER_STORAGE_BUFFER) cached = &m_StorageBuffers[index];
+		}
+
+		if (cached)
+		{
+			if (*cached == buffer) return;
+			*cached = buffer;
+		}
+		glBindBufferBase(target, index, buffer);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+	}
+
+	void OpenGLStateCache::ActiveTexture(uint32_t unit)
+	{
+		if (m_ActiveTexture == unit) return;
+		m_ActiveTexture = unit;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+	}
+
+	void OpenGLStateCache::BindTexture(uint32_t unit, uint32_t target, uint32_t texture)
+	{
+		if (unit < MaxTextureUnits)
+		{
+			if (m_Textures[unit] == texture && m_TextureTargets[unit] == target) return;
+			m_Textures[unit] = texture;
+			m_TextureTargets[unit] = target;
+		}
+
+		ActiveTexture(unit);
+		glBindTexture(target, texture);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+	}
+
+	size_t OpenGLStateCache::CapabilityIndex(uint32_t capability)
+	{
+		switch (capability)
+		{
+		case GL_BLEND:
+			return C_Blend;
+		case GL_CULL_FACE:
+			return C_CullFace;
+		case GL_DEPTH_TEST:
+			return C_DepthTest;
+		case GL_STENCIL_TEST:
+			return C_StencilTest;
+		case GL_SCISSOR_TEST:
+			return C_ScissorTest;
+		default:
+			return C_Count;
+		}
+	}
+
+	void OpenGLStateCache::SetEnabled(uint32_t capability, bool enable)
+	{
+		const size_t index = CapabilityIndex(capability);
+		if (index < C_Count)
+		{
+			if (m_Capabilities[index] == uint8_t(enable)) return;
+			m_Capabilities[index] = uint8_t(enable);
+		}
+
+		if (enable) glEnable(capability);
+		else glDisable(capability);
+	}
+
+	void OpenGLStateCache::CullFace(uint32_t face)
+	{
+		if (m_CullFace == face) return;
+		m_CullFace = face;
+		glCullFace(face);
+	}
+
+	void OpenGLStateCache::DepthFunc(uint32_t func)
+	{
+		if (m_DepthFunc == func) return;
+		m_DepthFunc = func;
+		glDepthFunc(func);
+	}
+
+	void OpenGLStateCache::DepthMask(bool write)
+	{
+		if (m_DepthMask == uint8_t(write)) return;
+		m_DepthMask = uint8_t(write);
+		glDepthMask(write);
+	}
+
+	void OpenGLStateCache::ColorMask(bool r, bool g, bool b, bool a)
+	{
+		const uint8_t mask = uint8_t(r) | uint8_t(g) << 1 | uint8_t(b) << 2 | uint8_t(a) << 3;
+		if (m_ColorMask == mask) return;
+		m_ColorMask = mask;
+		glColorMask(r, g, b, a);
+	}
+
+	void OpenGLStateCache::BlendFuncSeparate(uint32_t srcColor, uint32_t dstColor, uint32_t srcAlpha, uint32_t dstAlpha)
+	{
+		const std::array<uint32_t, 4> funcs{ srcColor, dstColor, srcAlpha, dstAlpha };
+		if (m_BlendFuncs == funcs) return;
+		m_BlendFuncs = funcs;
+		glBlendFuncSeparate(srcColor, dstColor, srcAlpha, dstAlpha);
+	}
+
+	void OpenGLStateCache::BlendEquationSeparate(uint32_t colorOp, uint32_t alphaOp)
+	{
+		const std::array<uint32_t, 2> equations{ colorOp, alphaOp };
+		if (m_BlendEquations == equations) return;
+		m_BlendEquations = equations;
+		glBlendEquationSeparate(colorOp, alphaOp);
+	}
+
+	void OpenGLStateCache::BlendColor(const glm::vec4& color)
+	{
+		if (m_BlendColor == color) return;
+		m_BlendColor = color;
+		glBlendColor(color.r, color.g, color.b, color.a);
+	}
+
+	void OpenGLStateCache::StencilFunc(uint32_t func, int32_t reference, uint32_t mask)
+	{
+		const std::array<uint32_t, 3> stencilFunc{ func, uint32_t(reference), mask };
+		if (m_StencilFunc == stencilFunc) return;
+		m_StencilFunc = stencilFunc;
+		glStencilFunc(func, reference, mask);
+	}
+
+	void OpenGLStateCache::StencilOp(uint32_t fail, uint32_t depthFail, uint32_t pass)
+	{
+		const std::array<uint32_t, 3> stencilOp{ fail, depthFail, pass };
+		if (m_StencilOp == stencilOp) return;
+		m_StencilOp = stencilOp;
+		glStencilOp(fail, depthFail, pass);
+	}
+
+	void OpenGLStateCache::StencilMask(uint32_t mask)
+	{
+		if (m_StencilMask == mask) return;
+		m_StencilMask = mask;
+		glStencilMask(mask);
+	}
+
+	void OpenGLStateCache::Viewport(int32_t x, int32_t y, int32_t width, int32_t height)
+	{
+		const std::array<int32_t, 4> viewport{ x, y, width, height };
+		if (m_Viewport == viewport) return;
+		m_Viewport = viewport;
+		glViewport(x, y, width, height);
+	}
+
+	void OpenGLStateCache::Scissor(int32_t x, int32_t y, int32_t width, int32_t height)
+	{
+		const std::array<int32_t, 4> scissor{ x, y, width, height };
+		if (m_Scissor == scissor) return;
+		m_Scissor = scissor;
+		glScissor(x, y, width, height);
+	}
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstdint>
+
+namespace Glory
+{
+    /** @brief Shadow copy of the GL state that command replay touches
+     *
+     * Every setter compares against the cached value and only reaches GL
+     * when the state actually changes. The cache can not see GL calls made
+     * outside of it, call @ref Invalidate whenever those may have happened.
+     */
+    class OpenGLStateCache
+    {
+    public:
+        static constexpr size_t MaxTextureUnits = 32;
+        static constexpr size_t MaxBufferBindings = 32;
+
+        /** @brief Constructor */
+        OpenGLStateCache();
+
+        /** @brief Forget all cached state so the next call to each setter reaches GL */
+        void Invalidate();
+        /** @brief Unbind the program, vertex array and framebuffer and make texture unit 0 active */
+        void RestoreDefaultBindings();
+
+        /** @brief glUseProgram */
+        void UseProgram(uint32_t program);
+        /** @brief glBindVertexArray */
+        void BindVertexArray(uint32_t vertexArray);
+        /** @brief glBindFramebuffer with GL_FRAMEBUFFER */
+        void BindFramebuffer(uint32_t framebuffer);
+        /** @brief glBindBufferBase, only uniform and shader storage bindings are cached */
+        void BindBufferBase(uint32_t target, uint32_t index, uint32_t buffer);
+        /** @brief glActiveTexture
+         * @param unit Texture unit index, not the GL_TEXTUREi enum */
+        void ActiveTexture(uint32_t unit);
+        /** @brief Bind a texture to a unit, only switching the active unit when the binding changes */
+        void BindTexture(uint32_t unit, uint32_t target, uint32_t texture);
+
+        /** @brief glEnable/glDisable for blending, culling, depth, stencil and scissor tests */
+        void SetEnabled(uint32_t capability, bool enable);
+        /** @brief glCullFace */
+        void CullFace(uint32_t face);
+        /** @brief glDepthFunc */
+        void DepthFunc(uint32_t func);
+        /** @brief glDepthMask */
+        void DepthMask(bool write);
+        /** @brief glColorMask */
+        void ColorMask(bool r, bool g, bool b, bool a);
+        /** @brief glBlendFuncSeparate */
+        void BlendFuncSeparate(uint32_t srcColor, uint32_t dstColor, uint32_t srcAlpha, uint32_t dstAlpha);
+        /** @brief glBlendEquationSeparate */
+        void BlendEquationSeparate(uint32_t colorOp, uint32_t alphaOp);
+        /** @brief glBlendColor */
+        void BlendColor(const glm::vec4& color);
+        /** @brief glStencilFunc */
+        void StencilFunc(uint32_t func, int32_t reference, uint32_t mask);
+        /** @brief glStencilOp */
+        void StencilOp(uint32_t fail, uint32_t depthFail, uint32_t pass);
+        /** @brief glStencilMask */
+        void StencilMask(uint32_t mask);
+        /** @brief glViewport */
+        void Viewport(int32_t x, int32_t y, int32_t width, int32_t height);
+        /** @brief glScissor */
+        void Scissor(int32_t x, int32_t y, int32_t width, int32_t height);
+
+    private:
+        enum Capability : uint8_t
+        {
+            C_Blend,
+            C_CullFace,
+            C_DepthTest,
+            C_StencilTest,
+            C_ScissorTest,
+            C_Count
+        };
+
+        static size_t CapabilityIndex(uint32_t capability);
+
+    private:
+        uint32_t m_Program;
+        uint32_t m_VertexArray;
+        uint32_t m_Framebuffer;
+        uint32_t m_ActiveTexture;
+        std::array<uint32_t, MaxTextureUnits> m_Textures;
+        std::array<uint32_t, MaxTextureUnits> m_TextureTargets;
+        std::array<uint32_t, MaxBufferBindings> m_UniformBuffers;
+        std::array<uint32_t, MaxBufferBindings> m_StorageBuffers;
+
+        std::array<uint8_t, C_Count> m_Capabilities;
+        uint32_t m_CullFace;
+        uint32_t m_DepthFunc;
+        uint8_t m_DepthMask;
+        uint8_t m_ColorMask;
+        std::array<uint32_t, 4> m_BlendFuncs;
+        std::array<uint32_t, 2> m_BlendEquations;
+        glm::vec4 m_BlendColor;
+        std::array<uint32_t, 3> m_StencilFunc;
+        std::array<uint32_t, 3> m_StencilOp;
+        uint32_t m_StencilMask;
+        std::array<int32_t, 4> m_Viewport;
+        std::array<int32_t, 4> m_Scissor;
+    };
+}
@@ -0,0 +1,180 @@
+#include "OpenGLStreamingBuffer.h"
+#include "OpenGLGraphicsModule.h"
+
+#include <cstring>
+
+namespace Glory
+{
+	namespace
+	{
+		/* 100ms per attempt, waits are repeated until the fence signals */
+		constexpr GLuint64 FenceWaitTimeout = 100000000;
+
+		bool WaitForFence(GLsync fence, GLuint64 timeout)
+		{
+			GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+			while (timeout > 0 && result == GL_TIMEOUT_EXPIRED)
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+			return result != GL_TIMEOUT_EXPIRED;
+		}
+	}
+
+	void OpenGLStreamingBuffer::Initialize(size_t size)
+	{
+		Release();
+		if (size == 0) return;
+
+		m_Size = size;
+		glGenBuffers(1, &m_GLBufferID);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+		glBindBuffer(GL_COPY_READ_BUFFER, m_GLBufferID);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+
+		if (GLEW_ARB_buffer_storage)
+		{
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glBufferStorage(GL_COPY_READ_BUFFER, m_Size, NULL, flags);
+			OpenGLGraphicsModule::LogGLError(glGetError());
+			m_pMapped = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, m_Size, flags));
+			OpenGLGraphicsModule::LogGLError(glGetError());
+
+			if (!m_pMapped)
+			{
+				/* Storage is immutable, start over with a new buffer for the orphaning fallback */
+				glBindBuffer(GL_COPY_READ_BUFFER, NULL);
+				glDeleteBuffers(1, &m_GLBufferID);
+				glGenBuffers(1, &m_GLBufferID);
+				glBindBuffer(GL_COPY_READ_BUFFER, m_GLBufferID);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+			}
+		}
+
+		if (!m_pMapped)
+		{
+			glBufferData(GL_COPY_READ_BUFFER, m_Size, NULL, GL_STREAM_DRAW);
+			OpenGLGraphicsModule::LogGLError(glGetError());
+		}
+
+		glBindBuffer(GL_COPY_READ_BUFFER, NULL);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+	}
+
+	void OpenGLStreamingBuffer::Release()
+	{
+		for (FencedRange& range : m_Fences)
+		{
+			WaitForFence(range.m_Fence, FenceWaitTimeout);
+			glDeleteSync(range.m_Fence);
+		}
+		m_Fences.clear();
+
+		if (m_GLBufferID)
+		{
+			if (m_pMapped)
+			{
+				glBindBuffer(GL_COPY_READ_BUFFER, m_GLBufferID);
+				glUnmapBuffer(GL_COPY_READ_BUFFER);
+				glBindBuffer(GL_COPY_READ_BUFFER, NULL);
+			}
+			glDeleteBuffers(1, &m_GLBufferID);
+			OpenGLGraphicsModule::LogGLError(glGetError());
+		}
+
+		m_GLBufferID = 0;
+		m_pMapped = nullptr;
+		m_Size = 0;
+		m_Head = 0;
+		m_FenceBegin = 0;
+	}
+
+	bool OpenGLStreamingBuffer::Upload(uint32_t dstBuffer, uint32_t dstOffset, const void* data, uint32_t size)
+	{
+		if (!m_GLBufferID || size > m_Size) return false;
+
+		size_t begin = (m_Head + Alignment - 1) & ~(Alignment - 1);
+		if (begin + size > m_Size)
+		{
+			if (m_pMapped)
+			{
+				/* Fence the tail so no fenced range wraps around */
+				Fence();
+			}
+			else
+			{
+				/* Orphan the ring, the driver hands us fresh memory while the GPU finishes with the old */
+				glBindBuffer(GL_COPY_READ_BUFFER, m_GLBufferID);
+				glBufferData(GL_COPY_READ_BUFFER, m_Size, NULL, GL_STREAM_DRAW);
+				OpenGLGraphicsModule::LogGLError(glGetError());
+			}
+			begin = 0;
+			m_FenceBegin = 0;
+		}
+		const size_t end = begin + size;
+
+		glBindBuffer(GL_COPY_READ_BUFFER, m_GLBufferID);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+		if (m_pMapped)
+		{
+			WaitForRange(begin, end);
+			std::memcpy(m_pMapped + begin, data, size);
+		}
+		else
+		{
+			const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+			void* pDst = glMapBufferRange(GL_COPY_READ_BUFFER, begin, size, access);
+			OpenGLGraphicsModule::LogGLError(glGetError());
+			if (!pDst)
+			{
+				glBindBuffer(GL_COPY_READ_BUFFER, NULL);
+				return false;
+			}
+			std::memcpy(pDst, data, size);
+			glUnmapBuffer(GL_COPY_READ_BUFFER);
+			OpenGLGraphicsModule::LogGLError(glGetError());
+		}
+
+		glBindBuffer(GL_COPY_WRITE_BUFFER, dstBuffer);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, begin, dstOffset, size);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+
+		glBindBuffer(GL_COPY_READ_BUFFER, NULL);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, NULL);
+
+		m_Head = end;
+		return true;
+	}
+
+	void OpenGLStreamingBuffer::Fence()
+	{
+		/* The orphaning fallback never waits so it needs no fences */
+		if (!m_pMapped || m_Head <= m_FenceBegin) return;
+
+		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		OpenGLGraphicsModule::LogGLError(glGetError());
+		m_Fences.push_back({ m_FenceBegin, m_Head, fence });
+		m_FenceBegin = m_Head;
+	}
+
+	bool OpenGLStreamingBuffer::IsPersistent() const
+	{
+		return m_pMapped != nullptr;
+	}
+
+	void OpenGLStreamingBuffer::WaitForRange(size_t begin, size_t end)
+	{
+		for (auto iter = m_Fences.begin(); iter != m_Fences.end();)
+		{
+			/* Only block on copies that still read from the range we are about to write,
+			 * others are just released once the GPU is done with them */
+			const bool overlaps = iter->m_Begin < end && begin < iter->m_End;
+			if (!WaitForFence(iter->m_Fence, overlaps ? FenceWaitTimeout : 0))
+			{
+				++iter;
+				continue;
+			}
+			glDeleteSync(iter->m_Fence);
+			iter = m_Fences.erase(iter);
+		}
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+
+typedef struct __GLsync* GLsync;
+
+namespace Glory
+{
+    /** @brief Ring of upload memory for buffers that are rewritten every frame
+     *
+     * Data is written to a persistently mapped staging buffer and then copied
+     * into the destination buffer on the GPU, so updating a buffer the GPU is
+     * still reading from does not make the driver stall. Regions of the ring
+     * are guarded by fences and are only waited on when the ring wraps around
+     * into data the GPU has not consumed yet.
+     * When persistent mapping is not available the ring is orphaned on wrap instead.
+     */
+    class OpenGLStreamingBuffer
+    {
+    public:
+        /** @brief Uploads smaller than this are cheaper as a plain glBufferSubData */
+        static constexpr uint32_t MinStreamSize = 256;
+        /** @brief Alignment of each upload in the ring */
+        static constexpr size_t Alignment = 16;
+
+        /** @brief Create the staging buffer
+         * @param size Size of the ring in bytes, 0 disables streaming */
+        void Initialize(size_t size);
+        /** @brief Wait for all pending copies and delete the staging buffer */
+        void Release();
+
+        /** @brief Upload data into a range of a GL buffer through the ring
+         * @param dstBuffer GL name of the destination buffer
+         * @param dstOffset Offset in bytes into the destination buffer
+         * @param data Data to upload
+         * @param size Size in bytes of the data
+         * @returns false if the data could not be streamed and must be uploaded directly */
+        bool Upload(uint32_t dstBuffer, uint32_t dstOffset, const void* data, uint32_t size);
+        /** @brief Guard all uploads since the previous call with a fence */
+        void Fence();
+
+        /** @brief Whether the ring is persistently mapped, false when falling back to orphaning */
+        bool IsPersistent() const;
+
+    private:
+        void WaitForRange(size_t begin, size_t end);
+
+    private:
+        struct FencedRange
+        {
+            size_t m_Begin;
+            size_t m_End;
+            GLsync m_Fence;
+        };
+
+        uint32_t m_GLBufferID = 0;
+        size_t m_Size = 0;
+        size_t m_Head = 0;
+        size_t m_FenceBegin = 0;
+        uint8_t* m_pMapped = nullptr;
+        std::deque<FencedRange> m_Fences;
+    };
+}
@@ -8,8 +8,8 @@ layout(push_constant) uniform ConsoleRenderConstantsUBO
 layout(set = 0, std140, binding = 0) readonly uniform ConsoleRenderConstantsUBO
 #endif
 {
-	mat4 Model;
-	mat4 Projection;
+	mat4 ModelProjection;
+	float DistanceRange;
 } Constants;
 
 layout(location = 0) in vec2 inPosition;
@@ -17,10 +17,12 @@ layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 0) out vec2 outTexCoord;
 layout(location = 1) out vec3 outColor;
+layout(location = 2) flat out float outDistanceRange;
 
 void main()
 {
-    gl_Position = Constants.Projection*Constants.Model*vec4(inPosition.xy, 0.0, 1.0);
+    gl_Position = Constants.ModelProjection*vec4(inPosition.xy, 0.0, 1.0);
     outTexCoord = inTexCoord;
 	outColor = inColor;
+	outDistanceRange = Constants.DistanceRange;
 }
\ No newline at end of file
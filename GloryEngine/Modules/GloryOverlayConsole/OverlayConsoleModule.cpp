@@ -29,10 +29,11 @@ namespace Glory
 
 	float TextScaleFactor = 0.35f;
 
+	/** Projection and model are multiplied on the CPU so the constants fit in the guaranteed 128 bytes of push constants */
 	struct ConsoleRenderConstants
 	{
-		glm::mat4 Model;
-		glm::mat4 Projection;
+		glm::mat4 ModelProjection;
+		float DistanceRange;
 	};
 
 	OverlayConsoleModule::OverlayConsoleModule():
@@ -384,11 +385,14 @@ namespace Glory
 		m_InputTextBracketMesh = pDevice->AcquireCachedMesh(m_pInputTextBracketMesh.get());
 		m_CursorTextMesh = pDevice->AcquireCachedMesh(m_pInputTextCursorMesh.get());
 
+		glm::mat4 projection = glm::identity<glm::mat4>();
+		CalculateProjection(pDevice, projection, float(windowWidth), float(windowHeight));
+
 		ConsoleRenderConstants constants;
 		const glm::mat4 translation = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, windowHeight - consoleHeight + animatedConsoleHeight, 0.0f));
 		const glm::mat4 scale = glm::scale(glm::identity<glm::mat4>(), glm::vec3(float(windowWidth), float(consoleHeight), 1.0f));
-		constants.Model = translation*scale;
-		CalculateProjection(pDevice, constants.Projection, float(windowWidth), float(windowHeight));
+		constants.ModelProjection = projection*translation*scale;
+		constants.DistanceRange = 0.0f;
 
 		///* Draw background */
 		pDevice->BeginPipeline(commandBuffer, m_ConsoleBackgroundPipeline);
@@ -397,7 +401,8 @@ namespace Glory
 		pDevice->EndPipeline(commandBuffer);
 
 		///* Draw text */
-		constants.Model = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, windowHeight + animatedConsoleHeight - textStart, 0.0f));
+		constants.ModelProjection = projection*glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, windowHeight + animatedConsoleHeight - textStart, 0.0f));
+		constants.DistanceRange = pFont->DistanceRange();
 		pDevice->BeginPipeline(commandBuffer, m_ConsoleTextPipeline);
 		pDevice->BindDescriptorSets(commandBuffer, m_ConsoleTextPipeline, { m_TextRenderSet });
 		pDevice->PushConstants(commandBuffer, m_ConsoleTextPipeline, 0, sizeof(ConsoleRenderConstants), &constants, STF_Vertex);
@@ -405,7 +410,7 @@ namespace Glory
 
 		/* Draw input text bracket */
 		const float inputTextHeight = windowHeight + animatedConsoleHeight - consoleHeight + textLineHeight + consolePadding;
-		constants.Model = glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, inputTextHeight, 0.0f));
+		constants.ModelProjection = projection*glm::translate(glm::identity<glm::mat4>(), glm::vec3(0.0f, inputTextHeight, 0.0f));
 
 		pDevice->PushConstants(commandBuffer, m_ConsoleTextPipeline, 0, sizeof(ConsoleRenderConstants), &constants, STF_Vertex);
 		pDevice->DrawMesh(commandBuffer, m_InputTextBracketMesh);
@@ -417,7 +422,7 @@ namespace Glory
 		if (m_pInputTextMesh->VertexCount() > 0 && m_CursorPos > 0)
 		{
 			m_InputTextMesh = pDevice->AcquireCachedMesh(m_pInputTextMesh.get(), MU_Dynamic);
-			constants.Model = glm::translate(glm::identity<glm::mat4>(), glm::vec3(inputTextXOffset, inputTextHeight, 0.0f));
+			constants.ModelProjection = projection*glm::translate(glm::identity<glm::mat4>(), glm::vec3(inputTextXOffset, inputTextHeight, 0.0f));
 			pDevice->PushConstants(commandBuffer, m_ConsoleTextPipeline, 0, sizeof(ConsoleRenderConstants), &constants, STF_Vertex);
 			pDevice->DrawMesh(commandBuffer, m_InputTextMesh);
 		}
@@ -425,7 +430,7 @@ namespace Glory
 		/* Draw cursor */
 		if (m_CursorBlink)
 		{
-			constants.Model = glm::translate(glm::identity<glm::mat4>(), glm::vec3(inputTextXOffset + m_InputTextWidth, inputTextHeight, 0.0f));
+			constants.ModelProjection = projection*glm::translate(glm::identity<glm::mat4>(), glm::vec3(inputTextXOffset + m_InputTextWidth, inputTextHeight, 0.0f));
 			pDevice->PushConstants(commandBuffer, m_ConsoleTextPipeline, 0, sizeof(ConsoleRenderConstants), &constants, STF_Vertex);
 			pDevice->DrawMesh(commandBuffer, m_CursorTextMesh);
 		}
@@ -6,4 +6,11 @@ layout(set = 4, binding = 8, std430) readonly buffer MaterialSSBO
 Material GetMaterial()
 {
 	return Materials[Constants.MaterialIndex];
+}
+
+/* Normal maps can be compressed to their X and Y channels, so Z is always rebuilt */
+vec3 UnpackNormal(vec4 texel)
+{
+	vec2 xy = texel.xy*2.0 - 1.0;
+	return vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
 }
\ No newline at end of file
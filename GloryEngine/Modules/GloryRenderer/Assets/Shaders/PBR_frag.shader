@@ -58,7 +58,7 @@ void main()
 	vec4 baseColor = TextureEnabled(0) ? texture(texSampler, fragTexCoord) : vec4(1.0);
 
 	baseColor = (TextureEnabled(0) ? vec4(pow(baseColor.rgb, vec3(2.2)), baseColor.a) : mat.Color)*inColor;
-	vec3 normal = TextureEnabled(1) ? normalize(TBN*(texture(normalSampler, fragTexCoord).xyz*2.0 - 1.0)) : TBN[2];
+	vec3 normal = TextureEnabled(1) ? normalize(TBN*UnpackNormal(texture(normalSampler, fragTexCoord))) : TBN[2];
 	float ao = TextureEnabled(2) ? texture(ambientSampler, fragTexCoord).r : mat.AmbientOcclusion;
 	float roughness = TextureEnabled(3) ? texture(roughnessSampler, fragTexCoord).g : mat.RoughnessFactor;
 	float metallic = TextureEnabled(4) ? texture(metalnessSampler, fragTexCoord).b : mat.MetallicFactor;
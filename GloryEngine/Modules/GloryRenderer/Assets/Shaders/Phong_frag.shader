@@ -73,11 +73,11 @@ void main()
 #ifdef WITH_TEXTURED
 #ifdef ENABLE_BINDLESS
 	vec4 baseColor = SampleTexture2D(mat.texSampler, fragTexCoord, mat.Color*inColor.a)*inColor.a;
-	vec3 normal = normalize(TBN*(SampleTexture2D(mat.normalSampler, fragTexCoord, vec4(TBN[2], 1.0)).xyz*2.0 - 1.0));
+	vec3 normal = normalize(TBN*UnpackNormal(SampleTexture2D(mat.normalSampler, fragTexCoord, vec4(0.5, 0.5, 1.0, 1.0))));
 	float shininess = SampleTexture2D(mat.shininessSampler, fragTexCoord, vec4(mat.Shininess)).r;
 #else
 	vec4 baseColor = TextureEnabled(0) ? texture(texSampler, fragTexCoord)*inColor.a : mat.Color*inColor.a;
-	vec3 normal = TextureEnabled(1) ? normalize(TBN*(texture(normalSampler, fragTexCoord).xyz*2.0 - 1.0)) : TBN[2];
+	vec3 normal = TextureEnabled(1) ? normalize(TBN*UnpackNormal(texture(normalSampler, fragTexCoord))) : TBN[2];
 	float shininess = TextureEnabled(2) ? texture(shininessSampler, fragTexCoord).r : mat.Shininess;
 #endif
 #else
@@ -18,6 +18,7 @@
 
 #include <PipelineData.h>
 #include <MeshData.h>
+#include <MeshOptimizer.h>
 #include <MaterialData.h>
 #include <CubemapData.h>
 
@@ -33,6 +34,90 @@ namespace Glory
 	static const size_t MAX_KERNEL_SIZE = 1024;
 	static const size_t MAX_TEXTURES = 1024;
 
+	namespace
+	{
+		/* Camera state needed to pick mesh LODs */
+		struct LODView
+		{
+			glm::vec3 m_Position;
+			glm::mat4 m_Projection;
+			float m_Bias;
+			float m_Hysteresis;
+		};
+
+		MeshLOD SelectMeshLOD(const MeshData* pMeshData, const glm::mat4& world, uint32_t& currentLOD, const LODView& view)
+		{
+			const BoundingSphere& bounds = pMeshData->GetBoundingSphere();
+			const glm::vec3 center = world*glm::vec4(bounds.m_Center, 1.0f);
+			const float scale = std::max(glm::length(glm::vec3(world[0])),
+				std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+			const float distance = glm::distance(center, view.m_Position);
+
+			/* Clip space w of the sphere center, the distance for perspective projections and 1 for orthographic ones */
+			const float w = std::max(view.m_Projection[3][3] - view.m_Projection[2][3]*distance, 0.0001f);
+			const float screenSize = bounds.m_Radius*scale*std::abs(view.m_Projection[1][1])/w*view.m_Bias;
+
+			currentLOD = pMeshData->SelectLOD(screenSize, currentLOD, view.m_Hysteresis);
+			return pMeshData->GetLOD(currentLOD);
+		}
+
+		/* LOD an object was drawn at with a mesh, carried over from the previous frame for hysteresis */
+		uint32_t& ObjectLOD(UniqueCameraData& cameraData, UUID objectID, UUID meshID)
+		{
+			size_t key = 0;
+			CombineHash(key, uint64_t(objectID));
+			CombineHash(key, uint64_t(meshID));
+			auto iter = cameraData.m_ObjectLODs.find(key);
+			if (iter != cameraData.m_ObjectLODs.end()) return iter->second;
+			auto previousIter = cameraData.m_PreviousObjectLODs.find(key);
+			const uint32_t lod = previousIter != cameraData.m_PreviousObjectLODs.end() ? previousIter->second : 0;
+			return cameraData.m_ObjectLODs.emplace(key, lod).first->second;
+		}
+
+		/* Pipeline of a batch for the vertex layout of a mesh, nullptr if it wasn't acquired yet */
+		const MeshLayoutPipeline* FindLayoutPipeline(const PipelineBatchData& batchData, const MeshData* pMesh)
+		{
+			for (const MeshLayoutPipeline& layoutPipeline : batchData.m_LayoutPipelines)
+			{
+				if (layoutPipeline.m_Stride == pMesh->VertexSize() && layoutPipeline.m_Attributes == pMesh->AttributeTypesVector())
+					return &layoutPipeline;
+			}
+			return nullptr;
+		}
+
+		/* Planes of a view frustum with normals pointing inwards */
+		struct Frustum
+		{
+			glm::vec4 m_Planes[6];
+		};
+
+		Frustum ExtractFrustum(const glm::mat4& viewProjection)
+		{
+			/* Rows of the matrix, the near plane is the one for a -w to w depth range which also contains 0 to w */
+			const glm::mat4 rows = glm::transpose(viewProjection);
+			Frustum frustum;
+			frustum.m_Planes[0] = rows[3] + rows[0];
+			frustum.m_Planes[1] = rows[3] - rows[0];
+			frustum.m_Planes[2] = rows[3] + rows[1];
+			frustum.m_Planes[3] = rows[3] - rows[1];
+			frustum.m_Planes[4] = rows[3] + rows[2];
+			frustum.m_Planes[5] = rows[3] - rows[2];
+			for (glm::vec4& plane : frustum.m_Planes)
+				plane /= glm::length(glm::vec3(plane));
+			return frustum;
+		}
+
+		bool IsVisible(const Frustum& frustum, const BoundingSphere& bounds)
+		{
+			for (const glm::vec4& plane : frustum.m_Planes)
+			{
+				if (glm::dot(glm::vec3(plane), bounds.m_Center) + plane.w < -bounds.m_Radius)
+					return false;
+			}
+			return true;
+		}
+	}
+
 	GloryRenderer::GloryRenderer(): m_pModule(nullptr), Renderer(nullptr)
 	{
 	}
@@ -342,6 +427,9 @@ namespace Glory
 		for (size_t i = 0; i < MAX_LIGHTS; ++i)
 			ResetLightDistances[i] = NUM_DEPTH_SLICES;
 
+		m_ResetLightDistancesBuffer = pDevice->CreateBuffer(sizeof(uint32_t)*MAX_LIGHTS, BufferType::BT_TransferRead, BF_Write);
+		pDevice->AssignBuffer(m_ResetLightDistancesBuffer, ResetLightDistances);
+
 		assert(m_ImageCount > 0);
 
 		InitializeShadowRendering(pDevice);
@@ -382,7 +470,10 @@ namespace Glory
 		for (size_t i = 0; i < m_LightDistancesSSBOs.size(); ++i)
 		{
 			if (!m_LightDistancesSSBOs[i])
-				m_LightDistancesSSBOs[i] = pDevice->CreateBuffer(sizeof(uint32_t)*MAX_LIGHTS, BufferType::BT_Storage, BF_ReadAndWrite);
+			{
+				m_LightDistancesSSBOs[i] = pDevice->CreateBuffer(sizeof(uint32_t)*MAX_LIGHTS, BufferType::BT_Storage, BufferFlags(BF_CopySrc | BF_CopyDst));
+				pDevice->AssignBuffer(m_LightDistancesSSBOs[i], ResetLightDistances);
+			}
 
 			if (!m_LightDistancesSets[i])
 			{
@@ -670,47 +761,18 @@ namespace Glory
 		GraphicsDevice* pDevice = m_pModule->GetEngine()->ActiveGraphicsDevice();
 		if (!pDevice) return;
 
+		/* Deliver readbacks of frames that already finished without blocking */
+		pDevice->PollReadbacks();
+
 		for (;;)
 		{
 			if (!m_FrameCommandBuffers[m_CurrentFrameIndex]) break;
+			/* Readback results recorded in this frame are delivered by the device once the wait succeeds */
 			const GraphicsDevice::WaitResult result = pDevice->Wait(m_FrameCommandBuffers[m_CurrentFrameIndex], 1);
 			if (result == GraphicsDevice::WR_Success)
 			{
 				pDevice->Release(m_FrameCommandBuffers[m_CurrentFrameIndex]);
 				m_FrameCommandBuffers[m_CurrentFrameIndex] = 0;
-
-				/* Read buffers since they are guaranteed to be finished writing to */
-				const BufferHandle lightDistancesSSBO = m_LightDistancesSSBOs[m_CurrentFrameIndex];
-				pDevice->ReadBuffer(lightDistancesSSBO, m_ClosestLightDepthSlices.data(), 0, m_FrameData.ActiveLights.count()*sizeof(uint32_t));
-
-				/* @todo: Reset using a compute shader */
-				pDevice->AssignBuffer(lightDistancesSSBO, ResetLightDistances, 0, m_FrameData.ActiveLights.count()*sizeof(uint32_t));
-
-				/* Read picking results */
-				m_PickResults.clear();
-				for (size_t i = 0; i < m_ActiveCameras.size(); ++i)
-				{
-					CameraRef camera = m_ActiveCameras[i];
-					const UniqueCameraData& uniqueCameraData = m_UniqueCameraDatas.at(camera.GetUUID());
-					BufferHandle pickResults = uniqueCameraData.m_PickResultsSSBOs[m_CurrentFrameIndex];
-					uint32_t numPicks = 0;
-					pDevice->ReadBuffer(pickResults, &numPicks, 0, sizeof(uint32_t));
-					if (numPicks == 0) continue;
-
-					std::vector<GPUPickResult> results(numPicks);
-					pDevice->ReadBuffer(pickResults, results.data(), sizeof(uint32_t)*4, numPicks*sizeof(GPUPickResult));
-					const size_t start = m_PickResults.size();
-					m_PickResults.reserve(m_PickResults.size() + numPicks);
-
-					for (size_t j = 0; j < results.size(); ++j)
-					{
-						const GPUPickResult& pick = results[j];
-						if (!pick.SceneID || !pick.ObjectID) continue;
-						m_PickResults.emplace_back(PickResult{ camera.GetUUID(),
-							SceneObjectRef{ pick.SceneID, pick.ObjectID }, glm::vec3(pick.Position), glm::vec3(pick.Normal) });
-					}
-				}
-
 				break;
 			}
 			if (result == GraphicsDevice::WR_Timeout) continue;
@@ -796,6 +858,18 @@ namespace Glory
 
 		PrepareDataPass();
 
+		/* Request the texture mips each camera needs, the device streams them in at the end of the frame */
+		pDevice->SetTextureStreamingBudget(size_t(settings.Value<unsigned int>("Texture Streaming Budget"))*1024*1024);
+		/* Freed meshes, such as merged static meshes of a rebuilt batch, are never drawn again and lose their density */
+		std::swap(m_PreviousMeshUVDensities, m_MeshUVDensities);
+		m_MeshUVDensities.clear();
+		for (size_t i = 0; i < m_ActiveCameras.size(); ++i)
+		{
+			RequestTextureMips(StaticBatches(), m_StaticBatchData, i);
+			RequestTextureMips(m_DynamicPipelineRenderDatas, m_DynamicBatchData, i);
+			RequestTextureMips(m_DynamicLatePipelineRenderDatas, m_DynamicLateBatchData, i);
+		}
+
 		/* Make sure every camera has a render pass */
 		for (size_t i = 0; i < m_ActiveCameras.size(); ++i)
 		{
@@ -803,6 +877,10 @@ namespace Glory
 			UniqueCameraData& uniqueCameraData = m_UniqueCameraDatas.at(camera.GetUUID());
 			const auto& resolution = camera.GetResolution();
 
+			/* Keep the LODs of last frame around so only objects that are drawn again keep their history */
+			std::swap(uniqueCameraData.m_PreviousObjectLODs, uniqueCameraData.m_ObjectLODs);
+			uniqueCameraData.m_ObjectLODs.clear();
+
 			BufferHandle& clusterSSBOHandle = uniqueCameraData.m_ClusterSSBO;
 			if (!uniqueCameraData.m_ClusterSSBO)
 			{
@@ -881,6 +959,7 @@ namespace Glory
 			pDevice->SetRenderPassClear(renderPass, camera.GetClearColor());
 			pDevice->BeginRenderPass(m_FrameCommandBuffers[m_CurrentFrameIndex], renderPass);
 			SkyboxPass(m_FrameCommandBuffers[m_CurrentFrameIndex], static_cast<uint32_t>(i));
+			StaticObjectsPass(m_FrameCommandBuffers[m_CurrentFrameIndex], static_cast<uint32_t>(i));
 			DynamicObjectsPass(m_FrameCommandBuffers[m_CurrentFrameIndex], static_cast<uint32_t>(i));
 
 			if (m_LineVertexCount && LinesEnabled_Internal())
@@ -1151,6 +1230,8 @@ namespace Glory
 			pDevice->EndRenderPass(m_FrameCommandBuffers[m_CurrentFrameIndex]);
 		}
 
+		ReadbackPass(m_FrameCommandBuffers[m_CurrentFrameIndex]);
+
 		EndFrameCommands(waitSemaphores, signalSemaphores);
 	}
 
@@ -1482,7 +1563,10 @@ namespace Glory
 			}
 
 			if (!m_LightDistancesSSBOs[i])
-				m_LightDistancesSSBOs[i] = pDevice->CreateBuffer(sizeof(uint32_t)*MAX_LIGHTS, BufferType::BT_Storage, BF_ReadAndWrite);
+			{
+				m_LightDistancesSSBOs[i] = pDevice->CreateBuffer(sizeof(uint32_t)*MAX_LIGHTS, BufferType::BT_Storage, BufferFlags(BF_CopySrc | BF_CopyDst));
+				pDevice->AssignBuffer(m_LightDistancesSSBOs[i], ResetLightDistances);
+			}
 
 			if (!m_LightDistancesSets[i])
 			{
@@ -1537,10 +1621,20 @@ namespace Glory
 		constants.m_LightCount = m_FrameData.ActiveLights.count();
 		constants.m_GridSize = glm::uvec4(GridSizeX, GridSizeY, NUM_DEPTH_SLICES, 0.0f);
 		CameraRef camera = m_ActiveCameras[cameraIndex];
-		const UniqueCameraData& uniqueCameraData = m_UniqueCameraDatas.at(camera.GetUUID());
+		UniqueCameraData& uniqueCameraData = m_UniqueCameraDatas.at(camera.GetUUID());
 		const DescriptorSetHandle lightSet = uniqueCameraData.m_LightSets[m_CurrentFrameIndex];
 		const LayerMask& cameraMask = camera.GetLayerMask();
 
+		const ModuleSettings& settings = m_pModule->Settings();
+		LODView lodView;
+		lodView.m_Position = camera.GetViewInverse()[3];
+		lodView.m_Projection = camera.GetProjection();
+		lodView.m_Bias = settings.Value<float>("LOD Bias");
+		lodView.m_Hysteresis = settings.Value<float>("LOD Hysteresis");
+		const Frustum frustum = ExtractFrustum(camera.GetProjection()*camera.GetView());
+		/* Picking reads object IDs from this frame so merged objects are drawn one by one while a pick is pending */
+		const bool exactObjectIDs = !uniqueCameraData.m_Picks.empty();
+
 		for (auto pipelineID : m_pModule->PipelineOrder())
 		{
 			auto iter = std::find_if(batches.begin(), batches.end(),
@@ -1557,22 +1651,35 @@ namespace Glory
 
 			PipelineData* pPipelineData = pipelines.GetPipelineData(pipelineRenderData.m_PipelineID);
 			if (!pPipelineData) continue;
-			pDevice->BeginPipeline(commandBuffer, batchData.m_Pipeline);
-			if (viewport.z > 0.0f && viewport.w > 0.0f)
-			{
-				pDevice->SetViewport(commandBuffer, viewport.x, viewport.y, viewport.z, viewport.w);
-				pDevice->SetScissor(commandBuffer, int(viewport.x), int(viewport.y), viewport.z, viewport.w);
-			}
+			const bool isBindless = pPipelineData->HasDefine("ENABLE_BINDLESS");
 
-			pDevice->BindDescriptorSets(commandBuffer, batchData.m_Pipeline,
-				{ globalRenderSet, batchData.m_ObjectDataSet, m_GlobalLightSet, lightSet, batchData.m_MaterialSet });
+			/* Meshes of different vertex layouts need their own pipeline, it is only switched when the layout changes */
+			PipelineHandle boundPipeline = NULL;
+			const auto bindPipeline = [&](const MeshData* pMesh) {
+				const MeshLayoutPipeline* pLayoutPipeline = FindLayoutPipeline(batchData, pMesh);
+				const PipelineHandle pipeline = pLayoutPipeline ? pLayoutPipeline->m_Pipeline : NULL;
+				if (!pipeline) return false;
+				if (pipeline == boundPipeline) return true;
+				if (boundPipeline) pDevice->EndPipeline(commandBuffer);
+				boundPipeline = pipeline;
+
+				pDevice->BeginPipeline(commandBuffer, pipeline);
+				if (viewport.z > 0.0f && viewport.w > 0.0f)
+				{
+					pDevice->SetViewport(commandBuffer, viewport.x, viewport.y, viewport.z, viewport.w);
+					pDevice->SetScissor(commandBuffer, int(viewport.x), int(viewport.y), viewport.z, viewport.w);
+				}
 
-			if (shadowsSet)
-				pDevice->BindDescriptorSets(commandBuffer, batchData.m_Pipeline, { shadowsSet }, 5);
+				pDevice->BindDescriptorSets(commandBuffer, pipeline,
+					{ globalRenderSet, batchData.m_ObjectDataSet, m_GlobalLightSet, lightSet, batchData.m_MaterialSet });
 
-			const bool isBindless = pPipelineData->HasDefine("ENABLE_BINDLESS");
-			if (isBindless && pPipelineData->ResourcePropertyCount() > 0)
-				pDevice->BindDescriptorSets(commandBuffer, batchData.m_Pipeline, { m_GlobalSamplersSet }, 6);
+				if (shadowsSet)
+					pDevice->BindDescriptorSets(commandBuffer, pipeline, { shadowsSet }, 5);
+
+				if (isBindless && pPipelineData->ResourcePropertyCount() > 0)
+					pDevice->BindDescriptorSets(commandBuffer, pipeline, { m_GlobalSamplersSet }, 6);
+				return true;
+			};
 
 			if (pPipelineData->BlendEnabled())
 			{
@@ -1629,25 +1736,27 @@ namespace Glory
 						Resource* pMeshResource = resources.GetResource(meshBatch.m_Mesh);
 						if (!pMeshResource) continue;
 						MeshData* pMeshData = static_cast<MeshData*>(pMeshResource);
-						MeshHandle mesh = pDevice->AcquireCachedMesh(pMeshData);
-						if (!mesh) continue;
+						MeshHandle mesh = pDevice->AcquireCachedMesh(pMeshData, MU_Static, UM_Deferred);
+						if (!mesh || !bindPipeline(pMeshData)) continue;
 
 						if (cameraMask != 0 && meshBatch.m_LayerMasks[orderedObject.MeshObjectIndices[i]] != 0 &&
 							(cameraMask & meshBatch.m_LayerMasks[orderedObject.MeshObjectIndices[i]]) == 0) continue;
 
 						const auto& ids = meshBatch.m_ObjectIDs[orderedObject.MeshObjectIndices[i]];
+						const MeshLOD lod = pMeshData->LODCount() > 1 ? SelectMeshLOD(pMeshData, meshBatch.m_Worlds[orderedObject.MeshObjectIndices[i]],
+							ObjectLOD(uniqueCameraData, ids.second, meshBatch.m_Mesh), lodView) : pMeshData->GetLOD(0);
 						constants.m_ObjectID = ids.second;
 						constants.m_SceneID = ids.first;
 						constants.m_ObjectDataIndex = orderedObject.ObjectIndices[i];
 						constants.m_MaterialIndex = meshBatch.m_MaterialIndices[orderedObject.MeshObjectIndices[i]];
 
-						pDevice->PushConstants(commandBuffer, batchData.m_Pipeline, 0, sizeof(RenderConstants), &constants, ShaderTypeFlag(STF_Vertex | STF_Fragment));
+						pDevice->PushConstants(commandBuffer, boundPipeline, 0, sizeof(RenderConstants), &constants, ShaderTypeFlag(STF_Vertex | STF_Fragment));
 						if (!batchData.m_TextureSets.empty())
-							pDevice->BindDescriptorSets(commandBuffer, batchData.m_Pipeline, { batchData.m_TextureSets[constants.m_MaterialIndex] }, 6);
-						pDevice->DrawMesh(commandBuffer, mesh);
+							pDevice->BindDescriptorSets(commandBuffer, boundPipeline, { batchData.m_TextureSets[constants.m_MaterialIndex] }, 6);
+						pDevice->DrawMesh(commandBuffer, mesh, lod.m_IndexOffset, lod.m_IndexCount);
 					}
 				}
-				pDevice->EndPipeline(commandBuffer);
+				if (boundPipeline) pDevice->EndPipeline(commandBuffer);
 				return;
 			}
 
@@ -1656,10 +1765,62 @@ namespace Glory
 			{
 				const PipelineMeshBatch& meshBatch = pipelineRenderData.m_Meshes.at(uniqueMeshID);
 				Resource* pMeshResource = resources.GetResource(meshBatch.m_Mesh);
-				if (!pMeshResource) continue;
 				MeshData* pMeshData = static_cast<MeshData*>(pMeshResource);
-				MeshHandle mesh = pDevice->AcquireCachedMesh(pMeshData);
-				if (!mesh) continue;
+				/* Meshes that are still pending upload are skipped until they are ready */
+				MeshHandle mesh = pMeshData ? pDevice->AcquireCachedMesh(pMeshData, MU_Static, UM_Deferred) : NULL;
+				if (!mesh || !bindPipeline(pMeshData))
+				{
+					objectIndex += static_cast<uint32_t>(meshBatch.m_Worlds.size());
+					continue;
+				}
+
+				/* Merged static meshes cull every object they contain and draw the visible ranges */
+				auto subMeshIter = m_StaticSubMeshes.empty() ? m_StaticSubMeshes.end() : m_StaticSubMeshes.find(meshBatch.m_Mesh);
+				if (subMeshIter != m_StaticSubMeshes.end())
+				{
+					const uint32_t currentObject = objectIndex;
+					++objectIndex;
+
+					if (cameraMask != 0 && meshBatch.m_LayerMasks[0] != 0 &&
+						(cameraMask & meshBatch.m_LayerMasks[0]) == 0) continue;
+					if (!IsVisible(frustum, pMeshData->GetBoundingSphere())) continue;
+
+					constants.m_ObjectDataIndex = currentObject;
+					constants.m_MaterialIndex = meshBatch.m_MaterialIndices[0];
+					if (!batchData.m_TextureSets.empty())
+						pDevice->BindDescriptorSets(commandBuffer, boundPipeline, { batchData.m_TextureSets[constants.m_MaterialIndex] }, 6);
+
+					const std::vector<StaticSubMesh>& subMeshes = subMeshIter->second;
+					size_t runStart = 0;
+					size_t runEnd = 0;
+					const auto drawRun = [&]() {
+						if (runStart == runEnd) return;
+						const bool single = runEnd - runStart == 1;
+						constants.m_ObjectID = single ? subMeshes[runStart].m_ObjectIDs.second : UUID(0);
+						constants.m_SceneID = single ? subMeshes[runStart].m_ObjectIDs.first : meshBatch.m_ObjectIDs[0].first;
+						const uint32_t firstIndex = subMeshes[runStart].m_IndexOffset;
+						const uint32_t lastIndex = subMeshes[runEnd - 1].m_IndexOffset + subMeshes[runEnd - 1].m_IndexCount;
+						pDevice->PushConstants(commandBuffer, boundPipeline, 0, sizeof(RenderConstants), &constants, ShaderTypeFlag(STF_Vertex | STF_Fragment));
+						pDevice->DrawMesh(commandBuffer, mesh, firstIndex, lastIndex - firstIndex);
+					};
+					for (size_t i = 0; i < subMeshes.size(); ++i)
+					{
+						if (!IsVisible(frustum, subMeshes[i].m_Bounds))
+						{
+							drawRun();
+							runStart = runEnd = i + 1;
+							continue;
+						}
+						if (exactObjectIDs)
+						{
+							drawRun();
+							runStart = i;
+						}
+						runEnd = i + 1;
+					}
+					drawRun();
+					continue;
+				}
 
 				for (size_t i = 0; i < meshBatch.m_Worlds.size(); ++i)
 				{
@@ -1670,22 +1831,128 @@ namespace Glory
 						(cameraMask & meshBatch.m_LayerMasks[i]) == 0) continue;
 
 					const auto& ids = meshBatch.m_ObjectIDs[i];
+					const MeshLOD lod = pMeshData->LODCount() > 1 ?
+						SelectMeshLOD(pMeshData, meshBatch.m_Worlds[i], ObjectLOD(uniqueCameraData, ids.second, meshBatch.m_Mesh), lodView) : pMeshData->GetLOD(0);
 					constants.m_ObjectID = ids.second;
 					constants.m_SceneID = ids.first;
 					constants.m_ObjectDataIndex = currentObject;
 					constants.m_MaterialIndex = meshBatch.m_MaterialIndices[i];
 
-					pDevice->PushConstants(commandBuffer, batchData.m_Pipeline, 0, sizeof(RenderConstants), &constants, ShaderTypeFlag(STF_Vertex | STF_Fragment));
+					pDevice->PushConstants(commandBuffer, boundPipeline, 0, sizeof(RenderConstants), &constants, ShaderTypeFlag(STF_Vertex | STF_Fragment));
 					if (!batchData.m_TextureSets.empty())
-						pDevice->BindDescriptorSets(commandBuffer, batchData.m_Pipeline, { batchData.m_TextureSets[constants.m_MaterialIndex] }, 6);
-					pDevice->DrawMesh(commandBuffer, mesh);
+						pDevice->BindDescriptorSets(commandBuffer, boundPipeline, { batchData.m_TextureSets[constants.m_MaterialIndex] }, 6);
+					pDevice->DrawMesh(commandBuffer, mesh, lod.m_IndexOffset, lod.m_IndexCount);
 				}
 			}
 
-			pDevice->EndPipeline(commandBuffer);
+			if (boundPipeline) pDevice->EndPipeline(commandBuffer);
 		}
 	}
 
+	void GloryRenderer::RequestTextureMips(const std::vector<PipelineBatch>& batches, const std::vector<PipelineBatchData>& batchDatas, size_t cameraIndex)
+	{
+		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::RequestTextureMips" };
+		GraphicsDevice* pDevice = m_pModule->GetEngine()->ActiveGraphicsDevice();
+		Resources& resources = m_pModule->GetEngine()->GetResources();
+		CameraRef camera = m_ActiveCameras[cameraIndex];
+		const LayerMask& cameraMask = camera.GetLayerMask();
+		const glm::mat4& projection = camera.GetProjection();
+		const glm::vec3 cameraPosition = glm::vec3(camera.GetViewInverse()[3]);
+		const float halfHeight = float(camera.GetResolution().y)*std::abs(projection[1][1])/2.0f;
+		const Frustum frustum = ExtractFrustum(projection*camera.GetView());
+		const float mipBias = m_pModule->Settings().Value<float>("Texture Mip Bias");
+
+		/* Log2 of the texture coordinate units covered by a pixel, the mip of a texture adds log2 of its size */
+		const auto footprint = [&](const BoundingSphere& bounds, float uvDensity) {
+			if (uvDensity <= 0.0f) return -FLT_MAX;
+			const float distance = std::max(glm::distance(bounds.m_Center, cameraPosition) - bounds.m_Radius, 0.0f);
+			const float w = std::max(projection[3][3] - projection[2][3]*distance, 0.0001f);
+			const float pixelsPerUnit = halfHeight/w;
+			return std::log2(uvDensity/pixelsPerUnit);
+		};
+
+		std::vector<float> materialFootprints;
+		for (size_t batchIndex = 0; batchIndex < batches.size() && batchIndex < batchDatas.size(); ++batchIndex)
+		{
+			const PipelineBatch& batch = batches[batchIndex];
+			const PipelineBatchData& batchData = batchDatas[batchIndex];
+			if (batchData.m_MaterialTextureCount == 0) continue;
+
+			const size_t materialCount = batchData.m_MaterialTextures.size()/batchData.m_MaterialTextureCount;
+			materialFootprints.assign(materialCount, FLT_MAX);
+			for (UUID uniqueMeshID : batch.m_UniqueMeshOrder)
+			{
+				const PipelineMeshBatch& meshBatch = batch.m_Meshes.at(uniqueMeshID);
+				Resource* pMeshResource = resources.GetResource(meshBatch.m_Mesh);
+				if (!pMeshResource) continue;
+				MeshData* pMeshData = static_cast<MeshData*>(pMeshResource);
+				const float uvDensity = GetUVDensity(pMeshData);
+
+				auto subMeshIter = m_StaticSubMeshes.empty() ? m_StaticSubMeshes.end() : m_StaticSubMeshes.find(meshBatch.m_Mesh);
+				if (subMeshIter != m_StaticSubMeshes.end())
+				{
+					/* Merged meshes are in world space so their density needs no scale */
+					const uint32_t materialIndex = meshBatch.m_MaterialIndices[0];
+					if (materialIndex >= materialCount) continue;
+					if (cameraMask != 0 && meshBatch.m_LayerMasks[0] != 0 &&
+						(cameraMask & meshBatch.m_LayerMasks[0]) == 0) continue;
+					for (const StaticSubMesh& subMesh : subMeshIter->second)
+					{
+						if (!IsVisible(frustum, subMesh.m_Bounds)) continue;
+						materialFootprints[materialIndex] = std::min(materialFootprints[materialIndex], footprint(subMesh.m_Bounds, uvDensity));
+					}
+					continue;
+				}
+
+				const BoundingSphere& bounds = pMeshData->GetBoundingSphere();
+				for (size_t i = 0; i < meshBatch.m_Worlds.size(); ++i)
+				{
+					const uint32_t materialIndex = meshBatch.m_MaterialIndices[i];
+					if (materialIndex >= materialCount) continue;
+					if (cameraMask != 0 && meshBatch.m_LayerMasks[i] != 0 &&
+						(cameraMask & meshBatch.m_LayerMasks[i]) == 0) continue;
+
+					const glm::mat4& world = meshBatch.m_Worlds[i];
+					const float scale = std::max(glm::length(glm::vec3(world[0])),
+						std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+					const BoundingSphere worldBounds{ glm::vec3(world*glm::vec4(bounds.m_Center, 1.0f)), bounds.m_Radius*scale };
+					if (!IsVisible(frustum, worldBounds)) continue;
+					materialFootprints[materialIndex] = std::min(materialFootprints[materialIndex],
+						footprint(worldBounds, scale > 0.0f ? uvDensity/scale : 0.0f));
+				}
+			}
+
+			for (size_t materialIndex = 0; materialIndex < materialCount; ++materialIndex)
+			{
+				if (materialFootprints[materialIndex] == FLT_MAX) continue;
+				for (size_t t = 0; t < batchData.m_MaterialTextureCount; ++t)
+				{
+					const UUID textureID = batchData.m_MaterialTextures[materialIndex*batchData.m_MaterialTextureCount + t];
+					if (!textureID) continue;
+					Resource* pResource = resources.GetResource(textureID);
+					if (!pResource) continue;
+					TextureData* pTexture = static_cast<TextureData*>(pResource);
+					ImageData* pImage = pTexture->GetImageData(&resources);
+					if (!pImage) continue;
+					const float size = float(std::max(pImage->GetWidth(), pImage->GetHeight()));
+					pDevice->RequestTextureMip(pTexture, materialFootprints[materialIndex] + std::log2(size) + mipBias);
+				}
+			}
+		}
+	}
+
+	float GloryRenderer::GetUVDensity(MeshData* pMeshData)
+	{
+		auto iter = m_MeshUVDensities.find(pMeshData->GetUUID());
+		if (iter != m_MeshUVDensities.end() && iter->second.first == pMeshData->DirtyVersion())
+			return iter->second.second;
+		auto previousIter = m_PreviousMeshUVDensities.find(pMeshData->GetUUID());
+		const float density = previousIter != m_PreviousMeshUVDensities.end() && previousIter->second.first == pMeshData->DirtyVersion() ?
+			previousIter->second.second : ComputeUVDensity(pMeshData);
+		m_MeshUVDensities[pMeshData->GetUUID()] = { pMeshData->DirtyVersion(), density };
+		return density;
+	}
+
 	void GloryRenderer::PrepareDataPass()
 	{
 		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::PrepareDataPass" };
@@ -1743,16 +2010,16 @@ namespace Glory
 		}
 		if (m_LightCameraDatas)
 		{
-			const size_t dirtySize = m_LightCameraDatas.DirtySize();
-			pDevice->AssignBuffer(m_LightCameraDatasBuffer, m_LightCameraDatas.DirtyStart(),
-				m_LightCameraDatas.m_DirtyRange.first*sizeof(PerCameraData), dirtySize*sizeof(PerCameraData));
+			m_LightCameraDatas.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+				pDevice->AssignBuffer(m_LightCameraDatasBuffer, data, offset, size);
+			});
 		}
 
 		if (m_LightSpaceTransforms)
 		{
-			const size_t dirtySize = m_LightSpaceTransforms.DirtySize();
-			pDevice->AssignBuffer(m_LightSpaceTransformsSSBO, m_LightSpaceTransforms.DirtyStart(),
-				m_LightSpaceTransforms.m_DirtyRange.first*sizeof(glm::mat4), dirtySize*sizeof(glm::mat4));
+			m_LightSpaceTransforms.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+				pDevice->AssignBuffer(m_LightSpaceTransformsSSBO, data, offset, size);
+			});
 		}
 
 		if (ShadowsEnabled())
@@ -1792,9 +2059,28 @@ namespace Glory
 			}
 		}
 
-		/* Update light data */
-		pDevice->AssignBuffer(m_LightsSSBO, m_FrameData.ActiveLights.data(), 0, MAX_LIGHTS*sizeof(LightData));
+		/* Update light data, only lights that changed since last frame are uploaded */
+		const size_t lightCount = std::min(m_FrameData.ActiveLights.count(), size_t(MAX_LIGHTS));
+		if (m_Lights->size() < lightCount)
+			m_Lights.resize(lightCount);
+		for (size_t i = 0; i < lightCount; ++i)
+		{
+			const LightData& lightData = m_FrameData.ActiveLights[i];
+			if (std::memcmp(&m_Lights.m_Data[i], &lightData, sizeof(LightData)) == 0) continue;
+			m_Lights.m_Data[i] = lightData;
+			m_Lights.SetDirty(i);
+		}
+		if (m_Lights)
+		{
+			m_Lights.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+				pDevice->AssignBuffer(m_LightsSSBO, data, offset, size);
+			});
+		}
 
+		UpdateTextureSlots(pDevice);
+		m_StaticBatching = m_pModule->Settings().Value<bool>("Merge Static Meshes");
+		if (m_StaticBatching) BuildStaticBatches();
+		PrepareBatches(StaticBatches(), m_StaticBatchData);
 		PrepareBatches(m_DynamicPipelineRenderDatas, m_DynamicBatchData);
 		PrepareBatches(m_DynamicLatePipelineRenderDatas, m_DynamicLateBatchData);
 		PrepareLineMesh(pDevice);
@@ -1828,7 +2114,6 @@ namespace Glory
 		Resources& resources = m_pModule->GetEngine()->GetResources();
 
 		/* Prepare dynamic data */
-		size_t textureCounter = 0;
 		size_t batchIndex = 0;
 		batchDatas.reserve(batches.size());
 		for (const auto& pipelineBatch : batches)
@@ -1853,13 +2138,18 @@ namespace Glory
 				if (batchData.m_Worlds->size() < objectCount + meshBatch.m_Worlds.size())
 					batchData.m_Worlds.resize(objectCount + meshBatch.m_Worlds.size());
 
+				/* Quantized positions are mapped back to model space by the world transform */
+				Resource* pMeshResource = resources.GetResource(meshID);
+				MeshData* pMeshData = pMeshResource ? static_cast<MeshData*>(pMeshResource) : nullptr;
+				const bool quantized = pMeshData && pMeshData->HasQuantizedPositions();
+				const glm::mat4 dequantization = quantized ? pMeshData->PositionDequantization() : glm::mat4{};
+
 				for (size_t i = 0; i < meshBatch.m_Worlds.size(); ++i)
 				{
-					if (std::memcmp(&batchData.m_Worlds.m_Data[objectCount + i],
-						&meshBatch.m_Worlds[i], sizeof(glm::mat4)) != 0)
+					const glm::mat4 world = quantized ? meshBatch.m_Worlds[i]*dequantization : meshBatch.m_Worlds[i];
+					if (std::memcmp(&batchData.m_Worlds.m_Data[objectCount + i], &world, sizeof(glm::mat4)) != 0)
 					{
-						std::memcpy(&batchData.m_Worlds.m_Data[objectCount + i],
-							&meshBatch.m_Worlds[i], sizeof(glm::mat4));
+						std::memcpy(&batchData.m_Worlds.m_Data[objectCount + i], &world, sizeof(glm::mat4));
 						batchData.m_Worlds.SetDirty(objectCount + i);
 					}
 				}
@@ -1900,162 +2190,105 @@ namespace Glory
 			if (!isBindless && textureCount > 0 && batchData.m_TextureSets.size() < pipelineBatch.m_UniqueMaterials.size())
 				batchData.m_TextureSets.resize(pipelineBatch.m_UniqueMaterials.size(), nullptr);
 
-			/* Update material data buffers */
-			std::map<UUID, uint32_t> uniqueTextureIndexes;
+			/* Material slots keep their textures and versions across frames */
+			if (batchData.m_MaterialsPipelineID != pipelineBatch.m_PipelineID || pPipelineData->IsDirty(pipelineCacheVersion))
+			{
+				ReleaseMaterialTextures(batchData);
+				batchData.m_LayoutPipelines.clear();
+				batchData.m_MaterialsPipelineID = pipelineBatch.m_PipelineID;
+				batchData.m_MaterialTextureCount = textureCount;
+				std::fill(batchData.m_MaterialVersions.begin(), batchData.m_MaterialVersions.end(), 0);
+			}
+			if (batchData.m_MaterialVersions.size() < pipelineBatch.m_UniqueMaterials.size())
+				batchData.m_MaterialVersions.resize(pipelineBatch.m_UniqueMaterials.size(), 0);
+			if (batchData.m_MaterialTextures.size() < pipelineBatch.m_UniqueMaterials.size()*textureCount)
+				batchData.m_MaterialTextures.resize(pipelineBatch.m_UniqueMaterials.size()*textureCount, 0);
+
+			/* Update material data buffers, only materials and textures that changed are written */
 			for (size_t materialIndex = 0; materialIndex < pipelineBatch.m_UniqueMaterials.size(); ++materialIndex)
 			{
 				const UUID materialID = pipelineBatch.m_UniqueMaterials[materialIndex];
-				const bool differentMaterial = batchData.m_LastFrameUniqueMaterials[materialIndex] != materialID;
+				uint64_t& materialVersion = batchData.m_MaterialVersions[materialIndex];
+				if (batchData.m_LastFrameUniqueMaterials[materialIndex] != materialID)
+					materialVersion = 0;
 				batchData.m_LastFrameUniqueMaterials[materialIndex] = materialID;
-				uint64_t& materialCacheVersion = m_ResourceCacheVersions[materialID];
 
 				MaterialData* pMaterialData = materials.GetMaterial(materialID);
 				if (!pMaterialData) continue;
-				const auto& buffer = pMaterialData->GetBufferReference();
-				if (std::memcmp(&batchData.m_MaterialDatas.m_Data[materialIndex*finalPropertyDataSize], buffer.data(), basePropertyDataSize) != 0)
-				{
-					std::memcpy(&batchData.m_MaterialDatas.m_Data[materialIndex*finalPropertyDataSize], buffer.data(), basePropertyDataSize);
-					batchData.m_MaterialDatas.SetDirty(materialIndex);
-					batchData.m_MaterialDatas.SetDirty(materialIndex + finalPropertyDataSize - 1);
-				}
-				const uint32_t textureBits = pMaterialData->TextureSetBits();
-				if (!isBindless && textureCount && batchData.m_TextureBits.m_Data[materialIndex] != textureBits)
+				const bool materialDirty = pMaterialData->IsDirty(materialVersion);
+				materialVersion = pMaterialData->DirtyVersion();
+				if (materialDirty)
 				{
-					batchData.m_TextureBits.m_Data[materialIndex] = textureBits;
-					batchData.m_TextureBits.SetDirty(materialIndex);
+					const auto& buffer = pMaterialData->GetBufferReference();
+					std::memcpy(&batchData.m_MaterialDatas.m_Data[materialIndex*finalPropertyDataSize], buffer.data(),
+						std::min(buffer.size(), basePropertyDataSize));
+					batchData.m_MaterialDatas.SetDirty(materialIndex*finalPropertyDataSize, basePropertyDataSize);
+
+					if (!isBindless && textureCount)
+					{
+						batchData.m_TextureBits.m_Data[materialIndex] = pMaterialData->TextureSetBits();
+						batchData.m_TextureBits.SetDirty(materialIndex);
+					}
 				}
 
 				if (textureCount == 0)
 					continue;
 
-				if (m_AllTextures->size() < textureCounter + textureCount)
+				UUID* materialTextures = &batchData.m_MaterialTextures[materialIndex*textureCount];
+				bool texturesDirty = false;
+				for (size_t materialTextureIndex = 0; materialTextureIndex < textureCount; ++materialTextureIndex)
 				{
-					if (textureCounter + textureCount >= MAX_TEXTURES)
+					UUID& textureID = materialTextures[materialTextureIndex];
+					if (materialDirty)
 					{
-						m_pModule->GetEngine()->GetDebug().LogError("Max textures exceeded.");
-						continue;
+						const UUID newTextureID = pMaterialData->GetResourceUUIDPointer(materialTextureIndex)->GetUUID();
+						if (newTextureID != textureID)
+						{
+							if (textureID) ReleaseTextureSlot(textureID);
+							if (newTextureID) AcquireTextureSlot(newTextureID, pDevice, isBindless);
+							textureID = newTextureID;
+							texturesDirty = true;
+							continue;
+						}
 					}
-
-					m_AllTextures.resize(textureCounter + textureCount);
+					if (!textureID) continue;
+					auto slotIter = m_TextureSlots.find(textureID);
+					texturesDirty |= slotIter != m_TextureSlots.end() && slotIter->second.m_ChangedFrame == m_TextureSlotFrame;
 				}
 
 				if (isBindless)
 				{
-					bool texturesDirty = false;
-					std::vector<uint32_t> textureIds(textureCount);
-
+					if (!materialDirty && !texturesDirty) continue;
+					uint32_t* textureIds = reinterpret_cast<uint32_t*>(&batchData.m_MaterialDatas.m_Data[materialIndex*finalPropertyDataSize + basePropertyDataSize]);
 					for (size_t materialTextureIndex = 0; materialTextureIndex < textureCount; ++materialTextureIndex)
 					{
-						const UUID textureID = pMaterialData->GetResourceUUIDPointer(materialTextureIndex)->GetUUID();
-						uint64_t& textureCacheVersion = m_ResourceCacheVersions[textureID];
-						uint64_t& textureImageCacheVersion = m_TextureImageCacheVersions[textureID];
-						Resource* pResource = resources.GetResource(textureID);
-						TextureData* pTexture = pResource ? static_cast<TextureData*>(pResource) : nullptr;
-						ImageData* pImage = pTexture ? pTexture->GetImageData(&resources) : nullptr;
-						uint64_t* imageCacheVersion = pImage ? &m_ResourceCacheVersions[pImage->GetUUID()] : nullptr;
-						texturesDirty |= (pTexture ? pTexture->IsDirty(textureCacheVersion) : false) ||
-							(pImage ? (pImage->IsDirty(*imageCacheVersion) || pImage->IsDirty(textureImageCacheVersion)) : false);
-						textureCacheVersion = pTexture ? pTexture->DirtyVersion() : 0;
-
-						const TextureHandle texture = pImage ? pDevice->AcquireCachedTexture(pTexture) : nullptr;
-						auto textureIter = uniqueTextureIndexes.find(texture);
-						if (texture && !uniqueTextureIndexes.contains(texture))
-							textureIter = uniqueTextureIndexes.emplace(texture, textureCounter).first;
-
-						const uint32_t texId = texture ? textureIter->second : UINT32_MAX;
-						textureIds[materialTextureIndex] = texId;
-
-						if (texture && (texturesDirty || std::memcmp(&m_AllTextures.m_Data[texId], &texture, sizeof(TextureHandle)) != 0))
-						{
-							std::memcpy(&m_AllTextures.m_Data[texId], &texture, sizeof(TextureHandle));
-							m_AllTextures.SetDirty(texId);
-						}
-						if (texture)
-							++textureCounter;
-						if (pImage)
-						{
-							textureImageCacheVersion = pImage->DirtyVersion();
-							*imageCacheVersion = pImage->DirtyVersion();
-						}
-						else textureImageCacheVersion = 0;
-					}
-
-					if (std::memcmp(&batchData.m_MaterialDatas.m_Data[materialIndex*finalPropertyDataSize + basePropertyDataSize],
-						textureIds.data(), textureIds.size()*sizeof(uint32_t)) != 0)
-					{
-						std::memcpy(&batchData.m_MaterialDatas.m_Data[materialIndex*finalPropertyDataSize + basePropertyDataSize],
-							textureIds.data(), textureIds.size()*sizeof(uint32_t));
-						batchData.m_MaterialDatas.SetDirty(materialIndex*finalPropertyDataSize + basePropertyDataSize);
-						batchData.m_MaterialDatas.SetDirty(materialIndex*finalPropertyDataSize + basePropertyDataSize + textureIds.size()*sizeof(uint32_t));
+						const UUID textureID = materialTextures[materialTextureIndex];
+						auto slotIter = textureID ? m_TextureSlots.find(textureID) : m_TextureSlots.end();
+						const bool valid = slotIter != m_TextureSlots.end() && slotIter->second.m_HasImage &&
+							slotIter->second.m_Index != UINT32_MAX;
+						textureIds[materialTextureIndex] = valid ? slotIter->second.m_Index : UINT32_MAX;
 					}
-					materialCacheVersion = pMaterialData->DirtyVersion();
+					batchData.m_MaterialDatas.SetDirty(materialIndex*finalPropertyDataSize + basePropertyDataSize,
+						textureCount*sizeof(uint32_t));
 					continue;
 				}
 
 				/* Textures */
-				if (!isBindless && !batchData.m_TextureSets[materialIndex])
-				{
-					DescriptorSetInfo setInfo;
-					setInfo.m_Layout = batchData.m_TextureSetLayout;
-					setInfo.m_Samplers.resize(textureCount);
-					for (size_t j = 0; j < textureCount; ++j)
-					{
-						const UUID textureID = pMaterialData->GetResourceUUIDPointer(j)->GetUUID();
-						Resource* pResource = resources.GetResource(textureID);
-						if (!pResource)
-						{
-							setInfo.m_Samplers[j].m_TextureHandle = NULL;
-							continue;
-						}
-						TextureData* pTexture = static_cast<TextureData*>(pResource);
-						setInfo.m_Samplers[j].m_TextureHandle = pDevice->AcquireCachedTexture(pTexture);
-					}
-					batchData.m_TextureSets[materialIndex] = pDevice->CreateDescriptorSet(std::move(setInfo));
-					materialCacheVersion = pMaterialData->DirtyVersion();
+				if (batchData.m_TextureSets[materialIndex] && !materialDirty && !texturesDirty)
 					continue;
-				}
 
-				std::vector<TextureData*> textures(textureCount);
-				bool texturesDirty = false;
+				/* Materials with the same textures share a cached set */
+				DescriptorSetInfo setInfo;
+				setInfo.m_Layout = batchData.m_TextureSetLayout;
+				setInfo.m_Samplers.resize(textureCount);
 				for (size_t materialTextureIndex = 0; materialTextureIndex < textureCount; ++materialTextureIndex)
 				{
-					const UUID textureID = pMaterialData->GetResourceUUIDPointer(materialTextureIndex)->GetUUID();
-					uint64_t& textureCacheVersion = m_ResourceCacheVersions[textureID];
-					uint64_t& textureImageCacheVersion = m_TextureImageCacheVersions[textureID];
-					Resource* pResource = resources.GetResource(textureID);
-					if (!pResource)
-					{
-						textures[materialTextureIndex] = NULL;
-						continue;
-					}
-					textures[materialTextureIndex] = static_cast<TextureData*>(pResource);
-					ImageData* pImage = textures[materialTextureIndex]->GetImageData(&resources);
-					uint64_t* imageCacheVersion = pImage ? &m_ResourceCacheVersions[pImage->GetUUID()] : nullptr;
-					texturesDirty |= textures[materialTextureIndex]->IsDirty(textureCacheVersion) ||
-						(pImage ? (pImage->IsDirty(*imageCacheVersion) || pImage->IsDirty(textureImageCacheVersion)) : false);
-					textureCacheVersion = textures[materialTextureIndex]->DirtyVersion();
-					if (pImage)
-					{
-						textureImageCacheVersion = pImage->DirtyVersion();
-						*imageCacheVersion = pImage->DirtyVersion();
-					}
-					else textureImageCacheVersion = 0;
+					const UUID textureID = materialTextures[materialTextureIndex];
+					auto slotIter = textureID ? m_TextureSlots.find(textureID) : m_TextureSlots.end();
+					const TextureHandle texture = slotIter != m_TextureSlots.end() ? slotIter->second.m_Texture : NULL;
+					setInfo.m_Samplers[materialTextureIndex].m_TextureHandle = texture ? texture : pDevice->GetDefaultTexture();
 				}
-
-				if (pMaterialData->IsDirty(materialCacheVersion) || differentMaterial || texturesDirty)
-				{
-					DescriptorSetUpdateInfo dsUpdateInfo;
-					dsUpdateInfo.m_Samplers.resize(textureCount);
-					for (size_t j = 0; j < textureCount; ++j)
-					{
-						TextureData* pTexture = textures[j];
-						const TextureHandle texture = pDevice->AcquireCachedTexture(pTexture);
-						dsUpdateInfo.m_Samplers[j].m_TextureHandles = &texture;
-						dsUpdateInfo.m_Samplers[j].m_DescriptorIndex = j;
-					}
-					pDevice->UpdateDescriptorSet(batchData.m_TextureSets[materialIndex], dsUpdateInfo);
-				}
-				materialCacheVersion = pMaterialData->DirtyVersion();
+				batchData.m_TextureSets[materialIndex] = pDevice->AcquireCachedDescriptorSet(std::move(setInfo));
 			}
 
 			if (!batchData.m_WorldsBuffer)
@@ -2067,9 +2300,9 @@ namespace Glory
 				pDevice->ResizeBuffer(batchData.m_WorldsBuffer, batchData.m_Worlds.TotalByteSize());
 			if (batchData.m_Worlds)
 			{
-				const size_t dirtySize = batchData.m_Worlds.DirtySize();
-				pDevice->AssignBuffer(batchData.m_WorldsBuffer, batchData.m_Worlds.DirtyStart(),
-					batchData.m_Worlds.m_DirtyRange.first*sizeof(glm::mat4), dirtySize*sizeof(glm::mat4));
+				batchData.m_Worlds.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+					pDevice->AssignBuffer(batchData.m_WorldsBuffer, data, offset, size);
+				});
 			}
 
 			if (!batchData.m_MaterialsBuffer)
@@ -2082,9 +2315,9 @@ namespace Glory
 
 			if (batchData.m_MaterialDatas)
 			{
-				const size_t dirtySize = batchData.m_MaterialDatas.DirtySize();
-				pDevice->AssignBuffer(batchData.m_MaterialsBuffer, batchData.m_MaterialDatas.DirtyStart(),
-					batchData.m_MaterialDatas.m_DirtyRange.first, dirtySize);
+				batchData.m_MaterialDatas.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+					pDevice->AssignBuffer(batchData.m_MaterialsBuffer, data, offset, size);
+				});
 			}
 
 			if (!isBindless && textureCount && !batchData.m_TextureBitsBuffer)
@@ -2096,9 +2329,9 @@ namespace Glory
 				pDevice->ResizeBuffer(batchData.m_TextureBitsBuffer, batchData.m_TextureBits.TotalByteSize());
 			if (!isBindless && textureCount && batchData.m_TextureBits)
 			{
-				const size_t dirtySize = batchData.m_TextureBits.DirtySize();
-				pDevice->AssignBuffer(batchData.m_TextureBitsBuffer, batchData.m_TextureBits.DirtyStart(),
-					batchData.m_TextureBits.m_DirtyRange.first*sizeof(uint32_t), dirtySize*sizeof(uint32_t));
+				batchData.m_TextureBits.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+					pDevice->AssignBuffer(batchData.m_TextureBitsBuffer, data, offset, size);
+				});
 			}
 
 			if (!batchData.m_ObjectDataSet)
@@ -2168,28 +2401,39 @@ namespace Glory
 				pDevice->UpdateDescriptorSet(batchData.m_MaterialSet, dsWrite);
 			}
 
+			std::vector<DescriptorSetLayoutHandle> descriptorSetLayouts(textureCount ? 7 : 6);
+			descriptorSetLayouts[0] = RendererDSLayouts::m_GlobalRenderSetLayout;
+			descriptorSetLayouts[1] = RendererDSLayouts::m_ObjectDataSetLayout;
+			descriptorSetLayouts[2] = RendererDSLayouts::m_GlobalLightSetLayout;
+			descriptorSetLayouts[3] = RendererDSLayouts::m_CameraLightSetLayout;
+			descriptorSetLayouts[4] = batchData.m_MaterialSetLayout;
+			descriptorSetLayouts[5] = RendererDSLayouts::m_ShadowAtlasSamplerSetLayout;
+			if (!isBindless && textureCount) descriptorSetLayouts[6] = batchData.m_TextureSetLayout;
+			else if (textureCount) descriptorSetLayouts[6] = RendererDSLayouts::m_GlobalSamplersLayout;
+
 			if (!batchData.m_Pipeline || pPipelineData->IsDirty(pipelineCacheVersion) || pPipelineData->SettingsDirty())
 			{
-				std::vector<DescriptorSetLayoutHandle> descriptorSetLayouts(textureCount ? 7 : 6);
-				descriptorSetLayouts[0] = RendererDSLayouts::m_GlobalRenderSetLayout;
-				descriptorSetLayouts[1] = RendererDSLayouts::m_ObjectDataSetLayout;
-				descriptorSetLayouts[2] = RendererDSLayouts::m_GlobalLightSetLayout;
-				descriptorSetLayouts[3] = RendererDSLayouts::m_CameraLightSetLayout;
-				descriptorSetLayouts[4] = batchData.m_MaterialSetLayout;
-				descriptorSetLayouts[5] = RendererDSLayouts::m_ShadowAtlasSamplerSetLayout;
-				if (!isBindless && textureCount) descriptorSetLayouts[6] = batchData.m_TextureSetLayout;
-				else if (textureCount) descriptorSetLayouts[6] = RendererDSLayouts::m_GlobalSamplersLayout;
-
-				PipelineData* pPipelineData = pipelines.GetPipelineData(pipelineBatch.m_PipelineID);
-				if (!pPipelineData) continue;
 				Resource* pMeshResource = resources.GetResource(pipelineBatch.m_UniqueMeshOrder[0]);
 				if (!pMeshResource) continue;
 				MeshData* pMesh = static_cast<MeshData*>(pMeshResource);
+				/* Updates the pipelines of all vertex layouts, their handles stay the same */
 				batchData.m_Pipeline = pDevice->AcquireCachedPipeline(defaultRenderPass, pPipelineData,
-					std::move(descriptorSetLayouts), pMesh->VertexSize(), pMesh->AttributeTypesVector());
+					std::vector<DescriptorSetLayoutHandle>(descriptorSetLayouts), pMesh->VertexSize(), pMesh->AttributeTypesVector());
 				pipelineCacheVersion = pPipelineData->DirtyVersion();
 			}
 
+			/* Every vertex layout in the batch gets its own pipeline from the device cache */
+			for (const UUID meshID : pipelineBatch.m_UniqueMeshOrder)
+			{
+				Resource* pMeshResource = resources.GetResource(meshID);
+				if (!pMeshResource) continue;
+				const MeshData* pMesh = static_cast<const MeshData*>(pMeshResource);
+				if (FindLayoutPipeline(batchData, pMesh)) continue;
+				const PipelineHandle pipeline = pDevice->AcquireCachedPipeline(defaultRenderPass, pPipelineData,
+					std::vector<DescriptorSetLayoutHandle>(descriptorSetLayouts), pMesh->VertexSize(), pMesh->AttributeTypesVector());
+				batchData.m_LayoutPipelines.push_back(MeshLayoutPipeline{ pMesh->VertexSize(), pMesh->AttributeTypesVector(), pipeline });
+			}
+
 			if (m_AllTextures)
 			{
 				DescriptorSetUpdateInfo updateInfo;
@@ -2202,6 +2446,107 @@ namespace Glory
 		}
 	}
 
+	TextureSlot* GloryRenderer::AcquireTextureSlot(UUID textureID, GraphicsDevice* pDevice, bool bindless)
+	{
+		auto iter = m_TextureSlots.find(textureID);
+		const bool newSlot = iter == m_TextureSlots.end();
+		if (newSlot)
+			iter = m_TextureSlots.emplace(textureID, TextureSlot{}).first;
+
+		TextureSlot& slot = iter->second;
+		++slot.m_References;
+		if (bindless && slot.m_Index == UINT32_MAX)
+		{
+			if (!m_FreeTextureSlots.empty())
+			{
+				slot.m_Index = m_FreeTextureSlots.back();
+				m_FreeTextureSlots.pop_back();
+			}
+			else if (m_AllTextures->size() < MAX_TEXTURES)
+			{
+				slot.m_Index = static_cast<uint32_t>(m_AllTextures->size());
+				m_AllTextures.resize(m_AllTextures->size() + 1);
+			}
+			else
+				m_pModule->GetEngine()->GetDebug().LogError("GloryRenderer::AcquireTextureSlot: Max textures exceeded.");
+
+			if (!newSlot && slot.m_Index != UINT32_MAX && slot.m_HasImage)
+			{
+				m_AllTextures.m_Data[slot.m_Index] = slot.m_Texture;
+				m_AllTextures.SetDirty(slot.m_Index);
+			}
+		}
+
+		if (newSlot)
+			RefreshTextureSlot(textureID, slot, pDevice);
+		return &slot;
+	}
+
+	void GloryRenderer::ReleaseTextureSlot(UUID textureID)
+	{
+		auto iter = m_TextureSlots.find(textureID);
+		if (iter == m_TextureSlots.end()) return;
+		TextureSlot& slot = iter->second;
+		if (--slot.m_References > 0) return;
+		if (slot.m_Index != UINT32_MAX)
+			m_FreeTextureSlots.push_back(slot.m_Index);
+		m_TextureSlots.erase(iter);
+	}
+
+	void GloryRenderer::ReleaseMaterialTextures(PipelineBatchData& batchData)
+	{
+		for (const UUID textureID : batchData.m_MaterialTextures)
+		{
+			if (!textureID) continue;
+			ReleaseTextureSlot(textureID);
+		}
+		batchData.m_MaterialTextures.clear();
+	}
+
+	bool GloryRenderer::RefreshTextureSlot(UUID textureID, TextureSlot& slot, GraphicsDevice* pDevice)
+	{
+		Resources& resources = m_pModule->GetEngine()->GetResources();
+		Resource* pResource = resources.GetResource(textureID);
+		TextureData* pTexture = pResource ? static_cast<TextureData*>(pResource) : nullptr;
+		ImageData* pImage = pTexture ? pTexture->GetImageData(&resources) : nullptr;
+		const uint64_t textureVersion = pTexture ? pTexture->DirtyVersion() : 0;
+		const uint64_t imageVersion = pImage ? pImage->DirtyVersion() : 0;
+		/* Streamed textures get a new handle when their resident mips change */
+		const uint64_t residencyVersion = pDevice->TextureResidencyVersion(pTexture);
+		if (slot.m_ChangedFrame && !slot.m_Pending && slot.m_TextureVersion == textureVersion &&
+			slot.m_ImageVersion == imageVersion && slot.m_ResidencyVersion == residencyVersion)
+			return false;
+
+		/* While the upload is pending the slot has no texture and materials use the default texture */
+		const TextureHandle texture = pTexture ? pDevice->AcquireCachedTexture(pTexture, UM_Deferred) : NULL;
+		const bool pending = !texture && pDevice->IsUploadPending(pTexture);
+		if (slot.m_ChangedFrame && slot.m_Pending && pending)
+			return false;
+
+		slot.m_TextureVersion = textureVersion;
+		slot.m_ImageVersion = imageVersion;
+		slot.m_ResidencyVersion = pDevice->TextureResidencyVersion(pTexture);
+		slot.m_Texture = texture;
+		slot.m_Pending = pending;
+		slot.m_HasImage = pImage && slot.m_Texture;
+		slot.m_ChangedFrame = m_TextureSlotFrame;
+
+		if (slot.m_Index != UINT32_MAX && slot.m_HasImage)
+		{
+			m_AllTextures.m_Data[slot.m_Index] = slot.m_Texture;
+			m_AllTextures.SetDirty(slot.m_Index);
+		}
+		return true;
+	}
+
+	void GloryRenderer::UpdateTextureSlots(GraphicsDevice* pDevice)
+	{
+		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::UpdateTextureSlots" };
+		++m_TextureSlotFrame;
+		for (auto& [textureID, slot] : m_TextureSlots)
+			RefreshTextureSlot(textureID, slot, pDevice);
+	}
+
 	void GloryRenderer::GenerateClusterSSBO(uint32_t cameraIndex, GraphicsDevice* pDevice, CameraRef camera, DescriptorSetHandle clusterSet)
 	{
 		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::GenerateClusterSSBO" };
@@ -2347,6 +2692,15 @@ namespace Glory
 		pDevice->EndPipeline(commandBuffer);
 	}
 
+	void GloryRenderer::StaticObjectsPass(CommandBufferHandle commandBuffer, uint32_t cameraIndex)
+	{
+		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::StaticObjectsPass" };
+		CameraRef camera = m_ActiveCameras[cameraIndex];
+		DescriptorSetHandle shadowAtlasSet = m_ShadowAtlasSamplerSets[m_CurrentFrameIndex];
+		RenderBatches(commandBuffer, StaticBatches(), m_StaticBatchData, cameraIndex, m_GlobalRenderSet,
+			{ 0.0f, 0.0f, camera.GetResolution() }, shadowAtlasSet);
+	}
+
 	void GloryRenderer::DynamicObjectsPass(CommandBufferHandle commandBuffer, uint32_t cameraIndex)
 	{
 		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::DynamicObjectsPass" };
@@ -2460,41 +2814,68 @@ namespace Glory
 	{
 		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::RenderShadows" };
 		GraphicsDevice* pDevice = m_pModule->GetEngine()->ActiveGraphicsDevice();
-		MaterialManager& materialManager = m_pModule->GetEngine()->GetMaterialManager();
-		PipelineManager& pipelines = m_pModule->GetEngine()->GetPipelineManager();
-		Resources& resources = m_pModule->GetEngine()->GetResources();
 
 		RenderConstants constants;
 		constants.m_CameraIndex = static_cast<uint32_t>(lightIndex);
 		constants.m_LightCount = m_FrameData.ActiveLights.count();
 
-		pDevice->BeginPipeline(commandBuffer, RendererPipelines::m_ShadowRenderPipeline);
+		PipelineHandle boundPipeline = NULL;
+		RenderShadowBatches(commandBuffer, StaticBatches(), m_StaticBatchData, constants, viewport, boundPipeline);
+		RenderShadowBatches(commandBuffer, m_DynamicPipelineRenderDatas, m_DynamicBatchData, constants, viewport, boundPipeline);
+		if (boundPipeline) pDevice->EndPipeline(commandBuffer);
+	}
+
+	void GloryRenderer::RenderShadowBatches(CommandBufferHandle commandBuffer, const std::vector<PipelineBatch>& batches,
+		const std::vector<PipelineBatchData>& batchDatas, RenderConstants& constants, const glm::vec4& viewport,
+		PipelineHandle& boundPipeline)
+	{
+		GraphicsDevice* pDevice = m_pModule->GetEngine()->ActiveGraphicsDevice();
+		MaterialManager& materialManager = m_pModule->GetEngine()->GetMaterialManager();
+		Resources& resources = m_pModule->GetEngine()->GetResources();
 
 		size_t batchIndex = 0;
-		for (const PipelineBatch& pipelineRenderData : m_DynamicPipelineRenderDatas)
+		for (const PipelineBatch& pipelineRenderData : batches)
 		{
-			if (batchIndex >= m_DynamicBatchData.size()) break;
-			const PipelineBatchData& batchData = m_DynamicBatchData.at(batchIndex);
+			if (batchIndex >= batchDatas.size()) break;
+			const PipelineBatchData& batchData = batchDatas.at(batchIndex);
 			++batchIndex;
-
-			if (viewport.z > 0.0f && viewport.w > 0.0f)
-			{
-				pDevice->SetViewport(commandBuffer, viewport.x, viewport.y, viewport.z, viewport.w);
-				pDevice->SetScissor(commandBuffer, int(viewport.x), int(viewport.y), viewport.z, viewport.w);
-			}
-
-			pDevice->BindDescriptorSets(commandBuffer, batchData.m_Pipeline,
-				{ m_GlobalShadowRenderSet, batchData.m_ObjectDataSet });
+			bool setsBound = false;
 
 			uint32_t objectIndex = 0;
 			for (UUID uniqueMeshID : pipelineRenderData.m_UniqueMeshOrder)
 			{
 				const PipelineMeshBatch& meshBatch = pipelineRenderData.m_Meshes.at(uniqueMeshID);
 				Resource* pMeshResource = resources.GetResource(meshBatch.m_Mesh);
-				if (!pMeshResource) continue;
 				MeshData* pMeshData = static_cast<MeshData*>(pMeshResource);
-				MeshHandle mesh = pDevice->AcquireCachedMesh(pMeshData);
-				if (!mesh) continue;
+				/* Meshes that are still pending upload are skipped until they are ready */
+				MeshHandle mesh = pMeshData ? pDevice->AcquireCachedMesh(pMeshData, MU_Static, UM_Deferred) : NULL;
+				const PipelineHandle shadowPipeline = mesh ? ShadowPipeline(pDevice, pMeshData) : NULL;
+				if (!shadowPipeline)
+				{
+					objectIndex += static_cast<uint32_t>(meshBatch.m_Worlds.size());
+					continue;
+				}
+
+				if (shadowPipeline != boundPipeline)
+				{
+					if (boundPipeline) pDevice->EndPipeline(commandBuffer);
+					pDevice->BeginPipeline(commandBuffer, shadowPipeline);
+					boundPipeline = shadowPipeline;
+					setsBound = false;
+				}
+
+				if (!setsBound)
+				{
+					if (viewport.z > 0.0f && viewport.w > 0.0f)
+					{
+						pDevice->SetViewport(commandBuffer, viewport.x, viewport.y, viewport.z, viewport.w);
+						pDevice->SetScissor(commandBuffer, int(viewport.x), int(viewport.y), viewport.z, viewport.w);
+					}
+
+					pDevice->BindDescriptorSets(commandBuffer, shadowPipeline,
+						{ m_GlobalShadowRenderSet, batchData.m_ObjectDataSet });
+					setsBound = true;
+				}
 
 				for (size_t i = 0; i < meshBatch.m_Worlds.size(); ++i)
 				{
@@ -2511,13 +2892,108 @@ namespace Glory
 					constants.m_ObjectDataIndex = currentObject;
 					constants.m_MaterialIndex = meshBatch.m_MaterialIndices[i];
 
-					pDevice->PushConstants(commandBuffer, batchData.m_Pipeline, 0, sizeof(RenderConstants), &constants, ShaderTypeFlag(STF_Vertex | STF_Fragment));
+					pDevice->PushConstants(commandBuffer, shadowPipeline, 0, sizeof(RenderConstants), &constants, ShaderTypeFlag(STF_Vertex | STF_Fragment));
 					pDevice->DrawMesh(commandBuffer, mesh);
 				}
 			}
 		}
+	}
 
-		pDevice->EndPipeline(commandBuffer);
+	PipelineHandle GloryRenderer::ShadowPipeline(GraphicsDevice* pDevice, const MeshData* pMesh)
+	{
+		const std::vector<AttributeType>& attributes = pMesh->AttributeTypesVector();
+		if (pMesh->VertexSize() == sizeof(CompactVertex3D) && attributes == RendererPipelines::m_ShadowVertexAttributes)
+			return RendererPipelines::m_ShadowRenderPipeline;
+
+		PipelineManager& pipelines = m_pModule->GetEngine()->GetPipelineManager();
+		const UUID shadowsPipeline = m_pModule->Settings().Value<uint64_t>("Shadows Pipeline");
+		PipelineData* pPipeline = pipelines.GetPipelineData(shadowsPipeline);
+		if (!pPipeline || m_ShadowsPasses.empty()) return NULL;
+
+		/* Meshes of layouts the pipeline can't be created for are left out of the shadows */
+		return pDevice->AcquireCachedPipeline(m_ShadowsPasses[0], pPipeline,
+			{ RendererDSLayouts::m_GlobalShadowRenderSetLayout, RendererDSLayouts::m_ObjectDataSetLayout },
+			pMesh->VertexSize(), attributes);
+	}
+
+	const std::vector<PipelineBatch>& GloryRenderer::StaticBatches() const
+	{
+		return m_StaticBatching ? m_StaticBatches : m_StaticPipelineRenderDatas;
+	}
+
+	void GloryRenderer::ReadbackPass(CommandBufferHandle commandBuffer)
+	{
+		ProfileSample s{ &m_pModule->GetEngine()->Profiler(), "GloryRenderer::ReadbackPass" };
+		GraphicsDevice* pDevice = m_pModule->GetEngine()->ActiveGraphicsDevice();
+
+		/* Light distances, results arrive once this frame has finished on the GPU */
+		const BufferHandle lightDistancesSSBO = m_LightDistancesSSBOs[m_CurrentFrameIndex];
+		const uint32_t lightCount = uint32_t(std::min(m_FrameData.ActiveLights.count(), size_t(MAX_LIGHTS)));
+		if (lightCount > 0)
+		{
+			const uint32_t size = lightCount*sizeof(uint32_t);
+			BufferBarrier lightDistancesBarrier;
+			lightDistancesBarrier.m_Buffer = lightDistancesSSBO;
+			lightDistancesBarrier.m_SrcAccessMask = AF_ShaderWrite;
+			lightDistancesBarrier.m_DstAccessMask = AF_CopySrc;
+			pDevice->PipelineBarrier(commandBuffer, { lightDistancesBarrier }, {},
+				PipelineStageFlagBits::PST_ComputeShader, PipelineStageFlagBits::PST_Transfer);
+
+			pDevice->Readback(commandBuffer, lightDistancesSSBO, 0, size, [this](const void* data, uint32_t dataSize) {
+				std::memcpy(m_ClosestLightDepthSlices.data(), data, dataSize);
+			});
+
+			/* Reset for the next use of this frame */
+			BufferBarrier resetBarrier;
+			resetBarrier.m_Buffer = lightDistancesSSBO;
+			resetBarrier.m_SrcAccessMask = AF_CopySrc;
+			resetBarrier.m_DstAccessMask = AF_CopyDst;
+			pDevice->PipelineBarrier(commandBuffer, { resetBarrier }, {},
+				PipelineStageFlagBits::PST_Transfer, PipelineStageFlagBits::PST_Transfer);
+			pDevice->CopyBuffer(commandBuffer, m_ResetLightDistancesBuffer, lightDistancesSSBO, 0, 0, size);
+
+			resetBarrier.m_SrcAccessMask = AF_CopyDst;
+			resetBarrier.m_DstAccessMask = AccessFlags(AF_ShaderRead | AF_ShaderWrite);
+			pDevice->PipelineBarrier(commandBuffer, { resetBarrier }, {},
+				PipelineStageFlagBits::PST_Transfer, PipelineStageFlagBits::PST_ComputeShader);
+		}
+
+		/* Picking results, the first camera with picks replaces the results of the previous frame */
+		bool clearResults = true;
+		for (size_t i = 0; i < m_ActiveCameras.size(); ++i)
+		{
+			CameraRef camera = m_ActiveCameras[i];
+			const UniqueCameraData& uniqueCameraData = m_UniqueCameraDatas.at(camera.GetUUID());
+			if (uniqueCameraData.m_Picks.empty()) continue;
+
+			const BufferHandle pickResults = uniqueCameraData.m_PickResultsSSBOs[m_CurrentFrameIndex];
+			const size_t count = std::min(uniqueCameraData.m_Picks.size(), MaxPicks);
+
+			BufferBarrier pickingBarrier;
+			pickingBarrier.m_Buffer = pickResults;
+			pickingBarrier.m_SrcAccessMask = AF_ShaderWrite;
+			pickingBarrier.m_DstAccessMask = AF_CopySrc;
+			pDevice->PipelineBarrier(commandBuffer, { pickingBarrier }, {},
+				PipelineStageFlagBits::PST_ComputeShader, PipelineStageFlagBits::PST_Transfer);
+
+			const uint32_t size = uint32_t(sizeof(uint32_t)*4 + count*sizeof(GPUPickResult));
+			pDevice->Readback(commandBuffer, pickResults, 0, size,
+				[this, cameraID = camera.GetUUID(), clearResults](const void* data, uint32_t) {
+				std::scoped_lock<std::mutex> lock(m_PickLock);
+				if (clearResults) m_PickResults.clear();
+
+				const uint32_t numPicks = std::min(*static_cast<const uint32_t*>(data), uint32_t(MaxPicks));
+				const GPUPickResult* results = reinterpret_cast<const GPUPickResult*>(static_cast<const char*>(data) + sizeof(uint32_t)*4);
+				for (size_t j = 0; j < numPicks; ++j)
+				{
+					const GPUPickResult& pick = results[j];
+					if (!pick.SceneID || !pick.ObjectID) continue;
+					m_PickResults.emplace_back(PickResult{ cameraID,
+						SceneObjectRef{ pick.SceneID, pick.ObjectID }, glm::vec3(pick.Position), glm::vec3(pick.Normal) });
+				}
+			});
+			clearResults = false;
+		}
 	}
 
 	void GloryRenderer::OnSubmitCamera(CameraRef camera)
@@ -2666,7 +3142,7 @@ namespace Glory
 			if (!lightGridSSBO)
 				lightGridSSBO = pDevice->CreateBuffer(sizeof(LightGrid)*NUM_CLUSTERS, BufferType::BT_Storage, BF_None);
 			if (!pickResultsUBO)
-				pickResultsUBO = pDevice->CreateBuffer(sizeof(GPUPickResult)*MaxPicks + sizeof(uint32_t)*4, BufferType::BT_Storage, BF_Read);
+				pickResultsUBO = pDevice->CreateBuffer(sizeof(GPUPickResult)*MaxPicks + sizeof(uint32_t)*4, BufferType::BT_Storage, BF_CopySrc);
 
 			if (!lightSet)
 			{
@@ -2826,9 +3302,9 @@ namespace Glory
 		}
 		if (m_CameraDatas)
 		{
-			const size_t dirtySize = m_CameraDatas.DirtySize();
-			pDevice->AssignBuffer(m_CameraDatasBuffer, m_CameraDatas.DirtyStart(),
-				m_CameraDatas.m_DirtyRange.first*sizeof(PerCameraData), static_cast<uint32_t>(dirtySize*sizeof(PerCameraData)));
+			m_CameraDatas.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+				pDevice->AssignBuffer(m_CameraDatasBuffer, data, offset, size);
+			});
 		}
 	}
 
@@ -13,6 +13,14 @@ namespace Glory
 	class GPUTextureAtlas;
 	class GloryRendererModule;
 
+	/** @brief Pipeline acquired for one vertex layout */
+	struct MeshLayoutPipeline
+	{
+		uint32_t m_Stride;
+		std::vector<AttributeType> m_Attributes;
+		PipelineHandle m_Pipeline;
+	};
+
 	struct PipelineBatchData
 	{
 		CPUBuffer<glm::mat4> m_Worlds;
@@ -25,8 +33,16 @@ namespace Glory
 		BufferHandle m_TextureBitsBuffer = 0;
 
 		std::vector<UUID> m_LastFrameUniqueMaterials;
+		/** @brief Material version last written to the material buffer per material slot */
+		std::vector<uint64_t> m_MaterialVersions;
+		/** @brief Texture IDs referenced by each material slot, @ref m_MaterialTextureCount per material */
+		std::vector<UUID> m_MaterialTextures;
+		UUID m_MaterialsPipelineID = 0;
+		size_t m_MaterialTextureCount = 0;
 
 		PipelineHandle m_Pipeline = 0;
+		/** @brief Pipeline of each vertex layout of the meshes in the batch, @ref m_Pipeline is the one of the first mesh */
+		std::vector<MeshLayoutPipeline> m_LayoutPipelines;
 		DescriptorSetLayoutHandle m_TextureSetLayout = 0;
 		DescriptorSetLayoutHandle m_MaterialSetLayout = 0;
 		DescriptorSetHandle m_ObjectDataSet = 0;
@@ -34,6 +50,24 @@ namespace Glory
 		std::vector<DescriptorSetHandle> m_TextureSets;
 	};
 
+	/** @brief Persistent GPU slot of a texture referenced by batched materials */
+	struct TextureSlot
+	{
+		TextureHandle m_Texture = 0;
+		/** @brief Index in the global bindless textures array or UINT32_MAX if not used bindless */
+		uint32_t m_Index = UINT32_MAX;
+		uint32_t m_References = 0;
+		bool m_HasImage = false;
+		/** @brief The texture is waiting for a deferred upload */
+		bool m_Pending = false;
+		uint64_t m_TextureVersion = 0;
+		uint64_t m_ImageVersion = 0;
+		/** @brief Residency version of the texture on the device when it was last acquired */
+		uint64_t m_ResidencyVersion = 0;
+		/** @brief Value of the slot frame counter when the texture last changed */
+		uint64_t m_ChangedFrame = 0;
+	};
+
 	struct UniqueCameraData
 	{
 		BufferHandle m_ClusterSSBO = 0;
@@ -66,6 +100,11 @@ namespace Glory
 
 		CameraAttachment m_VisualizedAttachment;
 		Utils::BitSet m_DebugOverlayBits;
+
+		/** @brief LOD each object with a LOD chain was drawn at this frame, by hash of the object and mesh ID */
+		std::unordered_map<size_t, uint32_t> m_ObjectLODs;
+		/** @brief LODs drawn the previous frame, objects that are not drawn again lose their entry */
+		std::unordered_map<size_t, uint32_t> m_PreviousObjectLODs;
 	};
 
 	class GloryRenderer : public Renderer
@@ -142,13 +181,21 @@ namespace Glory
 			const std::vector<PipelineBatchData>& batchDatas, size_t cameraIndex, DescriptorSetHandle globalRenderSet, const glm::vec4& viewport,
 			DescriptorSetHandle shadowsSet);
 		void PrepareDataPass();
+		void RequestTextureMips(const std::vector<PipelineBatch>& batches, const std::vector<PipelineBatchData>& batchDatas, size_t cameraIndex);
+		float GetUVDensity(MeshData* pMeshData);
 		void PrepareBatches(const std::vector<PipelineBatch>& batches, std::vector<PipelineBatchData>& batchDatas);
 		void GenerateClusterSSBO(uint32_t cameraIndex, GraphicsDevice* pDevice, CameraRef camera, DescriptorSetHandle clusterSet);
 		void PrepareLineMesh(GraphicsDevice* pDevice);
+		TextureSlot* AcquireTextureSlot(UUID textureID, GraphicsDevice* pDevice, bool bindless);
+		void ReleaseTextureSlot(UUID textureID);
+		void ReleaseMaterialTextures(PipelineBatchData& batchData);
+		bool RefreshTextureSlot(UUID textureID, TextureSlot& slot, GraphicsDevice* pDevice);
+		void UpdateTextureSlots(GraphicsDevice* pDevice);
 		void PrepareSkybox(GraphicsDevice* pDevice);
 
 		void ClusterPass(CommandBufferHandle commandBuffer, uint32_t cameraIndex);
 		void SkyboxPass(CommandBufferHandle commandBuffer, uint32_t cameraIndex);
+		void StaticObjectsPass(CommandBufferHandle commandBuffer, uint32_t cameraIndex);
 		void DynamicObjectsPass(CommandBufferHandle commandBuffer, uint32_t cameraIndex);
 		void DynamicLateObjectsPass(CommandBufferHandle commandBuffer, uint32_t cameraIndex);
 
@@ -157,6 +204,15 @@ namespace Glory
 
 		void ShadowMapsPass(CommandBufferHandle commandBuffer);
 		void RenderShadows(CommandBufferHandle commandBuffer, size_t lightIndex, const glm::vec4& viewport);
+		void RenderShadowBatches(CommandBufferHandle commandBuffer, const std::vector<PipelineBatch>& batches,
+			const std::vector<PipelineBatchData>& batchDatas, RenderConstants& constants, const glm::vec4& viewport,
+			PipelineHandle& boundPipeline);
+		/** @brief Shadow pipeline that matches the vertex layout of a mesh, created the first time the layout is seen */
+		PipelineHandle ShadowPipeline(GraphicsDevice* pDevice, const MeshData* pMesh);
+		/** @brief Merged static batches when static batching is enabled, otherwise the submitted static objects */
+		const std::vector<PipelineBatch>& StaticBatches() const;
+
+		void ReadbackPass(CommandBufferHandle commandBuffer);
 
 		virtual void OnSubmitCamera(CameraRef camera) override;
 		virtual void OnUnsubmitCamera(CameraRef camera) override;
@@ -181,11 +237,14 @@ namespace Glory
 		friend class GloryRendererModule;
 		GloryRendererModule* m_pModule;
 
+		std::vector<PipelineBatchData> m_StaticBatchData;
+		bool m_StaticBatching = true;
 		std::vector<PipelineBatchData> m_DynamicBatchData;
 		std::vector<PipelineBatchData> m_DynamicLateBatchData;
 		CPUBuffer<PerCameraData> m_CameraDatas;
 		CPUBuffer<PerCameraData> m_LightCameraDatas;
 		CPUBuffer<glm::mat4> m_LightSpaceTransforms;
+		CPUBuffer<LightData> m_Lights;
 
 		/* Buffers */
 		BufferHandle m_CameraDatasBuffer = 0;
@@ -250,6 +309,7 @@ namespace Glory
 		uint32_t m_ImageCount = 1;
 
 		std::vector<BufferHandle> m_LightDistancesSSBOs;
+		BufferHandle m_ResetLightDistancesBuffer = 0;
 		std::vector<uint32_t> m_ClosestLightDepthSlices;
 		std::vector<DescriptorSetHandle> m_LightDistancesSets;
 
@@ -268,9 +328,15 @@ namespace Glory
 		Utils::BitSet m_DebugOverlayBits;
 
 		std::unordered_map<UUID, uint64_t> m_ResourceCacheVersions;
-		std::unordered_map<UUID, uint64_t> m_TextureImageCacheVersions;
 
 		CPUBuffer<TextureHandle> m_AllTextures;
+		std::unordered_map<UUID, TextureSlot> m_TextureSlots;
+		std::vector<uint32_t> m_FreeTextureSlots;
+		uint64_t m_TextureSlotFrame = 1;
+		/** @brief Texture coordinate density and the version of the mesh it was measured for, by ID of the meshes drawn this frame */
+		std::unordered_map<UUID, std::pair<uint64_t, float>> m_MeshUVDensities;
+		/** @brief Densities of the previous frame, meshes that are not drawn again lose their entry */
+		std::unordered_map<UUID, std::pair<uint64_t, float>> m_PreviousMeshUVDensities;
 		DescriptorSetHandle m_GlobalSamplersSet = nullptr;
 	};
 }
\ No newline at end of file
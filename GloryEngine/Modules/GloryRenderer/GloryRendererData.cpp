@@ -15,6 +15,10 @@ namespace Glory
 	/* Shadow rendering */
 	PipelineHandle RendererPipelines::m_ShadowRenderPipeline = NULL;
 	PipelineHandle RendererPipelines::m_TransparentShadowRenderPipeline = NULL;
+	const std::vector<AttributeType> RendererPipelines::m_ShadowVertexAttributes = {
+		AttributeType::UNorm16x4, AttributeType::SNorm8x4, AttributeType::SNorm8x4,
+		AttributeType::SNorm8x4, AttributeType::Half2, AttributeType::UNorm8x4
+	};
 
 	/* Debug rendering */
 	PipelineHandle RendererPipelines::m_LineRenderPipeline = NULL;
@@ -6,6 +6,7 @@
 #include <glm/glm.hpp>
 
 #include <GraphicsHandles.h>
+#include <VertexDefinitions.h>
 #include <BitSet.h>
 
 namespace Glory
@@ -188,6 +189,8 @@ namespace Glory
 		/* Shadow rendering */
 		static PipelineHandle m_ShadowRenderPipeline;
 		static PipelineHandle m_TransparentShadowRenderPipeline;
+		/** @brief Vertex layout of @ref CompactVertex3D that @ref m_ShadowRenderPipeline is created for */
+		static const std::vector<AttributeType> m_ShadowVertexAttributes;
 
 		/* Debug rendering */
 		static PipelineHandle m_LineRenderPipeline;
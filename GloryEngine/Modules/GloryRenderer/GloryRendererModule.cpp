@@ -135,6 +135,20 @@ namespace Glory
 		settings.RegisterAssetReference<PipelineData>("ObjectID Visualizer", 50);
 		settings.RegisterAssetReference<PipelineData>("Depth Visualizer", 52);
 		settings.RegisterAssetReference<PipelineData>("Light Complexity Visualizer", 54);
+
+		/* Bias scales the projected size of meshes, above 1 keeps detailed LODs around for longer */
+		settings.PushGroup("Level Of Detail");
+		settings.RegisterValue<float>("LOD Bias", 1.0f);
+		settings.RegisterValue<float>("LOD Hysteresis", 0.1f);
+
+		/* Merges small static meshes that share a material, picking stays exact on frames with a pick request */
+		settings.PushGroup("Static Batching");
+		settings.RegisterValue<bool>("Merge Static Meshes", true);
+
+		/* Textures with stored mips only keep the levels visible objects need, the budget is in MB */
+		settings.PushGroup("Texture Streaming");
+		settings.RegisterValue<unsigned int>("Texture Streaming Budget", 512);
+		settings.RegisterValue<float>("Texture Mip Bias", 0.0f);
 	}
 
 	void GloryRendererModule::Preload()
@@ -239,9 +253,8 @@ namespace Glory
 		const UUID shadowsPipeline = settings.Value<uint64_t>("Shadows Pipeline");
 		pPipeline = pipelines.GetPipelineData(shadowsPipeline);
 		RendererPipelines::m_ShadowRenderPipeline = pDevice->AcquireCachedPipeline(m_Renderer.m_ShadowsPasses[0], pPipeline,
-			{ RendererDSLayouts::m_GlobalShadowRenderSetLayout, RendererDSLayouts::m_ObjectDataSetLayout }, sizeof(DefaultVertex3D),
-			{ AttributeType::Float3, AttributeType::Float3, AttributeType::Float3,
-			AttributeType::Float3, AttributeType::Float2, AttributeType::Float4 });
+			{ RendererDSLayouts::m_GlobalShadowRenderSetLayout, RendererDSLayouts::m_ObjectDataSetLayout }, sizeof(CompactVertex3D),
+			RendererPipelines::m_ShadowVertexAttributes);
 		const UUID shadowsTransparentPipeline = settings.Value<uint64_t>("Shadows Transparent Textured Pipeline");
 		pPipeline = pipelines.GetPipelineData(shadowsTransparentPipeline);
 		//m_TransparentShadowRenderPipeline = pDevice->AcquireCachedPipeline(m_ShadowsPasses[0], pPipeline, {}, sizeof(DefaultVertex3D),
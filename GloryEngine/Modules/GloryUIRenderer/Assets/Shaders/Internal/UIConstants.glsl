@@ -5,7 +5,6 @@ layout(set = 0, std140, binding = 0) readonly uniform UIConstantsUBO
 #endif
 {
 	mat4 Projection;
-	uint ObjectIndex;
-	uint ColorIndex;
 	uint HasTexture;
+	float DistanceRange;
 } Constants;
\ No newline at end of file
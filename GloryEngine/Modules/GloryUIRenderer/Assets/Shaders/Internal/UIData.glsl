@@ -8,12 +8,12 @@ layout(set = 0, std430, binding = 2) readonly buffer ColorsSSBO
 	vec4 Colors[];
 };
 
-mat4 WorldTransform()
+mat4 WorldTransform(uint objectIndex)
 {
-	return Worlds[Constants.ObjectIndex];
+	return Worlds[objectIndex];
 }
 
-vec4 Color()
+vec4 Color(uint colorIndex)
 {
-	return Colors[Constants.ColorIndex];
+	return Colors[colorIndex];
 }
\ No newline at end of file
@@ -8,12 +8,16 @@
 layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
+/* Object and color index of the element, elements of a batch share one vertex buffer */
+layout(location = 3) in vec2 inIndices;
 layout(location = 0) out vec2 outTexCoord;
 layout(location = 1) out vec4 outColor;
 
 void main()
 {
-    gl_Position = Constants.Projection*WorldTransform()*vec4(inPosition.xy, 0.0, 1.0);
+    uint objectIndex = uint(inIndices.x + 0.5);
+    uint colorIndex = uint(inIndices.y + 0.5);
+    gl_Position = Constants.Projection*WorldTransform(objectIndex)*vec4(inPosition.xy, 0.0, 1.0);
     outTexCoord = inTexCoord;
-	outColor = vec4(inColor, 1.0)*Color();
+	outColor = vec4(inColor, 1.0)*Color(colorIndex);
 } 
\ No newline at end of file
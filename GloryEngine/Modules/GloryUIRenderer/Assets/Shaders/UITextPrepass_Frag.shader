@@ -9,8 +9,18 @@ layout(location = 0) in vec2 inTexCoord;
 layout(location = 1) in vec4 inColor;
 layout(location = 0) out vec4 outColor;
 
+/* Antialiased coverage of a distance field sample, the edge stays one screen pixel wide at any scale */
+float DistanceFieldCoverage(float distance)
+{
+    vec2 unitRange = vec2(Constants.DistanceRange)/vec2(textureSize(Color, 0));
+    vec2 screenTexSize = vec2(1.0)/fwidth(inTexCoord);
+    float screenPxRange = max(0.5*dot(unitRange, screenTexSize), 1.0);
+    return clamp(screenPxRange*(distance - 0.5) + 0.5, 0.0, 1.0);
+}
+
 void main()
 {
     vec4 sampled = texture(Color, inTexCoord);
-    outColor = vec4(inColor.xyz, inColor.a*sampled.r);
+    float coverage = Constants.DistanceRange > 0.0 ? DistanceFieldCoverage(sampled.r) : sampled.r;
+    outColor = vec4(inColor.xyz, inColor.a*coverage);
 }
\ No newline at end of file
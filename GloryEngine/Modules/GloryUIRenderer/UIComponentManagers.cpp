@@ -52,11 +52,14 @@ namespace Glory
 		}
 
 		change |= Constraints::ProcessConstraint(pComponent.m_Width, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
-		change |= Constraints::ProcessConstraint(pComponent.m_Height, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
-		change |= Constraints::ProcessConstraint(pComponent.m_Width, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
+		const bool heightChanged = Constraints::ProcessConstraint(pComponent.m_Height, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
+		change |= heightChanged;
+		/* The width can depend on the height, it only needs another pass if the height moved */
+		if (heightChanged)
+			change |= Constraints::ProcessConstraint(pComponent.m_Width, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
+		/* Positions only depend on the size which is final now */
 		change |= Constraints::ProcessConstraint(pComponent.m_X, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
 		change |= Constraints::ProcessConstraint(pComponent.m_Y, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
-		change |= Constraints::ProcessConstraint(pComponent.m_X, glm::vec2{ pComponent.m_Width, pComponent.m_Height }, pComponent.m_ParentSize, screenSize);
 		return change;
 	}
 
@@ -83,7 +86,10 @@ namespace Glory
 			startInteractionTransform = parentTransform.m_InteractionTransformNoPivot;
         }
 
+		const float oldHeight = pComponent.m_Height.m_FinalValue;
 		ProcessConstraints(pRegistry, entity, pComponent);
+		if (oldHeight != pComponent.m_Height.m_FinalValue)
+			UIVerticalContainerManager::SetContentDirty(pRegistry, parent);
 
 		/* Conversion top to bottom rather than bottom to top */
 		const float actualY = parent ? -float(pComponent.m_Y) : pComponent.m_ParentSize.y - float(pComponent.m_Y);
@@ -102,6 +108,8 @@ namespace Glory
         pComponent.m_TransformNoScaleNoPivot = startTransform*translation*rotation*selfScale;
         pComponent.m_InteractionTransform = startInteractionTransform*interactionTranslation*rotation*glm::inverse(interactionPivotOffset)*selfScale;
         pComponent.m_InteractionTransformNoPivot = startInteractionTransform*interactionTranslation*rotation*selfScale;
+        pComponent.m_InverseInteractionTransform = glm::inverse(pComponent.m_InteractionTransform);
+        pDocument->m_HitGrid.Insert(entity, pComponent.m_InteractionTransform, size);
 
         pRegistry->SetEntityDirty(entity, false);
 		pDocument->SetDrawDirty();
@@ -209,7 +217,12 @@ namespace Glory
 		pComponent.m_Dirty = false;
 
 		FontData* pFont = pComponent.m_Font.Get(m_pResources);
-		if (!pFont) return;
+		if (!pFont)
+		{
+			/* Keep drawing the document until the font is loaded */
+			if (pComponent.m_Font.GetUUID()) pDocument->SetDrawDirty();
+			return;
+		}
 		const UUID meshID = pDocument->GetTextMesh(objectID, textData, pFont);
 
 		const uint32_t height = pFont->FontHeight();
@@ -230,7 +243,7 @@ namespace Glory
 
 		const glm::mat4 matTextOffset = glm::translate(glm::identity<glm::mat4>(), glm::vec3(textOffset, 0.0f));
 		glm::mat4 world = transform.m_TransformNoScale*glm::inverse(matTextOffset);
-		pDocument->AddRender(meshID, pFont->Texture(), std::move(world), textData.m_Color);
+		pDocument->AddRender(meshID, pFont->Texture(), std::move(world), textData.m_Color, pFont->DistanceRange());
     }
 
 	void UITextManager::OnDirtyImpl(Utils::ECS::EntityID entity, UIText& pComponent)
@@ -348,15 +361,19 @@ namespace Glory
 		const bool inputAllowed = pDocument->IsEnputEnabled();
 		if (!inputAllowed) return;
 
-		const UITransform& transform = m_pRegistry->GetComponent<UITransform>(entity);
-
-		const glm::vec4 cursor{ pDocument->GetCursorPos(), 0.0f, 1.0f };
-		const glm::mat4 inverse = glm::inverse(transform.m_InteractionTransform);
-		const glm::mat4 screenScaleTransform = glm::scale(glm::identity<glm::mat4>(), {});
-		const glm::vec4 transformedCursor = inverse*cursor;
+		/* Only elements in the grid cell of the cursor can be under it */
+		bool isMouseInRect = false;
+		if (pDocument->IsHitCandidate(entity))
+		{
+			const UITransform& transform = m_pRegistry->GetComponent<UITransform>(entity);
+			const glm::vec4 cursor{ pDocument->GetCursorPos(), 0.0f, 1.0f };
+			const glm::vec4 transformedCursor = transform.m_InverseInteractionTransform*cursor;
+			isMouseInRect = transformedCursor.x > 0.0f && transformedCursor.x < float(transform.m_Width) &&
+				transformedCursor.y > 0.0f && transformedCursor.y < float(transform.m_Height);
+		}
 
-		const bool isMouseInRect = transformedCursor.x > 0.0f && transformedCursor.x < float(transform.m_Width) &&
-			transformedCursor.y > 0.0f && transformedCursor.y < float(transform.m_Height);
+		/* Nothing to hover or release */
+		if (!isMouseInRect && !pComponent.m_Hovered && !pComponent.m_Down) return;
 
 		const UUID entityUUID = pDocument->EntityUUID(entity);
 		const UUID componentID = m_pRegistry->EntityComponentHashToID(entity, UIInteraction::GetTypeData()->TypeHash());
@@ -430,6 +447,22 @@ namespace Glory
 		Bind(DoPostDraw, &UIPanelManager::OnPostDrawImpl);
 	}
 
+	namespace
+	{
+		/** @brief Set an axis of an element to a fixed value without processing its other constraints
+		 * @returns Whether the final value changed
+		 */
+		template<typename T>
+		bool SetFixedConstraint(T& constraint, float value)
+		{
+			const bool change = constraint.m_FinalValue != value;
+			constraint.m_Constraint = 0;
+			constraint.m_Value = value;
+			constraint.m_FinalValue = value;
+			return change;
+		}
+	}
+
 	//template<typename Comp>
 	//static void UpdateEntity(Utils::ECS::EntityID entity, Utils::ECS::EntityRegistry& registry, Utils::ECS::InvocationType invocation)
 	//{
@@ -479,11 +512,10 @@ namespace Glory
 			const Utils::ECS::EntityID child = m_pRegistry->Child(entity, i);
 			UITransform& transform = m_pRegistry->GetComponent<UITransform>(child);
 			const float elementHeight = transform.m_Height.m_FinalValue;
-			transform.m_Y.m_Constraint = 0;
-			transform.m_Y.m_Value = height;
-			height += elementHeight + pComponent.m_Seperation;
-			if (UITransformManager::ProcessConstraints(m_pRegistry, child, transform))
+			/* Only children that moved need their transforms recalculated */
+			if (SetFixedConstraint(transform.m_Y, height))
 				m_pRegistry->SetEntityDirty(child);
+			height += elementHeight + pComponent.m_Seperation;
 		}
 
 		/* Resize self */
@@ -493,11 +525,20 @@ namespace Glory
 			transform.m_Height.m_Constraint = 0;
 			transform.m_Height = height;
 			if (UITransformManager::ProcessConstraints(m_pRegistry, entity, transform))
+			{
 				m_pRegistry->SetEntityDirty(entity);
+				SetContentDirty(m_pRegistry, m_pRegistry->GetParent(entity));
+			}
 		}
 		pComponent.m_Dirty = false;
 	}
 
+	void UIVerticalContainerManager::SetContentDirty(Utils::ECS::EntityRegistry* pRegistry, Utils::ECS::EntityID entity)
+	{
+		if (!pRegistry->EntityValid(entity) || !pRegistry->HasComponent<UIVerticalContainer>(entity)) return;
+		pRegistry->GetComponent<UIVerticalContainer>(entity).m_Dirty = true;
+	}
+
 	void UIVerticalContainerManager::OnDirtyImpl(Utils::ECS::EntityID entity, UIVerticalContainer& pComponent)
 	{
 		pComponent.m_Dirty = true;
@@ -609,12 +650,9 @@ namespace Glory
 		{
 			const Utils::ECS::EntityID child = m_pRegistry->Child(entity, i);
 			UITransform& transform = m_pRegistry->GetComponent<UITransform>(child);
-			transform.m_X.m_Constraint = 0;
-			transform.m_X.m_Value = -pComponent.m_ScrollPosition.x;
-			transform.m_Y.m_Constraint = 0;
-			transform.m_Y.m_Value = -pComponent.m_ScrollPosition.y;
-			if (UITransformManager::ProcessConstraints(m_pRegistry, child, transform))
-				m_pRegistry->SetEntityDirty(child);
+			bool moved = SetFixedConstraint(transform.m_X, -pComponent.m_ScrollPosition.x);
+			moved |= SetFixedConstraint(transform.m_Y, -pComponent.m_ScrollPosition.y);
+			if (moved) m_pRegistry->SetEntityDirty(child);
 		}
 
 		pComponent.m_Dirty = false;
@@ -120,6 +120,10 @@ namespace Glory
 	public:
 		void OnPreUpdateImpl(Utils::ECS::EntityID entity, UIVerticalContainer& pComponent, float);
 		void OnDirtyImpl(Utils::ECS::EntityID entity, UIVerticalContainer& pComponent);
+		/** @brief Lay out the children of a container again because one of them was resized
+		 * @param entity Parent of the resized element, nothing happens if it has no container
+		 */
+		static void SetContentDirty(Utils::ECS::EntityRegistry* pRegistry, Utils::ECS::EntityID entity);
 
 	private:
 		void OnInitialize() override;
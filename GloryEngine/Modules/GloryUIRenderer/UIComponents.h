@@ -63,7 +63,8 @@ namespace Glory
             m_TransformNoScale(glm::identity<glm::mat4>()),
             m_TransformNoScaleNoPivot(glm::identity<glm::mat4>()),
             m_InteractionTransform(glm::identity<glm::mat4>()),
-            m_InteractionTransformNoPivot(glm::identity<glm::mat4>())
+            m_InteractionTransformNoPivot(glm::identity<glm::mat4>()),
+            m_InverseInteractionTransform(glm::identity<glm::mat4>())
         {}
 
         REFLECTABLE(UITransform,
@@ -82,6 +83,8 @@ namespace Glory
         glm::mat4 m_TransformNoScaleNoPivot;
         glm::mat4 m_InteractionTransform;
         glm::mat4 m_InteractionTransformNoPivot;
+        /** @brief Transforms the cursor into the rect of the element for hit testing */
+        glm::mat4 m_InverseInteractionTransform;
     };
 
     /** @brief UI Image renderer */
@@ -10,6 +10,7 @@
 #include <VertexHelpers.h>
 
 #include <queue>
+#include <algorithm>
 
 namespace Glory
 {
@@ -72,6 +73,7 @@ namespace Glory
 	void UIDocument::Update(float dt)
 	{
 		m_Registry.SetUserData(this);
+		m_HitGrid.Query(m_CursorPos, m_HitCandidates);
 		m_Registry.Update(dt);
 		m_WasCursorDown = m_CursorDown;
 	}
@@ -121,16 +123,15 @@ namespace Glory
 	UUID UIDocument::GetTextMesh(UUID objectID, const TextData& data, FontData* pFont)
 	{
 		auto iter = m_pTextMeshes.find(objectID);
-		const bool exists = iter != m_pTextMeshes.end();
-		if (!exists)
+		if (iter == m_pTextMeshes.end())
 		{
 			MeshData* pMesh = new MeshData(data.m_Text.size() * 4, sizeof(VertexPosColorTex),
 				{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2 });
-			iter = m_pTextMeshes.emplace(objectID, pMesh).first;
+			iter = m_pTextMeshes.emplace(objectID, UITextMesh{ std::unique_ptr<MeshData>(pMesh) }).first;
 		}
 
-		if (data.m_TextDirty || !exists)
-			Utils::GenerateTextMesh(iter->second.get(), pFont, data);
+		/* Elements are marked dirty by any layout change, only regenerate when the text itself changed */
+		Utils::UpdateTextMesh(iter->second.m_pMesh.get(), pFont, data, iter->second.m_State);
 		return iter->first;
 	}
 
@@ -207,6 +208,7 @@ namespace Glory
 		}
 
 		m_Registry.DestroyEntity(entity);
+		m_HitGrid.Remove(entity);
 		m_Ids.erase(uuid);
 		m_UUIds.erase(entity);
 		m_Names.erase(entity);
@@ -261,6 +263,11 @@ namespace Glory
 		return m_InputEnabled;
 	}
 
+	bool UIDocument::IsHitCandidate(Utils::ECS::EntityID entity) const
+	{
+		return std::binary_search(m_HitCandidates.begin(), m_HitCandidates.end(), entity);
+	}
+
 	void UIDocument::SetEnputEnabled(bool enabled)
 	{
 		m_InputEnabled = enabled;
@@ -322,12 +329,13 @@ namespace Glory
 		}
 	}
 
-	void UIDocument::AddRender(UUID textMeshID, UUID textureID, glm::mat4&& world, const glm::vec4& color)
+	void UIDocument::AddRender(UUID textMeshID, UUID textureID, glm::mat4&& world, const glm::vec4& color, float distanceRange)
 	{
 		const size_t index = m_UIBatch.m_Worlds.size();
 		m_UIBatch.m_TextMeshes.emplace_back(textMeshID);
 		m_UIBatch.m_Worlds.emplace_back(std::move(world));
 		m_UIBatch.m_TextureIDs.emplace_back(textureID);
+		m_UIBatch.m_DistanceRanges.emplace_back(distanceRange);
 
 		auto iter = std::find(m_UIBatch.m_UniqueColors.begin(), m_UIBatch.m_UniqueColors.end(), color);
 
@@ -353,6 +361,7 @@ namespace Glory
 		m_UIBatch.m_TextMeshes.emplace_back(0);
 		m_UIBatch.m_Worlds.emplace_back(std::move(world));
 		m_UIBatch.m_TextureIDs.emplace_back(0);
+		m_UIBatch.m_DistanceRanges.emplace_back(0.0f);
 		m_UIBatch.m_ColorIndices.emplace_back(0);
 		m_UIBatch.m_MaskIncrements.Reserve(m_UIBatch.m_Worlds.size());
 		m_UIBatch.m_MaskDecrements.Reserve(m_UIBatch.m_Worlds.size());
@@ -366,6 +375,7 @@ namespace Glory
 		m_UIBatch.m_TextMeshes.emplace_back(0);
 		m_UIBatch.m_Worlds.emplace_back(glm::identity<glm::mat4>());
 		m_UIBatch.m_TextureIDs.emplace_back(0);
+		m_UIBatch.m_DistanceRanges.emplace_back(0.0f);
 		m_UIBatch.m_ColorIndices.emplace_back(0);
 		m_UIBatch.m_MaskIncrements.Reserve(m_UIBatch.m_Worlds.size());
 		m_UIBatch.m_MaskDecrements.Reserve(m_UIBatch.m_Worlds.size());
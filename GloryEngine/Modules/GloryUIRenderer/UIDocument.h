@@ -1,10 +1,12 @@
 #pragma once
 #include "ui_renderer_visibility.h"
+#include "UIHitGrid.h"
 
 #include <EntityRegistry.h>
 #include <TypeData.h>
 #include <GraphicsHandles.h>
 #include <MeshData.h>
+#include <FontDataStructs.h>
 
 #include <glm/matrix.hpp>
 
@@ -18,7 +20,13 @@ namespace Glory
 	class MeshData;
 	class FontData;
 	class GraphicsDevice;
-	struct TextData;
+
+	/** @brief Text mesh of a UI element and what it was generated from */
+	struct UITextMesh
+	{
+		std::unique_ptr<MeshData> m_pMesh;
+		TextMeshState m_State;
+	};
 
 	struct UIBatch
 	{
@@ -28,6 +36,7 @@ namespace Glory
 			m_TextMeshes.clear();
 			m_Worlds.clear();
 			m_TextureIDs.clear();
+			m_DistanceRanges.clear();
 			m_UniqueColors.clear();
 			m_ColorIndices.clear();
 		}
@@ -37,6 +46,7 @@ namespace Glory
 			m_TextMeshes.clear();
 			m_Worlds.clear();
 			m_TextureIDs.clear();
+			m_DistanceRanges.clear();
 			m_UniqueColors.clear();
 			m_ColorIndices.clear();
 		}
@@ -44,6 +54,8 @@ namespace Glory
 		std::vector<UUID> m_TextMeshes;
 		std::vector<glm::mat4> m_Worlds;
 		std::vector<UUID> m_TextureIDs;
+		/** @brief Distance range of the font atlas of each text render, 0 for coverage atlases and images */
+		std::vector<float> m_DistanceRanges;
 		Utils::BitSet m_MaskIncrements;
 		Utils::BitSet m_MaskDecrements;
 
@@ -93,6 +105,8 @@ namespace Glory
 		GLORY_UI_RENDERER_API bool IsCursorDown() const;
 		GLORY_UI_RENDERER_API bool WasCursorDown() const;
 		GLORY_UI_RENDERER_API bool IsEnputEnabled() const;
+		/** @brief Check whether the cursor is inside the bounds of an element, see @ref UIHitGrid */
+		GLORY_UI_RENDERER_API bool IsHitCandidate(Utils::ECS::EntityID entity) const;
 		GLORY_UI_RENDERER_API void SetEnputEnabled(bool enabled);
 		GLORY_UI_RENDERER_API size_t& PanelCounter();
 		GLORY_UI_RENDERER_API void SetDrawDirty();
@@ -102,7 +116,7 @@ namespace Glory
 		GLORY_UI_RENDERER_API void Start();
 		GLORY_UI_RENDERER_API void SetEntityDirty(Utils::ECS::EntityID entity, bool setChildrenDirty, bool setParentsDirty);
 
-		GLORY_UI_RENDERER_API void AddRender(UUID textMeshID, UUID textureID, glm::mat4&& world, const glm::vec4& color);
+		GLORY_UI_RENDERER_API void AddRender(UUID textMeshID, UUID textureID, glm::mat4&& world, const glm::vec4& color, float distanceRange=0.0f);
 		GLORY_UI_RENDERER_API void BeginMask(glm::mat4&& world);
 		GLORY_UI_RENDERER_API void EndMask();
 		GLORY_UI_RENDERER_API void CreateRenderPasses(GraphicsDevice* pDevice, size_t imageCount, const glm::uvec2& resolution, UIRendererModule* pUIRenderer);
@@ -117,6 +131,7 @@ namespace Glory
 
 	private:
 		friend class UIRendererModule;
+		friend class UITransformManager;
 		UUID m_SceneID;
 		UUID m_ObjectID;
 		UUID m_OriginalDocumentID;
@@ -135,12 +150,15 @@ namespace Glory
 		size_t m_PanelCounter;
 		Utils::BitSet m_DrawIsDirty;
 
-		std::map<UUID, std::unique_ptr<MeshData>> m_pTextMeshes;
+		std::map<UUID, UITextMesh> m_pTextMeshes;
 		std::string m_Name;
 		std::map<UUID, Utils::ECS::EntityID> m_Ids;
 		std::map<Utils::ECS::EntityID, UUID> m_UUIds;
 		std::map<Utils::ECS::EntityID, std::string> m_Names;
 
 		UIBatch m_UIBatch;
+		UIHitGrid m_HitGrid;
+		/** @brief Elements whose bounds contain the cursor this frame, sorted */
+		std::vector<Utils::ECS::EntityID> m_HitCandidates;
 	};
 }
@@ -0,0 +1,125 @@
+#include "UIHitGrid.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+
+namespace Glory
+{
+	bool UIHitGrid::CellRange::operator==(const CellRange& other) const
+	{
+		return m_MinX == other.m_MinX && m_MinY == other.m_MinY &&
+			m_MaxX == other.m_MaxX && m_MaxY == other.m_MaxY && m_Oversized == other.m_Oversized;
+	}
+
+	void UIHitGrid::Insert(Utils::ECS::EntityID entity, const glm::mat4& transform, const glm::vec2& size)
+	{
+		const glm::vec2 corners[4] = {
+			glm::vec2(transform*glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)),
+			glm::vec2(transform*glm::vec4(size.x, 0.0f, 0.0f, 1.0f)),
+			glm::vec2(transform*glm::vec4(0.0f, size.y, 0.0f, 1.0f)),
+			glm::vec2(transform*glm::vec4(size.x, size.y, 0.0f, 1.0f)),
+		};
+
+		glm::vec2 min = corners[0], max = corners[0];
+		for (size_t i = 1; i < 4; ++i)
+		{
+			min = glm::min(min, corners[i]);
+			max = glm::max(max, corners[i]);
+		}
+
+		/* A degenerate transform can never be hit */
+		if (glm::any(glm::isnan(min)) || glm::any(glm::isnan(max)) ||
+			glm::any(glm::isinf(min)) || glm::any(glm::isinf(max)))
+		{
+			Remove(entity);
+			return;
+		}
+
+		const glm::vec2 minCell = glm::floor(min/CellSize);
+		const glm::vec2 maxCell = glm::floor(max/CellSize);
+		const glm::vec2 maxCellIndex{ float(INT32_MAX/2) };
+		const bool inRange = glm::all(glm::lessThanEqual(glm::abs(minCell), maxCellIndex)) &&
+			glm::all(glm::lessThanEqual(glm::abs(maxCell), maxCellIndex));
+		const bool oversized = !inRange ||
+			(int64_t(maxCell.x) - int64_t(minCell.x) + 1)*(int64_t(maxCell.y) - int64_t(minCell.y) + 1) > MaxCellsPerElement;
+		const CellRange range = oversized ? CellRange{ 0, 0, 0, 0, true } :
+			CellRange{ int32_t(minCell.x), int32_t(minCell.y), int32_t(maxCell.x), int32_t(maxCell.y), false };
+
+		auto iter = m_Ranges.find(entity);
+		if (iter != m_Ranges.end())
+		{
+			if (iter->second == range) return;
+			RemoveFromCells(entity, iter->second);
+			iter->second = range;
+		}
+		else m_Ranges.emplace(entity, range);
+
+		if (range.m_Oversized)
+		{
+			m_Oversized.push_back(entity);
+			return;
+		}
+
+		for (int32_t y = range.m_MinY; y <= range.m_MaxY; ++y)
+		{
+			for (int32_t x = range.m_MinX; x <= range.m_MaxX; ++x)
+				m_Cells[CellKey(x, y)].push_back(entity);
+		}
+	}
+
+	void UIHitGrid::Remove(Utils::ECS::EntityID entity)
+	{
+		auto iter = m_Ranges.find(entity);
+		if (iter == m_Ranges.end()) return;
+		RemoveFromCells(entity, iter->second);
+		m_Ranges.erase(iter);
+	}
+
+	void UIHitGrid::Query(const glm::vec2& point, std::vector<Utils::ECS::EntityID>& candidates) const
+	{
+		candidates.assign(m_Oversized.begin(), m_Oversized.end());
+
+		const glm::vec2 cell = glm::floor(point/CellSize);
+		if (!glm::any(glm::isnan(cell)) && glm::all(glm::lessThanEqual(glm::abs(cell), glm::vec2(float(INT32_MAX/2)))))
+		{
+			auto iter = m_Cells.find(CellKey(int32_t(cell.x), int32_t(cell.y)));
+			if (iter != m_Cells.end())
+				candidates.insert(candidates.end(), iter->second.begin(), iter->second.end());
+		}
+
+		std::sort(candidates.begin(), candidates.end());
+	}
+
+	uint64_t UIHitGrid::CellKey(int32_t x, int32_t y)
+	{
+		return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(y));
+	}
+
+	void UIHitGrid::RemoveFromCells(Utils::ECS::EntityID entity, const CellRange& range)
+	{
+		if (range.m_Oversized)
+		{
+			auto iter = std::find(m_Oversized.begin(), m_Oversized.end(), entity);
+			if (iter == m_Oversized.end()) return;
+			*iter = m_Oversized.back();
+			m_Oversized.pop_back();
+			return;
+		}
+
+		for (int32_t y = range.m_MinY; y <= range.m_MaxY; ++y)
+		{
+			for (int32_t x = range.m_MinX; x <= range.m_MaxX; ++x)
+			{
+				auto cellIter = m_Cells.find(CellKey(x, y));
+				if (cellIter == m_Cells.end()) continue;
+				std::vector<Utils::ECS::EntityID>& entities = cellIter->second;
+				auto iter = std::find(entities.begin(), entities.end(), entity);
+				if (iter == entities.end()) continue;
+				*iter = entities.back();
+				entities.pop_back();
+				if (entities.empty()) m_Cells.erase(cellIter);
+			}
+		}
+	}
+}
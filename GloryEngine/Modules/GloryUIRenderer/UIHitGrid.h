@@ -0,0 +1,58 @@
+#pragma once
+#include <EntityID.h>
+
+#include <glm/vec2.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace Glory
+{
+	/** @brief Uniform grid of the screen bounds of UI elements to find the elements that may be under the cursor */
+	class UIHitGrid
+	{
+	public:
+		/** @brief Width and height of a cell in pixels */
+		static constexpr float CellSize = 64.0f;
+		/** @brief Elements that cover more cells than this are returned by every query instead */
+		static constexpr int64_t MaxCellsPerElement = 256;
+
+		/**
+		 * @brief Insert an element or move it to its new bounds
+		 * @param entity Element to insert
+		 * @param transform Transform from the rect of the element to the document
+		 * @param size Size of the rect of the element
+		 */
+		void Insert(Utils::ECS::EntityID entity, const glm::mat4& transform, const glm::vec2& size);
+		/** @brief Remove an element from the grid */
+		void Remove(Utils::ECS::EntityID entity);
+
+		/**
+		 * @brief Find the elements whose bounds contain a point
+		 * @param point Point in the document
+		 * @param candidates Elements that may contain the point sorted by entity ID
+		 */
+		void Query(const glm::vec2& point, std::vector<Utils::ECS::EntityID>& candidates) const;
+
+	private:
+		struct CellRange
+		{
+			int32_t m_MinX;
+			int32_t m_MinY;
+			int32_t m_MaxX;
+			int32_t m_MaxY;
+			bool m_Oversized;
+
+			bool operator==(const CellRange& other) const;
+		};
+
+		static uint64_t CellKey(int32_t x, int32_t y);
+		void RemoveFromCells(Utils::ECS::EntityID entity, const CellRange& range);
+
+	private:
+		std::unordered_map<uint64_t, std::vector<Utils::ECS::EntityID>> m_Cells;
+		std::unordered_map<Utils::ECS::EntityID, CellRange> m_Ranges;
+		std::vector<Utils::ECS::EntityID> m_Oversized;
+	};
+}
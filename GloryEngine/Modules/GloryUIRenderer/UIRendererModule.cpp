@@ -40,9 +40,18 @@ namespace Glory
 	struct UIConstants
 	{
 		glm::mat4 Projection;
-		uint32_t ObjectIndex;
-		uint32_t ColorIndex;
 		uint32_t HasTexture;
+		float DistanceRange;
+	};
+
+	/** @brief Vertex of the batched mesh of a document */
+	struct UIVertex
+	{
+		glm::vec2 Pos;
+		glm::vec3 Color;
+		glm::vec2 TexCoord;
+		/** @brief Index of the world transform and color of the element, stored as floats so every backend reads them the same */
+		glm::vec2 Indices;
 	};
 
 	GLORY_MODULE_VERSION_CPP(UIRendererModule);
@@ -116,18 +125,26 @@ namespace Glory
 		pDocument->m_InputEnabled = data.m_InputEnabled;
 		pDocument->Update(m_pEngine->Time().GetDeltaTime());
 
-		//if (!pDocument->m_DrawIsDirty.IsSet(frameIndex)) return;
-		pDocument->Draw();
-		pDocument->m_DrawIsDirty.Set(frameIndex, false);
-
 		Resources& resources = m_pEngine->GetResources();
+		auto iter = m_BatchDatas.try_emplace(pDocument->m_ObjectID).first;
+		UIBatchData& batchData = iter->second;
 
-		/* Prepare data */
-		auto iter = m_BatchDatas.find(pDocument->m_ObjectID);
-		if (iter == m_BatchDatas.end())
-			iter = m_BatchDatas.emplace(pDocument->m_ObjectID, UIBatchData()).first;
+		if (batchData.m_ClearColor != data.m_ClearColor)
+		{
+			batchData.m_ClearColor = data.m_ClearColor;
+			pDocument->SetDrawDirty();
+		}
+		if (TexturesChanged(pDevice, pDocument, batchData))
+			pDocument->SetDrawDirty();
 
-		UIBatchData& batchData = iter->second;
+		/* The render texture of this frame still holds the last draw of an unchanged document */
+		if (!pDocument->m_DrawIsDirty.IsSet(frameIndex)) return;
+
+		/* Cleared before drawing so elements that could not be fully drawn yet can keep the document dirty */
+		pDocument->m_DrawIsDirty.Set(frameIndex, false);
+		pDocument->Draw();
+
+		/* Prepare data */
 		if (batchData.m_Worlds->size() < pDocument->m_UIBatch.m_Worlds.size())
 			batchData.m_Worlds.resize(pDocument->m_UIBatch.m_Worlds.size());
 		if (batchData.m_Colors->size() < pDocument->m_UIBatch.m_UniqueColors.size())
@@ -163,18 +180,18 @@ namespace Glory
 			pDevice->ResizeBuffer(batchData.m_WorldsBuffers, batchData.m_Worlds.TotalByteSize());
 		if (batchData.m_Worlds)
 		{
-			const size_t dirtySize = batchData.m_Worlds.DirtySize();
-			pDevice->AssignBuffer(batchData.m_WorldsBuffers, batchData.m_Worlds.DirtyStart(),
-				batchData.m_Worlds.m_DirtyRange.first*sizeof(glm::mat4), dirtySize*sizeof(glm::mat4));
+			batchData.m_Worlds.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+				pDevice->AssignBuffer(batchData.m_WorldsBuffers, data, offset, size);
+			});
 		}
 
 		if (pDevice->BufferSize(batchData.m_ColorsBuffers) < batchData.m_Colors.TotalByteSize())
 			pDevice->ResizeBuffer(batchData.m_ColorsBuffers, batchData.m_Colors.TotalByteSize());
 		if (batchData.m_Colors)
 		{
-			const size_t dirtySize = batchData.m_Colors.DirtySize();
-			pDevice->AssignBuffer(batchData.m_ColorsBuffers, batchData.m_Colors.DirtyStart(),
-				batchData.m_Colors.m_DirtyRange.first*sizeof(glm::vec4), dirtySize*sizeof(glm::vec4));
+			batchData.m_Colors.ForEachDirtyRange([&](const void* data, uint32_t offset, uint32_t size) {
+				pDevice->AssignBuffer(batchData.m_ColorsBuffers, data, offset, size);
+			});
 		}
 
 		if (!batchData.m_BuffersSet)
@@ -209,40 +226,57 @@ namespace Glory
 		if (batchData.m_TextureSets.size() < pDocument->m_UIBatch.m_TextureIDs.size())
 		{
 			batchData.m_TextureSets.resize(pDocument->m_UIBatch.m_TextureIDs.size(), nullptr);
-			batchData.m_LastTextureIDs.resize(pDocument->m_UIBatch.m_TextureIDs.size(), 0ull);
+			batchData.m_LastTextures.resize(pDocument->m_UIBatch.m_TextureIDs.size(), nullptr);
 		}
 
+		/* Elements that use the same texture share a cached descriptor set */
 		for (size_t i = 0; i < pDocument->m_UIBatch.m_Worlds.size(); ++i)
 		{
-			UUID textureID = pDocument->m_UIBatch.m_TextureIDs[i];
+			const UUID textureID = pDocument->m_UIBatch.m_TextureIDs[i];
 			Resource* pTextureResource = textureID ? resources.GetResource(textureID) : nullptr;
 			TextureData* pTexture = pTextureResource ? static_cast<TextureData*>(pTextureResource) : nullptr;
-			TextureHandle texture = pDevice->AcquireCachedTexture(pTexture);
-			if (!pTexture) textureID = 0;
+			const TextureHandle texture = pDevice->AcquireCachedTexture(pTexture);
+			if (batchData.m_TextureSets[i] && batchData.m_LastTextures[i] == texture) continue;
 
-			if (!batchData.m_TextureSets[i])
-			{
-				DescriptorSetInfo setInfo;
-				setInfo.m_Layout = m_UISamplerLayout;
-				setInfo.m_Samplers.resize(1);
-				setInfo.m_Samplers[0].m_TextureHandle = texture;
-				batchData.m_TextureSets[i] = pDevice->CreateDescriptorSet(std::move(setInfo));
-				batchData.m_LastTextureIDs[i] = textureID;
-			}
+			DescriptorSetInfo setInfo;
+			setInfo.m_Layout = m_UISamplerLayout;
+			setInfo.m_Samplers.resize(1);
+			setInfo.m_Samplers[0].m_TextureHandle = texture;
+			batchData.m_TextureSets[i] = pDevice->AcquireCachedDescriptorSet(std::move(setInfo));
+			batchData.m_LastTextures[i] = texture;
+		}
+
+		UpdateBatchedMesh(pDocument, batchData);
+		const MeshHandle batchedMesh = pDevice->AcquireCachedMesh(batchData.m_pBatchedMesh.get(), MU_Dynamic);
+		if (!batchedMesh) return;
 
-			if (batchData.m_LastTextureIDs[i] != textureID)
+		/* Consecutive elements with the same pipeline and texture are drawn together,
+		 * masks change the stencil state so they always break a batch */
+		const UIBatch& uiBatch = pDocument->m_UIBatch;
+		batchData.m_DrawRanges.clear();
+		for (size_t i = 0; i < uiBatch.m_Worlds.size(); ++i)
+		{
+			const auto& [firstIndex, indexCount] = batchData.m_ElementIndices[i];
+			const bool isMask = uiBatch.m_MaskIncrements.IsSet(i) || uiBatch.m_MaskDecrements.IsSet(i);
+			if (!isMask && indexCount == 0) continue;
+			if (!isMask && !batchData.m_DrawRanges.empty())
 			{
-				DescriptorSetUpdateInfo dsWrite;
-				dsWrite.m_Samplers.resize(1);
-				dsWrite.m_Samplers[0].m_DescriptorIndex = 0;
-				dsWrite.m_Samplers[0].m_TextureHandles = &texture;
-				pDevice->UpdateDescriptorSet(batchData.m_TextureSets[i], dsWrite);
-				batchData.m_LastTextureIDs[i] = textureID;
+				UIBatchData::DrawRange& last = batchData.m_DrawRanges.back();
+				const bool lastIsMask = uiBatch.m_MaskIncrements.IsSet(last.m_Element) || uiBatch.m_MaskDecrements.IsSet(last.m_Element);
+				const bool sameBatch = !lastIsMask && last.m_FirstIndex + last.m_IndexCount == firstIndex &&
+					(uiBatch.m_TextMeshes[last.m_Element] != 0) == (uiBatch.m_TextMeshes[i] != 0) &&
+					(uiBatch.m_TextureIDs[last.m_Element] != 0) == (uiBatch.m_TextureIDs[i] != 0) &&
+					batchData.m_TextureSets[last.m_Element] == batchData.m_TextureSets[i] &&
+					uiBatch.m_DistanceRanges[last.m_Element] == uiBatch.m_DistanceRanges[i];
+				if (sameBatch)
+				{
+					last.m_IndexCount += indexCount;
+					continue;
+				}
 			}
+			batchData.m_DrawRanges.push_back({ i, firstIndex, indexCount });
 		}
 
-		m_ImageMesh = pDevice->AcquireCachedMesh(m_pImageMesh.get());
-
 		RenderPassHandle renderPass = pDocument->m_UIPasses[frameIndex];
 		pDevice->SetRenderPassClear(renderPass, data.m_ClearColor);
 		pDevice->BeginRenderPass(commandBuffer, renderPass);
@@ -250,14 +284,15 @@ namespace Glory
 		uint8_t mask = 0;
 		UIConstants constants;
 		constants.Projection = pDocument->m_Projection;
-		for (size_t i = 0; i < pDocument->m_UIBatch.m_Worlds.size(); ++i)
+		for (const UIBatchData::DrawRange& range : batchData.m_DrawRanges)
 		{
+			const size_t i = range.m_Element;
+
 			/* Setup constants */
-			constants.ObjectIndex = i;
-			constants.ColorIndex = pDocument->m_UIBatch.m_ColorIndices[i];
-			constants.HasTexture = pDocument->m_UIBatch.m_TextureIDs[i] ? 1 : 0;
+			constants.HasTexture = uiBatch.m_TextureIDs[i] ? 1 : 0;
+			constants.DistanceRange = uiBatch.m_DistanceRanges[i];
 
-			if (pDocument->m_UIBatch.m_MaskDecrements.IsSet(i))
+			if (uiBatch.m_MaskDecrements.IsSet(i))
 			{
 				/* Remove the shape from the stencil */
 				--mask;
@@ -267,13 +302,12 @@ namespace Glory
 				pDevice->BindDescriptorSets(commandBuffer, m_UIStencilPipeline, { batchData.m_BuffersSet });
 				pDevice->SetViewport(commandBuffer, 0.0f, 0.0f, float(pDocument->m_Resolution.x), float(pDocument->m_Resolution.y));
 				pDevice->SetScissor(commandBuffer, 0, 0, pDocument->m_Resolution.x, pDocument->m_Resolution.y);
-				pDevice->DrawMesh(commandBuffer, m_ImageMesh);
+				pDevice->DrawMesh(commandBuffer, batchedMesh, range.m_FirstIndex, range.m_IndexCount);
 				pDevice->EndPipeline(commandBuffer);
 				continue;
 			}
 
-			const bool isStencil = pDocument->m_UIBatch.m_MaskIncrements.IsSet(i);
-			if (isStencil)
+			if (uiBatch.m_MaskIncrements.IsSet(i))
 			{
 				/* Render the mask to the stencil buffer */
 				pDevice->BeginPipeline(commandBuffer, m_UIStencilPipeline);
@@ -283,22 +317,17 @@ namespace Glory
 				pDevice->BindDescriptorSets(commandBuffer, m_UIStencilPipeline, { batchData.m_BuffersSet });
 				pDevice->SetViewport(commandBuffer, 0.0f, 0.0f, float(pDocument->m_Resolution.x), float(pDocument->m_Resolution.y));
 				pDevice->SetScissor(commandBuffer, 0, 0, pDocument->m_Resolution.x, pDocument->m_Resolution.y);
-				pDevice->DrawMesh(commandBuffer, m_ImageMesh);
+				pDevice->DrawMesh(commandBuffer, batchedMesh, range.m_FirstIndex, range.m_IndexCount);
 				/* Second stencil pass compares stencil with the the expected addition, on fail it is reduced by 1 */
 				pDevice->SetStencilOp(commandBuffer, CompareOp::OP_Equal, Func::OP_Decrement, Func::OP_Decrement, Func::OP_Replace, mask + 1, 255);
-				pDevice->DrawMesh(commandBuffer, m_ImageMesh);
+				pDevice->DrawMesh(commandBuffer, batchedMesh, range.m_FirstIndex, range.m_IndexCount);
 				pDevice->EndPipeline(commandBuffer);
 
 				++mask;
 				continue;
 			}
 
-			const UUID meshID = pDocument->m_UIBatch.m_TextMeshes[i];
-
-			MeshData* pMesh = meshID ? pDocument->m_pTextMeshes.at(meshID).get() : nullptr;
-			MeshHandle mesh = pMesh ? pDevice->AcquireCachedMesh(pMesh, MU_Dynamic) : m_ImageMesh;
-
-			const PipelineHandle pipeline = meshID ? m_UITextPipeline : m_UIPipeline;
+			const PipelineHandle pipeline = uiBatch.m_TextMeshes[i] ? m_UITextPipeline : m_UIPipeline;
 			pDevice->BeginPipeline(commandBuffer, pipeline);
 
 			if (mask > 0)
@@ -311,12 +340,86 @@ namespace Glory
 			pDevice->BindDescriptorSets(commandBuffer, pipeline, { batchData.m_BuffersSet, batchData.m_TextureSets[i] });
 			pDevice->SetViewport(commandBuffer, 0.0f, 0.0f, float(pDocument->m_Resolution.x), float(pDocument->m_Resolution.y));
 			pDevice->SetScissor(commandBuffer, 0, 0, pDocument->m_Resolution.x, pDocument->m_Resolution.y);
-			pDevice->DrawMesh(commandBuffer, mesh);
+			pDevice->DrawMesh(commandBuffer, batchedMesh, range.m_FirstIndex, range.m_IndexCount);
 			pDevice->EndPipeline(commandBuffer);
 		}
 		pDevice->EndRenderPass(commandBuffer);
 	}
 
+	bool UIRendererModule::TexturesChanged(GraphicsDevice* pDevice, UIDocument* pDocument, UIBatchData& batchData)
+	{
+		Resources& resources = m_pEngine->GetResources();
+		const UIBatch& uiBatch = pDocument->m_UIBatch;
+		const size_t count = std::min(uiBatch.m_TextureIDs.size(), batchData.m_LastTextures.size());
+		for (size_t i = 0; i < count; ++i)
+		{
+			const UUID textureID = uiBatch.m_TextureIDs[i];
+			if (!textureID) continue;
+			Resource* pTextureResource = resources.GetResource(textureID);
+			TextureData* pTexture = pTextureResource ? static_cast<TextureData*>(pTextureResource) : nullptr;
+			/* Finished loading, uploading or streaming in a different mip range */
+			if (pDevice->AcquireCachedTexture(pTexture) != batchData.m_LastTextures[i]) return true;
+		}
+		return false;
+	}
+
+	void UIRendererModule::UpdateBatchedMesh(UIDocument* pDocument, UIBatchData& batchData)
+	{
+		const UIBatch& uiBatch = pDocument->m_UIBatch;
+		const size_t elementCount = uiBatch.m_Worlds.size();
+
+		/* Worlds and colors are read from buffers, so the vertices only change when an element
+		 * gets a different mesh, a new version of its mesh or a different color slot */
+		bool dirty = !batchData.m_pBatchedMesh || batchData.m_BuiltElements.size() != elementCount;
+		for (size_t i = 0; !dirty && i < elementCount; ++i)
+		{
+			const UUID meshID = uiBatch.m_TextMeshes[i];
+			const MeshData* pMesh = meshID ? pDocument->m_pTextMeshes.at(meshID).m_pMesh.get() : m_pImageMesh.get();
+			const UIBatchData::BuiltElement& built = batchData.m_BuiltElements[i];
+			dirty = built.m_MeshID != meshID || built.m_MeshVersion != pMesh->DirtyVersion() ||
+				built.m_ColorIndex != uiBatch.m_ColorIndices[i];
+		}
+		if (!dirty) return;
+
+		if (!batchData.m_pBatchedMesh)
+		{
+			batchData.m_pBatchedMesh.reset(new MeshData(uint32_t(elementCount*4), sizeof(UIVertex),
+				{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2, AttributeType::Float2 }));
+		}
+
+		MeshData* pBatchedMesh = batchData.m_pBatchedMesh.get();
+		pBatchedMesh->ClearVertices();
+		pBatchedMesh->ClearIndices();
+		batchData.m_BuiltElements.resize(elementCount);
+		batchData.m_ElementIndices.resize(elementCount);
+		for (size_t i = 0; i < elementCount; ++i)
+		{
+			const UUID meshID = uiBatch.m_TextMeshes[i];
+			const MeshData* pMesh = meshID ? pDocument->m_pTextMeshes.at(meshID).m_pMesh.get() : m_pImageMesh.get();
+			const glm::vec2 indices{ float(i), float(uiBatch.m_ColorIndices[i]) };
+
+			const uint32_t baseVertex = pBatchedMesh->VertexCount();
+			const uint32_t firstIndex = pBatchedMesh->IndexCount();
+			const VertexPosColorTex* vertices = reinterpret_cast<const VertexPosColorTex*>(pMesh->Vertices());
+			for (uint32_t j = 0; j < pMesh->VertexCount(); ++j)
+			{
+				UIVertex vertex{ vertices[j].Pos, vertices[j].Color, vertices[j].TexCoord, indices };
+				pBatchedMesh->AddVertex(reinterpret_cast<float*>(&vertex));
+			}
+
+			/* UI meshes are built from quads, each quad is 2 triangles that share their first vertex */
+			const uint32_t* meshIndices = pMesh->Indices();
+			for (uint32_t j = 0; j + 5 < pMesh->IndexCount(); j += 6)
+			{
+				pBatchedMesh->AddFace(baseVertex + meshIndices[j], baseVertex + meshIndices[j + 1],
+					baseVertex + meshIndices[j + 2], baseVertex + meshIndices[j + 5]);
+			}
+
+			batchData.m_ElementIndices[i] = { firstIndex, pBatchedMesh->IndexCount() - firstIndex };
+			batchData.m_BuiltElements[i] = { meshID, pMesh->DirtyVersion(), uiBatch.m_ColorIndices[i] };
+		}
+	}
+
 	MaterialData* UIRendererModule::PrepassStencilMaterial()
 	{
 		return m_pUIPrepassStencilMaterial;
@@ -711,7 +814,7 @@ namespace Glory
 		{
 			document.ResizeRenderTexture(pDevice, pRenderer->GetNumFramesInFlight(),
 				glm::uvec2(uint32_t(data.m_Resolution.x), uint32_t(data.m_Resolution.y)), this);
-			document.m_DrawIsDirty = true;
+			document.SetDrawDirty();
 		}
 
 		if (document.m_OriginalDocumentID != pDocument->GetUUID() || forceCreate)
@@ -837,16 +940,16 @@ namespace Glory
 		PipelineManager& pipelines = m_pEngine->GetPipelineManager();
 		PipelineData* pPipeline = pipelines.GetPipelineData(settings.Value<uint64_t>("UI Prepass Pipeline"));
 		m_UIPipeline = pDevice->AcquireCachedPipeline(m_DummyRenderPass, pPipeline,
-			{ m_UIBuffersLayout, m_UISamplerLayout }, sizeof(VertexPosColorTex),
-			{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2 });
+			{ m_UIBuffersLayout, m_UISamplerLayout }, sizeof(UIVertex),
+			{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2, AttributeType::Float2 });
 		pPipeline = pipelines.GetPipelineData(settings.Value<uint64_t>("UI Text Prepass Pipeline"));
 		m_UITextPipeline = pDevice->AcquireCachedPipeline(m_DummyRenderPass, pPipeline,
-			{ m_UIBuffersLayout, m_UISamplerLayout }, sizeof(VertexPosColorTex),
-			{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2 });
+			{ m_UIBuffersLayout, m_UISamplerLayout }, sizeof(UIVertex),
+			{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2, AttributeType::Float2 });
 		pPipeline = pipelines.GetPipelineData(settings.Value<uint64_t>("UI Prepass Stencil Pipeline"));
 		m_UIStencilPipeline = pDevice->AcquireCachedPipeline(m_DummyRenderPass, pPipeline,
-			{ m_UIBuffersLayout }, sizeof(VertexPosColorTex),
-			{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2 });
+			{ m_UIBuffersLayout }, sizeof(UIVertex),
+			{ AttributeType::Float2, AttributeType::Float3, AttributeType::Float2, AttributeType::Float2 });
 	}
 
 	void UIRendererModule::CheckCachedOverlayPipeline(RenderPassHandle renderPass, GraphicsDevice* pDevice)
@@ -115,7 +115,6 @@ namespace Glory
 
 		std::vector<UIRenderData> m_Frame;
 		std::unique_ptr<MeshData> m_pImageMesh;
-		MeshHandle m_ImageMesh = 0;
 		std::map<UUID, MeshData*> m_pDocumentQuads;
 		std::map<UUID, std::vector<TextureData*>> m_pDocumentTextures;
 		std::unordered_map<UUID, uint64_t> m_ResourceCacheVersions;
@@ -132,9 +131,38 @@ namespace Glory
 			BufferHandle m_WorldsBuffers = 0;
 			DescriptorSetHandle m_BuffersSet = 0;
 			std::vector<DescriptorSetHandle> m_TextureSets;
-			std::vector<UUID> m_LastTextureIDs;
+			std::vector<TextureHandle> m_LastTextures;
+
+			/** @brief What the vertices of an element in the batched mesh were built from */
+			struct BuiltElement
+			{
+				UUID m_MeshID;
+				uint64_t m_MeshVersion;
+				uint32_t m_ColorIndex;
+			};
+
+			/** @brief Elements drawn with a single draw call */
+			struct DrawRange
+			{
+				size_t m_Element;
+				uint32_t m_FirstIndex;
+				uint32_t m_IndexCount;
+			};
+
+			/** @brief Vertices of every element of the document in draw order */
+			std::unique_ptr<MeshData> m_pBatchedMesh;
+			std::vector<BuiltElement> m_BuiltElements;
+			/** @brief First index and index count of each element in the batched mesh */
+			std::vector<std::pair<uint32_t, uint32_t>> m_ElementIndices;
+			std::vector<DrawRange> m_DrawRanges;
+			/** @brief Clear color the render textures were last drawn with */
+			glm::vec4 m_ClearColor{ 0.0f, 0.0f, 0.0f, 0.0f };
 		};
 
+		void UpdateBatchedMesh(UIDocument* pDocument, UIBatchData& batchData);
+		/** @brief Check whether a texture the document was last drawn with resolves to a different handle now */
+		bool TexturesChanged(GraphicsDevice* pDevice, UIDocument* pDocument, UIBatchData& batchData);
+
 		std::map<UUID, UIBatchData> m_BatchDatas;
 
 		DescriptorSetLayoutHandle m_UIBuffersLayout = 0;
@@ -64,7 +64,7 @@ namespace Glory
 	{
 		if (m_DescriptorPools.empty())
 		{
-			CreatePool(1000);
+			CreatePool(1000, vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet);
 			m_ActivePoolIndex = 0;
 		}
 
@@ -90,10 +90,11 @@ namespace Glory
 		}
 
 		++m_ActivePoolIndex;
-		if (m_ActivePoolIndex > m_DescriptorPools.size())
-			CreatePool(1000);
+		if (m_ActivePoolIndex >= m_DescriptorPools.size())
+			CreatePool(1000, vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet);
 
 		allocInfo.descriptorPool = m_DescriptorPools[m_ActivePoolIndex];
+		*pool = m_DescriptorPools[m_ActivePoolIndex];
 		allocResult = m_pDevice->LogicalDevice().allocateDescriptorSets(&allocInfo, set);
 		if(allocResult != vk::Result::eSuccess)
 			m_pDevice->Debug().LogError("DescriptorAllocator::Allocate: Failed to allocate descriptor set.");
@@ -14,6 +14,7 @@
 #include <CubemapData.h>
 #include <FileData.h>
 #include <EngineProfiler.h>
+#include <BinaryStream.h>
 
 #define LOAD_VK_EXT(f, t, str)\
 f = (t)m_LogicalDevice.getProcAddr(str);\
@@ -160,6 +161,21 @@ namespace Glory
 		}
 	}
 
+	/** @brief Header written in front of the pipeline cache data on disk */
+	struct PipelineCacheFileHeader
+	{
+		static constexpr uint32_t Magic = 0x43504C47; /* GLPC */
+		static constexpr uint32_t CurrentVersion = 1;
+
+		uint32_t m_Magic;
+		uint32_t m_Version;
+		uint32_t m_VendorID;
+		uint32_t m_DeviceID;
+		uint32_t m_DriverVersion;
+		uint8_t m_PipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t m_DataSize;
+	};
+
 	VulkanDevice::VulkanDevice(VulkanGraphicsModule* pModule, vk::PhysicalDevice physicalDevice):
 		GraphicsDevice(pModule), m_VKDevice(physicalDevice), m_DidLastSupportCheckPass(false),
 		m_DescriptorAllocator(this), m_CommandBufferAllocator(this)
@@ -198,6 +214,9 @@ namespace Glory
 		m_CachedSamplers.clear();
 		m_CachedDescriptorSetLayouts.clear();
 
+		m_LogicalDevice.destroyPipelineCache(m_VKPipelineCache);
+		m_VKPipelineCache = nullptr;
+
 		m_LogicalDevice.destroy();
 	}
 
@@ -370,6 +389,7 @@ namespace Glory
 		LOAD_VK_EXT(PFNCmdSetColorBlendEquationEXT, PFN_vkCmdSetColorBlendEquationEXT, "vkCmdSetColorBlendEquationEXT");
 
 		CreateGraphicsCommandPool();
+		CreatePipelineCache();
 		AllocateFreeFences(10);
 	}
 
@@ -710,6 +730,11 @@ namespace Glory
 	}
 
 	void VulkanDevice::DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle)
+	{
+		DrawMesh(commandBuffer, handle, 0, UINT32_MAX);
+	}
+
+	void VulkanDevice::DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle, uint32_t firstIndex, uint32_t indexCount)
 	{
 		ProfileSample s{ &Profiler(), "VulkanDevice::DrawMesh" };
 		auto iter = m_CommandBuffers.find(commandBuffer);
@@ -744,12 +769,14 @@ namespace Glory
 		VK_Buffer* indexBuffer = mesh->m_IndexCount > 0 ? m_Buffers.Find(mesh->m_Buffers.back()) : nullptr;
 		vkCommandBuffer->bindVertexBuffers(0, vertexBuffers.size(), vertexBuffers.data(), offsets.data());
 		if (indexBuffer)
-			vkCommandBuffer->bindIndexBuffer(indexBuffer->m_VKBuffer, 0, vk::IndexType::eUint32);
+			vkCommandBuffer->bindIndexBuffer(indexBuffer->m_VKBuffer, 0, mesh->m_VKIndexType);
 
 		if (hasIndexBuffer)
 		{
-			vkCommandBuffer->drawIndexed(mesh->m_IndexCount, 1, 0, 0, 0);
-			m_CurrentTriangles += mesh->m_IndexCount/3;
+			/* A LOD range may lie past the indices of the full mesh */
+			if (indexCount == UINT32_MAX) indexCount = mesh->m_IndexCount;
+			vkCommandBuffer->drawIndexed(indexCount, 1, firstIndex, 0, 0);
+			m_CurrentTriangles += indexCount/3;
 		}
 		else
 			vkCommandBuffer->draw(mesh->m_VertexCount, 1, 0, 0);
@@ -889,7 +916,7 @@ namespace Glory
 		VK_CommandBuffer& vkCommandBuffer = iter->second;
 		vk::Fence vkFence = vkCommandBuffer.m_VKFence;
 
-		const vk::Result waitState = m_LogicalDevice.waitForFences(1, &vkFence, VK_TRUE, UINT64_MAX);
+		const vk::Result waitState = m_LogicalDevice.waitForFences(1, &vkFence, VK_TRUE, timeout);
 		if (int32_t(waitState) < 0)
 		{
 			Debug().LogError("VulkanDevice::Wait: Failed to wait for fence.");
@@ -899,6 +926,7 @@ namespace Glory
 		switch (waitState)
 		{
 		case vk::Result::eSuccess:
+			CompleteReadbacks(commandBuffer);
 			return WR_Success;
 		case vk::Result::eTimeout:
 			return WR_Timeout;
@@ -913,12 +941,19 @@ namespace Glory
 		auto iter = m_CommandBuffers.find(commandBuffer);
 		if (iter == m_CommandBuffers.end())
 		{
-			Debug().LogError("VulkanDevice::Wait: Invalid command buffer handle.");
+			Debug().LogError("VulkanDevice::Release: Invalid command buffer handle.");
 			return;
 		}
+
 		VK_CommandBuffer& vkCommandBuffer = iter->second;
 		vk::Fence vkFence = vkCommandBuffer.m_VKFence;
 
+		/* Readback buffers may only be read once the GPU finished writing them */
+		if (vkFence && m_LogicalDevice.getFenceStatus(vkFence) == vk::Result::eSuccess)
+			CompleteReadbacks(commandBuffer);
+		else
+			DropReadbacks(commandBuffer);
+
 		m_FreeFences.push_back(vkFence);
 		vkCommandBuffer.m_VKFence = nullptr;
 
@@ -1140,6 +1175,38 @@ namespace Glory
 				vk::ImageLayout::eTransferSrcOptimal, vkSrcImage->m_VKFinalLayout, vkSrcImage->m_VKAspect, 1, 1);
 	}
 
+	void VulkanDevice::CopyBuffer(CommandBufferHandle commandBuffer, BufferHandle src, BufferHandle dst,
+		uint32_t srcOffset, uint32_t dstOffset, uint32_t size)
+	{
+		ProfileSample s{ &Profiler(), "VulkanDevice::CopyBuffer" };
+		auto iter = m_CommandBuffers.find(commandBuffer);
+		if (iter == m_CommandBuffers.end())
+		{
+			Debug().LogError("VulkanDevice::CopyBuffer: Invalid command buffer handle.");
+			return;
+		}
+
+		VK_Buffer* vkSrcBuffer = m_Buffers.Find(src);
+		VK_Buffer* vkDstBuffer = m_Buffers.Find(dst);
+		if (!vkSrcBuffer)
+		{
+			Debug().LogError("VulkanDevice::CopyBuffer: Invalid src buffer handle.");
+			return;
+		}
+		if (!vkDstBuffer)
+		{
+			Debug().LogError("VulkanDevice::CopyBuffer: Invalid dst buffer handle.");
+			return;
+		}
+		if (srcOffset + size > vkSrcBuffer->m_Size || dstOffset + size > vkDstBuffer->m_Size)
+		{
+			Debug().LogError("VulkanDevice::CopyBuffer: Attempting to copy beyond buffer size.");
+			return;
+		}
+
+		CopyFromBuffer(*iter->second, vkDstBuffer->m_VKBuffer, vkSrcBuffer->m_VKBuffer, dstOffset, srcOffset, size);
+	}
+
 	GraphicsDevice::SwapchainResult VulkanDevice::AcquireNextSwapchainImage(SwapchainHandle swapchain, uint32_t* imageIndex,
 		SemaphoreHandle signalSemaphore)
 	{
@@ -1226,6 +1293,101 @@ namespace Glory
 		m_DefaultImage = texture->m_Image;
 	}
 
+	void VulkanDevice::LoadPipelineCache(const std::filesystem::path& path)
+	{
+		ProfileSample s{ &Profiler(), "VulkanDevice::LoadPipelineCache" };
+		m_PipelineCachePath = path;
+		if (!std::filesystem::exists(path)) return;
+
+		std::vector<char> data;
+		{
+			Utils::BinaryFileStream file{ path, true };
+			PipelineCacheFileHeader header;
+			if (file.Size() < sizeof(PipelineCacheFileHeader))
+			{
+				Debug().LogWarning("VulkanDevice::LoadPipelineCache: Pipeline cache file is corrupt, it will be rebuilt.");
+				return;
+			}
+			file.Read(header);
+
+			if (header.m_Magic != PipelineCacheFileHeader::Magic || header.m_Version != PipelineCacheFileHeader::CurrentVersion ||
+				header.m_DataSize > file.Size() - sizeof(PipelineCacheFileHeader))
+			{
+				Debug().LogWarning("VulkanDevice::LoadPipelineCache: Pipeline cache file is corrupt, it will be rebuilt.");
+				return;
+			}
+
+			if (header.m_VendorID != m_DeviceProperties.vendorID || header.m_DeviceID != m_DeviceProperties.deviceID ||
+				header.m_DriverVersion != m_DeviceProperties.driverVersion ||
+				std::memcmp(header.m_PipelineCacheUUID, m_DeviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0)
+			{
+				Debug().LogInfo("VulkanDevice::LoadPipelineCache: Pipeline cache was created by a different device or driver, it will be rebuilt.");
+				return;
+			}
+
+			data.resize(header.m_DataSize);
+			file.Read(data.data(), data.size());
+		}
+
+		if (!IsPipelineCacheCompatible(data))
+		{
+			Debug().LogInfo("VulkanDevice::LoadPipelineCache: Pipeline cache data is not compatible with this device, it will be rebuilt.");
+			return;
+		}
+
+		vk::PipelineCacheCreateInfo pipelineCacheCreateInfo = vk::PipelineCacheCreateInfo()
+			.setInitialDataSize(data.size())
+			.setPInitialData(data.data());
+
+		vk::PipelineCache loadedCache;
+		if (m_LogicalDevice.createPipelineCache(&pipelineCacheCreateInfo, nullptr, &loadedCache) != vk::Result::eSuccess)
+		{
+			Debug().LogWarning("VulkanDevice::LoadPipelineCache: Failed to create pipeline cache from file, it will be rebuilt.");
+			return;
+		}
+
+		/* Keep anything that was compiled before the cache was loaded */
+		if (m_VKPipelineCache)
+		{
+			if (m_LogicalDevice.mergePipelineCaches(loadedCache, 1, &m_VKPipelineCache) != vk::Result::eSuccess)
+				Debug().LogWarning("VulkanDevice::LoadPipelineCache: Failed to merge existing pipeline cache.");
+			m_LogicalDevice.destroyPipelineCache(m_VKPipelineCache);
+		}
+		m_VKPipelineCache = loadedCache;
+	}
+
+	void VulkanDevice::SavePipelineCache()
+	{
+		ProfileSample s{ &Profiler(), "VulkanDevice::SavePipelineCache" };
+		if (m_PipelineCachePath.empty() || !m_VKPipelineCache) return;
+
+		size_t dataSize = 0;
+		if (m_LogicalDevice.getPipelineCacheData(m_VKPipelineCache, &dataSize, nullptr) != vk::Result::eSuccess)
+		{
+			Debug().LogError("VulkanDevice::SavePipelineCache: Failed to get pipeline cache size.");
+			return;
+		}
+
+		std::vector<char> data(dataSize);
+		if (m_LogicalDevice.getPipelineCacheData(m_VKPipelineCache, &dataSize, data.data()) != vk::Result::eSuccess)
+		{
+			Debug().LogError("VulkanDevice::SavePipelineCache: Failed to get pipeline cache data.");
+			return;
+		}
+
+		PipelineCacheFileHeader header;
+		header.m_Magic = PipelineCacheFileHeader::Magic;
+		header.m_Version = PipelineCacheFileHeader::CurrentVersion;
+		header.m_VendorID = m_DeviceProperties.vendorID;
+		header.m_DeviceID = m_DeviceProperties.deviceID;
+		header.m_DriverVersion = m_DeviceProperties.driverVersion;
+		std::memcpy(header.m_PipelineCacheUUID, m_DeviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+		header.m_DataSize = static_cast<uint64_t>(dataSize);
+
+		Utils::BinaryFileStream file{ m_PipelineCachePath };
+		file.Write(header).Write(data.data(), dataSize);
+	}
+
 	vk::BufferUsageFlags GetBufferUsageFlags(BufferType bufferType, BufferFlags flags)
 	{
 		vk::BufferUsageFlags usageFlags;
@@ -1253,6 +1415,8 @@ namespace Glory
 		}
 		if (flags & BF_CopyDst)
 			usageFlags |= vk::BufferUsageFlagBits::eTransferDst;
+		if (flags & BF_CopySrc)
+			usageFlags |= vk::BufferUsageFlagBits::eTransferSrc;
 		return usageFlags;
 	}
 
@@ -1279,7 +1443,7 @@ namespace Glory
 
 	vk::MemoryPropertyFlags GetBufferMemoryPropertyFlags(BufferFlags flags)
 	{
-		if (flags == BF_None)
+		if ((flags & BF_ReadAndWrite) == 0)
 			return vk::MemoryPropertyFlagBits::eDeviceLocal;
 		vk::MemoryPropertyFlags result;
 		if (flags & BF_Write)
@@ -1525,6 +1689,21 @@ namespace Glory
 		case AttributeType::SINT4:
 			format = vk::Format::eR32G32B32A32Sint;
 			break;
+		case AttributeType::Half2:
+			format = vk::Format::eR16G16Sfloat;
+			break;
+		case AttributeType::Half4:
+			format = vk::Format::eR16G16B16A16Sfloat;
+			break;
+		case AttributeType::UNorm8x4:
+			format = vk::Format::eR8G8B8A8Unorm;
+			break;
+		case AttributeType::SNorm8x4:
+			format = vk::Format::eR8G8B8A8Snorm;
+			break;
+		case AttributeType::UNorm16x4:
+			format = vk::Format::eR16G16B16A16Unorm;
+			break;
 		}
 
 		return format;
@@ -1570,11 +1749,26 @@ namespace Glory
 		case AttributeType::SINT4:
 			offest += (sizeof(int32_t)*4);
 			break;
+		case AttributeType::Half2:
+			offest += (sizeof(uint16_t)*2);
+			break;
+		case AttributeType::Half4:
+			offest += (sizeof(uint16_t)*4);
+			break;
+		case AttributeType::UNorm8x4:
+			offest += (sizeof(uint8_t)*4);
+			break;
+		case AttributeType::SNorm8x4:
+			offest += (sizeof(int8_t)*4);
+			break;
+		case AttributeType::UNorm16x4:
+			offest += (sizeof(uint16_t)*4);
+			break;
 		}
 	}
 
 	MeshHandle VulkanDevice::CreateMesh(std::vector<BufferHandle>&& buffers, uint32_t vertexCount,
-		uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes)
+		uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes, IndexType indexType)
 	{
 		ProfileSample s{ &Profiler(), "VulkanDevice::CreateMesh" };
 		MeshHandle handle;
@@ -1582,6 +1776,7 @@ namespace Glory
 		mesh.m_Buffers = std::move(buffers);
 		mesh.m_VertexCount = vertexCount;
 		mesh.m_IndexCount = indexCount;
+		mesh.m_VKIndexType = indexType == IndexType::UInt16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
 
 		const uint32_t binding = 0;
 
@@ -1629,9 +1824,13 @@ namespace Glory
 
 		vkMesh->m_IndexCount = pMeshData->IndexCount();
 		vkMesh->m_VertexCount = pMeshData->VertexCount();
+		const bool shortIndices = pMeshData->GetIndexType() == IndexType::UInt16;
+		vkMesh->m_VKIndexType = shortIndices ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
 
 		const size_t vertexBufferSize = pMeshData->VertexCount()*pMeshData->VertexSize();
-		const size_t indexBufferSize = pMeshData->IndexCount()*sizeof(uint32_t);
+		const size_t indexBufferSize = pMeshData->IndexCount()*pMeshData->IndexStride();
+		/* LOD indices are stored right after the indices of the full mesh */
+		const size_t lodIndexBufferSize = pMeshData->LODIndexCount()*pMeshData->IndexStride();
 
 		WaitIdle();
 		VK_Buffer* vkVertexBuffer = m_Buffers.Find(vkMesh->m_Buffers[0]);
@@ -1645,17 +1844,28 @@ namespace Glory
 		if (vkMesh->m_IndexCount > 0)
 		{
 			VK_Buffer* vkIndexBuffer = m_Buffers.Find(vkMesh->m_Buffers.back());
-			if (indexBufferSize > vkIndexBuffer->m_Size)
+			if (indexBufferSize + lodIndexBufferSize > vkIndexBuffer->m_Size)
 			{
-				vkIndexBuffer->m_Size = indexBufferSize;
+				vkIndexBuffer->m_Size = indexBufferSize + lodIndexBufferSize;
 				ResizeBuffer(*vkIndexBuffer);
 			}
 
-			AssignBuffer(vkMesh->m_Buffers.back(), pMeshData->Indices(), indexBufferSize);
+			if (shortIndices)
+			{
+				std::vector<uint16_t> indices;
+				pMeshData->PackIndices(indices);
+				AssignBuffer(vkMesh->m_Buffers.back(), indices.data(), uint32_t(indexBufferSize + lodIndexBufferSize));
+			}
+			else
+			{
+				AssignBuffer(vkMesh->m_Buffers.back(), pMeshData->Indices(), indexBufferSize);
+				if (lodIndexBufferSize > 0)
+					AssignBuffer(vkMesh->m_Buffers.back(), pMeshData->LODIndices(), uint32_t(indexBufferSize), uint32_t(lodIndexBufferSize));
+			}
 		}
 	}
 
-	TextureHandle VulkanDevice::CreateTexture(TextureData* pTexture)
+	TextureHandle VulkanDevice::CreateTexture(TextureData* pTexture, uint32_t firstMipLevel)
 	{
 		ProfileSample s{ &Profiler(), "VulkanDevice::CreateTexture" };
 		ImageData* pImage = pTexture->GetImageData(&m_pModule->GetEngine()->GetResources());
@@ -1663,10 +1873,38 @@ namespace Glory
 		TextureHandle handle;
 		VK_Texture& texture = m_Textures.Emplace(handle, VK_Texture());
 
-		texture.m_Image = GetCachedImage(pImage);
+		if (pImage && firstMipLevel > 0 && pImage->MipLevelCount() > 1)
+		{
+			/* Streamed textures get their own image with only the levels they need,
+			 * it is destroyed together with the texture */
+			const size_t firstMip = std::min(size_t(firstMipLevel), pImage->MipLevelCount() - 1);
+			const ImageData::MipLevel& first = pImage->GetMipLevel(firstMip);
+			std::vector<ImageData::MipLevel> levels(pImage->MipLevels().begin() + firstMip, pImage->MipLevels().end());
+			for (ImageData::MipLevel& level : levels)
+				level.m_Offset -= first.m_Offset;
 
-		if (texture.m_Image != m_DefaultImage)
-			++m_Images.Find(texture.m_Image)->m_ReferenceCounter;
+			TextureCreateInfo createInfo;
+			createInfo.m_Width = first.m_Width;
+			createInfo.m_Height = first.m_Height;
+			createInfo.m_ImageAspectFlags = IA_Color;
+			createInfo.m_ImageType = ImageType::IT_2D;
+			createInfo.m_InternalFormat = pImage->GetInternalFormat();
+			createInfo.m_PixelFormat = pImage->GetFormat();
+			createInfo.m_Type = pImage->GetDataType();
+			createInfo.m_Flags = IF_None;
+			createInfo.m_SamplingEnabled = true;
+
+			const char* pixels = static_cast<const char*>(pImage->GetPixels()) + first.m_Offset;
+			texture.m_Image = CreateImage(createInfo, pixels, pImage->DataSize() - first.m_Offset, levels);
+			if (!texture.m_Image) texture.m_Image = m_DefaultImage;
+		}
+		else
+		{
+			texture.m_Image = GetCachedImage(pImage);
+
+			if (texture.m_Image != m_DefaultImage)
+				++m_Images.Find(texture.m_Image)->m_ReferenceCounter;
+		}
 
 		const SamplerSettings& samplerSettings = pTexture->GetSamplerSettings();
 		auto samplerIter = m_CachedSamplers.find(samplerSettings);
@@ -1711,16 +1949,24 @@ namespace Glory
 		const size_t numFaces = 6;
 		const size_t faceDataSize = pFaceImage->DataSize();
 		const size_t totalDataSize = faceDataSize*numFaces;
+		/* Stored mip chains of the faces are copied per face and level */
+		const std::vector<ImageData::MipLevel> mipLevels = pFaceImage->MipLevels();
 
 		std::vector<char> pixels(totalDataSize);
 
 		for (size_t i = 0; i < 6; ++i)
 		{
 			pFaceImage = pCubemap->GetImageData(&m_pModule->GetEngine()->GetResources(), i);
+			if (!pFaceImage || pFaceImage->DataSize() != faceDataSize || pFaceImage->MipLevelCount() != mipLevels.size() ||
+				pFaceImage->GetInternalFormat() != createInfo.m_InternalFormat)
+			{
+				Debug().LogError("VulkanDevice::CreateTexture(CubemapData): All faces must have the same size, format and mip levels.");
+				return NULL;
+			}
 			std::memcpy(&pixels[i*faceDataSize], pFaceImage->GetPixels(), faceDataSize);
 		}
 
-		return CreateTexture(createInfo, pixels.data(), totalDataSize);
+		return CreateTexture(createInfo, pixels.data(), totalDataSize, mipLevels);
 	}
 
 	void EnsureSupportedFormat(vk::Format& format, vk::ImageViewCreateInfo& viewInfo)
@@ -1741,12 +1987,18 @@ namespace Glory
 	}
 
 	TextureHandle VulkanDevice::CreateTexture(const TextureCreateInfo& textureInfo, const void* pixels, size_t dataSize)
+	{
+		return CreateTexture(textureInfo, pixels, dataSize, {});
+	}
+
+	TextureHandle VulkanDevice::CreateTexture(const TextureCreateInfo& textureInfo, const void* pixels, size_t dataSize,
+		const std::vector<ImageData::MipLevel>& storedMipLevels)
 	{
 		ProfileSample s{ &Profiler(), "VulkanDevice::CreateTexture(textureInfo)" };
 		TextureHandle handle;
 		VK_Texture& texture = m_Textures.Emplace(handle, VK_Texture());
 
-		texture.m_Image = CreateImage(textureInfo, pixels, dataSize);
+		texture.m_Image = CreateImage(textureInfo, pixels, dataSize, storedMipLevels);
 
 		if (textureInfo.m_SamplingEnabled)
 		{
@@ -2425,7 +2677,7 @@ namespace Glory
 			.setStage(shaderStage)
 			.setLayout(pipeline.m_VKLayout);
 
-		if (m_LogicalDevice.createComputePipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline.m_VKPipeline) != vk::Result::eSuccess)
+		if (m_LogicalDevice.createComputePipelines(m_VKPipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline.m_VKPipeline) != vk::Result::eSuccess)
 		{
 			Debug().LogError("VulkanDevice::CreateComputePipeline: Failed to create compute pipeline.");
 			return NULL;
@@ -2812,6 +3064,7 @@ namespace Glory
 			Debug().LogError("VulkanDevice::FreeBuffer: Invalid buffer handle.");
 			return;
 		}
+		FreeCachedDescriptorSets(handle);
 
 		if (buffer->m_pMappedMemory)
 		{
@@ -2853,6 +3106,7 @@ namespace Glory
 			Debug().LogError("VulkanDevice::FreeTexture: Invalid texture handle.");
 			return;
 		}
+		FreeCachedDescriptorSets(handle);
 
 		ImageHandle image = texture->m_Image;
 		VK_Image* vkImage = m_Images.Find(image);
@@ -3298,6 +3552,37 @@ namespace Glory
 			static_cast<uint32_t>(bufferImageCopies.size()), bufferImageCopies.data());
 	}
 
+	void VulkanDevice::CopyMipLevelsFromBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::Image image,
+		vk::ImageAspectFlags aspectFlags, const std::vector<ImageData::MipLevel>& mipLevels, uint32_t levelCount,
+		uint32_t layerCount, size_t layerSize)
+	{
+		ProfileSample s{ &Profiler(), "VulkanDevice::CopyMipLevelsFromBuffer" };
+
+		/* Every layer stores its own mip chain with the same layout */
+		std::vector<vk::BufferImageCopy> bufferImageCopies(levelCount*layerCount);
+		for (uint32_t layer = 0; layer < layerCount; ++layer)
+		{
+			for (uint32_t i = 0; i < levelCount; ++i)
+			{
+				vk::BufferImageCopy& copy = bufferImageCopies[layer*levelCount + i];
+				copy.bufferOffset = layer*layerSize + mipLevels[i].m_Offset;
+				copy.bufferRowLength = 0;
+				copy.bufferImageHeight = 0;
+
+				copy.imageSubresource.aspectMask = aspectFlags;
+				copy.imageSubresource.mipLevel = i;
+				copy.imageSubresource.baseArrayLayer = layer;
+				copy.imageSubresource.layerCount = 1;
+
+				copy.imageOffset = vk::Offset3D(0, 0, 0);
+				copy.imageExtent = vk::Extent3D(mipLevels[i].m_Width, mipLevels[i].m_Height, 1);
+			}
+		}
+
+		commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal,
+			static_cast<uint32_t>(bufferImageCopies.size()), bufferImageCopies.data());
+	}
+
 	void VulkanDevice::CopyImage(vk::CommandBuffer commandBuffer, vk::Image src, vk::ImageLayout srcLayout, vk::Image dst,
 		vk::ImageLayout dstLayout, vk::ImageAspectFlags srcAspectFlags, vk::ImageAspectFlags dstAspectFlags, vk::Offset3D srcOffset,
 		vk::Offset3D dstOffset, vk::Extent3D extent, uint32_t layerCount)
@@ -3453,7 +3738,7 @@ namespace Glory
 			createInfo.m_Flags = IF_None;
 			createInfo.m_SamplingEnabled = true;
 
-			ImageHandle newImage = CreateImage(createInfo, pImage->GetPixels(), pImage->DataSize());
+			ImageHandle newImage = CreateImage(createInfo, pImage->GetPixels(), pImage->DataSize(), pImage->MipLevels());
 			iter = m_ImageHandles.emplace(pImage->GetGPUUUID(), newImage).first;
 			cacheVersion = pImage->DirtyVersion();
 
@@ -3482,14 +3767,17 @@ namespace Glory
 		return flags;
 	}
 
-	ImageHandle VulkanDevice::CreateImage(const TextureCreateInfo& textureInfo, const void* pixels, size_t dataSize)
+	ImageHandle VulkanDevice::CreateImage(const TextureCreateInfo& textureInfo, const void* pixels, size_t dataSize,
+		const std::vector<ImageData::MipLevel>& storedMipLevels)
 	{
 		ProfileSample s{ &Profiler(), "VulkanDevice::CreateImage()" };
 		ImageHandle handle;
 		VK_Image& image = m_Images.Emplace(handle, VK_Image());
 
-		const uint32_t mipLevels = pixels ? static_cast<uint32_t>(
-			std::floor(std::log2(std::max(textureInfo.m_Width, textureInfo.m_Height)))) + 1 : 1;
+		/* Stored mip levels are copied as is, blits can't generate block compressed levels */
+		const bool hasStoredMips = pixels && !storedMipLevels.empty();
+		const uint32_t mipLevels = hasStoredMips ? static_cast<uint32_t>(storedMipLevels.size()) :
+			pixels ? static_cast<uint32_t>(std::floor(std::log2(std::max(textureInfo.m_Width, textureInfo.m_Height)))) + 1 : 1;
 		const vk::Format format = VKConverter::GetVulkanFormat(textureInfo.m_InternalFormat);
 		const vk::ImageType imageType = VKConverter::GetVulkanImageType(textureInfo.m_ImageType);
 		const bool isCubemap = textureInfo.m_ImageType == ImageType::IT_Cube || textureInfo.m_ImageType == ImageType::IT_CubeArray;
@@ -3511,7 +3799,7 @@ namespace Glory
 		imageInfo.samples = vk::SampleCountFlagBits::e1;
 		imageInfo.flags = isCubemap ? vk::ImageCreateFlagBits::eCubeCompatible : (vk::ImageCreateFlags)0;
 		imageInfo.mipLevels = textureInfo.m_SamplerSettings.MipmapMode == Filter::F_None ? 1 : mipLevels;
-		if (imageInfo.mipLevels > 1)
+		if (imageInfo.mipLevels > 1 && !hasStoredMips)
 			imageInfo.usage |= vk::ImageUsageFlagBits::eTransferSrc;
 
 		const vk::FormatProperties formatProperties = m_VKDevice.getFormatProperties(imageInfo.format);
@@ -3568,11 +3856,15 @@ namespace Glory
 
 			const size_t layerSize = dataSize / imageInfo.arrayLayers;
 
-			CopyFromBuffer(commandBuffer, vkStagingBuffer->m_VKBuffer, image.m_VKImage, image.m_VKAspect,
-				textureInfo.m_Width, textureInfo.m_Height, imageInfo.arrayLayers, layerSize);
+			if (hasStoredMips)
+				CopyMipLevelsFromBuffer(commandBuffer, vkStagingBuffer->m_VKBuffer, image.m_VKImage, image.m_VKAspect,
+					storedMipLevels, imageInfo.mipLevels, imageInfo.arrayLayers, layerSize);
+			else
+				CopyFromBuffer(commandBuffer, vkStagingBuffer->m_VKBuffer, image.m_VKImage, image.m_VKAspect,
+					textureInfo.m_Width, textureInfo.m_Height, imageInfo.arrayLayers, layerSize);
 
 			/* Transtion layout again so it can be sampled */
-			if (imageInfo.mipLevels > 1)
+			if (imageInfo.mipLevels > 1 && !hasStoredMips)
 				GenerateMipMaps(commandBuffer, image.m_VKImage, textureInfo.m_Width, textureInfo.m_Height, imageInfo.mipLevels);
 			else
 				TransitionImageLayout(commandBuffer, image.m_VKImage, format, vk::ImageLayout::eTransferDstOptimal,
@@ -3638,7 +3930,9 @@ namespace Glory
 		/* Have to wait */
 		WaitIdle();
 
-		const uint32_t mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(pImage->GetWidth(), pImage->GetHeight())))) + 1;
+		const bool hasStoredMips = pImage->MipLevelCount() > 0;
+		const uint32_t mipLevels = hasStoredMips ? static_cast<uint32_t>(pImage->MipLevelCount()) :
+			static_cast<uint32_t>(std::floor(std::log2(std::max(pImage->GetWidth(), pImage->GetHeight())))) + 1;
 		const vk::Format format = VKConverter::GetVulkanFormat(pImage->GetInternalFormat());
 
 		vk::MemoryRequirements memRequirements;
@@ -3656,11 +3950,15 @@ namespace Glory
 
 		const size_t layerSize = pImage->DataSize();
 
-		CopyFromBuffer(commandBuffer, vkStagingBuffer->m_VKBuffer, vkImage->m_VKImage, vkImage->m_VKAspect,
-			pImage->GetWidth(), pImage->GetHeight(), 1, layerSize);
+		if (hasStoredMips)
+			CopyMipLevelsFromBuffer(commandBuffer, vkStagingBuffer->m_VKBuffer, vkImage->m_VKImage, vkImage->m_VKAspect,
+				pImage->MipLevels(), mipLevels);
+		else
+			CopyFromBuffer(commandBuffer, vkStagingBuffer->m_VKBuffer, vkImage->m_VKImage, vkImage->m_VKAspect,
+				pImage->GetWidth(), pImage->GetHeight(), 1, layerSize);
 
 		/* Transtion layout again so it can be sampled */
-		if (mipLevels > 1)
+		if (mipLevels > 1 && !hasStoredMips)
 			GenerateMipMaps(commandBuffer, vkImage->m_VKImage, pImage->GetWidth(), pImage->GetHeight(), mipLevels);
 		else
 			TransitionImageLayout(commandBuffer, vkImage->m_VKImage, format, vk::ImageLayout::eTransferDstOptimal,
@@ -3930,6 +4228,30 @@ namespace Glory
 		return true;
 	}
 
+	void VulkanDevice::CreatePipelineCache()
+	{
+		vk::PipelineCacheCreateInfo pipelineCacheCreateInfo = vk::PipelineCacheCreateInfo();
+		if (m_LogicalDevice.createPipelineCache(&pipelineCacheCreateInfo, nullptr, &m_VKPipelineCache) != vk::Result::eSuccess)
+		{
+			Debug().LogError("VulkanDevice::CreatePipelineCache: Failed to create pipeline cache.");
+			m_VKPipelineCache = nullptr;
+		}
+	}
+
+	bool VulkanDevice::IsPipelineCacheCompatible(const std::vector<char>& data) const
+	{
+		/* The driver rejects mismatching data as well, but not all drivers do so gracefully */
+		VkPipelineCacheHeaderVersionOne header;
+		if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) return false;
+		std::memcpy(&header, data.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+
+		return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+			header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+			header.vendorID == m_DeviceProperties.vendorID &&
+			header.deviceID == m_DeviceProperties.deviceID &&
+			std::memcmp(header.pipelineCacheUUID, m_DeviceProperties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+	}
+
 	bool VulkanDevice::CreatePipeline(VK_Pipeline& pipeline, PipelineData* pPipeline)
 	{
 		ProfileSample s{ &Profiler(), "VulkanDevice::CreatePipeline" };
@@ -4095,7 +4417,7 @@ namespace Glory
 			.setBasePipelineHandle(VK_NULL_HANDLE)
 			.setBasePipelineIndex(-1);
 
-		if (m_LogicalDevice.createGraphicsPipelines(VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &pipeline.m_VKPipeline) != vk::Result::eSuccess)
+		if (m_LogicalDevice.createGraphicsPipelines(m_VKPipelineCache, 1, &pipelineCreateInfo, nullptr, &pipeline.m_VKPipeline) != vk::Result::eSuccess)
 		{
 			Debug().LogError("VulkanDevice::CreatePipeline: Failed to create graphics pipeline.");
 			return false;
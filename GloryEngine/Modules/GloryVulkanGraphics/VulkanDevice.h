@@ -6,6 +6,7 @@
 
 #include <GraphicsDevice.h>
 #include <GraphicsEnums.h>
+#include <ImageData.h>
 
 #include <optional>
 
@@ -35,6 +36,7 @@ namespace Glory
         std::vector<vk::VertexInputAttributeDescription> m_AttributeDescriptions;
         uint32_t m_VertexCount;
         uint32_t m_IndexCount;
+        vk::IndexType m_VKIndexType;
         std::vector<BufferHandle> m_Buffers;
     };
 
@@ -231,6 +233,7 @@ namespace Glory
         virtual void PushConstants(CommandBufferHandle commandBuffer, PipelineHandle pipeline, uint32_t offset, uint32_t size, const void* data, ShaderTypeFlag shaderStages) override;
 
         virtual void DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle) override;
+        virtual void DrawMesh(CommandBufferHandle commandBuffer, MeshHandle handle, uint32_t firstIndex, uint32_t indexCount) override;
         virtual void Dispatch(CommandBufferHandle commandBuffer, uint32_t x, uint32_t y, uint32_t z) override;
 
         virtual void SetStencilTestEnabled(CommandBufferHandle commandBuffer, bool enable) override;
@@ -252,6 +255,8 @@ namespace Glory
 
         virtual void CopyImage(CommandBufferHandle commandBuffer, TextureHandle src, TextureHandle dst) override;
         virtual void CopyImageToBuffer(CommandBufferHandle commandBuffer, TextureHandle src, BufferHandle dst) override;
+        virtual void CopyBuffer(CommandBufferHandle commandBuffer, BufferHandle src, BufferHandle dst,
+            uint32_t srcOffset, uint32_t dstOffset, uint32_t size) override;
 
         virtual SwapchainResult AcquireNextSwapchainImage(SwapchainHandle swapchain, uint32_t* imageIndex,
             SemaphoreHandle signalSemaphore=NULL) override;
@@ -261,6 +266,10 @@ namespace Glory
 
         virtual void OnInitialize() override;
 
+    private: /* Resource caching */
+        virtual void LoadPipelineCache(const std::filesystem::path& path) override;
+        virtual void SavePipelineCache() override;
+
     private: /* Resource management */
         virtual BufferHandle CreateBuffer(size_t bufferSize, BufferType type, BufferFlags flags=BF_None) override;
         virtual void ResizeBuffer(BufferHandle buffer, size_t bufferSize) override;
@@ -272,12 +281,13 @@ namespace Glory
         virtual void ReadBuffer(BufferHandle handle, void* outData, uint32_t offset, uint32_t size) override;
 
         virtual MeshHandle CreateMesh(std::vector<BufferHandle>&& buffers, uint32_t vertexCount,
-            uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes) override;
+            uint32_t indexCount, uint32_t stride, const std::vector<AttributeType>& attributeTypes,
+            IndexType indexType=IndexType::UInt32) override;
         virtual void UpdateMesh(MeshHandle mesh, std::vector<BufferHandle>&& buffers,
             uint32_t vertexCount, uint32_t indexCount) override;
         virtual void UpdateMesh(MeshHandle mesh, MeshData* pMeshData) override;
 
-        virtual TextureHandle CreateTexture(TextureData* pTexture) override;
+        virtual TextureHandle CreateTexture(TextureData* pTexture, uint32_t firstMipLevel=0) override;
         virtual TextureHandle CreateTexture(CubemapData* pCubemap) override;
         virtual TextureHandle CreateTexture(const TextureCreateInfo& textureInfo, const void* pixels=nullptr, size_t dataSize=0) override;
         virtual void UpdateTexture(TextureHandle texture, TextureData* pTextureData) override;
@@ -339,6 +349,9 @@ namespace Glory
 
         void CopyFromBuffer(vk::CommandBuffer commandBuffer, vk::Buffer dst, vk::Buffer src,
             int32_t dstOffset, int32_t srcOffset, uint32_t size);
+        void CopyMipLevelsFromBuffer(vk::CommandBuffer commandBuffer, vk::Buffer buffer, vk::Image image,
+            vk::ImageAspectFlags aspectFlags, const std::vector<ImageData::MipLevel>& mipLevels, uint32_t levelCount,
+            uint32_t layerCount=1, size_t layerSize=0);
 
         void CopyToBuffer(vk::CommandBuffer commandBuffer, vk::Image image, vk::ImageLayout layout,
             vk::Buffer buffer, vk::ImageAspectFlags aspectFlags, vk::Offset3D imageOffset,
@@ -350,7 +363,10 @@ namespace Glory
         vk::SurfaceFormatKHR SelectSurfaceFormat(vk::SurfaceKHR surface, const std::vector<vk::Format> requestFormats, vk::ColorSpaceKHR requestColorSpace);
 
         ImageHandle GetCachedImage(ImageData* pImage);
-        ImageHandle CreateImage(const TextureCreateInfo& textureInfo, const void* pixels, size_t dataSize);
+        TextureHandle CreateTexture(const TextureCreateInfo& textureInfo, const void* pixels, size_t dataSize,
+            const std::vector<ImageData::MipLevel>& storedMipLevels);
+        ImageHandle CreateImage(const TextureCreateInfo& textureInfo, const void* pixels, size_t dataSize,
+            const std::vector<ImageData::MipLevel>& storedMipLevels={});
         void UpdateImage(ImageHandle image, ImageData* pImage);
 
     private:
@@ -358,6 +374,8 @@ namespace Glory
         bool CreateSwapchain(VK_Swapchain& swapchain, const vk::SurfaceCapabilitiesKHR& capabilities, vk::SurfaceKHR surface,
             const glm::uvec2& resolution, bool vsync, uint32_t minImageCount);
         bool CreatePipeline(VK_Pipeline& pipeline, PipelineData* pPipeline);
+        void CreatePipelineCache();
+        bool IsPipelineCacheCompatible(const std::vector<char>& data) const;
         void ResizeBuffer(VK_Buffer& buffer);
 
     private:
@@ -406,5 +424,10 @@ namespace Glory
         CommandBufferAllocator m_CommandBufferAllocator;
 
         ImageHandle m_DefaultImage;
+
+        /* Shared by all graphics and compute pipelines, which like every other
+         * device resource are only created on the render thread */
+        vk::PipelineCache m_VKPipelineCache;
+        std::filesystem::path m_PipelineCachePath;
     };
 }
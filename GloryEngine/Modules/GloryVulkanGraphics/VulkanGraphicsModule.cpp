@@ -101,8 +101,6 @@ namespace Glory
             return;
         }
 
-        m_Devices.reserve(deviceCount);
-
         const std::vector<const char*> deviceExtensions = {
             VK_KHR_SWAPCHAIN_EXTENSION_NAME,
             VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME,
@@ -10,6 +10,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vulkan/vulkan.hpp>
 
+#include <list>
+
 namespace Glory
 {
 	class VulkanDevice;
@@ -64,7 +66,7 @@ namespace Glory
 		
 		std::map<SamplerSettings, vk::Sampler, SamplerSettingsComparer> m_Samplers;
 
-		std::vector<VulkanDevice> m_Devices;
+		std::list<VulkanDevice> m_Devices;
 
 #if defined(_DEBUG)
 		vk::DebugUtilsMessengerEXT m_DebugMessenger;
@@ -162,6 +162,7 @@ namespace Glory
 
 		GraphicsDevice* pDevice = m_pEngine->ActiveGraphicsDevice();
 		if (m_Swapchain) pDevice->FreeSwapchain(m_Swapchain);
+		if (pDevice) pDevice->SavePipelineCache();
 
 		m_IsRunning = false;
 		m_pEngine->GetSceneManager()->Stop();
@@ -210,14 +211,24 @@ namespace Glory
 	{
 		if (!std::filesystem::exists(path)) return;
 
-		Utils::BinaryFileStream file{ path, true };
+		/* Map the archive so images and audio can reference their payloads without copying */
+		Utils::BinaryMappedFileStream file{ path };
+		if (!file.IsOpen())
+		{
+			m_pEngine->GetDebug().LogError("GloryRuntime::LoadAssetGroup: Failed to map asset group.");
+			return;
+		}
 		AssetArchive archive{ &file };
-		archive.Deserialize(m_pEngine);
+		if (!archive.ReadTableOfContents(&m_pEngine->GetDebug())) return;
 
-		for (size_t i = 0; i < archive.Size(); ++i)
+		Resources& resources = m_pEngine->GetResources();
+		for (size_t i = 0; i < archive.EntryCount(); ++i)
 		{
-			Resource* pResource = archive.Get(m_pEngine, i);
-			m_pEngine->GetResources().AddResource(&pResource);
+			/* Assets shared with a group that was loaded before are already resident */
+			if (resources.GetResource(archive.Entry(i).m_ID)) continue;
+			Resource* pResource = archive.Load(m_pEngine, i);
+			if (!pResource) continue;
+			resources.AddResource(&pResource);
 		}
 	}
 
@@ -225,7 +236,12 @@ namespace Glory
 	{
 		if (!std::filesystem::exists(path)) return;
 
-		Utils::BinaryFileStream file{ path, true };
+		Utils::BinaryMappedFileStream file{ path };
+		if (!file.IsOpen())
+		{
+			m_pEngine->GetDebug().LogError("GloryRuntime::LoadShaderPack: Failed to map shader pack.");
+			return;
+		}
 		AssetArchive archive{ &file };
 		archive.Deserialize(m_pEngine);
 
@@ -235,6 +251,15 @@ namespace Glory
 			FileData* pShader = static_cast<FileData*>(pResource);
 			m_pEngine->GetPipelineManager().AddShader(pShader);
 		}
+
+		/* The pipeline cache lives next to the shader pack it was built from */
+		GraphicsDevice* pDevice = m_pEngine->ActiveGraphicsDevice();
+		if (pDevice)
+		{
+			std::filesystem::path pipelineCachePath = path;
+			pipelineCachePath.replace_extension(".gcpc");
+			pDevice->LoadPipelineCache(pipelineCachePath);
+		}
 	}
 
 	IEngine* GloryRuntime::GetEngine()
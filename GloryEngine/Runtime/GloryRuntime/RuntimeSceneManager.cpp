@@ -78,7 +78,12 @@ namespace Glory
 			return;
 		}
 
-		Utils::BinaryFileStream file{ path, true };
+		Utils::BinaryMappedFileStream file{ path };
+		if (!file.IsOpen())
+		{
+			m_pEngine->GetDebug().LogError("RuntimeSceneManager::LoadSceneOnly: Failed to map scene file.");
+			return;
+		}
 		AssetArchive archive{ &file };
 		archive.Deserialize(m_pEngine);
 
@@ -1,6 +1,20 @@
 #include "BinaryStream.h"
 #include "BitSet.h"
 
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 namespace Glory::Utils
 {
 	BinaryFileStream::BinaryFileStream(const std::filesystem::path& path, bool read, bool trunc):
@@ -232,7 +246,7 @@ namespace Glory::Utils
 		{
 			const size_t minimumSize = m_Size + size;
 			const size_t newSize = minimumSize + minimumSize/2;
-			ResizeBuffer(m_Size + size);
+			ResizeBuffer(newSize);
 		}
 
 		std::memcpy(&m_Buffer[m_Tell], data, size);
@@ -255,4 +269,141 @@ namespace Glory::Utils
 	{
 		return m_Buffer.get();
 	}
+
+	struct BinaryMappedFileStream::Mapping
+	{
+		~Mapping()
+		{
+#ifdef _WIN32
+			if (m_pData) UnmapViewOfFile(m_pData);
+			if (m_MapHandle) CloseHandle(m_MapHandle);
+			if (m_FileHandle != INVALID_HANDLE_VALUE) CloseHandle(m_FileHandle);
+#else
+			if (m_pData) munmap(m_pData, m_Size);
+#endif
+		}
+
+		char* m_pData = nullptr;
+		size_t m_Size = 0;
+#ifdef _WIN32
+		HANDLE m_FileHandle = INVALID_HANDLE_VALUE;
+		HANDLE m_MapHandle = NULL;
+#endif
+	};
+
+	BinaryMappedFileStream::BinaryMappedFileStream(const std::filesystem::path& path):
+		m_Mapping(std::make_shared<Mapping>()), m_Data(nullptr), m_Size(0), m_Tell(0)
+	{
+#ifdef _WIN32
+		m_Mapping->m_FileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+			nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_Mapping->m_FileHandle == INVALID_HANDLE_VALUE) return;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_Mapping->m_FileHandle, &size) || size.QuadPart == 0) return;
+		/* Copy on write so viewed bytes can be modified without touching the file */
+		m_Mapping->m_MapHandle = CreateFileMappingW(m_Mapping->m_FileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (!m_Mapping->m_MapHandle) return;
+		void* pData = MapViewOfFile(m_Mapping->m_MapHandle, FILE_MAP_COPY, 0, 0, 0);
+		if (!pData) return;
+		m_Mapping->m_pData = static_cast<char*>(pData);
+		m_Mapping->m_Size = size_t(size.QuadPart);
+#else
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file == -1) return;
+		struct stat fileStat;
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			close(file);
+			return;
+		}
+		/* Copy on write so viewed bytes can be modified without touching the file */
+		void* pData = mmap(nullptr, size_t(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		close(file);
+		if (pData == MAP_FAILED) return;
+		m_Mapping->m_pData = static_cast<char*>(pData);
+		m_Mapping->m_Size = size_t(fileStat.st_size);
+#endif
+		m_Data = m_Mapping->m_pData;
+		m_Size = m_Mapping->m_Size;
+	}
+
+	BinaryMappedFileStream::~BinaryMappedFileStream()
+	{
+		Close();
+	}
+
+	bool BinaryMappedFileStream::IsOpen() const
+	{
+		return m_Data != nullptr;
+	}
+
+	void BinaryMappedFileStream::Seek(size_t offset, Relative relative)
+	{
+		switch (relative)
+		{
+		case BinaryStream::Relative::Start:
+			m_Tell = offset;
+			break;
+		case BinaryStream::Relative::Current:
+			m_Tell = m_Tell + offset;
+			break;
+		case BinaryStream::Relative::End:
+			m_Tell = m_Size - offset;
+			break;
+		default:
+			break;
+		}
+	}
+
+	size_t BinaryMappedFileStream::Tell() const
+	{
+		return m_Tell;
+	}
+
+	size_t BinaryMappedFileStream::Size() const
+	{
+		return m_Size;
+	}
+
+	BinaryStream& BinaryMappedFileStream::Write(const char*, size_t)
+	{
+		return *this;
+	}
+
+	BinaryStream& BinaryMappedFileStream::Read(char* out, size_t size)
+	{
+		/* Reading past the end leaves the rest of the output zeroed */
+		const size_t available = m_Tell < m_Size ? std::min(size, m_Size - m_Tell) : 0;
+		if (available > 0) std::memcpy(out, &m_Data[m_Tell], available);
+		if (available < size) std::memset(out + available, 0, size - available);
+		m_Tell += size;
+		return *this;
+	}
+
+	void BinaryMappedFileStream::Close()
+	{
+		/* Views handed out keep the mapping alive through their owner */
+		m_Mapping.reset();
+		m_Data = nullptr;
+		m_Size = 0;
+		m_Tell = 0;
+	}
+
+	char* BinaryMappedFileStream::View(size_t size)
+	{
+		if (!m_Data || m_Tell > m_Size || size > m_Size - m_Tell) return nullptr;
+		char* pData = &m_Data[m_Tell];
+		m_Tell += size;
+		return pData;
+	}
+
+	std::shared_ptr<void> BinaryMappedFileStream::ViewOwner() const
+	{
+		return m_Mapping;
+	}
+
+	bool BinaryMappedFileStream::Eof()
+	{
+		return m_Tell >= m_Size;
+	}
 }
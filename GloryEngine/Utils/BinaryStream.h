@@ -3,6 +3,7 @@
 
 #include <fstream>
 #include <filesystem>
+#include <memory>
 
 namespace Glory::Utils
 {
@@ -158,6 +159,18 @@ namespace Glory::Utils
 
 		BinaryStream& Read(std::vector<char>& buffer, size_t size = 0);
 
+		/**
+		 * @brief Skip the next bytes of the stream and get them without copying
+		 * @param size Number of bytes
+		 * @returns The bytes or nullptr if the stream can't provide them in place, nothing is skipped then
+		 *
+		 * The bytes are only guaranteed to stay valid as long as the object returned by @ref ViewOwner() is kept alive.
+		 * They may be written to, this never changes the underlying file.
+		 */
+		virtual char* View(size_t size) { return nullptr; }
+		/** @brief Keeps the memory returned by @ref View() alive, even after the stream is closed */
+		virtual std::shared_ptr<void> ViewOwner() const { return nullptr; }
+
 		virtual bool Eof() = 0;
 	};
 
@@ -215,4 +228,38 @@ namespace Glory::Utils
 		size_t m_Size;
 		size_t m_Tell;
 	};
+
+	/**
+	 * @brief Read only stream of a memory mapped file
+	 *
+	 * Reading copies straight from the mapping and @ref View() hands out the mapped bytes without copying.
+	 * The mapping is copy on write, writing to viewed bytes only copies the touched pages.
+	 */
+	class BinaryMappedFileStream : public BinaryStream
+	{
+	public:
+		BinaryMappedFileStream(const std::filesystem::path& path);
+		virtual ~BinaryMappedFileStream();
+
+		/** @brief Whether the file could be mapped */
+		bool IsOpen() const;
+
+		void Seek(size_t offset, Relative relative = Relative::Start) override;
+		size_t Tell() const override;
+		size_t Size() const override;
+		BinaryStream& Write(const char* data, size_t size) override;
+		BinaryStream& Read(char* out, size_t size) override;
+		void Close() override;
+		char* View(size_t size) override;
+		std::shared_ptr<void> ViewOwner() const override;
+
+		virtual bool Eof() override;
+
+	private:
+		struct Mapping;
+		std::shared_ptr<Mapping> m_Mapping;
+		char* m_Data;
+		size_t m_Size;
+		size_t m_Tell;
+	};
 }
@@ -147,6 +147,10 @@ group "Engine"
 	include "Engine/RenderDocAPI"
 group ""
 
+group "Engine/Tests"
+	include "Engine/Tests"
+group ""
+
 group "Modules"
 	include "Modules/GloryOpenGLGraphics"
 	include "Modules/GlorySDLWindow"